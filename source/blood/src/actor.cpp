@@ -4397,6 +4397,7 @@ int MoveThing(spritetype *pSprite)
         short bakCstat = pSprite->cstat;
         pSprite->cstat &= ~257;
         v8 = gSpriteHit[nXSprite].hit = ClipMove((int*)&pSprite->x, (int*)&pSprite->y, (int*)&pSprite->z, &nSector, xvel[nSprite]>>12, yvel[nSprite]>>12, pSprite->clipdist<<2, (pSprite->z-top)/4, (bottom-pSprite->z)/4, CLIPMASK0);
+        spritegridTouch(nSprite);
         pSprite->cstat = bakCstat;
         dassert(nSector >= 0);
         if (pSprite->sectnum != nSector)
@@ -4593,6 +4594,7 @@ void MoveDude(spritetype *pSprite)
             short bakCstat = pSprite->cstat;
             pSprite->cstat &= ~257;
             gSpriteHit[nXSprite].hit = ClipMove((int*)&pSprite->x, (int*)&pSprite->y, (int*)&pSprite->z, &nSector, xvel[nSprite]>>12, yvel[nSprite]>>12, wd, tz, bz, CLIPMASK0);
+            spritegridTouch(nSprite);
             if (nSector == -1)
             {
                 nSector = pSprite->sectnum;
@@ -4603,7 +4605,9 @@ void MoveDude(spritetype *pSprite)
             if (sector[nSector].type >= kSectorPath && sector[nSector].type <= kSectorRotate)
             {
                 short nSector2 = nSector;
-                if (pushmove_old(&pSprite->x, &pSprite->y, &pSprite->z, &nSector2, wd, tz, bz, CLIPMASK0) == -1)
+                int const nPush = pushmove_old(&pSprite->x, &pSprite->y, &pSprite->z, &nSector2, wd, tz, bz, CLIPMASK0);
+                spritegridTouch(nSprite);
+                if (nPush == -1)
                     actDamageSprite(nSprite, pSprite, kDamageFall, 1000 << 4);
                 if (nSector2 != -1)
                     nSector = nSector2;
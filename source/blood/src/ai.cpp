@@ -1435,7 +1435,7 @@ void aiThinkTarget(spritetype *pSprite, XSPRITE *pXSprite)
             int nDist = approxDist(dx, dy);
             if (nDist > pDudeInfo->seeDist && nDist > pDudeInfo->hearDist)
                 continue;
-            if (!cansee(x, y, z, nSector, pSprite->x, pSprite->y, pSprite->z-((pDudeInfo->eyeHeight*pSprite->yrepeat)<<2), pSprite->sectnum))
+            if (!canseeCached(x, y, z, nSector, pSprite->x, pSprite->y, pSprite->z-((pDudeInfo->eyeHeight*pSprite->yrepeat)<<2), pSprite->sectnum))
                 continue;
             int nDeltaAngle = ((getangle(dx,dy)+1024-pSprite->ang)&2047)-1024;
             if (nDist < pDudeInfo->seeDist && klabs(nDeltaAngle) <= pDudeInfo->periphery)
@@ -1474,7 +1474,7 @@ void aiLookForTarget(spritetype *pSprite, XSPRITE *pXSprite)
             int nDist = approxDist(dx, dy);
             if (nDist > pDudeInfo->seeDist && nDist > pDudeInfo->hearDist)
                 continue;
-            if (!cansee(x, y, z, nSector, pSprite->x, pSprite->y, pSprite->z-((pDudeInfo->eyeHeight*pSprite->yrepeat)<<2), pSprite->sectnum))
+            if (!canseeCached(x, y, z, nSector, pSprite->x, pSprite->y, pSprite->z-((pDudeInfo->eyeHeight*pSprite->yrepeat)<<2), pSprite->sectnum))
                 continue;
             int nDeltaAngle = ((getangle(dx,dy)+1024-pSprite->ang)&2047)-1024;
             if (nDist < pDudeInfo->seeDist && klabs(nDeltaAngle) <= pDudeInfo->periphery)
@@ -1517,7 +1517,56 @@ void aiLookForTarget(spritetype *pSprite, XSPRITE *pXSprite)
     }
 }
 
+static canseequery_t aiCanseeQueries[kMaxSprites];
+
+// Collects the cansee() checks the dudes thinking this frame will most likely make (players and
+// their target against their eyes) so they can be answered in one batch.
+static void aiPrepareCansee(void)
+{
+    int nQueries = 0;
+    for (int nSprite = headspritestat[kStatDude]; nSprite >= 0; nSprite = nextspritestat[nSprite])
+    {
+        spritetype *pSprite = &sprite[nSprite];
+        if ((pSprite->flags & 32) || (gFrame & 3) != (nSprite & 3))
+            continue;
+        XSPRITE *pXSprite = &xsprite[pSprite->extra];
+        if (IsPlayerSprite(pSprite) || pXSprite->health == 0 || !pXSprite->aiState->thinkFunc)
+            continue;
+        if (nQueries+kMaxPlayers+1 > kMaxSprites)
+            break;
+        DUDEINFO *pDudeInfo = getDudeInfo(pSprite->type);
+        vec3_t const eye = { pSprite->x, pSprite->y, pSprite->z-((pDudeInfo->eyeHeight*pSprite->yrepeat)<<2) };
+        for (int p = connecthead; p >= 0; p = connectpoint2[p])
+        {
+            PLAYER *pPlayer = &gPlayer[p];
+            if (pSprite->owner == pPlayer->nSprite || pPlayer->pXSprite->health == 0)
+                continue;
+            spritetype *pPlayerSprite = pPlayer->pSprite;
+            int nDist = approxDist(pPlayerSprite->x-pSprite->x, pPlayerSprite->y-pSprite->y);
+            if (nDist > pDudeInfo->seeDist && nDist > pDudeInfo->hearDist)
+                continue;
+            canseequery_t &query = aiCanseeQueries[nQueries++];
+            query.pos1 = { pPlayerSprite->x, pPlayerSprite->y, pPlayerSprite->z };
+            query.sect1 = pPlayerSprite->sectnum;
+            query.pos2 = eye;
+            query.sect2 = pSprite->sectnum;
+        }
+        int nTarget = pXSprite->target;
+        if (nTarget >= 0 && nTarget < kMaxSprites && sprite[nTarget].statnum < kMaxStatus && !IsPlayerSprite(&sprite[nTarget]))
+        {
+            spritetype *pTarget = &sprite[nTarget];
+            canseequery_t &query = aiCanseeQueries[nQueries++];
+            query.pos1 = { pTarget->x, pTarget->y, pTarget->z };
+            query.sect1 = pTarget->sectnum;
+            query.pos2 = eye;
+            query.sect2 = pSprite->sectnum;
+        }
+    }
+    canseePrepareCache(aiCanseeQueries, nQueries);
+}
+
 void aiProcessDudes(void) {
+    aiPrepareCansee();
     for (int nSprite = headspritestat[kStatDude]; nSprite >= 0; nSprite = nextspritestat[nSprite]) {
         spritetype *pSprite = &sprite[nSprite];
         if (pSprite->flags & 32) continue;
@@ -1565,6 +1614,7 @@ void aiProcessDudes(void) {
                 break;
         }
     }
+    canseeClearCache();
     memset(cumulDamage, 0, sizeof(cumulDamage));
 }
 
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "renderlayer.h"
 #include "vfs.h"
 #include "fx_man.h"
+#include "pvs.h"
 #include "common.h"
 #include "common_game.h"
 #include "gamedefs.h"
@@ -113,6 +114,8 @@ int gNetPlayers;
 char *pUserTiles = NULL;
 char *pUserSoundRFF = NULL;
 char *pUserRFF = NULL;
+char *pTimedemoFile = NULL;
+bool bTimedemoRender = true;
 
 int gChokeCounter = 0;
 
@@ -181,6 +184,7 @@ void M32RunScript(const char *s)
 
 void ShutDown(void)
 {
+    Resource::StopLoads();
     if (!in3dmode())
         return;
     CONFIG_WriteSetup(0);
@@ -202,6 +206,7 @@ void ShutDown(void)
     DO_FREE_AND_NULL(pUserTiles);
     DO_FREE_AND_NULL(pUserSoundRFF);
     DO_FREE_AND_NULL(pUserRFF);
+    DO_FREE_AND_NULL(pTimedemoFile);
 }
 
 void QuitGame(void)
@@ -401,6 +406,7 @@ void PreloadTiles(void)
     viewPrecacheTiles();
     fxPrecache();
     gibPrecache();
+    seqPrecacheFinish();
 
     gameHandleEvents();
 }
@@ -449,6 +455,52 @@ void PrecacheExtraTextureMaps(int nTile)
 }
 #endif
 
+static char gVisibleTiles[(kMaxTiles+7)>>3];
+static char gOptionalTiles[(kMaxTiles+7)>>3];
+
+static void PreloadSectorTiles(int nSector, char *pTiles)
+{
+    sectortype *pSector = &sector[nSector];
+    if ((unsigned)pSector->floorpicnum < kMaxTiles)
+        SetBitString(pTiles, pSector->floorpicnum);
+    if ((unsigned)pSector->ceilingpicnum < kMaxTiles)
+        SetBitString(pTiles, pSector->ceilingpicnum);
+    for (int i = pSector->wallptr; i < pSector->wallptr+pSector->wallnum; i++)
+    {
+        if ((unsigned)wall[i].picnum < kMaxTiles)
+            SetBitString(pTiles, wall[i].picnum);
+        if ((unsigned)wall[i].overpicnum < kMaxTiles)
+            SetBitString(pTiles, wall[i].overpicnum);
+    }
+    for (int nSprite = headspritesect[nSector]; nSprite >= 0; nSprite = nextspritesect[nSprite])
+    {
+        if ((unsigned)sprite[nSprite].picnum < kMaxTiles)
+            SetBitString(pTiles, sprite[nSprite].picnum);
+    }
+}
+
+// Tiles only used in sectors that no player can see from where they start don't have to be in the
+// cache before the level starts: PreloadCache() leaves them to the loader threads.
+static void PreloadFindOptionalTiles(void)
+{
+    memset(gOptionalTiles, 0, sizeof(gOptionalTiles));
+    if (!pvsactive)
+        return;
+    memset(gVisibleTiles, 0, sizeof(gVisibleTiles));
+    for (int nSector = 0; nSector < numsectors; nSector++)
+    {
+        bool bVisible = false;
+        for (int p = connecthead; p >= 0 && !bVisible; p = connectpoint2[p])
+        {
+            spritetype *pSprite = gPlayer[p].pSprite;
+            bVisible = !pSprite || pSprite->sectnum < 0 || pvsCanSee(pSprite->sectnum, nSector);
+        }
+        PreloadSectorTiles(nSector, bVisible ? gVisibleTiles : gOptionalTiles);
+    }
+    for (unsigned int i = 0; i < sizeof(gOptionalTiles); i++)
+        gOptionalTiles[i] &= ~gVisibleTiles[i];
+}
+
 void PreloadCache(void)
 {
     char tempbuf[128];
@@ -461,10 +513,34 @@ void PreloadCache(void)
     if (MusicRestartsOnLoadToggle)
         sndTryPlaySpecialMusic(MUS_LOADING);
     PreloadTiles();
+    PreloadFindOptionalTiles();
     ClockTicks clock = totalclock;
     int cnt = 0;
+    int nTiles = 0;
     int percentDisplayed = -1;
 
+    // queue the whole set first so that it is read in the background while the loop below goes
+    // through it, the tiles that are waited for first
+    for (int i=0; i<kMaxTiles; i++)
+    {
+        if (TestBitString(gotpic, i) && !TestBitString(gOptionalTiles, i))
+            tilePrefetch(i);
+    }
+    for (int i=0; i<kMaxTiles; i++)
+    {
+        if (TestBitString(gotpic, i) && TestBitString(gOptionalTiles, i))
+            tilePrefetch(i);
+    }
+    for (int i=0; i<kMaxTiles; i++)
+    {
+        if (!TestBitString(gotpic, i))
+            continue;
+        if (TestBitString(gOptionalTiles, i) && (waloff[i] != 0 || tileIsLoading(i)))
+            ClearBitString(gotpic, i);
+        else
+            nTiles++;
+    }
+
     for (int i=0; i<kMaxTiles && !KB_KeyPressed(sc_Space); i++)
     {
         if (TestBitString(gotpic, i))
@@ -477,19 +553,20 @@ void PreloadCache(void)
 #endif
 
             MUSIC_Update();
+            Resource::FinishLoads();
 
             if ((++cnt & 7) == 0)
                 gameHandleEvents();
 
-            if (videoGetRenderMode() != REND_CLASSIC && totalclock - clock > (kTicRate>>2))
+            if (totalclock - clock > (kTicRate>>2))
             {
-                int const percentComplete = min(100, tabledivide32_noinline(100 * cnt, nPrecacheCount));
+                int const percentComplete = min(100, tabledivide32_noinline(100 * cnt, nTiles));
 
                 // this just prevents the loading screen percentage bar from making large jumps
                 while (percentDisplayed < percentComplete)
                 {
                     gameHandleEvents();
-                    Bsprintf(tempbuf, "Loaded %d%% (%d/%d textures)\n", percentDisplayed, cnt, nPrecacheCount);
+                    Bsprintf(tempbuf, "Loaded %d%% (%d/%d textures)\n", percentDisplayed, cnt, nTiles);
                     viewLoadingScreenUpdate(tempbuf, percentDisplayed);
                     videoNextPage();
 
@@ -783,6 +860,7 @@ void StartLevel(GAMEOPTIONS *gameOptions)
     gPaused = 0;
     gGameStarted = 1;
     ready2send = 1;
+    spritegridBuild();
 }
 
 void StartNetworkLevel(void)
@@ -1015,7 +1093,8 @@ void ProcessFrame(void)
         gPlayer[i].input.q16mlook = gFifoInput[gNetFifoTail&255][i].q16mlook;
     }
     gNetFifoTail++;
-    if (!(gFrame&7))
+    spritegridRefile();
+    if (numplayers > 1)
     {
         CalcGameChecksum();
         memcpy(gCheckFifo[gCheckHead[myconnectindex]&255][myconnectindex], gChecksum, sizeof(gChecksum));
@@ -1183,6 +1262,8 @@ SWITCH switches[] = {
     { "c", 43, 1 },
     { "conf", 43, 1 },
     { "noconsole", 43, 0 },
+    { "timedemo", 44, 1 },
+    { "norender", 45, 0 },
     { NULL, 0, 0 }
 };
 
@@ -1207,6 +1288,7 @@ void PrintHelp(void)
         "-noautoload\tDisable loading from autoload directory\n"
         "-nodemo\t\tNo Demos\n"
         "-nodudes\tNo monsters\n"
+        "-norender\tDon't draw anything during -timedemo\n"
         "-playback\tPlay back a demo\n"
         "-pname\t\tOverride player name setting from config file\n"
         "-record\t\tRecord demo\n"
@@ -1217,6 +1299,7 @@ void PrintHelp(void)
 #endif
         "-skill\t\tSet player handicap; Range:0..4; Default:2; (NOT difficulty level.)\n"
         "-snd\t\tSpecify an RFF Sound file name\n"
+        "-timedemo <file.dem>\tPlay back a demo as fast as possible, report timings and quit\n"
         "-usecwd\t\tRead data and configuration from current directory\n"
         ;
 #ifdef WM_MSGBOX_WINDOW
@@ -1497,6 +1580,19 @@ void ParseOptions(void)
             break;
         case 43: // conf, noconsole
             break;
+        case 44:
+            if (OptArgc < 1)
+                ThrowError("Missing argument");
+            pTimedemoFile = (char*)malloc(strlen(OptArgv[0])+1);
+            if (!pTimedemoFile)
+                return;
+            strcpy(pTimedemoFile, OptArgv[0]);
+            bNoDemo = 1;
+            bQuickStart = 1;
+            break;
+        case 45:
+            bTimedemoRender = false;
+            break;
         }
     }
 #if 0
@@ -1625,7 +1721,9 @@ int app_main(int argc, char const * const * argv)
     if (Bstrcmp(SetupFilename, SETUPFILENAME))
         initprintf("Using config file \"%s\".\n", SetupFilename);
 
+    G_StartupPhase(NULL);
     ScanINIFiles();
+    G_StartupPhase("ini scan");
 
 #ifdef STARTUP_SETUP_WINDOW
     if (readSetup < 0 || (!gNoSetup && (configversion != BYTEVERSION || gSetup.forcesetup)) || gCommandSetup)
@@ -1638,7 +1736,9 @@ int app_main(int argc, char const * const * argv)
     }
 #endif
 
+    G_StartupPhase(NULL);  // don't count time spent in the setup window
     G_LoadGroups(!bNoAutoLoad && !gSetup.noautoload);
+    G_StartupPhase("groups");
 
     //if (!g_useCwd)
     //    G_CleanupSearchPaths();
@@ -1692,6 +1792,7 @@ int app_main(int argc, char const * const * argv)
     gSysRes.Init(pUserRFF ? pUserRFF : "BLOOD.RFF");
     gGuiRes.Init("GUI.RFF");
     gSoundRes.Init(pUserSoundRFF ? pUserSoundRFF : "SOUNDS.RFF");
+    G_StartupPhase("resources");
 
     HookReplaceFunctions();
 
@@ -1716,6 +1817,7 @@ int app_main(int argc, char const * const * argv)
     }
 
     LoadExtraArts();
+    G_StartupPhase("art");
 
     levelLoadDefaults();
 
@@ -1730,6 +1832,7 @@ int app_main(int argc, char const * const * argv)
         initprintf("Definitions file \"%s\" loaded in %d ms.\n", defsfile, etime-stime);
     }
     loaddefinitions_game(defsfile, FALSE);
+    G_StartupPhase("defs");
     powerupInit();
     initprintf("Loading cosine table\n");
     trigInit(gSysRes);
@@ -1749,6 +1852,7 @@ int app_main(int argc, char const * const * argv)
     timerSetCallback(ClockStrobe);
     enginecompatibilitymode = ENGINE_19960925;
     // PORT-TODO: CD audio init
+    G_StartupPhase("game data");
 
     initprintf("Initializing network users\n");
     netInitialize(true);
@@ -1758,6 +1862,7 @@ int app_main(int argc, char const * const * argv)
     initprintf("Initializing sound system\n");
     sndInit();
     sfxInit();
+    G_StartupPhase("video/sound");
     gChoke.sub_83ff0(518, sub_84230);
     if (bAddUserMap)
     {
@@ -1769,6 +1874,9 @@ int app_main(int argc, char const * const * argv)
 
     OSD_Exec("autoexec.cfg");
 
+    G_StartupPhase("menus");
+    G_PrintStartupTimes();
+
     if (!bQuickStart)
         credLogosDos();
     scrSetDac();
@@ -1789,6 +1897,13 @@ RESTART:
         goto RESTART;
     }
     UpdateNetworkMenus();
+    if (pTimedemoFile)
+    {
+        if (!gDemo.SetupPlayback(pTimedemoFile))
+            ThrowError("Unable to play back demo \"%s\"", pTimedemoFile);
+        gDemo.Timedemo(bTimedemoRender);
+        QuitGame();
+    }
     if (!gDemo.at0 && gDemo.at59ef > 0 && gGameOptions.nGameType == 0 && !bNoDemo)
         gDemo.SetupPlayback(NULL);
     viewSetCrosshairColor(CrosshairColors.r, CrosshairColors.g, CrosshairColors.b);
@@ -1892,6 +2007,7 @@ RESTART:
                 quitevent = 0;
             }
             MUSIC_Update();
+            Resource::FinishLoads();
             CONTROL_BindsEnabled = gInputMode == INPUT_MODE_0;
             switch (gInputMode)
             {
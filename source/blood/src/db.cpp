@@ -196,6 +196,7 @@ void InsertSpriteSect(int nSprite, int nSector)
         headspritesect[nSector] = nSprite;
     }
     sprite[nSprite].sectnum = nSector;
+    spritegridLink(nSprite, nSector);
 }
 
 void RemoveSpriteSect(int nSprite)
@@ -203,6 +204,7 @@ void RemoveSpriteSect(int nSprite)
     dassert(nSprite >= 0 && nSprite < kMaxSprites);
     int nSector = sprite[nSprite].sectnum;
     dassert(nSector >= 0 && nSector < kMaxSectors);
+    spritegridUnlink(nSprite);
     int nOther = nextspritesect[nSprite];
     if (nOther < 0)
     {
@@ -410,6 +412,7 @@ unsigned short dbInsertXSprite(int nSprite)
         memset(&gSpriteHit[nXSprite], 0, sizeof(SPRITEHIT));
     xsprite[nXSprite].reference = nSprite;
     sprite[nSprite].extra = nXSprite;
+    evUpdateRX(3, nSprite);
     return nXSprite;
 }
 
@@ -418,6 +421,7 @@ void dbDeleteXSprite(int nXSprite)
     dassert(xsprite[nXSprite].reference >= 0);
     dassert(sprite[xsprite[nXSprite].reference].extra == nXSprite);
     InsertFree(nextXSprite, nXSprite);
+    evUpdateRX(3, xsprite[nXSprite].reference);
     sprite[xsprite[nXSprite].reference].extra = -1;
     xsprite[nXSprite].reference = -1;
 }
@@ -433,6 +437,7 @@ unsigned short dbInsertXWall(int nWall)
     memset(&xwall[nXWall], 0, sizeof(XWALL));
     xwall[nXWall].reference = nWall;
     wall[nWall].extra = nXWall;
+    evUpdateRX(0, nWall);
     return nXWall;
 }
 
@@ -440,6 +445,7 @@ void dbDeleteXWall(int nXWall)
 {
     dassert(xwall[nXWall].reference >= 0);
     InsertFree(nextXWall, nXWall);
+    evUpdateRX(0, xwall[nXWall].reference);
     wall[xwall[nXWall].reference].extra = -1;
     xwall[nXWall].reference = -1;
 }
@@ -455,6 +461,7 @@ unsigned short dbInsertXSector(int nSector)
     memset(&xsector[nXSector], 0, sizeof(XSECTOR));
     xsector[nXSector].reference = nSector;
     sector[nSector].extra = nXSector;
+    evUpdateRX(6, nSector);
     return nXSector;
 }
 
@@ -462,6 +469,7 @@ void dbDeleteXSector(int nXSector)
 {
     dassert(xsector[nXSector].reference >= 0);
     InsertFree(nextXSector, nXSector);
+    evUpdateRX(6, xsector[nXSector].reference);
     sector[xsector[nXSector].reference].extra = -1;
     xsector[nXSector].reference = -1;
 }
@@ -702,7 +710,11 @@ unsigned int dbReadMapCRC(const char *pPath)
         pathsearchmode = bakpathsearchmode;
         return -1;
     }
-    char *pData = (char*)gSysRes.Lock(pNode);
+    // the map data is only ever read from
+    char *pData = (char*)const_cast<void*>(gSysRes.View(pNode));
+    bool const bLocked = pData == NULL;
+    if (bLocked)
+        pData = (char*)gSysRes.Lock(pNode);
     pathsearchmode = bakpathsearchmode;
 
     int nSize = pNode->size;
@@ -727,7 +739,8 @@ unsigned int dbReadMapCRC(const char *pPath)
         ThrowError("Map file is wrong version");
     }
     unsigned int nCRC = *(unsigned int*)(pData+nSize-4);
-    gSysRes.Unlock(pNode);
+    if (bLocked)
+        gSysRes.Unlock(pNode);
     return nCRC;
 }
 
@@ -776,7 +789,11 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
         pathsearchmode = bakpathsearchmode;
         return -1;
     }
-    char *pData = (char*)gSysRes.Lock(pNode);
+    // the map data is only ever read from
+    char *pData = (char*)const_cast<void*>(gSysRes.View(pNode));
+    bool const bLocked = pData == NULL;
+    if (bLocked)
+        pData = (char*)gSysRes.Lock(pNode);
     pathsearchmode = bakpathsearchmode;
     int nSize = pNode->size;
     MAPSIGNATURE header;
@@ -788,7 +805,8 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
     if (memcmp(header.signature, "BLM\x1a", 4))
     {
         initprintf("Map file corrupted");
-        gSysRes.Unlock(pNode);
+        if (bLocked)
+            gSysRes.Unlock(pNode);
         return -1;
     }
     byte_1A76C8 = 0;
@@ -804,7 +822,8 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
 
     } else {
         initprintf("Map file is wrong version");
-        gSysRes.Unlock(pNode);
+        if (bLocked)
+            gSysRes.Unlock(pNode);
         return -1;
     }
 
@@ -854,14 +873,16 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
         else
         {
             initprintf("Corrupted Map file");
-            gSysRes.Unlock(pNode);
+            if (bLocked)
+                gSysRes.Unlock(pNode);
             return -1;
         }
     }
     else if (mapHeader.at16)
     {
         initprintf("Corrupted Map file");
-        gSysRes.Unlock(pNode);
+        if (bLocked)
+            gSysRes.Unlock(pNode);
         return -1;
     }
     parallaxtype = mapHeader.at1a;
@@ -1234,12 +1255,14 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
     if (Bcrc32(pData, nSize-4, 0) != nCRC)
     {
         initprintf("Map File does not match CRC");
-        gSysRes.Unlock(pNode);
+        if (bLocked)
+            gSysRes.Unlock(pNode);
         return -1;
     }
     if (pCRC)
         *pCRC = nCRC;
-    gSysRes.Unlock(pNode);
+    if (bLocked)
+        gSysRes.Unlock(pNode);
     PropagateMarkerReferences();
     if (byte_1A76C8)
     {
@@ -1254,14 +1277,16 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
         else
         {
             initprintf("Corrupted Map file");
-            gSysRes.Unlock(pNode);
+            if (bLocked)
+                gSysRes.Unlock(pNode);
             return -1;
         }
     }
     else if (gSongId != 0)
     {
         initprintf("Corrupted Map file");
-        gSysRes.Unlock(pNode);
+        if (bLocked)
+            gSysRes.Unlock(pNode);
         return -1;
     }
 
@@ -44,37 +44,55 @@ inline bool xsectRangeIsFine(int nXindex) {
 inline bool xwallRangeIsFine(int nXindex) {
     return (nXindex >= 0 && nXindex < kMaxXWalls);
 }
-#pragma pack(push, 1)
-
 struct AISTATE;
 
+// The fields the actor and AI loops read every frame come first, so a dude or thing usually
+// only costs one cache line; the struct is naturally aligned for the same reason. Savegames still
+// store the older packed field order, see XSPRITESAVE in loadsave.cpp.
 struct XSPRITE {
-    unsigned int unused1 : 2;           // additional dude flags in modern maps
-    unsigned int unused2 : 1;           // unused
-    unsigned int unused3 : 2;           // unused
-    unsigned int unused4 : 6;           // unused
-
+    AISTATE* aiState;                   // ai
     signed   int reference : 15;
     unsigned int state : 1;             // State 0
+    signed   int target : 16;           // target sprite
+    unsigned int health : 20;
+    unsigned int dudeDeaf : 1;          // dudeDeaf
+    unsigned int dudeAmbush : 1;        // dudeAmbush
+    unsigned int dudeGuard : 1;         // dudeGuard
+    unsigned int dudeFlag4 : 1;         // unused
+    unsigned int respawnPending : 2;    // respawnPending
+    unsigned int locked : 1;            // Locked
+    unsigned int Proximity : 1;         // Proximity
+    unsigned int isTriggered : 1;       // works in case if triggerOnce selected
+    unsigned int DudeLockout : 1;       // DudeLockout
+    unsigned int medium : 2;            // medium
+    unsigned int stateTimer : 16;       // ai timer
+    unsigned int burnTime : 16;
+    signed   int burnSource : 16;
+    unsigned int height : 16;
     unsigned int busy : 17;
+    unsigned int goalAng : 11;          // Dude goal ang
+    signed   int dodgeDir : 2;          // Dude dodge direction
+    unsigned int restState : 1;         // restState
+    unsigned int Interrutable : 1;      // Interruptable
+    signed   int targetX : 32;          // target x
+    signed   int targetY : 32;          // target y
+    signed   int targetZ : 32;          // target z
+
+    signed   int data1 : 16;            // Data 1
+    signed   int data2 : 16;            // Data 2
+    signed   int data3 : 16;            // Data 3
+    unsigned int data4 : 16;            // Data 4
     unsigned int txID : 10;             // TX ID
     unsigned int rxID : 10;             // RX ID
-    unsigned int command : 8;           // Cmd
-    unsigned int triggerOn : 1;         // going ON
-    unsigned int triggerOff : 1;        // going OFF
     unsigned int busyTime : 12;         // busyTime
     unsigned int waitTime : 12;         // waitTime
-    unsigned int restState : 1;         // restState
-    unsigned int Interrutable : 1;      // Interruptable
-
-    unsigned int respawnPending : 2;    // respawnPending
-
+    unsigned int command : 8;           // Cmd
     unsigned int dropMsg : 8;           // Drop Item
+    unsigned int key : 3;               // Key
+    unsigned int triggerOn : 1;         // going ON
+    unsigned int triggerOff : 1;        // going OFF
     unsigned int Decoupled : 1;         // Decoupled
     unsigned int triggerOnce : 1;       // 1-shot
-    unsigned int isTriggered : 1;       // works in case if triggerOnce selected
-
-    unsigned int key : 3;               // Key
     unsigned int wave : 2;              // Wave
     unsigned int Push : 1;              // Push
     unsigned int Vector : 1;            // Vector
@@ -82,37 +100,17 @@ struct XSPRITE {
     unsigned int Pickup : 1;            // Pickup
     unsigned int Touch : 1;             // Touch
     unsigned int Sight : 1;             // Sight
-    unsigned int Proximity : 1;         // Proximity
     unsigned int lSkill : 5;            // Launch 12345
     unsigned int lS : 1;                // Single
     unsigned int lB : 1;                // Bloodbath
     unsigned int lT : 1;                // Launch Team
     unsigned int lC : 1;                // Coop
-    unsigned int DudeLockout : 1;       // DudeLockout
-    signed   int data1 : 16;            // Data 1
-    signed   int data2 : 16;            // Data 2
-    signed   int data3 : 16;            // Data 3
-    unsigned int data4 : 16;            // Data 4
-    unsigned int locked : 1;            // Locked
-    unsigned int medium : 2;            // medium
     unsigned int respawn : 2;           // Respawn option
     unsigned int lockMsg : 8;           // Lock msg
-    unsigned int health : 20;
-    unsigned int dudeDeaf : 1;          // dudeDeaf
-    unsigned int dudeAmbush : 1;        // dudeAmbush
-    unsigned int dudeGuard : 1;         // dudeGuard
-    unsigned int dudeFlag4 : 1;         // unused
-    signed   int target : 16;           // target sprite
-    signed   int targetX : 32;          // target x
-    signed   int targetY : 32;          // target y
-    signed   int targetZ : 32;          // target z
-    unsigned int goalAng : 11;          // Dude goal ang
-    signed   int dodgeDir : 2;          // Dude dodge direction
-    unsigned int burnTime : 16;
-    signed   int burnSource : 16;
-    unsigned int height : 16;
-    unsigned int stateTimer : 16;       // ai timer
-    AISTATE* aiState;                   // ai
+    unsigned int unused2 : 1;           // unused
+    unsigned int unused1 : 2;           // additional dude flags in modern maps
+    unsigned int unused3 : 2;           // unused
+    unsigned int unused4 : 6;           // unused
     #ifdef NOONE_EXTENSIONS
     signed int sysData1: 32;            // used to keep here various system data, so user can't change it in map editor
     signed int sysData2: 32;            //
@@ -122,6 +120,25 @@ struct XSPRITE {
 
 };
 
+// Every XSPRITE field except aiState, for code that has to go field by field: savegames keep an
+// older layout, and the sync checksum must not depend on the pointer size.
+#define XSPRITE_FIELDS(X) \
+    X(unused1) X(unused2) X(unused3) X(unused4) X(reference) X(state) X(busy) X(txID) X(rxID) \
+    X(command) X(triggerOn) X(triggerOff) X(busyTime) X(waitTime) X(restState) X(Interrutable) \
+    X(respawnPending) X(dropMsg) X(Decoupled) X(triggerOnce) X(isTriggered) X(key) X(wave) X(Push) \
+    X(Vector) X(Impact) X(Pickup) X(Touch) X(Sight) X(Proximity) X(lSkill) X(lS) X(lB) X(lT) X(lC) \
+    X(DudeLockout) X(data1) X(data2) X(data3) X(data4) X(locked) X(medium) X(respawn) X(lockMsg) \
+    X(health) X(dudeDeaf) X(dudeAmbush) X(dudeGuard) X(dudeFlag4) X(target) X(targetX) X(targetY) \
+    X(targetZ) X(goalAng) X(dodgeDir) X(burnTime) X(burnSource) X(height) X(stateTimer) X(scale) \
+    XSPRITE_NNEXT_FIELDS(X)
+#ifdef NOONE_EXTENSIONS
+#define XSPRITE_NNEXT_FIELDS(X) X(sysData1) X(sysData2) X(physAttr)
+#else
+#define XSPRITE_NNEXT_FIELDS(X)
+#endif
+
+#pragma pack(push, 1)
+
 struct XSECTOR {
     signed int reference : 14;
     unsigned int state : 1;             // State
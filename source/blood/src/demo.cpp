@@ -345,6 +345,31 @@ void CDemo::ProcessKeys(void)
     }
 }
 
+void CDemo::StartPlayback(void)
+{
+    viewResizeView(gViewSize);
+    viewSetMessage("");
+    gNetPlayers = atf.nNetPlayers;
+    atb = atf.nInputCount;
+    myconnectindex = atf.nMyConnectIndex;
+    connecthead = atf.nConnectHead;
+    for (int i = 0; i < 8; i++)
+        connectpoint2[i] = atf.connectPoints[i];
+    memset(gNetFifoHead, 0, sizeof(gNetFifoHead));
+    gNetFifoTail = 0;
+    //memcpy(connectpoint2, aimHeight.connectPoints, sizeof(aimHeight.connectPoints));
+    memcpy(&gGameOptions, &m_gameOptions, sizeof(GAMEOPTIONS));
+    gSkill = gGameOptions.nDifficulty;
+    for (int i = 0; i < 8; i++)
+        playerInit(i, 0);
+    StartLevel(&gGameOptions);
+    for (int i = 0; i < 8; i++)
+    {
+        gProfile[i].nAutoAim = 1;
+        gProfile[i].nWeaponSwitch = 1;
+    }
+}
+
 void CDemo::Playback(void)
 {
     CONTROL_BindsEnabled = false;
@@ -363,29 +388,7 @@ _DEMOPLAYBACK:
         while (totalclock >= gNetFifoClock && !gQuitGame)
         {
             if (!v4)
-            {
-                viewResizeView(gViewSize);
-                viewSetMessage("");
-                gNetPlayers = atf.nNetPlayers;
-                atb = atf.nInputCount;
-                myconnectindex = atf.nMyConnectIndex;
-                connecthead = atf.nConnectHead;
-                for (int i = 0; i < 8; i++)
-                    connectpoint2[i] = atf.connectPoints[i];
-                memset(gNetFifoHead, 0, sizeof(gNetFifoHead));
-                gNetFifoTail = 0;
-                //memcpy(connectpoint2, aimHeight.connectPoints, sizeof(aimHeight.connectPoints));
-                memcpy(&gGameOptions, &m_gameOptions, sizeof(GAMEOPTIONS));
-                gSkill = gGameOptions.nDifficulty;
-                for (int i = 0; i < 8; i++)
-                    playerInit(i, 0);
-                StartLevel(&gGameOptions);
-                for (int i = 0; i < 8; i++)
-                {
-                    gProfile[i].nAutoAim = 1;
-                    gProfile[i].nWeaponSwitch = 1;
-                }
-            }
+                StartPlayback();
             ready2send = 0;
             OSD_DispatchQueued();
             if (!gDemo.at1)
@@ -449,6 +452,147 @@ _DEMOPLAYBACK:
     Close();
 }
 
+struct TIMEDEMOSTATS
+{
+    double min, avg, p99, max;
+};
+
+static int TimedemoCompare(const void *a, const void *b)
+{
+    float const fa = *(float const *)a, fb = *(float const *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Sorts pTimes in place.
+static void TimedemoStats(float *pTimes, int nCount, TIMEDEMOSTATS *pStats)
+{
+    double sum = 0.0;
+    for (int i = 0; i < nCount; i++)
+        sum += pTimes[i];
+    qsort(pTimes, nCount, sizeof(float), TimedemoCompare);
+    pStats->min = pTimes[0];
+    pStats->avg = sum / nCount;
+    pStats->p99 = pTimes[ClipHigh(nCount * 99 / 100, nCount - 1)];
+    pStats->max = pTimes[nCount - 1];
+}
+
+static void TimedemoPrintStats(const char *pzName, TIMEDEMOSTATS const *pStats)
+{
+    OSD_Printf("timedemo: %s_min_ms=%.3f %s_avg_ms=%.3f %s_p99_ms=%.3f %s_max_ms=%.3f\n", pzName, pStats->min,
+               pzName, pStats->avg, pzName, pStats->p99, pzName, pStats->max);
+}
+
+// Plays the demo set up by SetupPlayback() once through, one game tic after another with no regard
+// for the game clock, timing how long every tic takes to simulate and, unless bRender is false, to
+// draw. The per-tic times go to timedemo.csv and a summary to the console.
+void CDemo::Timedemo(bool bRender)
+{
+    CONTROL_BindsEnabled = false;
+    ready2send = 0;
+    gViewMode = 3;
+    StartPlayback();
+
+    int nPlayers = 0;
+    for (int p = connecthead; p >= 0; p = connectpoint2[p])
+        nPlayers++;
+
+    int const nTics = atb / nPlayers;
+    if (nTics <= 0)
+    {
+        OSD_Printf("timedemo: demo is empty\n");
+        Close();
+        return;
+    }
+
+    auto pSimTimes = (float *)Xmalloc(nTics * sizeof(float));
+    auto pRenderTimes = (float *)Xmalloc(nTics * sizeof(float));
+    auto pFrameTimes = (float *)Xmalloc(nTics * sizeof(float));
+
+    double const msPerCount = 1000.0 / timerGetPerformanceFrequency();
+    uint64_t const nStartTime = timerGetPerformanceCounter();
+    int nInput = 0, nTic = 0;
+
+    while (nTic < nTics && at1 && !gQuitGame)
+    {
+        for (int p = connecthead; p >= 0; p = connectpoint2[p])
+        {
+            if ((nInput&(kInputBufferSize-1)) == 0)
+                ReadInput(ClipHigh(atb-nInput, kInputBufferSize));
+            memcpy(&gFifoInput[gNetFifoHead[p]&255], &at1aa[nInput&(kInputBufferSize-1)], sizeof(GINPUT));
+            gNetFifoHead[p]++;
+            nInput++;
+        }
+
+        uint64_t const nSimStart = timerGetPerformanceCounter();
+        ProcessFrame();
+        uint64_t const nSimEnd = timerGetPerformanceCounter();
+
+        if (bRender)
+        {
+            // always show the tic just simulated instead of interpolating towards it
+            gNetFifoClock = totalclock;
+            viewDrawScreen();
+            videoNextPage();
+            if (TestBitString(gotpic, 2342))
+            {
+                FireProcess();
+                ClearBitString(gotpic, 2342);
+            }
+        }
+        uint64_t const nRenderEnd = timerGetPerformanceCounter();
+
+        pSimTimes[nTic] = (float)((nSimEnd - nSimStart) * msPerCount);
+        pRenderTimes[nTic] = (float)((nRenderEnd - nSimEnd) * msPerCount);
+        pFrameTimes[nTic] = (float)((nRenderEnd - nSimStart) * msPerCount);
+        nTic++;
+
+        if (handleevents() && quitevent)
+            break;
+    }
+
+    double const totalTime = (timerGetPerformanceCounter() - nStartTime) * msPerCount;
+
+    Close();
+    ready2send = 0;
+
+    if (nTic == 0)
+    {
+        Xfree(pSimTimes);
+        Xfree(pRenderTimes);
+        Xfree(pFrameTimes);
+        return;
+    }
+
+    char buffer[BMAX_PATH];
+    G_ModDirSnprintfLite(buffer, BMAX_PATH, "timedemo.csv");
+    FILE *hCSV = fopen(buffer, "w");
+    if (hCSV)
+    {
+        fprintf(hCSV, "tic,sim_ms,render_ms,frame_ms\n");
+        for (int i = 0; i < nTic; i++)
+            fprintf(hCSV, "%d,%.4f,%.4f,%.4f\n", i, pSimTimes[i], pRenderTimes[i], pFrameTimes[i]);
+        fclose(hCSV);
+    }
+    else
+        OSD_Printf("timedemo: unable to write \"%s\"\n", buffer);
+
+    TIMEDEMOSTATS simStats, renderStats, frameStats;
+    TimedemoStats(pSimTimes, nTic, &simStats);
+    TimedemoStats(pRenderTimes, nTic, &renderStats);
+    TimedemoStats(pFrameTimes, nTic, &frameStats);
+
+    OSD_Printf("timedemo: tics=%d of %d total_ms=%.1f tics_per_sec=%.1f render=%d\n", nTic, nTics, totalTime,
+               nTic * 1000.0 / totalTime, bRender);
+    TimedemoPrintStats("sim", &simStats);
+    if (bRender)
+        TimedemoPrintStats("render", &renderStats);
+    TimedemoPrintStats("frame", &frameStats);
+
+    Xfree(pSimTimes);
+    Xfree(pRenderTimes);
+    Xfree(pFrameTimes);
+}
+
 void CDemo::StopPlayback(void)
 {
     at1 = 0;
@@ -84,7 +84,9 @@ public:
     void Close(void);
     bool SetupPlayback(const char *);
     void ProcessKeys(void);
+    void StartPlayback(void);
     void Playback(void);
+    void Timedemo(bool bRender);
     void StopPlayback(void);
     void LoadDemoInfo(void);
     void NextDemo(void);
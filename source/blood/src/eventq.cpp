@@ -38,21 +38,489 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "nnexts.h"
 #endif
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// index of the lowest set bit, u must not be 0
+static inline int findFirstSet64(uint64_t u)
+{
+#if (defined __GNUC__  && __GNUC__>=3) || defined __clang__
+    return __builtin_ctzll(u);
+#elif defined _MSC_VER && (defined _M_X64 || defined _M_ARM64)
+    unsigned long result;
+    _BitScanForward64(&result, u);
+    return result;
+#elif defined _MSC_VER
+    unsigned long result;
+    if (_BitScanForward(&result, (uint32_t)u))
+        return result;
+    _BitScanForward(&result, (uint32_t)(u >> 32));
+    return result + 32;
+#else
+    int result = 0;
+    for (; !(u & 1); u >>= 1, result++);
+    return result;
+#endif
+}
+
+// Timing wheel the event queue runs on outside of vanilla mode: four levels of 64 slots with one
+// frame clock tick per level 0 slot, so posting and expiring an event costs O(1) no matter how
+// many are pending. Events further out than the four levels cover wait in a separate list.
+// Pending events are also chained by their (type, index) so evKill() only looks at the events
+// of the object it kills. Nodes come from a pool that grows by doubling and is never freed
+// during play.
+//
+// Events due on the same tick come out in the order they were posted, which is the order the
+// std::multiset previously used here gave them, so demos and savegames keep working.
+class EventWheel
+{
+public:
+    EventWheel();
+    ~EventWheel();
+    uint32_t Size(void) const { return nCount; }
+    void Clear(void);
+    void Insert(uint32_t nTime, EVENT event);
+    bool IsNotEmpty(uint32_t nTime);
+    EVENT Remove(void);
+    void Kill(int nIndex, int nType);
+    void Kill(int nIndex, int nType, CALLBACK_ID nCallback);
+    // Fills pTimes and pEvents with every pending event in the order they are going to happen.
+    void GetPending(uint32_t *pTimes, EVENT *pEvents);
+
+private:
+    enum
+    {
+        kWheelBits   = 6,
+        kWheelSlots  = 1 << kWheelBits,
+        kWheelLevels = 4,
+        kListFar     = kWheelLevels * kWheelSlots, // beyond the last level
+        kListDue     = kListFar + 1,               // expired, ready to be removed
+        kListCount,
+        kHashSize    = 4096,
+    };
+
+    struct EVENTNODE
+    {
+        uint32_t nTime;
+        uint32_t nSeq;
+        EVENT event;
+        int16_t nList;
+        int next, prev;
+        int hashNext, hashPrev;
+    };
+
+    EVENTNODE *pNodes;
+    int nNodes;
+    int nFreeNode;
+    int listHead[kListCount];
+    int listTail[kListCount];
+    uint64_t occupied[kWheelLevels];
+    int hashHead[kHashSize];
+    uint32_t nCursor; // next tick to expire; whatever is in kListDue is due at nCursor-1
+    uint32_t nCount;
+    uint32_t nSeq;
+
+    static int Hash(int nIndex, int nType) { return (nIndex + nType * 1399) & (kHashSize - 1); }
+    int AllocNode(void);
+    void FreeNode(int nNode);
+    void Link(int nList, int nNode);
+    void Unlink(int nNode);
+    void Place(int nNode);
+    void Cascade(void);
+    void Expire(int nSlot);
+    void Rebase(uint32_t nTime);
+};
+
+EventWheel::EventWheel()
+{
+    pNodes = NULL;
+    nNodes = 0;
+    Clear();
+}
+
+EventWheel::~EventWheel()
+{
+    DO_FREE_AND_NULL(pNodes);
+}
+
+void EventWheel::Clear(void)
+{
+    nFreeNode = -1;
+    for (int i = nNodes - 1; i >= 0; i--)
+    {
+        pNodes[i].next = nFreeNode;
+        nFreeNode = i;
+    }
+    for (int i = 0; i < kListCount; i++)
+        listHead[i] = listTail[i] = -1;
+    for (int i = 0; i < kHashSize; i++)
+        hashHead[i] = -1;
+    memset(occupied, 0, sizeof(occupied));
+    nCursor = UINT32_MAX;
+    nCount = 0;
+    nSeq = 0;
+}
+
+int EventWheel::AllocNode(void)
+{
+    if (nFreeNode < 0)
+    {
+        int const nNewNodes = nNodes ? nNodes * 2 : 1024;
+        pNodes = (EVENTNODE *)Xrealloc(pNodes, nNewNodes * sizeof(EVENTNODE));
+        for (int i = nNewNodes - 1; i >= nNodes; i--)
+        {
+            pNodes[i].next = nFreeNode;
+            nFreeNode = i;
+        }
+        nNodes = nNewNodes;
+    }
+    int const nNode = nFreeNode;
+    nFreeNode = pNodes[nNode].next;
+    return nNode;
+}
+
+void EventWheel::FreeNode(int nNode)
+{
+    EVENTNODE *pNode = &pNodes[nNode];
+    if (pNode->hashPrev >= 0)
+        pNodes[pNode->hashPrev].hashNext = pNode->hashNext;
+    else
+        hashHead[Hash(pNode->event.index, pNode->event.type)] = pNode->hashNext;
+    if (pNode->hashNext >= 0)
+        pNodes[pNode->hashNext].hashPrev = pNode->hashPrev;
+    pNode->next = nFreeNode;
+    nFreeNode = nNode;
+    nCount--;
+}
+
+void EventWheel::Link(int nList, int nNode)
+{
+    EVENTNODE *pNode = &pNodes[nNode];
+    pNode->nList = nList;
+    pNode->next = -1;
+    pNode->prev = listTail[nList];
+    if (listTail[nList] >= 0)
+        pNodes[listTail[nList]].next = nNode;
+    else
+        listHead[nList] = nNode;
+    listTail[nList] = nNode;
+    if (nList < kListFar)
+        occupied[nList >> kWheelBits] |= (uint64_t)1 << (nList & (kWheelSlots - 1));
+}
+
+void EventWheel::Unlink(int nNode)
+{
+    EVENTNODE *pNode = &pNodes[nNode];
+    int const nList = pNode->nList;
+    if (pNode->prev >= 0)
+        pNodes[pNode->prev].next = pNode->next;
+    else
+        listHead[nList] = pNode->next;
+    if (pNode->next >= 0)
+        pNodes[pNode->next].prev = pNode->prev;
+    else
+        listTail[nList] = pNode->prev;
+    if (nList < kListFar && listHead[nList] < 0)
+        occupied[nList >> kWheelBits] &= ~((uint64_t)1 << (nList & (kWheelSlots - 1)));
+}
+
+// Files a node under the slot of the lowest level whose range, counted from nCursor, covers it.
+void EventWheel::Place(int nNode)
+{
+    uint32_t const nTime = pNodes[nNode].nTime;
+    uint32_t const nDelta = nTime - nCursor;
+    dassert(nTime >= nCursor);
+    for (int nLevel = 0; nLevel < kWheelLevels; nLevel++)
+    {
+        if (nDelta < (uint32_t)1 << (kWheelBits * (nLevel + 1)))
+        {
+            Link(nLevel * kWheelSlots + ((nTime >> (kWheelBits * nLevel)) & (kWheelSlots - 1)), nNode);
+            return;
+        }
+    }
+    Link(kListFar, nNode);
+}
+
+// Called whenever nCursor starts a new run of level 0 slots: moves the events of the higher
+// level slots that run covers down to where they belong now.
+void EventWheel::Cascade(void)
+{
+    int nLevel;
+    for (nLevel = 1; nLevel < kWheelLevels; nLevel++)
+    {
+        int const nSlot = (nCursor >> (kWheelBits * nLevel)) & (kWheelSlots - 1);
+        int const nList = nLevel * kWheelSlots + nSlot;
+        int nNode = listHead[nList];
+        listHead[nList] = listTail[nList] = -1;
+        occupied[nLevel] &= ~((uint64_t)1 << nSlot);
+        while (nNode >= 0)
+        {
+            int const nNext = pNodes[nNode].next;
+            Place(nNode);
+            nNode = nNext;
+        }
+        if (nSlot != 0)
+            break;
+    }
+    if (nLevel == kWheelLevels)
+    {
+        int nNode = listHead[kListFar];
+        listHead[kListFar] = listTail[kListFar] = -1;
+        while (nNode >= 0)
+        {
+            int const nNext = pNodes[nNode].next;
+            Place(nNode);
+            nNode = nNext;
+        }
+    }
+}
+
+// Moves a level 0 slot to the due list, sorted by when its events were posted since cascading
+// can have put earlier events behind later ones.
+void EventWheel::Expire(int nSlot)
+{
+    dassert(listHead[kListDue] < 0);
+    int nNode = listHead[nSlot];
+    listHead[nSlot] = listTail[nSlot] = -1;
+    occupied[0] &= ~((uint64_t)1 << nSlot);
+    while (nNode >= 0)
+    {
+        int const nNext = pNodes[nNode].next;
+        EVENTNODE *pNode = &pNodes[nNode];
+        int nAfter = listTail[kListDue];
+        while (nAfter >= 0 && pNodes[nAfter].nSeq > pNode->nSeq)
+            nAfter = pNodes[nAfter].prev;
+        pNode->nList = kListDue;
+        pNode->prev = nAfter;
+        pNode->next = nAfter >= 0 ? pNodes[nAfter].next : listHead[kListDue];
+        if (pNode->next >= 0)
+            pNodes[pNode->next].prev = nNode;
+        else
+            listTail[kListDue] = nNode;
+        if (nAfter >= 0)
+            pNodes[nAfter].next = nNode;
+        else
+            listHead[kListDue] = nNode;
+        nNode = nNext;
+    }
+}
+
+// An event was posted for a tick that has already been expired while others are pending, which
+// happens when a new level resets the frame clock: refile everything relative to that tick.
+void EventWheel::Rebase(uint32_t nTime)
+{
+    int nPending = -1;
+    for (int nList = 0; nList < kListCount; nList++)
+    {
+        int nNode = listHead[nList];
+        while (nNode >= 0)
+        {
+            int const nNext = pNodes[nNode].next;
+            pNodes[nNode].next = nPending;
+            nPending = nNode;
+            nNode = nNext;
+        }
+        listHead[nList] = listTail[nList] = -1;
+    }
+    memset(occupied, 0, sizeof(occupied));
+    nCursor = nTime;
+    while (nPending >= 0)
+    {
+        int const nNext = pNodes[nPending].next;
+        Place(nPending);
+        nPending = nNext;
+    }
+}
+
+void EventWheel::Insert(uint32_t nTime, EVENT event)
+{
+    int const nNode = AllocNode();
+    EVENTNODE *pNode = &pNodes[nNode];
+    pNode->nTime = nTime;
+    pNode->nSeq = nSeq++;
+    pNode->event = event;
+    int const nHash = Hash(event.index, event.type);
+    pNode->hashPrev = -1;
+    pNode->hashNext = hashHead[nHash];
+    if (hashHead[nHash] >= 0)
+        pNodes[hashHead[nHash]].hashPrev = nNode;
+    hashHead[nHash] = nNode;
+
+    if (nCount == 0 && nTime < nCursor)
+        nCursor = nTime;
+    nCount++;
+
+    if (nTime + 1 == nCursor) // posted with no delay while the events of its tick are being processed
+        Link(kListDue, nNode);
+    else
+    {
+        if (nTime < nCursor)
+            Rebase(nTime);
+        Place(nNode);
+    }
+}
+
+bool EventWheel::IsNotEmpty(uint32_t nTime)
+{
+    for (;;)
+    {
+        if (listHead[kListDue] >= 0)
+            return nCursor - 1 <= nTime;
+        if (nCount == 0)
+        {
+            nCursor = nTime + 1;
+            return false;
+        }
+        if (nCursor > nTime)
+            return false;
+        if ((nCursor & (kWheelSlots - 1)) == 0)
+            Cascade();
+        uint64_t const nPending = occupied[0] >> (nCursor & (kWheelSlots - 1));
+        if (nPending == 0)
+        {
+            // nothing left in this run of slots: skip to the next run, but never past the
+            // current tick, events can still be posted for it
+            nCursor = min<uint32_t>((nCursor | (kWheelSlots - 1)) + 1, nTime + 1);
+            continue;
+        }
+        uint32_t const nNext = nCursor + findFirstSet64(nPending);
+        if (nNext > nTime)
+        {
+            nCursor = nTime + 1;
+            return false;
+        }
+        Expire(nNext & (kWheelSlots - 1));
+        nCursor = nNext + 1;
+    }
+}
+
+EVENT EventWheel::Remove(void)
+{
+    int const nNode = listHead[kListDue];
+    dassert(nNode >= 0);
+    EVENT const event = pNodes[nNode].event;
+    Unlink(nNode);
+    FreeNode(nNode);
+    return event;
+}
+
+void EventWheel::Kill(int nIndex, int nType)
+{
+    int nNode = hashHead[Hash(nIndex, nType)];
+    while (nNode >= 0)
+    {
+        int const nNext = pNodes[nNode].hashNext;
+        EVENT const &event = pNodes[nNode].event;
+        if (event.index == (unsigned)nIndex && event.type == (unsigned)nType)
+        {
+            Unlink(nNode);
+            FreeNode(nNode);
+        }
+        nNode = nNext;
+    }
+}
+
+void EventWheel::Kill(int nIndex, int nType, CALLBACK_ID nCallback)
+{
+    int nNode = hashHead[Hash(nIndex, nType)];
+    while (nNode >= 0)
+    {
+        int const nNext = pNodes[nNode].hashNext;
+        EVENT const &event = pNodes[nNode].event;
+        if (event.index == (unsigned)nIndex && event.type == (unsigned)nType && event.cmd == kCmdCallback
+            && event.funcID == (unsigned)nCallback)
+        {
+            Unlink(nNode);
+            FreeNode(nNode);
+        }
+        nNode = nNext;
+    }
+}
+
+struct PENDINGEVENT
+{
+    uint32_t nTime, nSeq;
+    EVENT event;
+};
+
+static int ComparePendingEvents(const void *a, const void *b)
+{
+    PENDINGEVENT const *pA = (PENDINGEVENT const *)a, *pB = (PENDINGEVENT const *)b;
+    if (pA->nTime != pB->nTime)
+        return pA->nTime < pB->nTime ? -1 : 1;
+    return pA->nSeq < pB->nSeq ? -1 : (pA->nSeq > pB->nSeq);
+}
+
+void EventWheel::GetPending(uint32_t *pTimes, EVENT *pEvents)
+{
+    if (nCount == 0)
+        return;
+    auto pPending = (PENDINGEVENT *)Xmalloc(nCount * sizeof(PENDINGEVENT));
+    int nPending = 0;
+    for (int nList = 0; nList < kListCount; nList++)
+    {
+        for (int nNode = listHead[nList]; nNode >= 0; nNode = pNodes[nNode].next)
+        {
+            pPending[nPending].nTime = pNodes[nNode].nTime;
+            pPending[nPending].nSeq = pNodes[nNode].nSeq;
+            pPending[nPending].event = pNodes[nNode].event;
+            nPending++;
+        }
+    }
+    dassert(nPending == (int)nCount);
+    qsort(pPending, nPending, sizeof(PENDINGEVENT), ComparePendingEvents);
+    for (int i = 0; i < nPending; i++)
+    {
+        pTimes[i] = pPending[i].nTime;
+        pEvents[i] = pPending[i].event;
+    }
+    Xfree(pPending);
+}
+
+static EventWheel eventWheel;
+
 class EventQueue
 {
 public:
-    PriorityQueue<EVENT>* PQueue;
+    PriorityQueue<EVENT>* PQueue; // vanilla mode only, eventWheel is used otherwise
     EventQueue()
     {
         PQueue = NULL;
     }
+    void Init(void)
+    {
+        if (PQueue)
+            delete PQueue;
+        PQueue = NULL;
+        if (VanillaMode())
+        {
+            PQueue = new VanillaPriorityQueue<EVENT>();
+            PQueue->Clear();
+        }
+        else
+            eventWheel.Clear();
+    }
+    uint32_t Size(void)
+    {
+        return PQueue ? PQueue->Size() : eventWheel.Size();
+    }
+    void Insert(uint32_t nTime, EVENT event)
+    {
+        if (PQueue)
+            PQueue->Insert(nTime, event);
+        else
+            eventWheel.Insert(nTime, event);
+    }
     bool IsNotEmpty(unsigned int nTime)
     {
+        if (!PQueue)
+            return eventWheel.IsNotEmpty(nTime);
         return PQueue->Size() > 0 && nTime >= PQueue->LowestPriority();
     }
     EVENT ERemove(void)
     {
-        return PQueue->Remove();
+        return PQueue ? PQueue->Remove() : eventWheel.Remove();
     }
     void Kill(int, int);
     void Kill(int, int, CALLBACK_ID);
@@ -61,11 +529,21 @@ public:
 EventQueue eventQ;
 void EventQueue::Kill(int a1, int a2)
 {
+    if (!PQueue)
+    {
+        eventWheel.Kill(a1, a2);
+        return;
+    }
     PQueue->Kill([=](EVENT nItem)->bool {return nItem.index == a1 && nItem.type == a2; });
 }
 
 void EventQueue::Kill(int a1, int a2, CALLBACK_ID a3)
 {
+    if (!PQueue)
+    {
+        eventWheel.Kill(a1, a2, a3);
+        return;
+    }
     EVENT evn = { (unsigned int)a1, (unsigned int)a2, kCmdCallback, (unsigned int)a3 };
     PQueue->Kill([=](EVENT nItem)->bool {return !memcmp(&nItem, &evn, sizeof(EVENT)); });
 }
@@ -255,15 +733,72 @@ static void SortRXBucket(int nCount)
 
 unsigned short bucketHead[1024+1];
 
-void evInit(void)
+// Objects whose rx channel may have changed since the index was last brought up to date. The
+// index is only rebuilt at load time in vanilla mode, matching the original game. Otherwise the
+// pending objects are merged in once per frame, from evProcess(), where nothing can be walking
+// a bucket that would move under it. Savegames store them unmerged, so saving does not change
+// the order the merge gives.
+static RXBUCKET rxPending[1024];
+static int nRXPending;
+static bool bRXPendingOverflow;
+static uint8_t rxDirtySprite[(kMaxSprites+7)>>3], rxDirtyWall[(kMaxWalls+7)>>3], rxDirtySector[(kMaxSectors+7)>>3];
+
+static uint8_t *evRXDirtyBitmap(int nType)
+{
+    switch (nType)
+    {
+    case 6:
+        return rxDirtySector;
+    case 0:
+        return rxDirtyWall;
+    case 3:
+        return rxDirtySprite;
+    }
+    return NULL;
+}
+
+// Returns the channel an object belongs to now, 0 if none.
+static int evGetRXChannel(int nType, int nIndex)
+{
+    switch (nType)
+    {
+    case 6:
+    {
+        int nXIndex = sector[nIndex].extra;
+        return nXIndex > 0 ? xsector[nXIndex].rxID : 0;
+    }
+    case 0:
+    {
+        int nXIndex = wall[nIndex].extra;
+        return nXIndex > 0 ? xwall[nXIndex].rxID : 0;
+    }
+    case 3:
+    {
+        if (sprite[nIndex].statnum >= kMaxStatus)
+            return 0;
+        int nXIndex = sprite[nIndex].extra;
+        return nXIndex > 0 ? xsprite[nXIndex].rxID : 0;
+    }
+    }
+    return 0;
+}
+
+void evUpdateRX(int nType, int nIndex)
 {
-    if (eventQ.PQueue)
-        delete eventQ.PQueue;
     if (VanillaMode())
-        eventQ.PQueue = new VanillaPriorityQueue<EVENT>();
-    else
-        eventQ.PQueue = new StdPriorityQueue<EVENT>();
-    eventQ.PQueue->Clear();
+        return;
+    if (nRXPending == ARRAY_SSIZE(rxPending))
+    {
+        bRXPendingOverflow = true;
+        return;
+    }
+    rxPending[nRXPending].type = nType;
+    rxPending[nRXPending].index = nIndex;
+    nRXPending++;
+}
+
+static void evBuildRXBucket(void)
+{
     int nCount = 0;
     for (int i = 0; i < numsectors; i++)
     {
@@ -316,6 +851,82 @@ void evInit(void)
             j++;
     }
     bucketHead[i] = j;
+    nRXPending = 0;
+    bRXPendingOverflow = false;
+}
+
+// Brings rxBucket up to date with the pending objects in one pass: their old entries are
+// dropped and their current ones go to the end of their channel, everything else keeps its
+// place and order.
+static void evFlushRXPending(void)
+{
+    if (bRXPendingOverflow)
+    {
+        evBuildRXBucket();
+        return;
+    }
+    if (nRXPending == 0)
+        return;
+
+    RXBUCKET added[ARRAY_SIZE(rxPending)];
+    int nAddedChannel[ARRAY_SIZE(rxPending)];
+    int nAdded = 0;
+    for (int i = 0; i < nRXPending; i++)
+    {
+        int const nType = rxPending[i].type, nIndex = rxPending[i].index;
+        uint8_t *pDirty = evRXDirtyBitmap(nType);
+        if (!pDirty || bitmap_test(pDirty, nIndex))
+            continue;
+        bitmap_set(pDirty, nIndex);
+        int const nChannel = evGetRXChannel(nType, nIndex);
+        if (nChannel <= 0)
+            continue;
+        // keep the additions sorted by channel, in the order they were reported within one
+        int j = nAdded++;
+        for (; j > 0 && nAddedChannel[j-1] > nChannel; j--)
+        {
+            added[j] = added[j-1];
+            nAddedChannel[j] = nAddedChannel[j-1];
+        }
+        added[j] = rxPending[i];
+        nAddedChannel[j] = nChannel;
+    }
+
+    static RXBUCKET merged[kChannelMax];
+    int nCount = 0, nNext = 0;
+    for (int nChannel = 0; nChannel < 1024; nChannel++)
+    {
+        int const nStart = bucketHead[nChannel], nEnd = bucketHead[nChannel+1];
+        bucketHead[nChannel] = nCount;
+        for (int i = nStart; i < nEnd; i++)
+        {
+            uint8_t *pDirty = evRXDirtyBitmap(rxBucket[i].type);
+            if (pDirty && bitmap_test(pDirty, rxBucket[i].index))
+                continue;
+            merged[nCount++] = rxBucket[i];
+        }
+        for (; nNext < nAdded && nAddedChannel[nNext] == nChannel; nNext++)
+        {
+            if (nCount < kChannelMax)
+                merged[nCount++] = added[nNext];
+        }
+    }
+    bucketHead[1024] = nCount;
+    memcpy(rxBucket, merged, nCount * sizeof(RXBUCKET));
+
+    for (int i = 0; i < nRXPending; i++)
+    {
+        uint8_t *pDirty = evRXDirtyBitmap(rxPending[i].type);
+        if (pDirty)
+            bitmap_clear(pDirty, rxPending[i].index);
+    }
+    nRXPending = 0;
+}
+
+void evInit(void)
+{
+    eventQ.Init();
+    evBuildRXBucket();
 }
 
 char evGetSourceState(int nType, int nIndex)
@@ -344,6 +955,33 @@ char evGetSourceState(int nType, int nIndex)
     return 0;
 }
 
+// Sends an event to the sprite with the given status listening on a channel, if there is at most
+// one. Bombs and flags get their channels at run time, which is why vanilla walks the status
+// lists instead. Returns false when several sprites listen: they must then get the event in
+// status list order, as they always have, so the caller walks the list.
+static bool evSendToRXSprites(int rxId, int nStatus, EVENT event)
+{
+    int nTarget = -1;
+    for (int i = bucketHead[rxId]; i < bucketHead[rxId+1]; i++)
+    {
+        if (rxBucket[i].type != 3)
+            continue;
+        int nSprite = rxBucket[i].index;
+        spritetype *pSprite = &sprite[nSprite];
+        if (pSprite->statnum != nStatus || (pSprite->flags & 32))
+            continue;
+        int nXSprite = pSprite->extra;
+        if (nXSprite <= 0 || xsprite[nXSprite].rxID != rxId)
+            continue;
+        if (nTarget >= 0)
+            return false;
+        nTarget = nSprite;
+    }
+    if (nTarget >= 0)
+        trMessageSprite(nTarget, event);
+    return true;
+}
+
 void evSend(int nIndex, int nType, int rxId, COMMAND_ID command)
 {
     switch (command) {
@@ -396,6 +1034,8 @@ void evSend(int nIndex, int nType, int rxId, COMMAND_ID command)
     case kChannelRemoteBomb5:
     case kChannelRemoteBomb6:
     case kChannelRemoteBomb7:
+        if (!VanillaMode() && evSendToRXSprites(rxId, kStatThing, event))
+            return;
         for (int nSprite = headspritestat[kStatThing]; nSprite >= 0; nSprite = nextspritestat[nSprite])
         {
             spritetype* pSprite = &sprite[nSprite];
@@ -412,6 +1052,8 @@ void evSend(int nIndex, int nType, int rxId, COMMAND_ID command)
         return;
     case kChannelTeamAFlagCaptured:
     case kChannelTeamBFlagCaptured:
+        if (!VanillaMode() && evSendToRXSprites(rxId, kStatItem, event))
+            return;
         for (int nSprite = headspritestat[kStatItem]; nSprite >= 0; nSprite = nextspritestat[nSprite])
         {
             spritetype* pSprite = &sprite[nSprite];
@@ -468,7 +1110,8 @@ void evSend(int nIndex, int nType, int rxId, COMMAND_ID command)
                     if (nXSprite > 0)
                     {
                         XSPRITE *pXSprite = &xsprite[nXSprite];
-                        if (pXSprite->rxID > 0)
+                        // outside vanilla the entry may belong to a sprite deleted this frame
+                        if (pXSprite->rxID > 0 && (VanillaMode() || pXSprite->rxID == rxId))
                             trMessageSprite(nSprite, event);
                     }
                     break;
@@ -486,7 +1129,7 @@ void evPost(int nIndex, int nType, unsigned int nDelta, COMMAND_ID command) {
     evn.index = nIndex;
     evn.type = nType;
     evn.cmd = command;
-    eventQ.PQueue->Insert((int)gFrameClock+nDelta, evn);
+    eventQ.Insert((int)gFrameClock+nDelta, evn);
 }
 
 void evPost(int nIndex, int nType, unsigned int nDelta, CALLBACK_ID callback) {
@@ -495,7 +1138,7 @@ void evPost(int nIndex, int nType, unsigned int nDelta, CALLBACK_ID callback) {
     evn.type = nType;
     evn.cmd = kCmdCallback;
     evn.funcID = callback;
-    eventQ.PQueue->Insert((int)gFrameClock+nDelta, evn);
+    eventQ.Insert((int)gFrameClock+nDelta, evn);
 }
 
 void evProcess(unsigned int nTime)
@@ -512,6 +1155,7 @@ void evProcess(unsigned int nTime)
         if (!bDone)
             break;
 #endif
+    evFlushRXPending();
     while(eventQ.IsNotEmpty(nTime))
     {
         EVENT event = eventQ.ERemove();
@@ -561,10 +1205,8 @@ void EventQLoadSave::Load()
     if (eventQ.PQueue)
         delete eventQ.PQueue;
     Read(&eventQ, sizeof(eventQ));
-    if (VanillaMode())
-        eventQ.PQueue = new VanillaPriorityQueue<EVENT>();
-    else
-        eventQ.PQueue = new StdPriorityQueue<EVENT>();
+    eventQ.PQueue = NULL;
+    eventQ.Init();
     int nEvents;
     Read(&nEvents, sizeof(nEvents));
     for (int i = 0; i < nEvents; i++)
@@ -573,33 +1215,61 @@ void EventQLoadSave::Load()
         unsigned int eventtime;
         Read(&eventtime, sizeof(eventtime));
         Read(&event, sizeof(event));
-        eventQ.PQueue->Insert(eventtime, event);
+        eventQ.Insert(eventtime, event);
     }
     Read(rxBucket, sizeof(rxBucket));
     Read(bucketHead, sizeof(bucketHead));
+    // the reports not merged yet, evProcess() merges them as if the game had not been saved
+    Read(&nRXPending, sizeof(nRXPending));
+    char bOverflow;
+    Read(&bOverflow, sizeof(bOverflow));
+    bRXPendingOverflow = bOverflow != 0;
+    if (nRXPending < 0 || nRXPending > ARRAY_SSIZE(rxPending))
+        ThrowError("Invalid rx report count %d in saved game", nRXPending);
+    Read(rxPending, nRXPending * sizeof(RXBUCKET));
 }
 
 void EventQLoadSave::Save()
 {
-    EVENT events[1024];
-    unsigned int eventstime[1024];
     Write(&eventQ, sizeof(eventQ));
-    int nEvents = eventQ.PQueue->Size();
+    int nEvents = eventQ.Size();
     Write(&nEvents, sizeof(nEvents));
-    for (int i = 0; i < nEvents; i++)
+    if (eventQ.PQueue)
     {
-        eventstime[i] = eventQ.PQueue->LowestPriority();
-        events[i] = eventQ.ERemove();
-        Write(&eventstime[i], sizeof(eventstime[i]));
-        Write(&events[i], sizeof(events[i]));
+        EVENT events[kPQueueSize];
+        unsigned int eventstime[kPQueueSize];
+        for (int i = 0; i < nEvents; i++)
+        {
+            eventstime[i] = eventQ.PQueue->LowestPriority();
+            events[i] = eventQ.ERemove();
+            Write(&eventstime[i], sizeof(eventstime[i]));
+            Write(&events[i], sizeof(events[i]));
+        }
+        dassert(eventQ.PQueue->Size() == 0);
+        for (int i = 0; i < nEvents; i++)
+        {
+            eventQ.PQueue->Insert(eventstime[i], events[i]);
+        }
     }
-    dassert(eventQ.PQueue->Size() == 0);
-    for (int i = 0; i < nEvents; i++)
+    else if (nEvents > 0)
     {
-        eventQ.PQueue->Insert(eventstime[i], events[i]);
+        auto events = (EVENT *)Xmalloc(nEvents * sizeof(EVENT));
+        auto eventstime = (uint32_t *)Xmalloc(nEvents * sizeof(uint32_t));
+        eventWheel.GetPending(eventstime, events);
+        for (int i = 0; i < nEvents; i++)
+        {
+            Write(&eventstime[i], sizeof(eventstime[i]));
+            Write(&events[i], sizeof(events[i]));
+        }
+        Xfree(events);
+        Xfree(eventstime);
     }
     Write(rxBucket, sizeof(rxBucket));
     Write(bucketHead, sizeof(bucketHead));
+    Write(&nRXPending, sizeof(nRXPending));
+    char bOverflow = bRXPendingOverflow;
+    Write(&bOverflow, sizeof(bOverflow));
+    Write(rxPending, nRXPending * sizeof(RXBUCKET));
 }
 
 static EventQLoadSave *myLoadSave;
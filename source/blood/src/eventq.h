@@ -139,6 +139,9 @@ struct EVENT {
 };
 
 void evInit(void);
+// Tells the rx channel index that the rxID of an object, or whether it has an x-object at all,
+// may have changed. The index catches up at the start of the next evProcess().
+void evUpdateRX(int nType, int nIndex);
 char evGetSourceState(int nType, int nIndex);
 void evSend(int nIndex, int nType, int rxId, COMMAND_ID command);
 void evPost(int nIndex, int nType, unsigned int nDelta, COMMAND_ID command);
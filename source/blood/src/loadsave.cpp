@@ -48,6 +48,104 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #endif
 
 GAMEOPTIONS gSaveGameOptions[10];
+
+// XSPRITE as it was laid out when savegames started storing it verbatim. Savegames keep this
+// layout so XSPRITE itself can be ordered for the game loop.
+#pragma pack(push, 1)
+struct XSPRITESAVE {
+    unsigned int unused1 : 2;           // additional dude flags in modern maps
+    unsigned int unused2 : 1;           // unused
+    unsigned int unused3 : 2;           // unused
+    unsigned int unused4 : 6;           // unused
+
+    signed   int reference : 15;
+    unsigned int state : 1;             // State 0
+    unsigned int busy : 17;
+    unsigned int txID : 10;             // TX ID
+    unsigned int rxID : 10;             // RX ID
+    unsigned int command : 8;           // Cmd
+    unsigned int triggerOn : 1;         // going ON
+    unsigned int triggerOff : 1;        // going OFF
+    unsigned int busyTime : 12;         // busyTime
+    unsigned int waitTime : 12;         // waitTime
+    unsigned int restState : 1;         // restState
+    unsigned int Interrutable : 1;      // Interruptable
+
+    unsigned int respawnPending : 2;    // respawnPending
+
+    unsigned int dropMsg : 8;           // Drop Item
+    unsigned int Decoupled : 1;         // Decoupled
+    unsigned int triggerOnce : 1;       // 1-shot
+    unsigned int isTriggered : 1;       // works in case if triggerOnce selected
+
+    unsigned int key : 3;               // Key
+    unsigned int wave : 2;              // Wave
+    unsigned int Push : 1;              // Push
+    unsigned int Vector : 1;            // Vector
+    unsigned int Impact : 1;            // Impact
+    unsigned int Pickup : 1;            // Pickup
+    unsigned int Touch : 1;             // Touch
+    unsigned int Sight : 1;             // Sight
+    unsigned int Proximity : 1;         // Proximity
+    unsigned int lSkill : 5;            // Launch 12345
+    unsigned int lS : 1;                // Single
+    unsigned int lB : 1;                // Bloodbath
+    unsigned int lT : 1;                // Launch Team
+    unsigned int lC : 1;                // Coop
+    unsigned int DudeLockout : 1;       // DudeLockout
+    signed   int data1 : 16;            // Data 1
+    signed   int data2 : 16;            // Data 2
+    signed   int data3 : 16;            // Data 3
+    unsigned int data4 : 16;            // Data 4
+    unsigned int locked : 1;            // Locked
+    unsigned int medium : 2;            // medium
+    unsigned int respawn : 2;           // Respawn option
+    unsigned int lockMsg : 8;           // Lock msg
+    unsigned int health : 20;
+    unsigned int dudeDeaf : 1;          // dudeDeaf
+    unsigned int dudeAmbush : 1;        // dudeAmbush
+    unsigned int dudeGuard : 1;         // dudeGuard
+    unsigned int dudeFlag4 : 1;         // unused
+    signed   int target : 16;           // target sprite
+    signed   int targetX : 32;          // target x
+    signed   int targetY : 32;          // target y
+    signed   int targetZ : 32;          // target z
+    unsigned int goalAng : 11;          // Dude goal ang
+    signed   int dodgeDir : 2;          // Dude dodge direction
+    unsigned int burnTime : 16;
+    signed   int burnSource : 16;
+    unsigned int height : 16;
+    unsigned int stateTimer : 16;       // ai timer
+    AISTATE* aiState;                   // ai
+    #ifdef NOONE_EXTENSIONS
+    signed int sysData1: 32;            // used to keep here various system data, so user can't change it in map editor
+    signed int sysData2: 32;            //
+    unsigned int physAttr : 32;         // currently used by additional physics sprites to keep it's attributes.
+    #endif
+    signed int scale;                   // used for scaling SEQ size on sprites
+};
+#pragma pack(pop)
+#ifdef NOONE_EXTENSIONS
+EDUKE32_STATIC_ASSERT(sizeof(XSPRITESAVE) == 70 + sizeof(void*));
+#else
+EDUKE32_STATIC_ASSERT(sizeof(XSPRITESAVE) == 58 + sizeof(void*));
+#endif
+
+#define XSPRITESAVE_COPY(f) pDest->f = pSrc->f;
+
+static void xspriteFromSave(XSPRITE *pDest, XSPRITESAVE const *pSrc)
+{
+    XSPRITE_FIELDS(XSPRITESAVE_COPY)
+    pDest->aiState = pSrc->aiState;
+}
+
+static void xspriteToSave(XSPRITESAVE *pDest, XSPRITE const *pSrc)
+{
+    memset(pDest, 0, sizeof(XSPRITESAVE));
+    XSPRITE_FIELDS(XSPRITESAVE_COPY)
+    pDest->aiState = pSrc->aiState;
+}
+
 char *gSaveGamePic[10];
 unsigned int gSavedOffset = 0;
 
@@ -128,14 +226,16 @@ void LoadSave::LoadGame(char *pzFile)
         scrLoadPLUs();
     InitSectorFX();
     viewInitializePrediction();
-    PreloadCache();
-    if (!bVanilla && !gMe->packSlots[1].isActive) // if diving suit is not active, turn off reverb sound effect
-        sfxSetReverb(0);
-    ambInit();
 #ifdef YAX_ENABLE
     yax_update(numyaxbunches > 0 ? 2 : 1);
 #endif
+    // PreloadCache() needs the PVS of the loaded map
     calc_sector_reachability();
+    PreloadCache();
+    if (!bVanilla && !gMe->packSlots[1].isActive) // if diving suit is not active, turn off reverb sound effect
+        sfxSetReverb(0);
+    ambInit();
+    spritegridBuild();
     memset(myMinLag, 0, sizeof(myMinLag));
     otherMinLag = 0;
     myMaxLag = 0;
@@ -331,7 +431,11 @@ void MyLoadSave::Load(void)
         {
             int nXSprite = sprite[nSprite].extra;
             if (nXSprite > 0)
-                Read(&xsprite[nXSprite], sizeof(XSPRITE));
+            {
+                XSPRITESAVE xspriteSave;
+                Read(&xspriteSave, sizeof(xspriteSave));
+                xspriteFromSave(&xsprite[nXSprite], &xspriteSave);
+            }
         }
     }
     memset(xwall, 0, sizeof(xwall));
@@ -445,7 +549,11 @@ void MyLoadSave::Save(void)
         {
             int nXSprite = sprite[nSprite].extra;
             if (nXSprite > 0)
-                Write(&xsprite[nXSprite], sizeof(XSPRITE));
+            {
+                XSPRITESAVE xspriteSave;
+                xspriteToSave(&xspriteSave, &xsprite[nXSprite]);
+                Write(&xspriteSave, sizeof(xspriteSave));
+            }
         }
     }
     for (int nWall = 0; nWall < numwalls; nWall++)
@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "enet.h"
 #endif
 #include "compat.h"
+#include "xxhash.h"
 #include "config.h"
 #include "controls.h"
 #include "globals.h"
@@ -67,7 +68,8 @@ char gNetAddress[32];
 // PORT-TODO: Use different port?
 int gNetPort = kNetDefaultPort;
 
-const short word_1328AC = 0x214;
+// 0x215: the sync checksum covers the whole world and is sent every tic
+const short word_1328AC = 0x215;
 
 PKT_STARTGAME gPacketStartGame;
 
@@ -236,6 +238,192 @@ void sub_79760(void)
     gBufferJitter = 1;
 }
 
+// Besides the players, the sync checksum covers every live sprite with its xsprite and velocity,
+// the heights of the sectors and the positions of the walls, with their x-objects' state. Sector
+// and wall shades and palettes are left out, the renderer animates them.
+//
+// Each object keeps its hash along with a copy of the state it was computed from. A check compares
+// the objects against their copies and only rehashes the ones that changed. The objects are grouped
+// in blocks of 64 and a block's hash is the XOR of its objects' hashes, so it is updated in place.
+// The block hashes of the last 256 checks are kept, so when a desync is detected each machine can
+// write out the blocks of the check that failed and comparing the files tells which objects
+// diverged first. Hashes are made from explicit fields, never from raw x-object bytes, so machines
+// with different pointer sizes agree.
+enum
+{
+    kSyncBlockShift   = 6,
+    kSyncBlockSize    = 1 << kSyncBlockShift,
+    kSyncSpriteBlocks = (kMaxSprites + kSyncBlockSize - 1) >> kSyncBlockShift,
+    kSyncSectorBlocks = (kMaxSectors + kSyncBlockSize - 1) >> kSyncBlockShift,
+    kSyncWallBlocks   = (kMaxWalls + kSyncBlockSize - 1) >> kSyncBlockShift,
+    kSyncBlocks       = kSyncSpriteBlocks + kSyncSectorBlocks + kSyncWallBlocks,
+    kSyncSectorFields = 8,
+    kSyncWallFields   = 6,
+};
+
+// What a sprite's hash was computed from; all zero while the sprite is not in use.
+struct SYNCSPRITE
+{
+    int nLive;
+    int vel[3];
+    spritetype sprite;
+    XSPRITE xsprite;
+};
+
+static SYNCSPRITE gSyncSprite[kMaxSprites];
+static int32_t gSyncSector[kMaxSectors][kSyncSectorFields];
+static int32_t gSyncWall[kMaxWalls][kSyncWallFields];
+static uint32_t gSyncSpriteHash[kMaxSprites], gSyncSectorHash[kMaxSectors], gSyncWallHash[kMaxWalls];
+static int gSyncSectors, gSyncWalls;
+static uint32_t gSyncBlockHash[kSyncBlocks];
+static uint32_t gSyncBlocks[256][kSyncBlocks];
+
+static uint32_t netHashXSprite(XSPRITE const *pXSprite, uint32_t nSeed)
+{
+    int32_t buffer[96];
+    int nFields = 0;
+#define NET_XSPRITE_FIELD(f) buffer[nFields++] = pXSprite->f;
+    XSPRITE_FIELDS(NET_XSPRITE_FIELD)
+#undef NET_XSPRITE_FIELD
+    dassert(nFields <= ARRAY_SSIZE(buffer));
+    return XXH32(buffer, nFields * sizeof(int32_t), nSeed);
+}
+
+static uint32_t netHashSprite(int nSprite)
+{
+    SYNCSPRITE const *pState = &gSyncSprite[nSprite];
+    uint32_t nHash = XXH32(&pState->sprite, sizeof(spritetype), nSprite);
+    nHash = XXH32(pState->vel, sizeof(pState->vel), nHash);
+    int nXSprite = pState->sprite.extra;
+    if (nXSprite > 0 && nXSprite < kMaxXSprites)
+        nHash = netHashXSprite(&pState->xsprite, nHash);
+    return nHash;
+}
+
+static void netUpdateSpriteHash(int nSprite)
+{
+    SYNCSPRITE *pState = &gSyncSprite[nSprite];
+    spritetype *pSprite = &sprite[nSprite];
+    if (pSprite->statnum >= kMaxStatus && !pState->nLive)
+        return;
+    SYNCSPRITE state;
+    memset(&state, 0, sizeof(state));
+    if (pSprite->statnum < kMaxStatus)
+    {
+        state.nLive = 1;
+        state.vel[0] = xvel[nSprite];
+        state.vel[1] = yvel[nSprite];
+        state.vel[2] = zvel[nSprite];
+        memcpy(&state.sprite, pSprite, sizeof(spritetype));
+        int nXSprite = pSprite->extra;
+        if (nXSprite > 0 && nXSprite < kMaxXSprites)
+            memcpy(&state.xsprite, &xsprite[nXSprite], sizeof(XSPRITE));
+    }
+    if (!memcmp(&state, pState, sizeof(state)))
+        return;
+    memcpy(pState, &state, sizeof(state));
+    uint32_t const nHash = state.nLive ? netHashSprite(nSprite) : 0;
+    gSyncBlockHash[nSprite >> kSyncBlockShift] ^= gSyncSpriteHash[nSprite] ^ nHash;
+    gSyncSpriteHash[nSprite] = nHash;
+}
+
+static void netUpdateSectorHash(int nSector)
+{
+    int32_t state[kSyncSectorFields] = {};
+    if (nSector < numsectors)
+    {
+        sectortype *pSector = &sector[nSector];
+        state[0] = 1;
+        state[1] = pSector->ceilingz;
+        state[2] = pSector->floorz;
+        state[3] = pSector->ceilingheinum;
+        state[4] = pSector->floorheinum;
+        int nXSector = pSector->extra;
+        if (nXSector > 0 && nXSector < kMaxXSectors)
+        {
+            XSECTOR *pXSector = &xsector[nXSector];
+            state[5] = pXSector->state;
+            state[6] = pXSector->busy;
+            state[7] = pXSector->data;
+        }
+    }
+    if (!memcmp(state, gSyncSector[nSector], sizeof(state)))
+        return;
+    memcpy(gSyncSector[nSector], state, sizeof(state));
+    uint32_t const nHash = state[0] ? XXH32(state, sizeof(state), kMaxSprites + nSector) : 0;
+    gSyncBlockHash[kSyncSpriteBlocks + (nSector >> kSyncBlockShift)] ^= gSyncSectorHash[nSector] ^ nHash;
+    gSyncSectorHash[nSector] = nHash;
+}
+
+static void netUpdateWallHash(int nWall)
+{
+    int32_t state[kSyncWallFields] = {};
+    if (nWall < numwalls)
+    {
+        walltype *pWall = &wall[nWall];
+        state[0] = 1;
+        state[1] = pWall->x;
+        state[2] = pWall->y;
+        int nXWall = pWall->extra;
+        if (nXWall > 0 && nXWall < kMaxXWalls)
+        {
+            XWALL *pXWall = &xwall[nXWall];
+            state[3] = pXWall->state;
+            state[4] = pXWall->busy;
+            state[5] = pXWall->data;
+        }
+    }
+    if (!memcmp(state, gSyncWall[nWall], sizeof(state)))
+        return;
+    memcpy(gSyncWall[nWall], state, sizeof(state));
+    uint32_t const nHash = state[0] ? XXH32(state, sizeof(state), kMaxSprites + kMaxSectors + nWall) : 0;
+    gSyncBlockHash[kSyncSpriteBlocks + kSyncSectorBlocks + (nWall >> kSyncBlockShift)] ^= gSyncWallHash[nWall] ^ nHash;
+    gSyncWallHash[nWall] = nHash;
+}
+
+// Brings the block hashes up to date with the world; sectors and walls past the end of the map
+// are looked at once more after a smaller map was loaded, to drop their hashes.
+static void netUpdateSyncBlocks(void)
+{
+    for (int i = 0; i < kMaxSprites; i++)
+        netUpdateSpriteHash(i);
+    int const nSectors = max<int>(gSyncSectors, numsectors);
+    for (int i = 0; i < nSectors; i++)
+        netUpdateSectorHash(i);
+    gSyncSectors = numsectors;
+    int const nWalls = max<int>(gSyncWalls, numwalls);
+    for (int i = 0; i < nWalls; i++)
+        netUpdateWallHash(i);
+    gSyncWalls = numwalls;
+}
+
+// Writes the block hashes of a check to syncblocks<player>.txt, for comparing with the files the
+// other machines write for the same desync.
+static void netWriteSyncBlocks(int nCheck)
+{
+    char name[32], buffer[BMAX_PATH];
+    Bsnprintf(name, sizeof(name), "syncblocks%d.txt", myconnectindex);
+    G_ModDirSnprintfLite(buffer, BMAX_PATH, name);
+    FILE *hFile = fopen(buffer, "w");
+    if (!hFile)
+    {
+        OSD_Printf("Unable to write \"%s\"\n", buffer);
+        return;
+    }
+    uint32_t const *pBlocks = gSyncBlocks[nCheck&255];
+    fprintf(hFile, "check %d\n", nCheck);
+    for (int i = 0; i < kSyncSpriteBlocks; i++)
+        fprintf(hFile, "sprites %d-%d %08x\n", i << kSyncBlockShift, ((i+1) << kSyncBlockShift) - 1, pBlocks[i]);
+    pBlocks += kSyncSpriteBlocks;
+    for (int i = 0; i < kSyncSectorBlocks; i++)
+        fprintf(hFile, "sectors %d-%d %08x\n", i << kSyncBlockShift, ((i+1) << kSyncBlockShift) - 1, pBlocks[i]);
+    pBlocks += kSyncSectorBlocks;
+    for (int i = 0; i < kSyncWallBlocks; i++)
+        fprintf(hFile, "walls %d-%d %08x\n", i << kSyncBlockShift, ((i+1) << kSyncBlockShift) - 1, pBlocks[i]);
+    fclose(hFile);
+    OSD_Printf("Sync blocks of check %d written to \"%s\"\n", nCheck, buffer);
+}
+
 void CalcGameChecksum(void)
 {
     memset(gChecksum, 0, sizeof(gChecksum));
@@ -258,15 +446,13 @@ void CalcGameChecksum(void)
             sum += *pBuffer++;
         }
         gChecksum[2] ^= sum;
-        pBuffer = (int*)gPlayer[p].pXSprite;
-        sum = 0;
-        length = sizeof(XSPRITE)/4;
-        while (length--)
-        {
-            sum += *pBuffer++;
-        }
-        gChecksum[3] ^= sum;
+        gChecksum[3] ^= netHashXSprite(gPlayer[p].pXSprite, 0);
     }
+    netUpdateSyncBlocks();
+    uint32_t *pBlocks = gSyncBlocks[gCheckHead[myconnectindex]&255];
+    memcpy(pBlocks, gSyncBlockHash, sizeof(gSyncBlockHash));
+    gChecksum[2] ^= XXH32(pBlocks, kSyncSpriteBlocks*sizeof(uint32_t), 0);
+    gChecksum[3] ^= XXH32(pBlocks+kSyncSpriteBlocks, (kSyncSectorBlocks+kSyncWallBlocks)*sizeof(uint32_t), 0);
 }
 
 void netCheckSync(void)
@@ -301,6 +487,7 @@ void netCheckSync(void)
                             pBuffer += sprintf(pBuffer, " %d", i);
                     }
                     viewSetErrorMessage(buffer);
+                    netWriteSyncBlocks(gCheckTail);
                     bOutOfSync = 1;
                 }
             }
@@ -45,6 +45,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "sfx.h"
 #include "seq.h"
 #include "ai.h"
+#include "pvs.h"
 
 #define kMaxPatrolFoundSounds 256 //sizeof(Bonkle) / sizeof(Bonkle[0])
 PATROL_FOUND_SOUNDS patrolBonkles[kMaxPatrolFoundSounds];
@@ -1042,6 +1043,62 @@ void windGenDoVerticalWind(XSPRITE* pXSource, int nSector) {
 }
 
 
+// Live dudes hashed by the 4096x4096 map cell they stand in, so that each proximity sprite only
+// checks the dudes around it. The hash is filled when the first proximity sprite needs it in a tic
+// and dropped whenever one fires, as whatever it sets off may move, spawn or kill dudes.
+#define kProxCellShift 12
+#define kProxHashSize 1024
+
+static short gProxHashHead[kProxHashSize];
+static short gProxHashNext[kMaxSprites];
+static bool gProxHashValid = false;
+
+static int proxHashCell(int cx, int cy) {
+    return ((cx * 73856093) ^ (cy * 19349663)) & (kProxHashSize - 1);
+}
+
+static void proxHashBuild(void) {
+
+    memset(gProxHashHead, -1, sizeof(gProxHashHead));
+    for (int nSprite = headspritestat[kStatDude]; nSprite >= 0; nSprite = nextspritestat[nSprite]) {
+        spritetype* pSpr = &sprite[nSprite];
+        if (!xsprIsFine(pSpr) || xsprite[pSpr->extra].health <= 0)
+            continue;
+
+        int nHash = proxHashCell(pSpr->x >> kProxCellShift, pSpr->y >> kProxCellShift);
+        gProxHashNext[nSprite] = gProxHashHead[nHash];
+        gProxHashHead[nHash] = nSprite;
+    }
+
+    gProxHashValid = true;
+}
+
+// same as checking every live dude with CheckProximity()
+static bool proxHashCheck(int x, int y, int z, int nSector, int nDist) {
+
+    if (!gProxHashValid)
+        proxHashBuild();
+
+    int nRange = nDist << 4; // CheckProximity() compares klabs(dx) >> 4 against nDist
+    int cx1 = (x - nRange) >> kProxCellShift, cx2 = (x + nRange) >> kProxCellShift;
+    int cy1 = (y - nRange) >> kProxCellShift, cy2 = (y + nRange) >> kProxCellShift;
+    for (int cx = cx1; cx <= cx2; cx++) {
+        for (int cy = cy1; cy <= cy2; cy++) {
+            for (int nSprite = gProxHashHead[proxHashCell(cx, cy)]; nSprite >= 0; nSprite = gProxHashNext[nSprite]) {
+                if (CheckProximity(&sprite[nSprite], x, y, z, nSector, nDist))
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// The PVS can only rule out a line of sight if its ends are inside the sectors given for them.
+static int sightPvsSector(int x, int y, int nSector) {
+    return (pvsactive && sectRangeIsFine(nSector) && inside(x, y, nSector) == 1) ? nSector : -1;
+}
+
 void nnExtProcessSuperSprites() {
 
     // process tracking conditions
@@ -1127,6 +1184,7 @@ void nnExtProcessSuperSprites() {
 
     // process additional proximity sprites
     if (gProxySpritesCount > 0) {
+        gProxHashValid = false;
         for (int i = 0; i < gProxySpritesCount; i++) {
             if (!xsprIsFine(&sprite[gProxySpritesList[i]]))
                 continue;
@@ -1142,12 +1200,9 @@ void nnExtProcessSuperSprites() {
 
             if (!pXProxSpr->DudeLockout) {
 
-                for (int nAffected = headspritestat[kStatDude]; nAffected >= 0; nAffected = nextspritestat[nAffected]) {
-                    if (!xsprIsFine(&sprite[nAffected]) || xsprite[sprite[nAffected].extra].health <= 0) continue;
-                    else if (CheckProximity(&sprite[nAffected], x, y, z, sectnum, okDist)) {
-                        trTriggerSprite(index, pXProxSpr, kCmdSpriteProximity);
-                        break;
-                    }
+                if (proxHashCheck(x, y, z, sectnum, okDist)) {
+                    trTriggerSprite(index, pXProxSpr, kCmdSpriteProximity);
+                    gProxHashValid = false;
                 }
 
             } else {
@@ -1160,6 +1215,7 @@ void nnExtProcessSuperSprites() {
 
                     if (gPlayer[a].pXSprite->health > 0 && CheckProximity(gPlayer[a].pSprite, x, y, z, sectnum, okDist)) {
                         trTriggerSprite(index, pXProxSpr, kCmdSpriteProximity);
+                        gProxHashValid = false;
                         break;
                     }
 
@@ -1171,6 +1227,14 @@ void nnExtProcessSuperSprites() {
 
     // process sight sprites (for players only)
     if (gSightSpritesCount > 0) {
+        
+        // sectors the players stand in for the PVS, once per tic
+        int nPlayerPvsSect[kMaxPlayers];
+        for (int a = connecthead; a >= 0; a = connectpoint2[a]) {
+            spritetype* pPlaySprite = gPlayer[a].pSprite;
+            nPlayerPvsSect[a] = (pPlaySprite) ? sightPvsSector(pPlaySprite->x, pPlaySprite->y, pPlaySprite->sectnum) : -1;
+        }
+
         for (int i = 0; i < gSightSpritesCount; i++) {
             if (!xsprIsFine(&sprite[gSightSpritesList[i]]))
                 continue;
@@ -1191,6 +1255,7 @@ void nnExtProcessSuperSprites() {
             int x = sprite[gSightSpritesList[i]].x;	int y = sprite[gSightSpritesList[i]].y;
             int z = sprite[gSightSpritesList[i]].z; int sectnum = sprite[gSightSpritesList[i]].sectnum;
             int ztop2, zbot2;
+            int nPvsSect = sightPvsSector(x, y, sectnum);
             
             for (int a = connecthead; a >= 0; a = connectpoint2[a]) {
                 
@@ -1198,6 +1263,9 @@ void nnExtProcessSuperSprites() {
                 if (!pPlayer || !xsprIsFine(pPlayer->pSprite) || pPlayer->pXSprite->health <= 0)
                     continue;
 
+                if (!pvsCanSee(nPvsSect, nPlayerPvsSect[a]))
+                    continue;
+
                 spritetype* pPlaySprite = pPlayer->pSprite;
                 GetSpriteExtents(pPlaySprite, &ztop2, &zbot2);
                 if (cansee(x, y, z, sectnum, pPlaySprite->x, pPlaySprite->y, ztop2, pPlaySprite->sectnum)) {
@@ -1568,6 +1636,7 @@ void debrisMove(int listIndex) {
 
         moveHit = gSpriteHit[nXSprite].hit = ClipMove((int*)&pSprite->x, (int*)&pSprite->y, (int*)&pSprite->z, &nSector, xvel[nSprite] >> 12,
             yvel[nSprite] >> 12, clipDist, ceilDist, floorDist, CLIPMASK0);
+        spritegridTouch(nSprite);
 
         pSprite->cstat = oldcstat;
         if (pSprite->sectnum != nSector) {
@@ -1579,6 +1648,7 @@ void debrisMove(int listIndex) {
             short nSector2 = nSector;
             if (pushmove_old(&pSprite->x, &pSprite->y, &pSprite->z, &nSector2, clipDist, ceilDist, floorDist, CLIPMASK0) != -1)
                 nSector = nSector2;
+            spritegridTouch(nSprite);
         }
 
         if ((gSpriteHit[nXSprite].hit & 0xc000) == 0x8000) {
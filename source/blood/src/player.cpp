@@ -1740,7 +1740,9 @@ void playerProcess(PLAYER *pPlayer)
     if (!gNoClip)
     {
         short nSector = pSprite->sectnum;
-        if (pushmove_old(&pSprite->x, &pSprite->y, &pSprite->z, &nSector, dw, dzt, dzb, CLIPMASK0) == -1)
+        int const nPush = pushmove_old(&pSprite->x, &pSprite->y, &pSprite->z, &nSector, dw, dzt, dzb, CLIPMASK0);
+        spritegridTouch(nSprite);
+        if (nPush == -1)
             actDamageSprite(nSprite, pSprite, kDamageFall, 500<<4);
         if (pSprite->sectnum != nSector)
         {
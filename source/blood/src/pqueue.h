@@ -21,7 +21,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 //-------------------------------------------------------------------------
 #pragma once
-#include <set>
 #include <functional>
 #include "common_game.h"
 #define kPQueueSize 1024
@@ -144,43 +143,3 @@ public:
         }
     }
 };
-
-template<typename T> class StdPriorityQueue : public PriorityQueue<T>
-{
-public:
-    std::multiset<queueItem<T>> stdQueue;
-    ~StdPriorityQueue()
-    {
-        stdQueue.clear();
-    }
-    uint32_t Size(void) { return stdQueue.size(); };
-    void Clear(void)
-    {
-        stdQueue.clear();
-    }
-    void Insert(uint32_t nPriority, T data)
-    {
-        stdQueue.insert({ nPriority, data });
-    }
-    T Remove(void)
-    {
-        dassert(stdQueue.size() > 0);
-        T data = stdQueue.begin()->at4;
-        stdQueue.erase(stdQueue.begin());
-        return data;
-    }
-    uint32_t LowestPriority(void)
-    {
-        return stdQueue.begin()->at0;
-    }
-    void Kill(std::function<bool(T)> pMatch)
-    {
-        for (auto i = stdQueue.begin(); i != stdQueue.end();)
-        {
-            if (pMatch(i->at4))
-                i = stdQueue.erase(i);
-            else
-                i++;
-        }
-    }
-};
@@ -24,9 +24,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#include "crc32.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "compat.h"
 #include "cache1d.h"
+#include "mpmcqueue.h"
 #ifdef WITHKPLIB
 #include "kplib.h"
 #endif
@@ -47,6 +50,173 @@ CACHENODE Resource::purgeHead = { NULL, &purgeHead, &purgeHead, 0 };
 #ifdef USE_QHEAP
 QHeap *Resource::heap;
 #endif
+
+// Index keys: 64-bit FNV-1a of the upper-cased type followed by the name or the id, so neither
+// Probe() nor Lookup() has to build or upper-case a string. Names still get compared on a match.
+static inline uint64_t ResourceKeyAdd(uint64_t key, const char *s)
+{
+    for (; *s; s++)
+    {
+        key = (key ^ (unsigned char)Btoupper(*s)) * 0x100000001b3ull;
+    }
+    return (key ^ '.') * 0x100000001b3ull;
+}
+
+static inline uint64_t ResourceKey(const char *type, const char *name)
+{
+    return ResourceKeyAdd(ResourceKeyAdd(0xcbf29ce484222325ull, type), name);
+}
+
+static inline uint64_t ResourceKey(const char *type, unsigned int id)
+{
+    uint64_t key = ResourceKeyAdd(0xcbf29ce484222325ull, type);
+    for (int i = 0; i < 4; i++, id >>= 8)
+    {
+        key = (key ^ (id & 0xff)) * 0x100000001b3ull;
+    }
+    return key;
+}
+
+static inline unsigned int ResourceSlot(uint64_t key)
+{
+    return (unsigned int)(key ^ (key >> 32));
+}
+
+static void SetKeys(DICTNODE *node)
+{
+    node->nameKey = ResourceKey(node->type, node->name);
+    node->idKey = ResourceKey(node->type, node->id);
+}
+
+// Background reads. Prefetch() queues a resource stored in an RFF file for a loader thread, which
+// copies it out of the mapped file, or reads it with kpread() where the file could not be mapped,
+// into a buffer taken from the cache beforehand and decrypts it. FinishLoads() hands finished
+// buffers to their nodes, so the cache and the MRU list are only ever touched on the main thread.
+// Lock() and Load() wait for a node that is still being read.
+
+enum {
+    kLoadThreads = 2,
+    kLoadQueueSize = 256,
+    kLoadMaxBytes = 8 << 20, // queued buffers are out of reach of the purge
+    kMaxLoadResources = 4,
+};
+
+struct LOADREQ
+{
+    Resource *pRes;
+    DICTNODE *pNode;
+    char *pBuffer;
+    unsigned int nOffset;
+    unsigned int nSize;
+    bool bCrypt;
+    bool bFailed;
+};
+
+static mpmcqueue<LOADREQ, kLoadQueueSize> loadRequests, loadFinished;
+
+static std::thread *loadThreads;
+static int nLoadThreads;
+static std::mutex loadMutex;
+static std::condition_variable loadWake;
+static bool bLoadQuit;
+
+// main thread only
+static int nLoadPending;
+static unsigned int nLoadBytes;
+static Resource *loadResources[kMaxLoadResources];
+static int nLoadResources;
+
+static void RegisterLoads(Resource *pRes)
+{
+    if (nLoadResources < kMaxLoadResources)
+        loadResources[nLoadResources++] = pRes;
+}
+
+static void UnregisterLoads(Resource *pRes)
+{
+    for (int i = 0; i < nLoadResources; i++)
+    {
+        if (loadResources[i] == pRes)
+        {
+            loadResources[i] = loadResources[--nLoadResources];
+            return;
+        }
+    }
+}
+
+static bool LoadQueueFull(unsigned int nSize)
+{
+    return nLoadPending >= kLoadQueueSize || (nLoadPending > 0 && nLoadBytes + nSize > kLoadMaxBytes);
+}
+
+static void LoadWorker(void)
+{
+    LOADREQ req;
+
+    for (;;)
+    {
+        if (!loadRequests.pop(&req))
+        {
+            std::unique_lock<std::mutex> lock(loadMutex);
+            loadWake.wait(lock, []{ return bLoadQuit || !loadRequests.empty(); });
+
+            if (bLoadQuit)
+                return;
+
+            continue;
+        }
+
+        Resource *pRes = req.pRes;
+        if (pRes->mapped)
+            memcpy(req.pBuffer, pRes->mapped + req.nOffset, req.nSize);
+        else
+            req.bFailed = (unsigned int)kpread(&pRes->pfd, req.pBuffer, req.nSize, req.nOffset) != req.nSize;
+
+        if (!req.bFailed && req.bCrypt)
+            pRes->Crypt(req.pBuffer, min(req.nSize, 0x100u), 0);
+
+        while (!loadFinished.push(req))
+            std::this_thread::yield();
+    }
+}
+
+static void LoadStart(void)
+{
+    if (nLoadThreads != 0)
+        return;
+
+    bLoadQuit = false;
+    nLoadThreads = kLoadThreads;
+    loadThreads = new std::thread[nLoadThreads];
+
+    for (int i = 0; i < nLoadThreads; i++)
+        loadThreads[i] = std::thread(LoadWorker);
+}
+
+static void LoadCollect(LOADREQ const &req)
+{
+    DICTNODE *h = req.pNode;
+
+    dassert(h->loading);
+    h->loading = false;
+    nLoadPending--;
+    nLoadBytes -= req.nSize;
+
+    // the node may have been replaced by an external file or a buffer in the meantime
+    if (!req.bFailed && !h->ptr && !(h->flags & (DICT_EXTERNAL|DICT_BUFFER)) && h->offset == req.nOffset && h->size == req.nSize)
+    {
+        h->ptr = req.pBuffer;
+
+        h->prev = Resource::purgeHead.prev;
+        Resource::purgeHead.prev->next = h;
+        h->next = &Resource::purgeHead;
+        Resource::purgeHead.prev = h;
+    }
+    else
+    {
+        Resource::Free(req.pBuffer);
+    }
+}
 Resource::Resource(void)
 {
     dict = NULL;
@@ -56,10 +226,16 @@ Resource::Resource(void)
     count = 0;
     handle = -1;
     crypt = true;
+    mapped = NULL;
+    mappedSize = 0;
+    hasPfd = false;
+    precacheNext = -1;
 }
 
 Resource::~Resource(void)
 {
+    WaitLoads();
+    UnregisterLoads(this);
     if (dict)
     {
         for (unsigned int i = 0; i < count; i++)
@@ -76,9 +252,15 @@ Resource::~Resource(void)
         buffSize = 0;
         count = 0;
     }
+    if (hasPfd)
+    {
+        kpclose(&pfd);
+        hasPfd = false;
+    }
     if (handle != -1)
     {
         kclose(handle);
+        mapped = NULL;
     }
 }
 
@@ -96,6 +278,12 @@ void Resource::Init(const char *filename)
         {
             int nFileLength = kfilelength(handle);
             dassert(nFileLength != -1);
+            mapped = (const char*)kmapview(handle, &mappedSize);
+            if (!mapped)
+            {
+                hasPfd = kpopen(handle, &pfd) == 0;
+            }
+            RegisterLoads(this);
             if (kread(handle, &header, sizeof(RFFHeader)) != sizeof(RFFHeader)
                 || memcmp(header.sign, "RFF\x1a", 4))
             {
@@ -253,6 +441,7 @@ void Resource::Flush(CACHENODE *h)
 
 void Resource::Purge(void)
 {
+    WaitLoads();
     for (unsigned int i = 0; i < count; i++)
     {
         if (dict[i].ptr)
@@ -264,13 +453,10 @@ void Resource::Purge(void)
 
 DICTNODE **Resource::Probe(const char *fname, const char *type)
 {
-    char name[BMAX_PATH];
     dassert(indexName != NULL);
-    memset(name, 0, sizeof(name));
-    strcpy(name, type);
-    strcat(name, fname);
     dassert(dict != NULL);
-    unsigned int hash = Bcrc32(name, strlen(name), 0) & (buffSize - 1);
+    uint64_t key = ResourceKey(type, fname);
+    unsigned int hash = ResourceSlot(key) & (buffSize - 1);
     unsigned int i = hash;
     do
     {
@@ -278,8 +464,9 @@ DICTNODE **Resource::Probe(const char *fname, const char *type)
         {
             return &indexName[i];
         }
-        if (!strcmp((*indexName[i]).type, type)
-            && !strcmp((*indexName[i]).name, fname))
+        if ((*indexName[i]).nameKey == key
+            && !Bstrcasecmp((*indexName[i]).type, type)
+            && !Bstrcasecmp((*indexName[i]).name, fname))
         {
             return &indexName[i];
         }
@@ -294,16 +481,10 @@ DICTNODE **Resource::Probe(const char *fname, const char *type)
 
 DICTNODE **Resource::Probe(unsigned int id, const char *type)
 {
-    struct {
-        int id;
-        char type[BMAX_PATH];
-    } name;
     dassert(indexName != NULL);
-    memset(&name, 0, sizeof(name));
-    strcpy(name.type, type);
-    name.id = id;
     dassert(dict != NULL);
-    unsigned int hash = Bcrc32(&name, strlen(name.type)+sizeof(name.id), 0) & (buffSize - 1);
+    uint64_t key = ResourceKey(type, id);
+    unsigned int hash = ResourceSlot(key) & (buffSize - 1);
     unsigned int i = hash;
     do
     {
@@ -311,8 +492,9 @@ DICTNODE **Resource::Probe(unsigned int id, const char *type)
         {
             return &indexId[i];
         }
-        if (!strcmp((*indexId[i]).type, type)
-            && (*indexId[i]).id == id)
+        if ((*indexId[i]).idKey == key
+            && (*indexId[i]).id == id
+            && !Bstrcasecmp((*indexId[i]).type, type))
         {
             return &indexId[i];
         }
@@ -335,6 +517,7 @@ void Resource::Reindex(void)
     memset(indexName, 0, buffSize * sizeof(DICTNODE*));
     for (unsigned int i = 0; i < count; i++)
     {
+        SetKeys(&dict[i]);
         DICTNODE **node = Probe(dict[i].name, dict[i].type);
         *node = &dict[i];
     }
@@ -357,6 +540,7 @@ void Resource::Reindex(void)
 
 void Resource::Grow(void)
 {
+    WaitLoads();
     buffSize *= 2;
     void *p = Alloc(buffSize * sizeof(DICTNODE));
     memset(p, 0, buffSize * sizeof(DICTNODE));
@@ -428,6 +612,7 @@ void Resource::AddExternalResource(const char *name, const char *type, int id, i
         strcpy(node->type, type2);
         strcpy(node->name, name2);
         strcpy(node->path, path);
+        SetKeys(node);
     }
     node->size = size;
     node->flags = DICT_EXTERNAL | flags;
@@ -473,6 +658,7 @@ void Resource::AddExternalResource(const char *name, const char *type, int id, i
         strcpy(node->name, name2);
         strcpy(node->path, path);
         node->id = id;
+        SetKeys(node);
         node->size = size;
         node->flags = DICT_EXTERNAL | flags;
         node->buffer = NULL;
@@ -526,6 +712,7 @@ void Resource::AddFromBuffer(const char* name, const char* type, char* data, int
         node->name = (char*)Alloc(nNameLength+1);
         strcpy(node->type, type2);
         strcpy(node->name, name2);
+        SetKeys(node);
     }
     node->size = size;
     node->flags = DICT_BUFFER | flags;
@@ -568,6 +755,7 @@ void Resource::AddFromBuffer(const char* name, const char* type, char* data, int
         strcpy(node->type, type2);
         strcpy(node->name, name2);
         node->id = id;
+        SetKeys(node);
         node->size = size;
         node->flags = DICT_BUFFER | flags;
         node->buffer = pHeapData;
@@ -638,27 +826,27 @@ void Resource::Free(void *p)
 
 DICTNODE *Resource::Lookup(const char *name, const char *type)
 {
-    char name2[BMAX_PATH], type2[BMAX_PATH];
     dassert(name != NULL);
     dassert(type != NULL);
     //if (strlen(name) > 8 || strlen(type) > 3) return NULL;
-    // Try to load external resource first
-    AddExternalResource(name, type);
-    strcpy(name2, name);
-    strcpy(type2, type);
-    Bstrupr(type2);
-    Bstrupr(name2);
-    return *Probe(name2, type2);
+    DICTNODE *node = *Probe(name, type);
+    // Try to load external resource first; that means opening a file, so it is only tried once per
+    // resource and level
+    if (!node || !node->externalChecked)
+    {
+        AddExternalResource(name, type);
+        node = *Probe(name, type);
+        if (node)
+            node->externalChecked = true;
+    }
+    return node;
 }
 
 DICTNODE *Resource::Lookup(unsigned int id, const char *type)
 {
-    char type2[BMAX_PATH];
     dassert(type != NULL);
     //if (strlen(type) > 3) return NULL;
-    strcpy(type2, type);
-    Bstrupr(type2);
-    return *Probe(id, type2);
+    return *Probe(id, type);
 }
 
 void Resource::Read(DICTNODE *n)
@@ -690,14 +878,21 @@ void Resource::Read(DICTNODE *n, void *p)
     }
     else
     {
-        int r = klseek(handle, n->offset, SEEK_SET);
-        if (r == -1)
+        if (mapped && n->offset + n->size <= (unsigned int)mappedSize)
         {
-            ThrowError("Error seeking to resource!");
+            Bmemcpy(p, mapped + n->offset, n->size);
         }
-        if ((uint32_t)kread(handle, p, n->size) != n->size)
+        else
         {
-            ThrowError("Error loading resource!");
+            int r = klseek(handle, n->offset, SEEK_SET);
+            if (r == -1)
+            {
+                ThrowError("Error seeking to resource!");
+            }
+            if ((uint32_t)kread(handle, p, n->size) != n->size)
+            {
+                ThrowError("Error loading resource!");
+            }
         }
         if (n->flags & DICT_CRYPT)
         {
@@ -710,7 +905,7 @@ void Resource::Read(DICTNODE *n, void *p)
             {
                 size = n->size;
             }
-            Crypt(n->ptr, size, 0);
+            Crypt(p, size, 0);
         }
 #if B_BIG_ENDIAN == 1
         if (!Bstrcmp(n->type, "QAV"))
@@ -793,6 +988,10 @@ void Resource::Read(DICTNODE *n, void *p)
 void *Resource::Load(DICTNODE *h)
 {
     dassert(h != NULL);
+    if (h->loading)
+    {
+        WaitLoads(h);
+    }
     if (h->ptr)
     {
         if (!h->lockCount)
@@ -831,6 +1030,10 @@ void *Resource::Load(DICTNODE *h, void *p)
 void *Resource::Lock(DICTNODE *h)
 {
     dassert(h != NULL);
+    if (h->loading)
+    {
+        WaitLoads(h);
+    }
     if (h->ptr)
     {
         if (h->lockCount == 0)
@@ -865,6 +1068,118 @@ void Resource::Unlock(DICTNODE *h)
     }
 }
 
+// Returns the data of a resource in place, read-only and without going through the cache, when it
+// is stored as is: unencrypted entries of a memory-mapped RFF file and resources added from
+// buffers. The data is as stored, so types Read() converts on big-endian machines must not be
+// viewed. Returns NULL when the resource has to be locked instead.
+const void *Resource::View(DICTNODE *h)
+{
+    dassert(h != NULL);
+    if (h->flags & DICT_EXTERNAL)
+    {
+        return NULL;
+    }
+    if (h->flags & DICT_BUFFER)
+    {
+        return h->buffer;
+    }
+    if (!(h->flags & DICT_CRYPT) && mapped && h->offset + h->size <= (unsigned int)mappedSize)
+    {
+        return mapped + h->offset;
+    }
+    return NULL;
+}
+
+// Queues h for a loader thread. Returns true if it is being read in the background, false if it
+// has to be loaded the usual way: it is loaded already, not stored in the RFF file itself or the
+// queue is full.
+bool Resource::Prefetch(DICTNODE *h)
+{
+    dassert(h != NULL);
+    if (h->loading)
+    {
+        return true;
+    }
+#if B_BIG_ENDIAN == 1
+    // Read() converts some types in place
+    return false;
+#else
+    if (h->ptr || h->size == 0 || (h->flags & (DICT_EXTERNAL|DICT_BUFFER)) || LoadQueueFull(h->size))
+    {
+        return false;
+    }
+    if (!(mapped && h->offset + h->size <= (unsigned int)mappedSize) && !hasPfd)
+    {
+        return false;
+    }
+    LoadStart();
+
+    LOADREQ req = { this, h, (char*)Alloc(h->size), h->offset, h->size, (h->flags & DICT_CRYPT) != 0, false };
+    loadRequests.push(req);
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+    }
+    loadWake.notify_one();
+
+    h->loading = true;
+    nLoadPending++;
+    nLoadBytes += h->size;
+    return true;
+#endif
+}
+
+// Called every frame.
+void Resource::FinishLoads(void)
+{
+    LOADREQ req;
+    while (nLoadPending != 0 && loadFinished.pop(&req))
+    {
+        LoadCollect(req);
+    }
+    for (int i = 0; i < nLoadResources; i++)
+    {
+        if (loadResources[i]->precacheNext >= 0)
+            loadResources[i]->QueuePrecache();
+    }
+}
+
+// Waits for h, or for everything queued when h is NULL.
+void Resource::WaitLoads(DICTNODE *h)
+{
+    while (h ? h->loading : nLoadPending != 0)
+    {
+        LOADREQ req;
+        if (loadFinished.pop(&req))
+            LoadCollect(req);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void Resource::StopLoads(void)
+{
+    WaitLoads();
+    for (int i = 0; i < nLoadResources; i++)
+    {
+        loadResources[i]->precacheNext = -1;
+    }
+    if (nLoadThreads == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        bLoadQuit = true;
+    }
+    loadWake.notify_all();
+
+    for (int i = 0; i < nLoadThreads; i++)
+        loadThreads[i].join();
+
+    delete[] loadThreads;
+    loadThreads = NULL;
+    nLoadThreads = 0;
+}
+
 void Resource::Crypt(void *p, int length, unsigned short key)
 {
     char *cp = (char*)p;
@@ -904,6 +1219,10 @@ void Resource::FNAddFiles(fnlist_t * fnlist, const char *pattern)
 
 void Resource::PurgeCache(void)
 {
+    for (unsigned int i = 0; i < count; i++)
+    {
+        dict[i].externalChecked = false;
+    }
 #ifndef USE_QHEAP
     for (CACHENODE *node = purgeHead.next; node != &purgeHead; node = node->next)
     {
@@ -920,21 +1239,33 @@ void Resource::PurgeCache(void)
 #endif
 }
 
+// Sounds are read on the loader threads while the level starts; PrecacheSounds() only queues as
+// many as they take at once and FinishLoads() goes on from there.
 void Resource::PrecacheSounds(void)
 {
-    for (unsigned int i = 0; i < count; i++)
+    precacheNext = 0;
+    QueuePrecache();
+}
+
+void Resource::QueuePrecache(void)
+{
+    for (; precacheNext >= 0 && (unsigned int)precacheNext < count; precacheNext++)
     {
-        DICTNODE *pNode = &dict[i];
-        if ((!strcmp(pNode->type, "RAW") || !strcmp(pNode->type, "SFX")) && !pNode->ptr)
+        DICTNODE *pNode = &dict[precacheNext];
+        if ((!strcmp(pNode->type, "RAW") || !strcmp(pNode->type, "SFX")) && !pNode->ptr && !Prefetch(pNode))
         {
+            if (LoadQueueFull(pNode->size))
+                return;
             Load(pNode);
             gameHandleEvents();
         }
     }
+    precacheNext = -1;
 }
 
 void Resource::RemoveNode(DICTNODE* pNode)
 {
+    WaitLoads();
     Flush(pNode);
     if (pNode->name)
     {
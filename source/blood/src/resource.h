@@ -80,6 +80,10 @@ struct DICTNODE : CACHENODE
     char *path;
     char *buffer;
     unsigned int id;
+    uint64_t nameKey;       // ResourceKey() of type and name, for indexName
+    uint64_t idKey;         // ResourceKey() of type and id, for indexId
+    bool externalChecked;   // Lookup() by name already looked for a file overriding it
+    bool loading;           // queued for a loader thread, see Prefetch()
 };
 
 class Resource
@@ -107,6 +111,7 @@ public:
     void *Load(DICTNODE *h, void *p);
     void *Lock(DICTNODE *h);
     void Unlock(DICTNODE *h);
+    const void *View(DICTNODE *h);
     void Crypt(void *p, int length, unsigned short key);
     static void RemoveMRU(CACHENODE *h);
     int Size(DICTNODE*h) { return h->size; }
@@ -114,6 +119,11 @@ public:
     void PrecacheSounds(void);
     void PurgeCache(void);
     void RemoveNode(DICTNODE* pNode);
+    bool Prefetch(DICTNODE *h);
+    void QueuePrecache(void);
+    static void FinishLoads(void);
+    static void WaitLoads(DICTNODE *h = NULL);
+    static void StopLoads(void);
 
     DICTNODE *dict;
     DICTNODE **indexName;
@@ -122,6 +132,11 @@ public:
     unsigned int count;
     int handle;
     bool crypt;
+    const char *mapped;
+    int mappedSize;
+    buildvfs_pfd pfd;
+    bool hasPfd;
+    int precacheNext;
 
 #if USE_QHEAP
     static QHeap *heap;
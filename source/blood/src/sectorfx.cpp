@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "compat.h"
 #include "build.h"
 #include "pragmas.h"
+#include "microprofile.h"
 #include "common_game.h"
 
 #include "blood.h"
@@ -111,97 +112,146 @@ short shadeList[kMaxXSectors];
 int panCount = 0;
 short panList[kMaxXSectors];
 
-void DoSectorLighting(void)
+static void UndoLighting(sectortype *pSector, XSECTOR *pXSector)
 {
-    for (int i = 0; i < shadeCount; i++)
+    int v4 = pXSector->shade;
+    if (pXSector->shadeFloor)
     {
-        int nXSector = shadeList[i];
-        XSECTOR *pXSector = &xsector[nXSector];
-        int nSector = pXSector->reference;
-        dassert(sector[nSector].extra == nXSector);
-        if (pXSector->shade)
+        pSector->floorshade -= v4;
+        if (pXSector->color)
         {
-            int v4 = pXSector->shade;
-            if (pXSector->shadeFloor)
-            {
-                sector[nSector].floorshade -= v4;
-                if (pXSector->color)
-                {
-                    int nTemp = pXSector->floorpal;
-                    pXSector->floorpal = sector[nSector].floorpal;
-                    sector[nSector].floorpal = nTemp;
-                }
-            }
-            if (pXSector->shadeCeiling)
-            {
-                sector[nSector].ceilingshade -= v4;
-                if (pXSector->color)
-                {
-                    int nTemp = pXSector->ceilpal;
-                    pXSector->ceilpal = sector[nSector].ceilingpal;
-                    sector[nSector].ceilingpal = nTemp;
-                }
-            }
-            if (pXSector->shadeWalls)
-            {
-                int nStartWall = sector[nSector].wallptr;
-                int nEndWall = nStartWall + sector[nSector].wallnum;
-                for (int j = nStartWall; j < nEndWall; j++)
-                {
-                    wall[j].shade -= v4;
-                    if (pXSector->color)
-                    {
-                        wall[j].pal = sector[nSector].floorpal;
-                    }
-                }
-            }
-            pXSector->shade = 0;
+            int nTemp = pXSector->floorpal;
+            pXSector->floorpal = pSector->floorpal;
+            pSector->floorpal = nTemp;
         }
-        if (pXSector->shadeAlways || pXSector->busy)
+    }
+    if (pXSector->shadeCeiling)
+    {
+        pSector->ceilingshade -= v4;
+        if (pXSector->color)
+        {
+            int nTemp = pXSector->ceilpal;
+            pXSector->ceilpal = pSector->ceilingpal;
+            pSector->ceilingpal = nTemp;
+        }
+    }
+    if (pXSector->shadeWalls)
+    {
+        int nStartWall = pSector->wallptr;
+        int nEndWall = nStartWall + pSector->wallnum;
+        for (int j = nStartWall; j < nEndWall; j++)
         {
-            int t1 = pXSector->wave;
-            int t2 = pXSector->amplitude;
-            if (!pXSector->shadeAlways && pXSector->busy)
+            wall[j].shade -= v4;
+            if (pXSector->color)
             {
-                t2 = mulscale16(t2, pXSector->busy);
+                wall[j].pal = pSector->floorpal;
             }
-            int v4 = GetWaveValue(t1, pXSector->phase*8+pXSector->freq*(int)totalclock, t2);
-            if (pXSector->shadeFloor)
+        }
+    }
+    pXSector->shade = 0;
+}
+
+static void ApplyLighting(sectortype *pSector, XSECTOR *pXSector, int v4)
+{
+    if (pXSector->shadeFloor)
+    {
+        pSector->floorshade = ClipRange(pSector->floorshade+v4, -128, 127);
+        if (pXSector->color && v4 != 0)
+        {
+            int nTemp = pXSector->floorpal;
+            pXSector->floorpal = pSector->floorpal;
+            pSector->floorpal = nTemp;
+        }
+    }
+    if (pXSector->shadeCeiling)
+    {
+        pSector->ceilingshade = ClipRange(pSector->ceilingshade+v4, -128, 127);
+        if (pXSector->color && v4 != 0)
+        {
+            int nTemp = pXSector->ceilpal;
+            pXSector->ceilpal = pSector->ceilingpal;
+            pSector->ceilingpal = nTemp;
+        }
+    }
+    if (pXSector->shadeWalls)
+    {
+        int nStartWall = pSector->wallptr;
+        int nEndWall = nStartWall + pSector->wallnum;
+        for (int j = nStartWall; j < nEndWall; j++)
+        {
+            wall[j].shade = ClipRange(wall[j].shade+v4, -128, 127);
+            if (pXSector->color && v4 != 0)
             {
-                sector[nSector].floorshade = ClipRange(sector[nSector].floorshade+v4, -128, 127);
-                if (pXSector->color && v4 != 0)
-                {
-                    int nTemp = pXSector->floorpal;
-                    pXSector->floorpal = sector[nSector].floorpal;
-                    sector[nSector].floorpal = nTemp;
-                }
+                wall[j].pal = pSector->floorpal;
             }
-            if (pXSector->shadeCeiling)
+        }
+    }
+    pXSector->shade = v4;
+}
+
+// shadeList grouped by wave type. It is rebuilt when shadeList grows or the wave of a sector in it
+// changes, which DoSectorLighting() notices on the way.
+#define kWaveCount 16
+
+static short shadeWaveList[kMaxXSectors];
+static int shadeWaveStart[kWaveCount+1];
+static int shadeWaveCount = -1;
+
+static void SortSectorLighting(void)
+{
+    int nWaveCount[kWaveCount] = {};
+    for (int i = 0; i < shadeCount; i++)
+        nWaveCount[xsector[shadeList[i]].wave]++;
+    shadeWaveStart[0] = 0;
+    for (int i = 0; i < kWaveCount; i++)
+        shadeWaveStart[i+1] = shadeWaveStart[i]+nWaveCount[i];
+    int nWaveNext[kWaveCount];
+    memcpy(nWaveNext, shadeWaveStart, sizeof(nWaveNext));
+    for (int i = 0; i < shadeCount; i++)
+        shadeWaveList[nWaveNext[xsector[shadeList[i]].wave]++] = shadeList[i];
+    shadeWaveCount = shadeCount;
+}
+
+// Only sectors whose wave gives a different value than the one applied last time are touched:
+// undoing a value and applying it again leaves a sector as it was.
+void DoSectorLighting(void)
+{
+    MICROPROFILE_SCOPEI("Game", EDUKE32_FUNCTION, MP_YELLOWGREEN);
+    if (shadeWaveCount != shadeCount)
+        SortSectorLighting();
+    bool bResort = false;
+    for (int nWave = 0; nWave < kWaveCount; nWave++)
+    {
+        for (int i = shadeWaveStart[nWave]; i < shadeWaveStart[nWave+1]; i++)
+        {
+            int nXSector = shadeWaveList[i];
+            XSECTOR *pXSector = &xsector[nXSector];
+            int nSector = pXSector->reference;
+            dassert(sector[nSector].extra == nXSector);
+            if (pXSector->wave != nWave)
+                bResort = true;
+            if (pXSector->shadeAlways || pXSector->busy)
             {
-                sector[nSector].ceilingshade = ClipRange(sector[nSector].ceilingshade+v4, -128, 127);
-                if (pXSector->color && v4 != 0)
+                int t2 = pXSector->amplitude;
+                if (!pXSector->shadeAlways && pXSector->busy)
                 {
-                    int nTemp = pXSector->ceilpal;
-                    pXSector->ceilpal = sector[nSector].ceilingpal;
-                    sector[nSector].ceilingpal = nTemp;
+                    t2 = mulscale16(t2, pXSector->busy);
                 }
+                int v4 = GetWaveValue(pXSector->wave, pXSector->phase*8+pXSector->freq*(int)totalclock, t2);
+                if (v4 == pXSector->shade)
+                    continue;
+                if (pXSector->shade)
+                    UndoLighting(&sector[nSector], pXSector);
+                ApplyLighting(&sector[nSector], pXSector, v4);
             }
-            if (pXSector->shadeWalls)
+            else if (pXSector->shade)
             {
-                int nStartWall = sector[nSector].wallptr;
-                int nEndWall = nStartWall + sector[nSector].wallnum;
-                for (int j = nStartWall; j < nEndWall; j++)
-                {
-                    wall[j].shade = ClipRange(wall[j].shade+v4, -128, 127);
-                    if (pXSector->color && v4 != 0)
-                    {
-                        wall[j].pal = sector[nSector].floorpal;
-                    }
-                }
+                UndoLighting(&sector[nSector], pXSector);
             }
-            pXSector->shade = v4;
         }
     }
+    if (bResort)
+        shadeWaveCount = -1;
 }
 
 void UndoSectorLighting(void)
@@ -214,41 +264,7 @@ void UndoSectorLighting(void)
             XSECTOR *pXSector = &xsector[i];
             if (pXSector->shade)
             {
-                int v4 = pXSector->shade;
-                if (pXSector->shadeFloor)
-                {
-                    sector[i].floorshade -= v4;
-                    if (pXSector->color)
-                    {
-                        int nTemp = pXSector->floorpal;
-                        pXSector->floorpal = sector[i].floorpal;
-                        sector[i].floorpal = nTemp;
-                    }
-                }
-                if (pXSector->shadeCeiling)
-                {
-                    sector[i].ceilingshade -= v4;
-                    if (pXSector->color)
-                    {
-                        int nTemp = pXSector->ceilpal;
-                        pXSector->ceilpal = sector[i].ceilingpal;
-                        sector[i].ceilingpal = nTemp;
-                    }
-                }
-                if (pXSector->shadeWalls)
-                {
-                    int nStartWall = sector[i].wallptr;
-                    int nEndWall = nStartWall + sector[i].wallnum;
-                    for (int j = nStartWall; j < nEndWall; j++)
-                    {
-                        wall[j].shade -= v4;
-                        if (pXSector->color)
-                        {
-                            wall[j].pal = sector[i].floorpal;
-                        }
-                    }
-                }
-                pXSector->shade = 0;
+                UndoLighting(&sector[i], pXSector);
             }
         }
     }
@@ -259,6 +275,7 @@ int wallPanCount;
 
 void DoSectorPanning(void)
 {
+    MICROPROFILE_SCOPEI("Game", EDUKE32_FUNCTION, MP_YELLOWGREEN);
     for (int i = 0; i < panCount; i++)
     {
         int nXSector = panList[i];
@@ -273,6 +290,8 @@ void DoSectorPanning(void)
             int speed = pXSector->panVel<<10;
             if (!pXSector->panAlways && (pXSector->busy&0xffff))
                 speed = mulscale16(speed, pXSector->busy);
+            if (speed == 0)
+                continue;
 
             if (pXSector->panFloor) // Floor
             {
@@ -323,6 +342,8 @@ void DoSectorPanning(void)
                 psx = mulscale16(psx, pXWall->busy);
                 psy = mulscale16(psy, pXWall->busy);
             }
+            if (psx == 0 && psy == 0)
+                continue;
             int nTile = wall[nWall].picnum;
             int px = (wall[nWall].xpanning<<8)+pXWall->xpanFrac;
             int py = (wall[nWall].ypanning<<8)+pXWall->ypanFrac;
@@ -338,6 +359,7 @@ void DoSectorPanning(void)
 
 void InitSectorFX(void)
 {
+    shadeWaveCount = -1;
     shadeCount = 0;
     panCount = 0;
     wallPanCount = 0;
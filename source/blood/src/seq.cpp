@@ -40,11 +40,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #define kMaxClients 256
 #define kMaxSequences 1024
+#define kMaxPrecacheSeqs 1024
 
 static ACTIVE activeList[kMaxSequences];
 static int activeCount = 0;
 static int nClients = 0;
 static void(*clientCallback[kMaxClients])(int, int);
+static int precacheSeqs[kMaxPrecacheSeqs];
+static int nPrecacheSeqs = 0;
 
 int seqRegisterClient(void(*pClient)(int, int))
 {
@@ -73,16 +76,37 @@ void Seq::Precache(void)
         tilePrecacheTile(seqGetTile(&frames[i]));
 }
 
+// Sequences that aren't in the cache yet are read on the loader threads while the level's other
+// resources are gathered; seqPrecacheFinish() then goes through their frames.
 void seqPrecacheId(int id)
 {
     DICTNODE *hSeq = gSysRes.Lookup(id, "SEQ");
-    if (!hSeq)
+    if (!hSeq || hSeq->loading)
+        return;
+    if (!hSeq->ptr && nPrecacheSeqs < kMaxPrecacheSeqs && gSysRes.Prefetch(hSeq))
+    {
+        precacheSeqs[nPrecacheSeqs++] = id;
         return;
+    }
     Seq *pSeq = (Seq*)gSysRes.Lock(hSeq);
     pSeq->Precache();
     gSysRes.Unlock(hSeq);
 }
 
+void seqPrecacheFinish(void)
+{
+    for (int i = 0; i < nPrecacheSeqs; i++)
+    {
+        DICTNODE *hSeq = gSysRes.Lookup(precacheSeqs[i], "SEQ");
+        if (!hSeq)
+            continue;
+        Seq *pSeq = (Seq*)gSysRes.Lock(hSeq);
+        pSeq->Precache();
+        gSysRes.Unlock(hSeq);
+    }
+    nPrecacheSeqs = 0;
+}
+
 SEQINST siWall[kMaxXWalls];
 SEQINST siCeiling[kMaxXSectors];
 SEQINST siFloor[kMaxXSectors];
@@ -84,6 +84,7 @@ inline int seqGetTile(SEQFRAME* pFrame)
 
 int seqRegisterClient(void(*pClient)(int, int));
 void seqPrecacheId(int id);
+void seqPrecacheFinish(void);
 SEQINST* GetInstance(int nType, int nXIndex);
 void UnlockInstance(SEQINST *pInst);
 void seqSpawn(int nSeq, int nType, int nXIndex, int nCallbackID = -1);
@@ -154,7 +154,7 @@ void tileProcessGLVoxels(void)
 
 char * tileLoadTile(int nTile)
 {
-    if (!waloff[nTile]) tileLoad(nTile);
+    if (!waloff[nTile] || tileIsLoading(nTile)) tileLoad(nTile);
     return (char*)waloff[nTile];
 }
 
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "build.h"
 #include "compat.h"
 #include "mmulti.h"
+#include "sectorindex.h"
 #include "common_game.h"
 
 #include "ai.h"
@@ -949,7 +950,10 @@ void TranslateSector(int nSector, int a2, int a3, int a4, int a5, int a6, int a7
             if (!(pSprite->cstat&48) && floorZ <= bottom)
             {
                 if (v14)
+                {
                     RotatePoint((int*)&pSprite->x, (int*)&pSprite->y, v14, v20, v24);
+                    spritegridTouch(nSprite);
+                }
                 viewBackupSpriteLoc(nSprite, pSprite);
                 pSprite->ang = (pSprite->ang+v14)&2047;
                 pSprite->x += v28;
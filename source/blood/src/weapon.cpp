@@ -220,6 +220,13 @@ void SpawnShellEject(PLAYER *pPlayer, int a2, int a3)
 
 void WeaponInit(void)
 {
+    // read them all on the loader threads at once, the loop below waits for each one
+    for (int i = 0; i < kQAVEnd; i++)
+    {
+        DICTNODE *hRes = gSysRes.Lookup(i, "QAV");
+        if (hRes)
+            gSysRes.Prefetch(hRes);
+    }
     for (int i = 0; i < kQAVEnd; i++)
     {
         DICTNODE *hRes = gSysRes.Lookup(i, "QAV");
@@ -1140,6 +1147,7 @@ void ThrowRemote(int, PLAYER *pPlayer)
     int nXSprite = pSprite->extra;
     XSPRITE *pXSprite = &xsprite[nXSprite];
     pXSprite->rxID = 90+(pPlayer->pSprite->type-kDudePlayer1);
+    evUpdateRX(3, pSprite->index);
     UseAmmo(pPlayer, 11, 1);
     pPlayer->throwPower = 0;
 }
@@ -1150,6 +1158,7 @@ void DropRemote(int, PLAYER *pPlayer)
     int nXSprite = pSprite->extra;
     XSPRITE *pXSprite = &xsprite[nXSprite];
     pXSprite->rxID = 90+(pPlayer->pSprite->type-kDudePlayer1);
+    evUpdateRX(3, pSprite->index);
     UseAmmo(pPlayer, 11, 1);
 }
 
@@ -108,6 +108,12 @@ void setpalookupaddress(char *paladdr);
 void setuphlineasm4(int32_t bxinc, int32_t byinc);
 void hlineasm4(bssize_t cnt, int32_t skiploadincs, int32_t paloffs, uint32_t by, uint32_t bx, intptr_t p);
 
+// Draws cnt+1 pixels leftwards from p without touching any of the state set up above, so it may be
+// called from several threads at once. Points to the fastest version the CPU supports.
+typedef void (*hlinespanfunc_t)(char *p, bssize_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                                int32_t xinc, int32_t yinc, int32_t logx, int32_t logy);
+extern hlinespanfunc_t hlinespan;
+
 void setupslopevlin(int32_t logylogx, intptr_t bufplc, int32_t pinc);
 void slopevlin(intptr_t p, int32_t i, intptr_t slopaloffs, bssize_t cnt, int32_t bx, int32_t by);
 
@@ -144,6 +150,7 @@ void setupdrawslab (int32_t dabpl, intptr_t pal);
 void drawslab (int32_t dx, int32_t v, int32_t dy, int32_t vi, intptr_t vptr, intptr_t p);
 void stretchhline (intptr_t p0, int32_t u, bssize_t cnt, int32_t uinc, intptr_t rptr, intptr_t p);
 
+// Picks the SIMD versions of the span functions the CPU supports; call after sysReadCPUID().
 void mmxoverlay();
 
 #endif	// else
@@ -25,7 +25,10 @@
 #include "glbuild.h"
 #include "palette.h"
 #include "pragmas.h"
+#include "pvs.h"
 #include "random.h"
+#include "sectorindex.h"
+#include "spritegrid.h"
 
 #include "vfs.h"
 #include "cache1d.h"
@@ -638,6 +641,7 @@ EXTERN uspritetype tsprite[MAXSPRITESONSCREEN];
 EXTERN uint32_t sectorchanged[MAXSECTORS + M32_FIXME_SECTORS];
 EXTERN uint32_t wallchanged[MAXWALLS + M32_FIXME_WALLS];
 EXTERN uint32_t spritechanged[MAXSPRITES];
+EXTERN uint32_t geometrychanged;  // bumped by every tracked sector or wall write
 #endif
 
 #ifdef NEW_MAP_FORMAT
@@ -673,6 +677,7 @@ static FORCE_INLINE void sector_tracker_hook__(intptr_t const address)
 #endif
 
     ++sectorchanged[sectnum];
+    ++geometrychanged;
 }
 
 static FORCE_INLINE void wall_tracker_hook__(intptr_t const address)
@@ -684,6 +689,14 @@ static FORCE_INLINE void wall_tracker_hook__(intptr_t const address)
 #endif
 
     ++wallchanged[wallnum];
+    ++geometrychanged;
+
+    // moving a wall or relinking a red wall invalidates the potentially visible sets holding its sector
+    if (pvsactive && address - (intptr_t)&wall[wallnum] < (intptr_t)offsetof(uwalltype, cstat))
+        pvsTouchWall(wallnum);
+
+    if (sectorindexactive && address - (intptr_t)&wall[wallnum] < (intptr_t)offsetof(uwalltype, point2))
+        sectorindexTouchWall(wallnum);
 }
 
 static FORCE_INLINE void sprite_tracker_hook__(intptr_t const address)
@@ -695,6 +708,16 @@ static FORCE_INLINE void sprite_tracker_hook__(intptr_t const address)
 #endif
 
     ++spritechanged[spritenum];
+
+    // moving a sprite or changing its alignment or tile takes it out of its spritegrid cell
+    if (spritegridactive)
+    {
+        intptr_t const ofs = address - (intptr_t)&sprite[spritenum];
+
+        if (ofs < (intptr_t)offsetof(uspritetype, z) || ofs == (intptr_t)offsetof(uspritetype, cstat)
+            || ofs == (intptr_t)offsetof(uspritetype, picnum))
+            spritegridTouch(spritenum);
+    }
 }
 #endif
 
@@ -1233,6 +1256,18 @@ void    artClearMapArt(void);
 void    artSetupMapArt(const char *filename);
 bool    tileLoad(int16_t tilenume);
 void    tileLoadData(int16_t tilenume, int32_t dasiz, char *buffer);
+
+// Background tile loading. tileLoadAsync() is for the renderers: it queues the tile for a loader
+// thread and points it at a placeholder, loading it right away only if that isn't possible. Pass
+// masked for sprites and masked walls, so that the placeholder is transparent rather than black.
+// tilePrefetch() queues a tile without any placeholder. Loaded tiles reach the cache in
+// tileFinishLoads(), which videoNextPage() calls; tileLoad() waits for a queued tile.
+// Code that reads pixels must call tileLoad() while tileIsLoading(), since waloff[] may point at
+// the placeholder.
+bool    tileLoadAsync(int16_t tilenume, bool masked = false);
+void    tilePrefetch(int16_t tilenume);
+void    tileFinishLoads(void);
+bool    tileIsLoading(int16_t tilenume);
 int32_t tileGetCRC32(int16_t tileNum);
 vec2_16_t tileGetSize(int16_t tileNum);
 void    artConvertRGB(palette_t *pic, uint8_t const *buf, int32_t bufsizx, int32_t sizx, int32_t sizy);
@@ -1337,6 +1372,25 @@ void   neartag(int32_t xs, int32_t ys, int32_t zs, int16_t sectnum, int16_t ange
                int32_t (*blacklist_sprite_func)(int32_t)) ATTRIBUTE((nonnull(6,7,8)));
 int32_t   cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1,
                  int32_t x2, int32_t y2, int32_t z2, int16_t sect2);
+
+typedef struct
+{
+    vec3_t  pos1, pos2;
+    int16_t sect1, sect2;
+} canseequery_t;
+
+// Evaluates cansee() for every query, setting bit i of the results bitmap if query i can see its
+// target. Enough queries are spread over the engine thread pool; the answers don't depend on it.
+void      canseeBatch(canseequery_t const *queries, int32_t numqueries, uint8_t *results);
+
+// canseeCached() takes the same arguments as cansee(). It answers queries that were handed to
+// canseePrepareCache() from a batch run there, as long as no sector or wall has been written since,
+// and calls cansee() for anything else. Without struct trackers it always calls cansee().
+void      canseePrepareCache(canseequery_t const *queries, int32_t numqueries);
+void      canseeClearCache(void);
+int32_t   canseeCached(int32_t x1, int32_t y1, int32_t z1, int16_t sect1,
+                       int32_t x2, int32_t y2, int32_t z2, int16_t sect2);
+
 int32_t   inside(int32_t x, int32_t y, int16_t sectnum);
 void   calc_sector_reachability(void);
 int    sectorsareconnected(int const, int const);
@@ -1456,6 +1510,7 @@ static FORCE_INLINE CONSTEXPR int32_t E_SpriteIsValid(const int32_t i)
 }
 
 int clipshape_idx_for_sprite(uspriteptr_t curspr, int curidx);
+int clipshape_haspicnum(int picnum);
 
 void   alignceilslope(int16_t dasect, int32_t x, int32_t y, int32_t z);
 void   alignflorslope(int16_t dasect, int32_t x, int32_t y, int32_t z);
@@ -21,6 +21,8 @@ struct cpuinfo_t
     struct
     {
         int invariant_tsc : 1;
+        int sse2 : 1;
+        int avx2 : 1;  // only set if the OS also saves the YMM registers
     } features;
 };
 
@@ -30,25 +30,78 @@ enum cachelock_t : char
     CACHE1D_PERMANENT = 255,
 };
 
+// What a block holds, for the statistics shown by "cacheinfo".
+enum cachecategory_t : uint8_t
+{
+    CACHE1D_CAT_OTHER,
+    CACHE1D_CAT_TILE,
+    CACHE1D_CAT_VOXEL,
+    CACHE1D_CAT_SOUND,
+    CACHE1D_CAT_ANIM,
+    CACHE1D_NUMCATEGORIES
+};
+
+// Free space is kept in segregated size-class lists, so finding room is constant time while the
+// cache has any. Once it is full, blocks are evicted least recently used first: a block counts as
+// used when its owner raises its lock byte, as setgotpic() does for tiles. All calls may be made
+// from any thread.
 class cache1d
 {
 public:
     void    initBuffer(intptr_t dacachestart, uint32_t dacachesize, uint32_t minsize = 0);
-    void    allocateBlock(intptr_t* newhandle, int32_t newbytes, char* newlockptr);
-    void    tryHarder(int32_t const newbytes, int32_t * const besto, int32_t * const bestz);
+    void    allocateBlock(intptr_t* newhandle, int32_t newbytes, char* newlockptr, cachecategory_t category = CACHE1D_CAT_OTHER);
 
     void    ageBlocks(void);
-    int32_t findBlock(int32_t const newbytes, int32_t * const besto, int32_t * const bestz);
-    void    report(void);
+    void    report(bool listblocks = true);
     void    reset(void);
 
+    // Game thread only: counts a draw of a resident block, so "cacheinfo" can show how busy a category is.
+    void countDraw(cachecategory_t category) { m_stats[category].draws++; }
+
+    // Block descriptors, unused ones included; only to be looked at while nothing else allocates.
     int numBlocks(void) { return m_numBlocks; }
     cacheindex_t const * getIndex(void) { return m_index; }
 
 private:
-    void inc_and_check_cacnum(void);
+    struct cachelink_t
+    {
+        int32_t offset;
+        int32_t prev, next;        // neighbours in the buffer
+        int32_t lruprev, lrunext;  // towards the most / least recently used block, or the free list
+        uint8_t lastlock;          // lock byte when last looked at
+        uint8_t category;
+        uint8_t isfree;
+    };
+
+    struct cachestats_t
+    {
+        uint32_t draws, misses, evictions;
+        int32_t  numblocks, bytes;
+    };
+
+    enum
+    {
+        SLBITS  = 4,
+        SLCOUNT = 1 << SLBITS,
+        FLCOUNT = 32 - SLBITS,
+    };
+
+    int32_t newDescriptor(void);
+    void    freeDescriptor(int32_t block);
+    void    mapSize(int32_t units, int *fl, int *sl);
+    void    insertFree(int32_t block);
+    void    removeFree(int32_t block);
+    int32_t findFree(int32_t newbytes);
+    void    lruRemove(int32_t block);
+    void    lruPushFront(int32_t block);
+    int32_t releaseBlock(int32_t block);
+    int32_t evictBlock(int32_t block);
+    int32_t evictLeastRecent(int32_t newbytes);
+    int32_t evictWindow(int32_t newbytes);
+    void    reportLocked(bool listblocks);
 
     cacheindex_t *m_index{};
+    cachelink_t  *m_link{};
 
     intptr_t m_baseAddress{};
     int32_t  m_totalSize{};
@@ -56,6 +109,16 @@ private:
 
     int m_maxBlocks{};
     int m_numBlocks{};
+    int m_freeDescriptor{};
+    int m_ageCursor{};
+
+    int32_t m_lruHead{}, m_lruTail{};
+
+    uint32_t m_flBitmap{};
+    uint32_t m_slBitmap[FLCOUNT]{};
+    int32_t  m_freeHead[FLCOUNT][SLCOUNT]{};
+
+    cachestats_t m_stats[CACHE1D_NUMCATEGORIES]{};
 };
 
 extern cache1d g_cache;
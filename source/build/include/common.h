@@ -154,6 +154,17 @@ void COMMON_clearbackground(int32_t numcols, int32_t numrows);
 #define EDUKE32_TMRTIC t[ti++]=timerGetTicks()
 #define EDUKE32_TMRPRN do { int ii=0; fprintf(stderr,"%s: ",tmrstr); for (ii=1; ii<ti; ii++) fprintf(stderr,"%d ", t[ii]-t[ii-1]); fprintf(stderr,"\n"); } while (0)
 
+// Startup profiling: each G_StartupPhase() call closes the phase begun by the previous one and
+// files its time under the given name (NULL only restarts the clock). G_PrintStartupTimes() logs
+// the breakdown as a single line.
+void G_StartupPhase(char const *name);
+void G_PrintStartupTimes(void);
+
+// Computes the CRC32 of each of numfiles files, spread over the engine thread pool. Every job opens,
+// reads and closes its own file, so only as many files are open at once as there are threads.
+// failed[i] is set to 1 if file i could not be opened.
+void G_CrcFiles(int32_t numfiles, char const * const *paths, uint32_t *crcs, uint8_t *failed);
+
 #if defined _WIN32 && !defined EDUKE32_STANDALONE
 int Paths_ReadRegistryValue(char const * const SubKey, char const * const Value, char * const Output, DWORD * OutputSize);
 #endif
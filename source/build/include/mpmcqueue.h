@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef mpmcqueue_h_
+#define mpmcqueue_h_
+
+#include "compat.h"
+
+#include <atomic>
+
+// Bounded lock-free queue any number of threads may push to and pop from at the same time
+// (Dmitry Vyukov's sequence-numbered ring). Capacity must be a power of two. push() fails when
+// the queue is full and pop() when it is empty; neither ever blocks.
+
+template <typename T, uint32_t Capacity>
+class mpmcqueue
+{
+    EDUKE32_STATIC_ASSERT((Capacity & (Capacity - 1)) == 0);
+
+public:
+    mpmcqueue()
+    {
+        for (uint32_t i = 0; i < Capacity; i++)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(T const &value)
+    {
+        uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell_t &cell = m_cells[pos & (Capacity - 1)];
+            int32_t const diff = (int32_t)(cell.sequence.load(std::memory_order_acquire) - pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.data = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool pop(T *value)
+    {
+        uint32_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell_t &cell = m_cells[pos & (Capacity - 1)];
+            int32_t const diff = (int32_t)(cell.sequence.load(std::memory_order_acquire) - (pos + 1));
+
+            if (diff == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    *value = cell.data;
+                    cell.sequence.store(pos + Capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Only a hint while other threads are pushing or popping.
+    bool empty(void) const
+    {
+        return m_enqueuePos.load(std::memory_order_acquire) == m_dequeuePos.load(std::memory_order_acquire);
+    }
+
+private:
+    struct cell_t
+    {
+        std::atomic<uint32_t> sequence;
+        T data;
+    };
+
+    cell_t m_cells[Capacity];
+
+    // keep producers and consumers off each other's cache line
+    alignas(64) std::atomic<uint32_t> m_enqueuePos{};
+    alignas(64) std::atomic<uint32_t> m_dequeuePos{};
+};
+
+#endif // mpmcqueue_h_
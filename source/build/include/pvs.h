@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef pvs_h_
+#define pvs_h_
+
+#include "compat.h"
+
+// Potentially visible set: for every sector, a bitmap of the sectors a straight line of sight
+// starting anywhere inside it could reach by passing through red walls. It is conservative:
+// heights, masked and one-way walls are ignored, so a sector missing from the set can never be
+// seen from the other one, but one in the set may not be.
+//
+// calc_sector_reachability() builds the set whenever a map or savegame has been loaded. Building it
+// is spread over the engine thread pool and the result is kept in pvscache/, keyed by the map's MD4
+// and a checksum of its walls, so later loads only read it back. Maps with TROR get no set.
+//
+// Moving a wall or relinking a red wall through the struct trackers marks it. pvsUpdate() turns the
+// marked walls into stale rows, which answer "visible" for everything until a later pvsUpdate() with
+// no walls marked in between flows them again. Between a tracked write and the next pvsUpdate() no
+// row is trusted. Without struct trackers the set is never built.
+
+extern int32_t pvsactive;
+
+void pvsBuild(void);
+void pvsFree(void);
+
+void pvsTouchWall(int wallnum);
+
+// Game thread only. pvsSetView() already calls it.
+void pvsUpdate(void);
+
+// Returns 1 if a line of sight from fromsect may reach tosect, including when there is no usable set.
+int pvsCanSee(int fromsect, int tosect);
+
+// The renderers only use the set when the camera actually stands in the sector drawing starts from,
+// which is not the case for mirrors and room-over-room views.
+void pvsSetView(int32_t x, int32_t y, int sectnum);
+int  pvsViewCanSee(int sectnum);
+
+#endif // pvs_h_
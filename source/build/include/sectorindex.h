@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef sectorindex_h_
+#define sectorindex_h_
+
+#include "compat.h"
+
+// Uniform grid over the sectors' bounding boxes, so that updatesector() and friends only need to
+// call inside() on the few sectors filed under the cell a point falls in instead of on all of them.
+//
+// calc_sector_reachability() rebuilds the grid whenever a map or savegame has been loaded. A tracked
+// write to a wall's x or y marks the wall, and marked walls are looked at before the next lookup.
+// Code writing wall positions behind the trackers' back (through an int32_t pointer, say) has to
+// report it through sectorindexUpdateWall() or sectorindexUpdateSector() instead. A sector that
+// leaves the cells it was filed under goes on a short list of sectors every lookup checks, and the
+// grid is rebuilt once that list grows too long.
+//
+// An unreported move can make a lookup return the wrong one of two overlapping sectors, so without
+// struct trackers the grid never turns on.
+
+extern int32_t sectorindexactive;
+
+void sectorindexBuild(void);
+void sectorindexFree(void);
+
+void sectorindexUpdateSector(int sectnum);
+void sectorindexUpdateWall(int wallnum);
+void sectorindexTouchWall(int wallnum);
+
+// Returns 0 if there is no usable index. Otherwise the sectors that may contain (x, y) are
+// cell[0..numcell) and extra[0..numextra); a sector may appear in both.
+int sectorindexQuery(int32_t x, int32_t y, int16_t const **cell, int *numcell, int16_t const **extra, int *numextra);
+
+#endif // sectorindex_h_
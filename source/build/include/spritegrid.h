@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef spritegrid_h_
+#define spritegrid_h_
+
+#include "compat.h"
+
+// Hash of facing sprites by the map cell they stand in, so that clipmove() and getzrange() only
+// look at the sprites near the mover in sectors holding a lot of them (gibs, debris, casings).
+//
+// A game turns the grid on by calling spritegridBuild() once a level or savegame has been loaded;
+// initspritelists() turns it off again. While it is on:
+//
+//  - code linking a sprite into a sector list or unlinking it from one calls spritegridLink() and
+//    spritegridUnlink(); the engine's list functions and setsprite() already do.
+//  - a tracked write to a sprite's position, cstat or picnum takes it out of its cell and onto its
+//    sector's list of loose sprites, which every query returns. Code moving a sprite any other way,
+//    through xyz or xy, by copying the whole sprite or by handing &spr->x to clipmove(), pushmove()
+//    or rotatepoint(), calls spritegridTouch() on it afterwards.
+//  - spritegridRefile() files the loose sprites back into their cells. Call it somewhere no pointer
+//    into sprite[] is held, like the start of a game tic.
+//
+// Queries hand back their sprites in sector list order, so clipping results are the same as
+// walking headspritesect[]/nextspritesect[]. Without struct trackers the grid never turns on.
+
+extern int32_t spritegridactive;
+
+void spritegridBuild(void);
+void spritegridFree(void);
+void spritegridRefile(void);
+
+void spritegridLink(int spritenum, int sectnum);
+void spritegridUnlink(int spritenum);
+void spritegridTouch(int spritenum);
+
+// Returns -1 if the sprites of sectnum should just be walked. Otherwise *list holds the returned
+// number of sprites of sectnum, in sector list order, that are not filed or are filed under a cell
+// overlapping the box around (x, y) with the given radius.
+int spritegridQuery(int sectnum, int32_t x, int32_t y, int32_t radius, int16_t const **list);
+
+#endif // spritegrid_h_
@@ -0,0 +1,29 @@
+#pragma once
+
+#ifndef threadpool_h_
+#define threadpool_h_
+
+#include "compat.h"
+
+// Engine worker thread pool.
+//
+// The pool is started on first use with one worker less than the number of hardware threads; the
+// thread calling threadpoolParallelFor() takes part in the work, so a machine with N hardware
+// threads runs N jobs at once. With no workers (single core machines) everything runs serially on
+// the calling thread.
+//
+// The pool is meant to be driven from the game thread: threadpoolInit() and threadpoolUninit()
+// must not overlap a threadpoolParallelFor(), and threadpoolParallelFor() is not reentrant. A job
+// that calls it again gets its indices run serially on the thread running the job.
+
+typedef void (*threadpoolfunc_t)(int32_t index, void *userdata);
+
+int32_t threadpoolInit(int32_t numthreads);
+void    threadpoolUninit(void);
+int32_t threadpoolGetNumThreads(void);
+
+// Calls func(i, userdata) for every i in [0, count) and returns once all calls have finished.
+// The order in which indices are processed is unspecified.
+void threadpoolParallelFor(int32_t count, threadpoolfunc_t func, void *userdata);
+
+#endif // threadpool_h_
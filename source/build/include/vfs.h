@@ -72,6 +72,23 @@ static inline int64_t buildvfs_lseek_rel(buildvfs_fd fd, int64_t o)
 #define buildvfs_exists(fn) PHYSFS_exists(fn)
 #define buildvfs_isdir(path) PHYSFS_isDirectory(path)
 #define buildvfs_unlink(path) PHYSFS_delete(path)
+// PhysicsFS has no rename, so this goes through the real paths inside the write dir
+static inline int buildvfs_rename(char const *oldpath, char const *newpath)
+{
+    char const *const dir = PHYSFS_getWriteDir();
+    char const *const sep = PHYSFS_getDirSeparator();
+    char oldfn[BMAX_PATH], newfn[BMAX_PATH];
+
+    if (dir == nullptr || Bsnprintf(oldfn, sizeof(oldfn), "%s%s%s", dir, sep, oldpath) >= (int)sizeof(oldfn)
+        || Bsnprintf(newfn, sizeof(newfn), "%s%s%s", dir, sep, newpath) >= (int)sizeof(newfn))
+        return -1;
+
+#ifdef _WIN32
+    return !MoveFileExA(oldfn, newfn, MOVEFILE_REPLACE_EXISTING);
+#else
+    return rename(oldfn, newfn);
+#endif
+}
 
 #else
 
@@ -153,6 +170,15 @@ static FORCE_INLINE int buildvfs_isdir(char const *path)
     return (Bstat(path, &st) ? 0 : (st.st_mode & S_IFDIR) == S_IFDIR);
 }
 #define buildvfs_unlink(path) unlink(path)
+// replaces newpath if it exists
+static FORCE_INLINE int buildvfs_rename(char const *oldpath, char const *newpath)
+{
+#ifdef _WIN32
+    return !MoveFileExA(oldpath, newpath, MOVEFILE_REPLACE_EXISTING);
+#else
+    return rename(oldpath, newpath);
+#endif
+}
 
 #endif
 
@@ -279,6 +305,34 @@ void krename(int32_t crcval, int32_t filenum, const char *newname);
 char const * kfileparent(int32_t handle);
 #endif
 
+// Positional reads for loader threads: kpopen() makes an independent handle onto the data of an
+// open file, which kpread() can then read from any thread without disturbing the VFS. It stays valid
+// after the file is closed. Returns -1 where that isn't possible, e.g. for files inside ZIP archives.
+typedef struct
+{
+    intptr_t fd;
+    int32_t  base, length;
+} buildvfs_pfd;
+
+#ifdef USE_PHYSFS
+static inline int32_t kpopen(buildvfs_kfd, buildvfs_pfd *) { return -1; }
+static inline int32_t kpread(buildvfs_pfd const *, void *, int32_t, int32_t) { return -1; }
+static inline void kpclose(buildvfs_pfd *) {}
+#else
+int32_t kpopen(buildvfs_kfd handle, buildvfs_pfd *pfd);
+int32_t kpread(buildvfs_pfd const *pfd, void *buffer, int32_t leng, int32_t offset);
+void    kpclose(buildvfs_pfd *pfd);
+#endif
+
+// Returns the whole contents of an open file as read-only memory, without copying. The pointer stays
+// valid until the file is closed. Returns NULL where the data cannot be mapped, e.g. for compressed
+// ZIP entries, in which case the file can still be read normally.
+#ifdef USE_PHYSFS
+static inline void const *kmapview(buildvfs_kfd, int32_t *) { return NULL; }
+#else
+void const *kmapview(buildvfs_kfd handle, int32_t *length);
+#endif
+
 extern int32_t kpzbufloadfil(buildvfs_kfd);
 
 #ifdef WITHKPLIB
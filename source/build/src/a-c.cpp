@@ -65,33 +65,25 @@ void sethlinesizes(int32_t logx, int32_t logy, intptr_t bufplc)
 { glogx = logx; glogy = logy; gbuf = (char *)bufplc; }
 void setpalookupaddress(char *paladdr) { ghlinepal = paladdr; }
 void setuphlineasm4(int32_t bxinc, int32_t byinc) { gbxinc = bxinc; gbyinc = byinc; }
-void hlineasm4(bssize_t cnt, int32_t skiploadincs, int32_t paloffs, uint32_t by, uint32_t bx, intptr_t p)
-{
-    Bassert(gbuf);
-
-    if (!skiploadincs) { gbxinc = asm1; gbyinc = asm2; }
 
-    const char *const A_C_RESTRICT palptr = &ghlinepal[paloffs];
-    const char *const A_C_RESTRICT buf = gbuf;
-    const vec2_t inc = { gbxinc, gbyinc };
-    const vec2_t log = { glogx, glogy };
+// cnt+1 pixels, leftwards from p
+static void hlinespan_c(char *p, bssize_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                        int32_t xinc, int32_t yinc, int32_t logx, int32_t logy)
+{
+    const char *const A_C_RESTRICT palptr = pal;
+    const char *const A_C_RESTRICT bufptr = buf;
+    const vec2_t inc = { xinc, yinc };
+    const vec2_t log = { logx, logy };
     const vec2_t log32 = { 32-log.x, 32-log.y };
-    char *pp = (char *)p;
+    char *pp = p;
 
 #ifdef CLASSIC_SLICE_BY_4
     for (; cnt>=4; cnt-=4, pp-=4)
     {
-#if 1
-        *pp = palptr[buf[((bx>>log32.x)<<log.y)+(by>>log32.y)]];
-        *(pp-1) = palptr[buf[(((bx-inc.x)>>log32.x)<<log.y)+((by-inc.y)>>log32.y)]];
-        *(pp-2) = palptr[buf[(((bx-(inc.x<<1))>>log32.x)<<log.y)+((by-(inc.y<<1))>>log32.y)]];
-        *(pp-3) = palptr[buf[(((bx-(inc.x*3))>>log32.x)<<log.y)+((by-(inc.y*3))>>log32.y)]];
-#else
-        *(int32_t *)(pp-3) = palptr[buf[(((bx-(inc.x*3))>>log32.x)<<log.y)+((by-(inc.y*3))>>log32.y)]] +
-            (palptr[buf[(((bx-(inc.x<<1))>>log32.x)<<log.y)+((by-(inc.y<<1))>>log32.y)]]<<8) +
-            (palptr[buf[(((bx-inc.x)>>log32.x)<<log.y)+((by-inc.y)>>log32.y)]]<<16) +
-            (palptr[buf[((bx>>log32.x)<<log.y)+(by>>log32.y)]]<<24);
-#endif
+        *pp = palptr[bufptr[((bx>>log32.x)<<log.y)+(by>>log32.y)]];
+        *(pp-1) = palptr[bufptr[(((bx-inc.x)>>log32.x)<<log.y)+((by-inc.y)>>log32.y)]];
+        *(pp-2) = palptr[bufptr[(((bx-(inc.x<<1))>>log32.x)<<log.y)+((by-(inc.y<<1))>>log32.y)]];
+        *(pp-3) = palptr[bufptr[(((bx-(inc.x*3))>>log32.x)<<log.y)+((by-(inc.y*3))>>log32.y)]];
         bx -= inc.x<<2;
         by -= inc.y<<2;
     }
@@ -99,33 +91,53 @@ void hlineasm4(bssize_t cnt, int32_t skiploadincs, int32_t paloffs, uint32_t by,
 
     for (; cnt>=0; cnt--, pp--)
     {
-        *pp = palptr[buf[((bx>>log32.x)<<log.y)+(by>>log32.y)]];
+        *pp = palptr[bufptr[((bx>>log32.x)<<log.y)+(by>>log32.y)]];
         bx -= inc.x;
         by -= inc.y;
     }
 }
 
+hlinespanfunc_t hlinespan = hlinespan_c;
+
+void hlineasm4(bssize_t cnt, int32_t skiploadincs, int32_t paloffs, uint32_t by, uint32_t bx, intptr_t p)
+{
+    Bassert(gbuf);
+
+    if (!skiploadincs) { gbxinc = asm1; gbyinc = asm2; }
+
+    hlinespan((char *)p, cnt, &ghlinepal[paloffs], gbuf, bx, by, gbxinc, gbyinc, glogx, glogy);
+}
+
 
 ///// Sloped ceiling/floor vertical line functions /////
-void slopevlin(intptr_t p, int32_t i, intptr_t slopaloffs, bssize_t cnt, int32_t bx, int32_t by)
+// cnt pixels, stepping gpinc from p, with the palookup of each read downwards from slopalptr
+static void slopevlinspan_c(char *p, const intptr_t *slopalptr, bssize_t cnt, int32_t bx, int32_t by, int32_t bz, int32_t bzinc)
 {
-    intptr_t * A_C_RESTRICT slopalptr;
-    int32_t bz, bzinc;
+    int32_t i;
     uint32_t u, v;
 
-    bz = asm3; bzinc = (asm1>>3);
-    slopalptr = (intptr_t *)slopaloffs;
     for (; cnt>0; cnt--)
     {
         i = (sloptable[(bz>>6)+HALFSLOPTABLESIZ]); bz += bzinc;
         u = bx+(inthi_t)globalx3*i;
         v = by+(inthi_t)globaly3*i;
-        (*(char *)p) = *(char *)(((intptr_t)slopalptr[0])+gbuf[((u>>(32-glogx))<<glogy)+(v>>(32-glogy))]);
+        (*p) = *(char *)(((intptr_t)slopalptr[0])+gbuf[((u>>(32-glogx))<<glogy)+(v>>(32-glogy))]);
         slopalptr--;
         p += gpinc;
     }
 }
 
+typedef void (*slopevlinspanfunc_t)(char *, const intptr_t *, bssize_t, int32_t, int32_t, int32_t, int32_t);
+
+static slopevlinspanfunc_t slopevlinspan = slopevlinspan_c;
+
+void slopevlin(intptr_t p, int32_t i, intptr_t slopaloffs, bssize_t cnt, int32_t bx, int32_t by)
+{
+    UNREFERENCED_PARAMETER(i);
+
+    slopevlinspan((char *)p, (const intptr_t *)slopaloffs, cnt, bx, by, asm3, asm1>>3);
+}
+
 
 ///// Wall,face sprite/wall sprite vertical line functions /////
 
@@ -262,7 +274,7 @@ static void vlineasm4nlogy(bssize_t cnt, char *p, char *const A_C_RESTRICT * pal
 #endif
 
 // cnt >= 1
-void vlineasm4(bssize_t cnt, char *p)
+static void vlineasm4_c(bssize_t cnt, char *p)
 {
     char * const A_C_RESTRICT pal[4] = {(char *)palookupoffse[0], (char *)palookupoffse[1], (char *)palookupoffse[2], (char *)palookupoffse[3]};
     char * const A_C_RESTRICT buf[4] = {(char *)bufplce[0], (char *)bufplce[1], (char *)bufplce[2], (char *)bufplce[3]};
@@ -340,6 +352,12 @@ void vlineasm4(bssize_t cnt, char *p)
     Bmemcpy(&vplce[0], &vplc[0], sizeof(uint32_t) * 4);
 }
 
+typedef void (*vlineasm4func_t)(bssize_t, char *);
+
+static vlineasm4func_t vlineasm4func = vlineasm4_c;
+
+void vlineasm4(bssize_t cnt, char *p) { vlineasm4func(cnt, p); }
+
 #ifdef USE_SATURATE_VPLC
 static int32_t g_saturate;  // -1 if saturating vplc is requested, 0 else
 # define set_saturate(dosaturate) g_saturate = -(int)!!dosaturate
@@ -395,7 +413,7 @@ int32_t mvlineasm1(int32_t vinc, intptr_t paloffs, bssize_t cnt, uint32_t vplc,
 }
 
 // cnt >= 1
-void mvlineasm4(bssize_t cnt, char *p)
+static void mvlineasm4_c(bssize_t cnt, char *p)
 {
     char *const A_C_RESTRICT pal[4] = {(char *)palookupoffse[0], (char *)palookupoffse[1], (char *)palookupoffse[2], (char *)palookupoffse[3]};
     char *const A_C_RESTRICT buf[4] = {(char *)bufplce[0], (char *)bufplce[1], (char *)bufplce[2], (char *)bufplce[3]};
@@ -473,6 +491,10 @@ void mvlineasm4(bssize_t cnt, char *p)
     Bmemcpy(&vplce[0], &vplc[0], sizeof(uint32_t) * 4);
 }
 
+static vlineasm4func_t mvlineasm4func = mvlineasm4_c;
+
+void mvlineasm4(bssize_t cnt, char *p) { mvlineasm4func(cnt, p); }
+
 #ifdef USE_ASM64
 # define GLOGY a64_glogy
 #else
@@ -524,23 +546,14 @@ void setuptvlineasm2(int32_t neglogy, intptr_t paloffs1, intptr_t paloffs2)
 }
 
 #if !defined USE_ASM64
-// Pass: asm1=vinc2, asm2=pend
-// Return: asm1=vplc1, asm2=vplc2
-void tvlineasm2(uint32_t vplc2, int32_t vinc1, intptr_t bufplc1, intptr_t bufplc2, uint32_t vplc1, intptr_t p)
+// cnt >= 1 rows of two columns, pp[0] from buf1 and pp[1] from buf2
+static void tvlineasm2span_c(char *pp, bssize_t cnt, const char *buf1, const char *buf2, uint32_t &vplc1, uint32_t &vplc2,
+                             int32_t vinc1, int32_t vinc2)
 {
     char ch;
 
-    bssize_t cnt = tabledivide32(asm2-p-1, bpl);  // >= 1
-    const int32_t vinc2 = asm1;
-
-    const char *const A_C_RESTRICT buf1 = (char *)bufplc1;
-    const char *const A_C_RESTRICT buf2 = (char *)bufplc2;
     const int32_t logy = glogy, ourbpl = bpl, transm = transmode;
 
-    char *pp = (char *)p;
-
-    cnt++;
-
     uint8_t const shift = transm<<3;
 
     do
@@ -558,6 +571,19 @@ void tvlineasm2(uint32_t vplc2, int32_t vinc1, intptr_t bufplc1, intptr_t bufplc
         pp += ourbpl;
     }
     while (--cnt > 0);
+}
+
+typedef void (*tvlineasm2spanfunc_t)(char *, bssize_t, const char *, const char *, uint32_t &, uint32_t &, int32_t, int32_t);
+
+static tvlineasm2spanfunc_t tvlineasm2span = tvlineasm2span_c;
+
+// Pass: asm1=vinc2, asm2=pend
+// Return: asm1=vplc1, asm2=vplc2
+void tvlineasm2(uint32_t vplc2, int32_t vinc1, intptr_t bufplc1, intptr_t bufplc2, uint32_t vplc1, intptr_t p)
+{
+    bssize_t const cnt = tabledivide32(asm2-p-1, bpl);  // >= 1
+
+    tvlineasm2span((char *)p, cnt+1, (const char *)bufplc1, (const char *)bufplc2, vplc1, vplc2, vinc1, asm1);
 
     asm1 = vplc1;
     asm2 = vplc2;
@@ -566,58 +592,68 @@ void tvlineasm2(uint32_t vplc2, int32_t vinc1, intptr_t bufplc1, intptr_t bufplc
 
 //Floor sprite horizontal line functions
 void msethlineshift(int32_t logx, int32_t logy) { glogx = logx; glogy = logy; }
-// cntup16>>16 + 1 iterations
-void mhline(intptr_t bufplc, uint32_t bx, int32_t cntup16, int32_t junk, uint32_t by, intptr_t p)
+
+// cnt pixels, rightwards from p
+static void mhlinespan_c(char *p, int32_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                         int32_t xinc, int32_t yinc, int32_t logx, int32_t logy)
 {
     char ch;
 
-    const int32_t xinc = asm1, yinc = asm2;
+    do
+    {
+        ch = buf[((bx>>(32-logx))<<logy)+(by>>(32-logy))];
+        if (ch != 255) *p = pal[ch];
+        bx += xinc;
+        by += yinc;
+        p++;
+    }
+    while (--cnt);
+}
 
-    UNREFERENCED_PARAMETER(junk);
+static void thlinespan_c(char *p, int32_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                         int32_t xinc, int32_t yinc, int32_t logx, int32_t logy)
+{
+    char ch;
 
-    gbuf = (char *)bufplc;
-    gpal = (char *)asm3;
+    uint8_t const shift = transmode<<3;
 
-    cntup16>>=16;
-    cntup16++;
     do
     {
-        ch = gbuf[((bx>>(32-glogx))<<glogy)+(by>>(32-glogy))];
-        if (ch != 255) *((char *)p) = gpal[ch];
+        ch = buf[((bx>>(32-logx))<<logy)+(by>>(32-logy))];
+        if (ch != 255) *p = gtrans[((*p)<<(8-shift))|(pal[ch]<<shift)];
         bx += xinc;
         by += yinc;
         p++;
     }
-    while (--cntup16);
+    while (--cnt);
 }
 
-void tsethlineshift(int32_t logx, int32_t logy) { glogx = logx; glogy = logy; }
-// cntup16>>16 + 1 iterations
-void thline(intptr_t bufplc, uint32_t bx, int32_t cntup16, int32_t junk, uint32_t by, intptr_t p)
-{
-    char ch;
+typedef void (*mhlinespanfunc_t)(char *, int32_t, const char *, const char *, uint32_t, uint32_t, int32_t, int32_t, int32_t, int32_t);
 
-    const int32_t xinc = asm1, yinc = asm2;
+static mhlinespanfunc_t mhlinespan = mhlinespan_c;
+static mhlinespanfunc_t thlinespan = thlinespan_c;
 
+// cntup16>>16 + 1 iterations
+void mhline(intptr_t bufplc, uint32_t bx, int32_t cntup16, int32_t junk, uint32_t by, intptr_t p)
+{
     UNREFERENCED_PARAMETER(junk);
 
     gbuf = (char *)bufplc;
     gpal = (char *)asm3;
 
-    cntup16>>=16;
-    cntup16++;
+    mhlinespan((char *)p, (cntup16>>16)+1, gpal, gbuf, bx, by, asm1, asm2, glogx, glogy);
+}
 
-    uint8_t const shift = transmode<<3;
+void tsethlineshift(int32_t logx, int32_t logy) { glogx = logx; glogy = logy; }
+// cntup16>>16 + 1 iterations
+void thline(intptr_t bufplc, uint32_t bx, int32_t cntup16, int32_t junk, uint32_t by, intptr_t p)
+{
+    UNREFERENCED_PARAMETER(junk);
 
-    do
-    {
-        ch = gbuf[((bx>>(32-glogx))<<glogy)+(by>>(32-glogy))];
-        if (ch != 255) *((char *)p) = gtrans[((*((char *)p))<<(8-shift))|(gpal[ch]<<shift)];
-        bx += xinc;
-        by += yinc;
-        p++;
-    }
-    while (--cntup16);
+    gbuf = (char *)bufplc;
+    gpal = (char *)asm3;
+
+    thlinespan((char *)p, (cntup16>>16)+1, gpal, gbuf, bx, by, asm1, asm2, glogx, glogy);
 }
 
 
@@ -708,6 +744,395 @@ void drawslab(int32_t dx, int32_t v, int32_t dy, int32_t vi, intptr_t vptr, intp
     while (--dy);
 }
 
+
+///// SIMD span and column functions /////
+
+// These produce exactly the same pixels as the reference functions above. Spans on tiles one
+// texel wide or tall (logx or logy of 0) shift by 32 in the reference, which the vector shifts
+// don't reproduce, so those are left to the C versions. So are columns of tiles whose height is
+// not a power of two (logy of 0), which scale vplc by the tile height instead of shifting it.
+
+#if defined EDUKE32_CPU_X86 && defined BITNESS64 && (defined __SSE2__ || defined _MSC_VER)
+# include "build_cpuid.h"
+# include <immintrin.h>
+# if defined __GNUC__ || defined __clang__
+#  define A_C_TARGET_AVX2 __attribute__((target("avx2")))
+# else
+#  define A_C_TARGET_AVX2
+# endif
+
+static void hlinespan_sse2(char *p, bssize_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                           int32_t xinc, int32_t yinc, int32_t logx, int32_t logy)
+{
+    if (logx && logy && cnt >= 3)
+    {
+        __m128i const shx = _mm_cvtsi32_si128(32-logx), shy = _mm_cvtsi32_si128(32-logy), shl = _mm_cvtsi32_si128(logy);
+        // lane j is pixel p-3+j
+        __m128i vbx = _mm_setr_epi32(bx-3*xinc, bx-2*xinc, bx-xinc, bx);
+        __m128i vby = _mm_setr_epi32(by-3*yinc, by-2*yinc, by-yinc, by);
+        __m128i const vxinc = _mm_set1_epi32(xinc<<2), vyinc = _mm_set1_epi32(yinc<<2);
+
+        do
+        {
+            __m128i const idx = _mm_add_epi32(_mm_sll_epi32(_mm_srl_epi32(vbx, shx), shl), _mm_srl_epi32(vby, shy));
+            uint32_t i[4];
+            _mm_storeu_si128((__m128i *)i, idx);
+
+            uint32_t const pix = (uint8_t)pal[(uint8_t)buf[i[0]]] | ((uint8_t)pal[(uint8_t)buf[i[1]]]<<8) |
+                                 ((uint8_t)pal[(uint8_t)buf[i[2]]]<<16) | ((uint32_t)(uint8_t)pal[(uint8_t)buf[i[3]]]<<24);
+            Bmemcpy(p-3, &pix, sizeof(pix));
+
+            vbx = _mm_sub_epi32(vbx, vxinc);
+            vby = _mm_sub_epi32(vby, vyinc);
+            p -= 4;
+            cnt -= 4;
+        }
+        while (cnt >= 3);
+
+        bx = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi32(vbx, 0xff));
+        by = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi32(vby, 0xff));
+    }
+
+    hlinespan_c(p, cnt, pal, buf, bx, by, xinc, yinc, logx, logy);
+}
+
+// Fetches base[idx] for all eight lanes. The gather only loads the aligned dword holding each
+// byte, so it never touches memory outside the page the byte itself lives on.
+static FORCE_INLINE A_C_TARGET_AVX2 __m256i gatherbytes_avx2(const char *base, __m256i idx)
+{
+    __m256i const ofs = _mm256_add_epi32(idx, _mm256_set1_epi32((int32_t)((uintptr_t)base & 3)));
+    __m256i const dw  = _mm256_i32gather_epi32((const int *)((uintptr_t)base & ~(uintptr_t)3), _mm256_srli_epi32(ofs, 2), 4);
+    __m256i const sh  = _mm256_slli_epi32(_mm256_and_si256(ofs, _mm256_set1_epi32(3)), 3);
+
+    return _mm256_and_si256(_mm256_srlv_epi32(dw, sh), _mm256_set1_epi32(255));
+}
+
+// low byte of each lane -> 8 consecutive bytes
+static FORCE_INLINE A_C_TARGET_AVX2 __m128i packbytes_avx2(__m256i v)
+{
+    __m256i const sh = _mm256_shuffle_epi8(v, _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                               0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    return _mm_unpacklo_epi32(_mm256_castsi256_si128(sh), _mm256_extracti128_si256(sh, 1));
+}
+
+static FORCE_INLINE A_C_TARGET_AVX2 __m256i texidx_avx2(__m256i vbx, __m256i vby, __m128i shx, __m128i shy, __m128i shl)
+{
+    return _mm256_add_epi32(_mm256_sll_epi32(_mm256_srl_epi32(vbx, shx), shl), _mm256_srl_epi32(vby, shy));
+}
+
+static A_C_TARGET_AVX2 void hlinespan_avx2(char *p, bssize_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                                           int32_t xinc, int32_t yinc, int32_t logx, int32_t logy)
+{
+    if (logx && logy && cnt >= 7)
+    {
+        __m128i const shx = _mm_cvtsi32_si128(32-logx), shy = _mm_cvtsi32_si128(32-logy), shl = _mm_cvtsi32_si128(logy);
+        // lane j is pixel p-7+j
+        __m256i const lane = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        __m256i vbx = _mm256_sub_epi32(_mm256_set1_epi32(bx), _mm256_mullo_epi32(lane, _mm256_set1_epi32(xinc)));
+        __m256i vby = _mm256_sub_epi32(_mm256_set1_epi32(by), _mm256_mullo_epi32(lane, _mm256_set1_epi32(yinc)));
+        __m256i const vxinc = _mm256_set1_epi32(xinc<<3), vyinc = _mm256_set1_epi32(yinc<<3);
+
+        do
+        {
+            __m256i const ch = gatherbytes_avx2(buf, texidx_avx2(vbx, vby, shx, shy, shl));
+            _mm_storel_epi64((__m128i *)(p-7), packbytes_avx2(gatherbytes_avx2(pal, ch)));
+
+            vbx = _mm256_sub_epi32(vbx, vxinc);
+            vby = _mm256_sub_epi32(vby, vyinc);
+            p -= 8;
+            cnt -= 8;
+        }
+        while (cnt >= 7);
+
+        bx = (uint32_t)_mm256_extract_epi32(vbx, 7);
+        by = (uint32_t)_mm256_extract_epi32(vby, 7);
+    }
+
+    hlinespan_c(p, cnt, pal, buf, bx, by, xinc, yinc, logx, logy);
+}
+
+// Shared by the masked and translucent spans: trans is null for mhline.
+static FORCE_INLINE A_C_TARGET_AVX2 void mthlinespan_avx2(char *p, int32_t cnt, const char *pal, const char *buf, uint32_t &bx, uint32_t &by,
+                                                          int32_t xinc, int32_t yinc, int32_t logx, int32_t logy, const char *trans)
+{
+    __m128i const shx = _mm_cvtsi32_si128(32-logx), shy = _mm_cvtsi32_si128(32-logy), shl = _mm_cvtsi32_si128(logy);
+    __m128i const dshift = _mm_cvtsi32_si128(8-(transmode<<3)), pshift = _mm_cvtsi32_si128(transmode<<3);
+    // lane j is pixel p+j
+    __m256i const lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i vbx = _mm256_add_epi32(_mm256_set1_epi32(bx), _mm256_mullo_epi32(lane, _mm256_set1_epi32(xinc)));
+    __m256i vby = _mm256_add_epi32(_mm256_set1_epi32(by), _mm256_mullo_epi32(lane, _mm256_set1_epi32(yinc)));
+    __m256i const vxinc = _mm256_set1_epi32(xinc<<3), vyinc = _mm256_set1_epi32(yinc<<3);
+    __m256i const transparent = _mm256_set1_epi32(255);
+
+    do
+    {
+        __m256i const ch  = gatherbytes_avx2(buf, texidx_avx2(vbx, vby, shx, shy, shl));
+        __m256i const dst = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)p));
+        __m256i pix = gatherbytes_avx2(pal, ch);
+
+        if (trans)
+            pix = gatherbytes_avx2(trans, _mm256_or_si256(_mm256_sll_epi32(dst, dshift), _mm256_sll_epi32(pix, pshift)));
+
+        // not _mm256_blendv_epi8(): GCC 12 folds it into a signed char compare, which -funsigned-char breaks
+        __m256i const keep = _mm256_cmpeq_epi32(ch, transparent);
+        pix = _mm256_or_si256(_mm256_andnot_si256(keep, pix), _mm256_and_si256(keep, dst));
+        _mm_storel_epi64((__m128i *)p, packbytes_avx2(pix));
+
+        vbx = _mm256_add_epi32(vbx, vxinc);
+        vby = _mm256_add_epi32(vby, vyinc);
+        p += 8;
+        cnt -= 8;
+    }
+    while (cnt >= 8);
+
+    bx = (uint32_t)_mm256_extract_epi32(vbx, 0);
+    by = (uint32_t)_mm256_extract_epi32(vby, 0);
+}
+
+static A_C_TARGET_AVX2 void mhlinespan_avx2(char *p, int32_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                                            int32_t xinc, int32_t yinc, int32_t logx, int32_t logy)
+{
+    if (logx && logy && cnt >= 8)
+    {
+        int32_t const vcnt = cnt & ~7;
+        mthlinespan_avx2(p, vcnt, pal, buf, bx, by, xinc, yinc, logx, logy, nullptr);
+        if ((cnt -= vcnt) == 0)
+            return;
+        p += vcnt;
+    }
+
+    mhlinespan_c(p, cnt, pal, buf, bx, by, xinc, yinc, logx, logy);
+}
+
+static A_C_TARGET_AVX2 void thlinespan_avx2(char *p, int32_t cnt, const char *pal, const char *buf, uint32_t bx, uint32_t by,
+                                            int32_t xinc, int32_t yinc, int32_t logx, int32_t logy)
+{
+    if (logx && logy && cnt >= 8)
+    {
+        int32_t const vcnt = cnt & ~7;
+        mthlinespan_avx2(p, vcnt, pal, buf, bx, by, xinc, yinc, logx, logy, gtrans);
+        if ((cnt -= vcnt) == 0)
+            return;
+        p += vcnt;
+    }
+
+    thlinespan_c(p, cnt, pal, buf, bx, by, xinc, yinc, logx, logy);
+}
+
+// Fetches the byte at each of four 64-bit addresses, the same way gatherbytes_avx2() does. The
+// column functions read each lane from its own tile or palookup, so there is no common base.
+static FORCE_INLINE A_C_TARGET_AVX2 __m128i gatherbytes64_avx2(__m256i addr)
+{
+    __m128i const dw = _mm256_i64gather_epi32((const int *)nullptr, _mm256_andnot_si256(_mm256_set1_epi64x(3), addr), 1);
+    __m128i const lo = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(addr, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    __m128i const sh = _mm_slli_epi32(_mm_and_si128(lo, _mm_set1_epi32(3)), 3);
+
+    return _mm_and_si128(_mm_srlv_epi32(dw, sh), _mm_set1_epi32(255));
+}
+
+static FORCE_INLINE A_C_TARGET_AVX2 __m128i gatheroffsets64_avx2(__m256i base, __m128i idx)
+{
+    return gatherbytes64_avx2(_mm256_add_epi64(base, _mm256_cvtepu32_epi64(idx)));
+}
+
+// low byte of each lane -> 4 consecutive bytes
+static FORCE_INLINE A_C_TARGET_AVX2 uint32_t packbytes4_avx2(__m128i v)
+{
+    return (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi8(v, _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)));
+}
+
+static A_C_TARGET_AVX2 void vlineasm4_avx2(bssize_t cnt, char *p)
+{
+    int32_t const logy = glogy, ourbpl = bpl;
+
+    if (!logy)
+    {
+        vlineasm4_c(cnt, p);
+        return;
+    }
+
+    __m256i const buf = _mm256_setr_epi64x(bufplce[0], bufplce[1], bufplce[2], bufplce[3]);
+    __m256i const pal = _mm256_setr_epi64x(palookupoffse[0], palookupoffse[1], palookupoffse[2], palookupoffse[3]);
+    __m128i const vinc = _mm_loadu_si128((const __m128i *)vince);
+    __m128i const shy  = _mm_cvtsi32_si128(logy);
+    __m128i vplc = _mm_loadu_si128((const __m128i *)vplce);
+
+    do
+    {
+        __m128i const ch = gatheroffsets64_avx2(buf, _mm_srl_epi32(vplc, shy));
+        uint32_t const pix = packbytes4_avx2(gatheroffsets64_avx2(pal, ch));
+        Bmemcpy(p, &pix, sizeof(pix));
+
+        vplc = _mm_add_epi32(vplc, vinc);
+        p += ourbpl;
+    }
+    while (--cnt);
+
+    _mm_storeu_si128((__m128i *)vplce, vplc);
+}
+
+static A_C_TARGET_AVX2 void mvlineasm4_avx2(bssize_t cnt, char *p)
+{
+    int32_t const logy = glogy, ourbpl = bpl;
+
+    if (!logy)
+    {
+        mvlineasm4_c(cnt, p);
+        return;
+    }
+
+    __m256i const buf = _mm256_setr_epi64x(bufplce[0], bufplce[1], bufplce[2], bufplce[3]);
+    __m256i const pal = _mm256_setr_epi64x(palookupoffse[0], palookupoffse[1], palookupoffse[2], palookupoffse[3]);
+    __m128i const vinc = _mm_loadu_si128((const __m128i *)vince);
+    __m128i const shy  = _mm_cvtsi32_si128(logy);
+    __m128i const transparent = _mm_set1_epi32(255);
+#ifdef USE_SATURATE_VPLC
+    __m128i const saturate = _mm_set1_epi32(g_saturate), sign = _mm_set1_epi32(INT32_MIN);
+    __m128i const svinc = _mm_xor_si128(vinc, sign);
+#endif
+    __m128i vplc = _mm_loadu_si128((const __m128i *)vplce);
+
+    do
+    {
+        uint32_t dst;
+        Bmemcpy(&dst, p, sizeof(dst));
+
+        __m128i const ch   = gatheroffsets64_avx2(buf, _mm_srl_epi32(vplc, shy));
+        __m128i const pix  = gatheroffsets64_avx2(pal, ch);
+        __m128i const keep = _mm_cmpeq_epi32(ch, transparent);
+        uint32_t const out = packbytes4_avx2(_mm_or_si128(_mm_andnot_si128(keep, pix), _mm_and_si128(keep, _mm_cvtepu8_epi32(_mm_cvtsi32_si128(dst)))));
+        Bmemcpy(p, &out, sizeof(out));
+
+        vplc = _mm_add_epi32(vplc, vinc);
+#ifdef USE_SATURATE_VPLC
+        // unsigned vplc < vinc, as saturate_vplc() does it
+        vplc = _mm_or_si128(vplc, _mm_and_si128(saturate, _mm_cmplt_epi32(_mm_xor_si128(vplc, sign), svinc)));
+#endif
+        p += ourbpl;
+    }
+    while (--cnt);
+
+    _mm_storeu_si128((__m128i *)vplce, vplc);
+}
+
+#if !defined USE_ASM64 && !defined USE_SATURATE_VPLC_TRANS
+// Two rows per step: lanes 0 and 1 are the two columns of one row, lanes 2 and 3 those of the next.
+static A_C_TARGET_AVX2 void tvlineasm2span_avx2(char *pp, bssize_t cnt, const char *buf1, const char *buf2, uint32_t &vplc1, uint32_t &vplc2,
+                                                int32_t vinc1, int32_t vinc2)
+{
+    int32_t const logy = glogy, ourbpl = bpl;
+
+    if (logy && cnt >= 2)
+    {
+        __m256i const buf = _mm256_setr_epi64x((intptr_t)buf1, (intptr_t)buf2, (intptr_t)buf1, (intptr_t)buf2);
+        __m256i const pal = _mm256_setr_epi64x((intptr_t)gpal, (intptr_t)gpal2, (intptr_t)gpal, (intptr_t)gpal2);
+        __m256i const trans = _mm256_set1_epi64x((intptr_t)gtrans);
+        __m128i const vinc  = _mm_setr_epi32(vinc1<<1, vinc2<<1, vinc1<<1, vinc2<<1);
+        __m128i const shy   = _mm_cvtsi32_si128(logy);
+        __m128i const dshift = _mm_cvtsi32_si128(8-(transmode<<3)), pshift = _mm_cvtsi32_si128(transmode<<3);
+        __m128i const transparent = _mm_set1_epi32(255);
+        __m128i vplc = _mm_setr_epi32(vplc1, vplc2, vplc1+vinc1, vplc2+vinc2);
+
+        do
+        {
+            uint16_t row0, row1;
+            Bmemcpy(&row0, pp, sizeof(row0));
+            Bmemcpy(&row1, pp+ourbpl, sizeof(row1));
+
+            __m128i const dst  = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(row0 | (row1<<16)));
+            __m128i const ch   = gatheroffsets64_avx2(buf, _mm_srl_epi32(vplc, shy));
+            __m128i const pix  = gatheroffsets64_avx2(pal, ch);
+            __m128i const blnd = gatheroffsets64_avx2(trans, _mm_or_si128(_mm_sll_epi32(dst, dshift), _mm_sll_epi32(pix, pshift)));
+            __m128i const keep = _mm_cmpeq_epi32(ch, transparent);
+            uint32_t const out = packbytes4_avx2(_mm_or_si128(_mm_andnot_si128(keep, blnd), _mm_and_si128(keep, dst)));
+
+            row0 = (uint16_t)out;
+            row1 = (uint16_t)(out>>16);
+            Bmemcpy(pp, &row0, sizeof(row0));
+            Bmemcpy(pp+ourbpl, &row1, sizeof(row1));
+
+            vplc = _mm_add_epi32(vplc, vinc);
+            pp += ourbpl<<1;
+            cnt -= 2;
+        }
+        while (cnt >= 2);
+
+        vplc1 = (uint32_t)_mm_cvtsi128_si32(vplc);
+        vplc2 = (uint32_t)_mm_extract_epi32(vplc, 1);
+
+        if (!cnt)
+            return;
+    }
+
+    tvlineasm2span_c(pp, cnt, buf1, buf2, vplc1, vplc2, vinc1, vinc2);
+}
+#endif
+
+// Eight pixels per step. The slope table lookup and the texel index are computed for all of them at
+// once; the palookup differs per pixel, so that lookup goes through gatherbytes64_avx2().
+static A_C_TARGET_AVX2 void slopevlinspan_avx2(char *p, const intptr_t *slopalptr, bssize_t cnt, int32_t bx, int32_t by, int32_t bz, int32_t bzinc)
+{
+    if (glogx && glogy && cnt >= 8)
+    {
+        __m128i const shx = _mm_cvtsi32_si128(32-glogx), shy = _mm_cvtsi32_si128(32-glogy), shl = _mm_cvtsi32_si128(glogy);
+        __m256i const lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i const vbx = _mm256_set1_epi32(bx), vby = _mm256_set1_epi32(by);
+        __m256i const vx3 = _mm256_set1_epi32(globalx3), vy3 = _mm256_set1_epi32(globaly3);
+        __m256i const vbzinc = _mm256_set1_epi32(bzinc<<3);
+        __m256i const half = _mm256_set1_epi32(HALFSLOPTABLESIZ);
+        __m256i vbz = _mm256_add_epi32(_mm256_set1_epi32(bz), _mm256_mullo_epi32(lane, _mm256_set1_epi32(bzinc)));
+
+        do
+        {
+            __m256i const i = _mm256_i32gather_epi32(sloptable, _mm256_add_epi32(_mm256_srai_epi32(vbz, 6), half), 4);
+            __m256i const u = _mm256_add_epi32(vbx, _mm256_mullo_epi32(vx3, i));
+            __m256i const v = _mm256_add_epi32(vby, _mm256_mullo_epi32(vy3, i));
+            __m256i const ch = gatherbytes_avx2(gbuf, texidx_avx2(u, v, shx, shy, shl));
+
+            // slopalptr[0], slopalptr[-1], ... slopalptr[-7]
+            __m256i const pal0 = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(slopalptr-3)), _MM_SHUFFLE(0, 1, 2, 3));
+            __m256i const pal1 = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(slopalptr-7)), _MM_SHUFFLE(0, 1, 2, 3));
+
+            uint64_t const pix = packbytes4_avx2(gatheroffsets64_avx2(pal0, _mm256_castsi256_si128(ch)))
+                                 | ((uint64_t)packbytes4_avx2(gatheroffsets64_avx2(pal1, _mm256_extracti128_si256(ch, 1)))<<32);
+
+            for (int k=0; k<8; k++, p += gpinc)
+                *p = (char)(pix>>(k<<3));
+
+            vbz = _mm256_add_epi32(vbz, vbzinc);
+            slopalptr -= 8;
+            cnt -= 8;
+        }
+        while (cnt >= 8);
+
+        bz = _mm_cvtsi128_si32(_mm256_castsi256_si128(vbz));
+    }
+
+    slopevlinspan_c(p, slopalptr, cnt, bx, by, bz, bzinc);
+}
+
+void mmxoverlay()
+{
+    if (cpu.features.avx2)
+    {
+        hlinespan  = hlinespan_avx2;
+        mhlinespan = mhlinespan_avx2;
+        thlinespan = thlinespan_avx2;
+
+        vlineasm4func  = vlineasm4_avx2;
+        mvlineasm4func = mvlineasm4_avx2;
+#if !defined USE_ASM64 && !defined USE_SATURATE_VPLC_TRANS
+        tvlineasm2span = tvlineasm2span_avx2;
+#endif
+        slopevlinspan  = slopevlinspan_avx2;
+    }
+    else if (cpu.features.sse2)
+        hlinespan = hlinespan_sse2;
+}
+#else
+void mmxoverlay() { }
+#endif
+
 #if 0
 void stretchhline(intptr_t p0, int32_t u, bssize_t cnt, int32_t uinc, intptr_t rptr, intptr_t p)
 {
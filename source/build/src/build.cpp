@@ -776,7 +776,7 @@ int app_main(int argc, char const* const* argv)
         walock[i] = CACHE1D_PERMANENT;
         picsiz[i] = 5 + (5<<4);
         tilesiz[i].x = sx; tilesiz[i].y = sy;
-        g_cache.allocateBlock(&waloff[i], sx*sy, &walock[i]);
+        g_cache.allocateBlock(&waloff[i], sx*sy, &walock[i], CACHE1D_CAT_TILE);
         newtile = (char *)waloff[i];
 
         col = paletteGetClosestColor(128, 128, 0);
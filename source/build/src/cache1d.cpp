@@ -43,30 +43,86 @@
 #include "pragmas.h"
 #include "vfs.h"
 
+#include <mutex>
+
 static bool g_cacheInit;
 static char zerochar;
+static std::mutex cachemutex;  // guards g_cache, the only instance
 static int32_t lockrecip[200];
 
 cache1d g_cache;
 
 #if !defined DEBUG_ALLOCACHE_AS_MALLOC
-static int osdfunc_cacheinfo(osdcmdptr_t UNUSED(parm))
+static int osdfunc_cacheinfo(osdcmdptr_t parm)
 {
-    UNREFERENCED_CONST_PARAMETER(parm);
-
-    g_cache.report();
+    g_cache.report(parm->numparms > 0 && !Bstrcasecmp(parm->parms[0], "blocks"));
 
     return OSDCMD_OK;
 }
 
+static char const *const cachecategorynames[CACHE1D_NUMCATEGORIES] = { "other", "tiles", "voxels", "sounds", "anims" };
+
+static inline int findLastSet(uint32_t u)
+{
+#if (defined __GNUC__  && __GNUC__>=3) || defined __clang__
+    return 31 - __builtin_clz(u);
+#elif defined _MSC_VER
+    DWORD result;
+    _BitScanReverse(&result, u);
+    return result;
+#else
+    int result = -1;
+    for (; u != 0; u >>= 1, result++);
+    return result;
+#endif
+}
+
+static inline int findFirstSet(uint32_t u)
+{
+#if (defined __GNUC__  && __GNUC__>=3) || defined __clang__
+    return __builtin_ctz(u);
+#elif defined _MSC_VER
+    DWORD result;
+    _BitScanForward(&result, u);
+    return result;
+#else
+    int result = 0;
+    for (; !(u & 1); u >>= 1, result++);
+    return result;
+#endif
+}
+
 void cache1d::reset(void)
 {
-    Bmemset(m_index, 0, m_maxBlocks * sizeof(cacheindex_t));
+    std::lock_guard<std::mutex> lock(cachemutex);
 
-    m_index[0].leng = m_totalSize;
-    m_index[0].lock = &zerochar;
+    for (int i = 0; i < m_maxBlocks; i++)
+    {
+        m_index[i] = { &zerochar, nullptr, 0, 0 };
+        m_link[i]  = { 0, -1, -1, -1, i + 1, 0, CACHE1D_CAT_OTHER, 1 };
+    }
+
+    m_link[m_maxBlocks - 1].lrunext = -1;
+
+    m_numBlocks      = 0;
+    m_freeDescriptor = 0;
+    m_ageCursor      = 0;
+    m_lruHead = m_lruTail = -1;
+
+    m_flBitmap = 0;
+    Bmemset(m_slBitmap, 0, sizeof(m_slBitmap));
+    for (auto &fl : m_freeHead)
+        for (auto &head : fl)
+            head = -1;
+
+    for (auto &stats : m_stats)
+        stats.numblocks = stats.bytes = 0;
 
-    m_numBlocks = 1;
+    // descriptor 0 always stays the block at the start of the buffer
+    int32_t const first = newDescriptor();
+
+    m_index[first].leng = m_totalSize;
+    insertFree(first);
 }
 
 void cache1d::initBuffer(intptr_t dacachestart, uint32_t dacachesize, uint32_t minsize /*= 0*/)
@@ -76,7 +132,7 @@ void cache1d::initBuffer(intptr_t dacachestart, uint32_t dacachesize, uint32_t m
         for (int i = 1; i < 200; i++)
             lockrecip[i] = tabledivide32_noinline(1 << 28, 200 - i);
 
-        OSD_RegisterFunction("cacheinfo", "cacheinfo: displays cache statistics", osdfunc_cacheinfo);
+        OSD_RegisterFunction("cacheinfo", "cacheinfo [blocks]: displays cache statistics", osdfunc_cacheinfo);
 
         g_cacheInit = true;
     }
@@ -87,10 +143,20 @@ void cache1d::initBuffer(intptr_t dacachestart, uint32_t dacachesize, uint32_t m
     m_baseAddress = ((uintptr_t)dacachestart + 15) & ~(uintptr_t)0xf;
     m_totalSize   = (dacachesize - (((uintptr_t)(dacachestart)) & 0xf)) & ~(uintptr_t)0xf;
 
-    m_maxBlocks    = MINCACHEINDEXSIZE;
-    m_minBlockSize = minsize >= MINCACHEBLOCKSIZE ? minsize : Bgetpagesize();
-    m_index        = (cacheindex_t *)Xaligned_alloc(m_minBlockSize, m_maxBlocks * sizeof(cacheindex_t));
+    // blocks no longer have to be kept few for the allocator to stay fast, so the granularity is
+    // only there to keep the descriptor count down
+    m_minBlockSize = 64;
+
+    if (minsize >= MINCACHEBLOCKSIZE)
+        m_minBlockSize = 1 << findLastSet(minsize);
+
+    m_totalSize &= ~(m_minBlockSize - 1);
 
+    m_maxBlocks = MINCACHEINDEXSIZE;
+    m_index     = (cacheindex_t *)Xrealloc(m_index, m_maxBlocks * sizeof(cacheindex_t));
+    m_link      = (cachelink_t *)Xrealloc(m_link, m_maxBlocks * sizeof(cachelink_t));
+
+    m_numBlocks = 0;
     reset();
 
 #ifdef DEBUGGINGAIDS
@@ -99,46 +165,304 @@ void cache1d::initBuffer(intptr_t dacachestart, uint32_t dacachesize, uint32_t m
     initprintf("Initialized %.1fM cache\n", (float)(dacachesize/1024.f/1024.f));
 }
 
-// Dynamic cache resizing -- increase cache array size when full
-void cache1d::inc_and_check_cacnum(void)
+int32_t cache1d::newDescriptor(void)
 {
-    if (++m_numBlocks >= m_maxBlocks)
+    if (m_freeDescriptor == -1)
     {
-        auto new_index = (cacheindex_t *)Xaligned_alloc(Bgetpagesize(), (m_maxBlocks + MINCACHEINDEXSIZE) * sizeof(cacheindex_t));
+        // Dynamic cache resizing -- increase cache array size when full
+        int const newMaxBlocks = m_maxBlocks + MINCACHEINDEXSIZE;
 
-        Bmemset(new_index + m_maxBlocks, 0, MINCACHEINDEXSIZE * sizeof(cacheindex_t));
-        Bmemcpy(new_index, m_index, m_maxBlocks * sizeof(cacheindex_t));
+        m_index = (cacheindex_t *)Xrealloc(m_index, newMaxBlocks * sizeof(cacheindex_t));
+        m_link  = (cachelink_t *)Xrealloc(m_link, newMaxBlocks * sizeof(cachelink_t));
 
-        Xaligned_free(m_index);
-        m_index = new_index;
+        for (int i = m_maxBlocks; i < newMaxBlocks; i++)
+        {
+            m_index[i] = { &zerochar, nullptr, 0, 0 };
+            m_link[i]  = { 0, -1, -1, -1, i + 1, 0, CACHE1D_CAT_OTHER, 1 };
+        }
+
+        m_link[newMaxBlocks - 1].lrunext = -1;
+        m_freeDescriptor = m_maxBlocks;
 
 #ifdef DEBUGGINGAIDS
-        buildprint("Cache increased from \'", m_maxBlocks, "\' to \'", m_maxBlocks + MINCACHEINDEXSIZE, "\' entries.\n");
+        buildprint("Cache increased from \'", m_maxBlocks, "\' to \'", newMaxBlocks, "\' entries.\n");
 #endif
-        m_maxBlocks += MINCACHEINDEXSIZE;
+        m_maxBlocks = newMaxBlocks;
+    }
+
+    int32_t const block = m_freeDescriptor;
+
+    m_freeDescriptor = m_link[block].lrunext;
+    m_numBlocks      = max(m_numBlocks, block + 1);
+
+    m_link[block] = { 0, -1, -1, -1, -1, 0, CACHE1D_CAT_OTHER, 1 };
+
+    return block;
+}
+
+void cache1d::freeDescriptor(int32_t const block)
+{
+    m_index[block] = { &zerochar, nullptr, 0, 0 };
+    m_link[block]  = { 0, -1, -1, -1, m_freeDescriptor, 0, CACHE1D_CAT_OTHER, 1 };
+
+    m_freeDescriptor = block;
+}
+
+// Two-level segregated fit: the first level is the power of two of the size in units of
+// m_minBlockSize, the second splits that range into SLCOUNT linear steps.
+void cache1d::mapSize(int32_t const units, int * const fl, int * const sl)
+{
+    if (units < SLCOUNT)
+    {
+        *fl = 0;
+        *sl = units;
+        return;
+    }
+
+    int const bit = findLastSet(units);
+
+    *fl = bit - SLBITS + 1;
+    *sl = (units >> (bit - SLBITS)) - SLCOUNT;
+}
+
+void cache1d::insertFree(int32_t const block)
+{
+    int fl, sl;
+    mapSize(m_index[block].leng / m_minBlockSize, &fl, &sl);
+
+    auto &link = m_link[block];
+
+    link.isfree  = 1;
+    link.lruprev = -1;
+    link.lrunext = m_freeHead[fl][sl];
+
+    if (link.lrunext != -1)
+        m_link[link.lrunext].lruprev = block;
+
+    m_freeHead[fl][sl] = block;
+    m_flBitmap |= 1u << fl;
+    m_slBitmap[fl] |= 1u << sl;
+}
+
+void cache1d::removeFree(int32_t const block)
+{
+    int fl, sl;
+    mapSize(m_index[block].leng / m_minBlockSize, &fl, &sl);
+
+    auto &link = m_link[block];
+
+    if (link.lruprev != -1)
+        m_link[link.lruprev].lrunext = link.lrunext;
+    else
+        m_freeHead[fl][sl] = link.lrunext;
+
+    if (link.lrunext != -1)
+        m_link[link.lrunext].lruprev = link.lruprev;
+
+    if (m_freeHead[fl][sl] == -1 && !(m_slBitmap[fl] &= ~(1u << sl)))
+        m_flBitmap &= ~(1u << fl);
+
+    link.lruprev = link.lrunext = -1;
+    link.isfree  = 0;
+}
+
+int32_t cache1d::findFree(int32_t const newbytes)
+{
+    int32_t units = newbytes / m_minBlockSize;
+    int fl, sl;
+
+    // round up to the next size class so that any block on the list found is large enough
+    if (units >= SLCOUNT)
+        units += (1 << (findLastSet(units) - SLBITS)) - 1;
+
+    mapSize(units, &fl, &sl);
+
+    if (fl < FLCOUNT)
+    {
+        uint32_t slmap = m_slBitmap[fl] & (~0u << sl);
+
+        if (!slmap)
+        {
+            uint32_t const flmap = fl + 1 < FLCOUNT ? m_flBitmap & (~0u << (fl + 1)) : 0;
+
+            if (flmap)
+            {
+                fl    = findFirstSet(flmap);
+                slmap = m_slBitmap[fl];
+            }
+        }
+
+        if (slmap)
+            return m_freeHead[fl][findFirstSet(slmap)];
     }
+
+    // blocks in the requested size's own class may still be large enough
+    mapSize(newbytes / m_minBlockSize, &fl, &sl);
+
+    for (int32_t block = m_freeHead[fl][sl]; block != -1; block = m_link[block].lrunext)
+        if (m_index[block].leng >= newbytes)
+            return block;
+
+    return -1;
+}
+
+void cache1d::lruRemove(int32_t const block)
+{
+    auto &link = m_link[block];
+
+    if (link.lruprev != -1)
+        m_link[link.lruprev].lrunext = link.lrunext;
+    else
+        m_lruHead = link.lrunext;
+
+    if (link.lrunext != -1)
+        m_link[link.lrunext].lruprev = link.lruprev;
+    else
+        m_lruTail = link.lruprev;
+
+    link.lruprev = link.lrunext = -1;
+}
+
+void cache1d::lruPushFront(int32_t const block)
+{
+    auto &link = m_link[block];
+
+    link.lruprev = -1;
+    link.lrunext = m_lruHead;
+
+    if (m_lruHead != -1)
+        m_link[m_lruHead].lruprev = block;
+    else
+        m_lruTail = block;
+
+    m_lruHead = block;
 }
 
-int32_t cache1d::findBlock(int32_t const newbytes, int32_t * const besto, int32_t * const bestz)
+// Returns the block to the free lists, merged with any free neighbours; the result is the
+// descriptor of the merged block.
+int32_t cache1d::releaseBlock(int32_t block)
 {
-    int32_t bestval = INT32_MAX;
+    auto &stats = m_stats[m_link[block].category];
+
+    stats.numblocks--;
+    stats.bytes -= m_index[block].leng;
+
+    lruRemove(block);
+
+    m_index[block].lock = &zerochar;
+    m_index[block].hand = nullptr;
+    m_index[block].ovh  = 0;
+
+    int32_t const next = m_link[block].next;
+
+    if (next != -1 && m_link[next].isfree)
+    {
+        removeFree(next);
+
+        m_index[block].leng += m_index[next].leng;
+        m_link[block].next = m_link[next].next;
+
+        if (m_link[block].next != -1)
+            m_link[m_link[block].next].prev = block;
+
+        freeDescriptor(next);
+    }
+
+    int32_t const prev = m_link[block].prev;
 
-    for (native_t z=m_numBlocks-1, o1=m_totalSize; z>=0; z--)
+    if (prev != -1 && m_link[prev].isfree)
     {
-        o1 -= m_index[z].leng;
+        removeFree(prev);
 
-        int32_t const o2 = o1 + newbytes;
+        m_index[prev].leng += m_index[block].leng;
+        m_link[prev].next = m_link[block].next;
 
-        if (o2 > m_totalSize)
+        if (m_link[prev].next != -1)
+            m_link[m_link[prev].next].prev = prev;
+
+        freeDescriptor(block);
+        block = prev;
+    }
+
+    insertFree(block);
+
+    return block;
+}
+
+int32_t cache1d::evictBlock(int32_t const block)
+{
+    if (*m_index[block].lock)
+        *m_index[block].hand = 0;
+
+    m_stats[m_link[block].category].evictions++;
+
+    return releaseBlock(block);
+}
+
+// Evicts from the least recently used end until a large enough hole opens up. Blocks whose lock
+// went up since they were last looked at get a second chance at the other end of the list.
+int32_t cache1d::evictLeastRecent(int32_t const newbytes)
+{
+    int32_t evicted = 0;
+    int     steps   = 0;
+
+    for (auto const &stats : m_stats)
+        steps += stats.numblocks;
+
+    // past this the holes evicted so far are too scattered, let evictWindow() pick a range instead
+    int32_t const maxEvicted = newbytes * 2 + (m_totalSize >> 4);
+
+    for (int32_t block = m_lruTail, prev; block != -1 && steps-- > 0 && evicted < maxEvicted; block = prev)
+    {
+        prev = m_link[block].lruprev;
+
+        uint8_t const lock = *m_index[block].lock;
+
+        if (lock >= CACHE1D_LOCKED)
+            continue;
+
+        if (lock > m_link[block].lastlock)
+        {
+            m_link[block].lastlock = lock;
+            lruRemove(block);
+            lruPushFront(block);
             continue;
+        }
+
+        evicted += m_index[block].leng;
+
+        int32_t const merged = evictBlock(block);
+
+        if (m_index[merged].leng >= newbytes)
+            return merged;
+    }
+
+    return -1;
+}
+
+// The original cache1d strategy: find the run of neighbouring blocks large enough for the request
+// whose eviction costs the least, preferring large blocks with low lock values.
+int32_t cache1d::evictWindow(int32_t const newbytes)
+{
+    int32_t bestval   = INT32_MAX;
+    int32_t bestblock = -1;
+
+    for (int32_t start = 0; start != -1; start = m_link[start].next)
+    {
+        int32_t const o1 = m_link[start].offset;
+
+        if (o1 + newbytes > m_totalSize)
+            break;
 
         int32_t daval = 0;
 
-        for (native_t i=o1, zz=z; i<o2; i+=m_index[zz++].leng)
+        for (int32_t block = start, o = o1; o < o1 + newbytes; o += m_index[block].leng, block = m_link[block].next)
         {
-            if (*m_index[zz].lock == 0)
+            uint8_t const lock = *m_index[block].lock;
+
+            if (lock == 0)
                 continue;
-            else if (*m_index[zz].lock >= CACHE1D_LOCKED)
+            else if (lock >= CACHE1D_LOCKED)
             {
                 daval = INT32_MAX;
                 break;
@@ -147,7 +471,7 @@ int32_t cache1d::findBlock(int32_t const newbytes, int32_t * const besto, int32_
             // Potential for eviction increases with
             //  - smaller item size
             //  - smaller lock byte value (but in [1 .. 199])
-            daval += mulscale32(m_index[zz].leng + 65536, lockrecip[*m_index[zz].lock]);
+            daval += mulscale32(m_index[block].leng + 65536, lockrecip[lock]);
 
             if (daval >= bestval)
                 break;
@@ -155,48 +479,41 @@ int32_t cache1d::findBlock(int32_t const newbytes, int32_t * const besto, int32_
 
         if (daval < bestval)
         {
-            bestval = daval;
-            *besto  = o1;
-            *bestz  = z;
+            bestval   = daval;
+            bestblock = start;
 
             if (bestval == 0)
                 break;
         }
     }
 
-    return bestval;
-}
-
-void cache1d::tryHarder(int32_t const newbytes, int32_t *const besto, int32_t *const bestz)
-{
-    buildprint("WARNING: request for ", newbytes >> 10, " KB block exhausted cache!\nAttempting to make it fit...\n");
-
-    if (m_minBlockSize > MINCACHEBLOCKSIZE)
-        m_minBlockSize >>= 1;
+    if (bestblock == -1)
+        return -1;
 
-    int cnt = m_numBlocks - 1;
+    int32_t const o1 = m_link[bestblock].offset;
 
-    while (findBlock(newbytes, besto, bestz) == INT32_MAX)
+    for (int32_t block = bestblock;; block = m_link[block].next)
     {
-        ageBlocks();
-        if (EDUKE32_PREDICT_FALSE(!cnt--))
-        {
-            report();
-            fatal_exit("CACHE SPACE ALL LOCKED UP!");
-        }
+        if (!m_link[block].isfree)
+            block = evictBlock(block);
+
+        if (m_link[block].offset + m_index[block].leng >= o1 + newbytes)
+            return block;
     }
 }
 
-void cache1d::allocateBlock(intptr_t* newhandle, int32_t newbytes, char* newlockptr)
+void cache1d::allocateBlock(intptr_t* newhandle, int32_t newbytes, char* newlockptr, cachecategory_t category /*= CACHE1D_CAT_OTHER*/)
 {
+    std::lock_guard<std::mutex> lock(cachemutex);
+
     // Make all requests a multiple of the minimum block size
     int const askedbytes = newbytes;
-    newbytes = (newbytes + m_minBlockSize-1) & ~(m_minBlockSize-1);
+    newbytes = (max(newbytes, 1) + m_minBlockSize-1) & ~(m_minBlockSize-1);
 
 #ifdef DEBUGGINGAIDS
     if (EDUKE32_PREDICT_FALSE(!newlockptr || *newlockptr == 0))
     {
-        report();
+        reportLocked(true);
         fatal_exit("ALLOCACHE CALLED WITH LOCK OF 0!");
     }
 #endif
@@ -205,152 +522,194 @@ void cache1d::allocateBlock(intptr_t* newhandle, int32_t newbytes, char* newlock
     {
         buildprint("Cache size: ", m_totalSize, "\n");
         buildprint("*Newhandle: 0x", hex((intptr_t)newhandle),", Newbytes: ", newbytes, ", *Newlock: ", *newlockptr, "\n");
-        report();
+        reportLocked(true);
         fatal_exit("BUFFER TOO BIG TO FIT IN CACHE!");
     }
 
-    int32_t bestz = 0;
-    int32_t besto = 0;
+    int32_t block = findFree(newbytes);
 
-    // if we can't find a block, try to age the cache until we can
-    // it's better than the alternative of aborting the entire program
-    
-    if (findBlock(newbytes, &besto, &bestz) == INT32_MAX)
-        tryHarder(newbytes, &besto, &bestz);
+    if (block == -1)
+        block = evictLeastRecent(newbytes);
 
-    //printf("%d %d %d\n",besto,newbytes,*newlockptr);
+    if (block == -1)
+    {
+        buildprint("WARNING: request for ", newbytes >> 10, " KB block exhausted cache!\nAttempting to make it fit...\n");
 
-    //Suck things out
-    int32_t sucklen = -newbytes;
-    int32_t suckz = bestz;
+        if (EDUKE32_PREDICT_FALSE((block = evictWindow(newbytes)) == -1))
+        {
+            reportLocked(true);
+            fatal_exit("CACHE SPACE ALL LOCKED UP!");
+        }
+    }
 
-    for (;sucklen<0; sucklen+=m_index[suckz++].leng)
-        if (*m_index[suckz].lock)
-            *m_index[suckz].hand = 0;
+    removeFree(block);
 
-    //Remove all blocks except 1
-    suckz -= bestz+1;
-    m_numBlocks -= suckz;
+    int32_t const remaining = m_index[block].leng - newbytes;
 
-    auto &found = m_index[bestz];
+    if (remaining > 0)
+    {
+        int32_t const rest = newDescriptor();
 
-    Bmemmove(&found, &m_index[bestz + suckz], (m_numBlocks - bestz) * sizeof(cacheindex_t));
+        m_index[rest].leng   = remaining;
+        m_link[rest].offset  = m_link[block].offset + newbytes;
+        m_link[rest].prev    = block;
+        m_link[rest].next    = m_link[block].next;
+
+        if (m_link[rest].next != -1)
+            m_link[m_link[rest].next].prev = rest;
+
+        m_link[block].next = rest;
+
+        insertFree(rest);
+    }
+
+    auto &found = m_index[block];
 
     found.hand  = newhandle;
     found.leng  = newbytes;
     found.lock  = newlockptr;
     found.ovh   = newbytes-askedbytes;
 
-    *newhandle = m_baseAddress + besto;
-
-    //Add new empty block if necessary
-    if (sucklen <= 0)
-        return;
-
-    if (++bestz == m_numBlocks)
-    {
-        inc_and_check_cacnum();
-        m_index[bestz].leng = sucklen;
-        m_index[bestz].lock = &zerochar;
-        return;
-    }
-
-    auto &rem = m_index[bestz];
+    m_link[block].category = category;
+    m_link[block].lastlock = *newlockptr;
 
-    if (*rem.lock == 0)
-    {
-        rem.leng += sucklen;
-        return;
-    }
+    lruPushFront(block);
 
-    inc_and_check_cacnum();
+    auto &stats = m_stats[category];
 
-    for (native_t z=m_numBlocks-1; z>bestz; z--)
-        m_index[z] = m_index[z-1];
+    stats.misses++;
+    stats.numblocks++;
+    stats.bytes += newbytes;
 
-    rem.leng = sucklen;
-    rem.lock = &zerochar;
+    *newhandle = m_baseAddress + m_link[block].offset;
 }
 
 void cache1d::ageBlocks(void)
 {
-    static int agecount;
+    std::lock_guard<std::mutex> lock(cachemutex);
 
-    if (agecount >= m_numBlocks)
-        agecount = m_numBlocks-1;
+    if (m_numBlocks == 0)
+        return;
 
-    int cnt = min(m_maxBlocks >> 4, m_numBlocks-1);
+    int cnt = min(m_maxBlocks >> 4, m_numBlocks);
 
-    while(cnt--)
+    // Permanent blocks don't count towards the blocks aged per call; stop after one lap regardless.
+    for (int visited = 0; cnt > 0 && visited < m_numBlocks; visited++)
     {
-        // If we have pointer to lock char and it's in [2 .. 199], decrease.
-        if (m_index[agecount].lock)
+        if (--m_ageCursor < 0)
+            m_ageCursor = m_numBlocks-1;
+
+        auto &link = m_link[m_ageCursor];
+
+        if (link.isfree)
+        {
+            cnt--;
+            continue;
+        }
+
+        char &lock = *m_index[m_ageCursor].lock;
+
+        if ((uint8_t)lock == CACHE1D_PERMANENT)
+            continue;
+
+        cnt--;
+
+        // Raised since the last visit, so it has been used: move to the recently used end.
+        if ((uint8_t)lock > link.lastlock)
         {
-             if ((((*m_index[agecount].lock)-2)&255) < CACHE1D_UNLOCKED-1)
-                (*m_index[agecount].lock)--;
-             else if (*m_index[agecount].lock == CACHE1D_PERMANENT)
-                 cnt++;
+            lruRemove(m_ageCursor);
+            lruPushFront(m_ageCursor);
         }
 
-        if (--agecount < 0)
-            agecount = m_numBlocks-1;
+        // If we have pointer to lock char and it's in [2 .. 199], decrease.
+        if ((((uint8_t)lock-2)&255) < CACHE1D_UNLOCKED-1)
+            lock--;
+
+        link.lastlock = lock;
     }
 }
 
-void cache1d::report(void)
+void cache1d::report(bool listblocks /*= true*/)
+{
+    std::lock_guard<std::mutex> lock(cachemutex);
+
+    reportLocked(listblocks);
+}
+
+void cache1d::reportLocked(bool listblocks)
 {
     int32_t usedSize = 0;
+    int32_t lockedSize = 0;
+    int32_t largestFree = 0;
     int32_t unusable = 0;
+    int32_t usedBlocks = 0;
     inthashtable_t h_blocktotile = { nullptr, INTHASH_SIZE(m_maxBlocks) };
 
-    inthash_init(&h_blocktotile);
+    if (listblocks)
+    {
+        inthash_init(&h_blocktotile);
 
-    for (native_t j = 0; j < MAXTILES-1; j++)
-        if (waloff[j])
-            inthash_add(&h_blocktotile, waloff[j], j, true);
+        for (native_t j = 0; j < MAXTILES-1; j++)
+            if (waloff[j])
+                inthash_add(&h_blocktotile, waloff[j], j, true);
+    }
 
-    for (native_t i = 0; i < m_numBlocks-1; i++)
+    for (int32_t i = 0; i != -1; i = m_link[i].next)
     {
-        buildprint("CAC:", i, " ");
+        auto const &index = m_index[i];
 
-        if (m_index[i].hand)
-            buildprint("OFS:0x", hex((int32_t)(*m_index[i].hand - m_baseAddress)), " ");
-        else
+        if (m_link[i].isfree)
         {
-            buildprint("FREE\n");
+            largestFree = max(largestFree, index.leng);
+
+            if (listblocks)
+                buildprint("CAC:", i, " OFS:0x", hex(m_link[i].offset), " SIZ:", index.leng, " FREE\n");
+
             continue;
         }
 
-        buildprint("SIZ:", m_index[i].leng, " ");
+        uint8_t const lock = *index.lock;
 
-        if (m_index[i].lock)
-        {
-            buildprint("LCK:", *m_index[i].lock, " ");
+        usedBlocks++;
+        usedSize += index.leng;
+        unusable += index.ovh;
 
-            if (*m_index[i].lock)
-                usedSize += m_index[i].leng;
-        }
-        else
-            buildprint("LCK: NULL ");
+        if (lock >= CACHE1D_LOCKED)
+            lockedSize += index.leng;
+
+        if (!listblocks)
+            continue;
+
+        buildprint("CAC:", i, " OFS:0x", hex(m_link[i].offset), " SIZ:", index.leng, " LCK:", lock, " ");
 
-        int const tile = inthash_find(&h_blocktotile, *m_index[i].hand);
+        int const tile = inthash_find(&h_blocktotile, m_baseAddress + m_link[i].offset);
 
         if (tile != -1)
             buildprint("PIC:", tile, " ");
 
-        unusable += m_index[i].ovh;
-        buildprint("OVH:", m_index[i].ovh, "\n");
+        buildprint(cachecategorynames[m_link[i].category], " OVH:", index.ovh, "\n");
     }
-    
+
+    if (listblocks)
+        inthash_free(&h_blocktotile);
+
     buildprint("Cache size:  ", m_totalSize >> 10, " KB\n"
-               "Used:        ", usedSize >> 10, " KB\n"
-               "Remaining:   ", (m_totalSize - usedSize) >> 10, " KB\n"
-               "Block count: ", m_numBlocks, "/", m_maxBlocks, "\n");
+               "Used:        ", usedSize >> 10, " KB (", lockedSize >> 10, " KB locked)\n"
+               "Remaining:   ", (m_totalSize - usedSize) >> 10, " KB (largest block ", largestFree >> 10, " KB)\n"
+               "Block count: ", usedBlocks, " used, ", m_numBlocks, "/", m_maxBlocks, " descriptors\n");
+
+    initprintf("%d KB (%.2f%%) space made unusable by %d byte block alignment.\n", unusable >> 10, (float)unusable / m_totalSize * 100.f,
+               m_minBlockSize);
 
-    initprintf("%d KB (%.2f%%) space made unusable by %d KB block alignment.\n", unusable >> 10, (float)unusable / m_totalSize * 100.f,
-               m_minBlockSize >> 10);
+    initprintf("%-8s %10s %10s %10s %8s %10s\n", "", "draws", "misses", "evictions", "blocks", "KB");
 
-    inthash_free(&h_blocktotile);
+    for (int i = 0; i < CACHE1D_NUMCATEGORIES; i++)
+    {
+        auto const &stats = m_stats[i];
+
+        initprintf("%-8s %10u %10u %10u %8d %10d\n", cachecategorynames[i], stats.draws, stats.misses,
+                   stats.evictions, stats.numblocks, stats.bytes >> 10);
+    }
 }
 #else
 void cache1d::initBuffer(intptr_t dacachestart, uint32_t dacachesize, uint32_t minsize /*= 0*/)
@@ -360,13 +719,14 @@ void cache1d::initBuffer(intptr_t dacachestart, uint32_t dacachesize, uint32_t m
     UNREFERENCED_PARAMETER(minsize);
 }
 
-void cache1d::allocateBlock(intptr_t *newhandle, int32_t newbytes, char *newlockptr)
+void cache1d::allocateBlock(intptr_t *newhandle, int32_t newbytes, char *newlockptr, cachecategory_t category /*= CACHE1D_CAT_OTHER*/)
 {
     UNREFERENCED_PARAMETER(newlockptr);
+    UNREFERENCED_PARAMETER(category);
     *newhandle = (intptr_t)Xmalloc(newbytes);
 }
 
 void cache1d::ageBlocks(void) {}
-void cache1d::report(void) {}
+void cache1d::report(bool listblocks /*= true*/) { UNREFERENCED_PARAMETER(listblocks); }
 void cache1d::reset(void) {}
 #endif
@@ -537,6 +537,11 @@ int clipshape_idx_for_sprite(uspriteptr_t const curspr, int curidx)
 
      return curidx;
 }
+
+int clipshape_haspicnum(int const picnum)
+{
+    return pictoidx[picnum] >= 0;
+}
 #else
 int32_t clipshape_idx_for_sprite(uspriteptr_t const curspr, int32_t curidx)
 {
@@ -544,6 +549,12 @@ int32_t clipshape_idx_for_sprite(uspriteptr_t const curspr, int32_t curidx)
     UNREFERENCED_PARAMETER(curidx);
     return -1;
 }
+
+int clipshape_haspicnum(int const picnum)
+{
+    UNREFERENCED_PARAMETER(picnum);
+    return 0;
+}
 #endif  // HAVE_CLIPSHAPE_FEATURE
 ////// //////
 
@@ -600,6 +611,17 @@ int clipinsidebox(vec2_t const vect, int const wallnum, int const walldist)
 
 static int32_t clipmove_warned;
 
+// walk the sprites of sectnum that spritegridQuery() returned, or all of them if it returned -1
+static FORCE_INLINE int clipsprite_first(int const sectnum, int16_t const *const list, int const num)
+{
+    return num < 0 ? headspritesect[sectnum] : (num > 0 ? list[0] : -1);
+}
+
+static FORCE_INLINE int clipsprite_next(int const spritenum, int16_t const *const list, int const num, int *const idx)
+{
+    return num < 0 ? nextspritesect[spritenum] : (++*idx < num ? list[*idx] : -1);
+}
+
 static inline void addclipsect(int const sectnum)
 {
     if (clipsectnum < MAXCLIPSECTORS)
@@ -1348,7 +1370,11 @@ int32_t clipmove(vec3_t * const pos, int16_t * const sectnum, int32_t xvect, int
         if (curspr)
             continue;  // next sector of this index
 #endif
-        for (native_t j=headspritesect[dasect]; j>=0; j=nextspritesect[j])
+        int16_t const *sprlist;
+        int const sprnum = spritegridQuery(dasect, cent.x, cent.y, rad, &sprlist);
+        int sprcnt = 0;
+
+        for (native_t j=clipsprite_first(dasect, sprlist, sprnum); j>=0; j=clipsprite_next(j, sprlist, sprnum, &sprcnt))
         {
             auto const spr = (uspriteptr_t)&sprite[j];
             const int32_t cstat = spr->cstat;
@@ -2084,7 +2110,12 @@ restart_grand:
     if (dasprclipmask)
     for (bssize_t i=0; i<clipsectnum; i++)
     {
-        for (bssize_t j=headspritesect[clipsectorlist[i]]; j>=0; j=nextspritesect[j])
+        // facing sprites farther away than walldist plus the largest clipdist can't be stood on
+        int16_t const *sprlist;
+        int const sprnum = spritegridQuery(clipsectorlist[i], pos->x, pos->y, walldist+(255<<2)+1, &sprlist);
+        int sprcnt = 0;
+
+        for (bssize_t j=clipsprite_first(clipsectorlist[i], sprlist, sprnum); j>=0; j=clipsprite_next(j, sprlist, sprnum, &sprcnt))
         {
             const int32_t cstat = sprite[j].cstat;
             int32_t daz, daz2;
@@ -2699,7 +2730,7 @@ restart_grand:
                     {
                         tileUpdatePicnum(&tilenum, 0);
 
-                        if (!waloff[tilenum])
+                        if (!waloff[tilenum] || tileIsLoading(tilenum))
                             tileLoad(tilenum);
 
                         if (waloff[tilenum])
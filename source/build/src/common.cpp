@@ -7,9 +7,13 @@
 #include "baselayer.h"
 
 #include "common.h"
+#include "crc32.h"
+#include "threadpool.h"
 
 #include "vfs.h"
 
+#include <chrono>
+
 void PrintBuildInfo(void)
 {
     buildprint(
@@ -566,3 +570,113 @@ void Paths_ParseXDGDesktopFilesFromGOG(const char * homepath, const char * game,
         Paths_ParseXDGDesktopFile(buf, func);
     }
 }
+
+static struct
+{
+    char const *name;
+    double      ms;
+} startupPhases[16];
+
+static int32_t startupNumPhases;
+static double  startupPhaseStart;
+
+// the first phases run before timerInit(), after which sys_timer may switch the engine timer to
+// another counter, so this keeps to a clock of its own
+static double startupGetTime(void)
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void G_StartupPhase(char const *name)
+{
+    double const now = startupGetTime();
+
+    if (name && startupNumPhases < ARRAY_SSIZE(startupPhases))
+    {
+        startupPhases[startupNumPhases].name = name;
+        startupPhases[startupNumPhases].ms   = now - startupPhaseStart;
+        startupNumPhases++;
+    }
+
+    startupPhaseStart = now;
+}
+
+void G_PrintStartupTimes(void)
+{
+    if (!startupNumPhases)
+        return;
+
+    double total = 0.0;
+
+    initprintf("Startup:");
+
+    for (int i = 0; i < startupNumPhases; i++)
+    {
+        initprintf("%s %s %.1f ms", i ? "," : "", startupPhases[i].name, startupPhases[i].ms);
+        total += startupPhases[i].ms;
+    }
+
+    initprintf(" (%.1f ms total)\n", total);
+
+    startupNumPhases = 0;
+}
+
+typedef struct
+{
+    char const * const *paths;
+    uint32_t *crcs;
+    uint8_t *failed;
+} crcfilesjob_t;
+
+static int32_t G_CrcFile(char const *path, uint32_t *crc)
+{
+    static constexpr int ReadSize = 65536;
+
+    int32_t const fh = Bopen(path, BO_RDONLY|BO_BINARY, BS_IREAD);
+
+    if (fh < 0)
+        return -1;
+
+    auto buf = (uint8_t *)Xmalloc(ReadSize);
+    uint32_t crcval = 0;
+    int32_t b;
+
+    do
+    {
+        b = Bread(fh, buf, ReadSize);
+        if (b > 0) crcval = Bcrc32(buf, b, crcval);
+    }
+    while (b == ReadSize);
+
+    Xfree(buf);
+    Bclose(fh);
+
+    *crc = crcval;
+
+    return 0;
+}
+
+static void G_CrcFileJob(int32_t index, void *userdata)
+{
+    auto job = (crcfilesjob_t *)userdata;
+
+    job->failed[index] = G_CrcFile(job->paths[index], &job->crcs[index]) != 0;
+}
+
+void G_CrcFiles(int32_t numfiles, char const * const *paths, uint32_t *crcs, uint8_t *failed)
+{
+    crcfilesjob_t job = { paths, crcs, failed };
+
+    // each file is one job: the big retail groups dominate, but hashing them side by side
+    // instead of one after the other is what most of the time goes into on a first start
+    threadpoolParallelFor(numfiles, G_CrcFileJob, &job);
+
+    // a job only holds its own file open, but whatever else the process has open at the same
+    // time still counts against the descriptor limit, so give failed files one more go alone
+    for (native_t i = 0; i < numfiles; i++)
+    {
+        if (failed[i])
+            failed[i] = G_CrcFile(paths[i], &crcs[i]) != 0;
+    }
+}
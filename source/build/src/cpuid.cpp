@@ -9,10 +9,24 @@ cpuinfo_t cpu;
 
 #ifdef _WIN32
 # include <intrin.h>
+# include <immintrin.h>
 #else
 # include <cpuid.h>
 #endif
 
+// XCR0 bits 1 and 2: the OS preserves the XMM and YMM register state across context switches
+static int sysOSSupportsAVX(void)
+{
+#ifdef _WIN32
+    return (_xgetbv(0) & 6) == 6;
+#else
+    uint32_t eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    UNREFERENCED_PARAMETER(edx);
+    return (eax & 6) == 6;
+#endif
+}
+
 static char g_cpuVendorIDString[16];
 static char g_cpuBrandString[64];
 
@@ -26,6 +40,8 @@ void sysReadCPUID()
     __cpuid(0, regs[0], regs[1], regs[2], regs[3]);
 #endif
 
+    auto const maxleaf = (unsigned)regs[0];
+
     // CPUID returns things out of order...
     Bmemcpy(g_cpuVendorIDString,   regs+1, 4);
     Bmemcpy(g_cpuVendorIDString+8, regs+2, 4);
@@ -44,6 +60,29 @@ void sysReadCPUID()
     else
         cpu.type = CPU_UNKNOWN;
 
+    if (maxleaf >= 1)
+    {
+#ifdef _WIN32
+        __cpuid(regs, 1);
+#else
+        __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        cpu.features.sse2 = (regs[3] & (1 << 26)) != 0;
+
+        // AVX needs both OSXSAVE and AVX before XGETBV may be used to check for OS support
+        int const avx = (regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && sysOSSupportsAVX();
+
+        if (avx && maxleaf >= 7)
+        {
+#ifdef _WIN32
+            __cpuidex(regs, 7, 0);
+#else
+            __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+            cpu.features.avx2 = (regs[1] & (1 << 5)) != 0;
+        }
+    }
+
 #ifdef _WIN32
     __cpuid(regs, 0x80000000);
 #else
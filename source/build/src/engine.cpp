@@ -24,7 +24,9 @@
 #include "palette.h"
 #include "pragmas.h"
 #include "scriptfile.h"
+#include "sectorindex.h"
 #include "softsurface.h"
+#include "threadpool.h"
 #include "vfs.h"
 
 #ifdef USE_OPENGL
@@ -52,6 +54,12 @@
 #endif
 
 #define MULTI_COLUMN_VLINE
+
+#ifdef ENGINE_USING_A_C
+// Record wall columns and flat ceiling/floor spans into screen strips and draw
+// them on the thread pool (r_classicthreads).
+# define CLASSIC_STRIP_RENDERING
+#endif
 //#define DEBUG_TILESIZY_512
 //#define DEBUG_TILEOFFSETS
 //////////
@@ -128,6 +136,7 @@ uint32_t r_screenxy = 0;
 
 int32_t r_rotatespriteinterp = 1;
 int32_t r_fpgrouscan = 1;
+int32_t r_classicthreads = 0;
 int32_t r_displayindex = 0;
 int32_t r_borderless = 2;
 int32_t r_windowpositioning = 1;
@@ -1674,7 +1683,7 @@ static inline int findUnusedTile(void)
 //
 static void classicScanSector(int16_t startsectnum)
 {
-    if (startsectnum < 0)
+    if (startsectnum < 0 || !pvsViewCanSee(startsectnum))
         return;
 
     if (automapping)
@@ -1732,7 +1741,7 @@ static void classicScanSector(int16_t startsectnum)
             // Example: standing at exactly the intersection of a large sector
             // into four quadrant sub-sectors.
 #if 1
-            if (nextsectnum >= 0 && (wal->cstat&32) == 0 && sectorbordercnt < ARRAY_SSIZE(sectorborder))
+            if (nextsectnum >= 0 && (wal->cstat&32) == 0 && sectorbordercnt < ARRAY_SSIZE(sectorborder) && pvsViewCanSee(nextsectnum))
 #ifdef YAX_ENABLE
                 if (yax_nomaskpass==0 || !yax_isislandwall(w, !yax_globalcf) || (yax_nomaskdidit=1, 0))
 #endif
@@ -1952,7 +1961,7 @@ static void maskwallscan(int32_t x1, int32_t x2, int32_t saturatevplc)
 
     setgotpic(globalpicnum);
 
-    if (waloff[globalpicnum] == 0) tileLoad(globalpicnum);
+    if (waloff[globalpicnum] == 0) tileLoadAsync(globalpicnum, true);
 
     tweak_tsizes(&tsiz);
 
@@ -2201,6 +2210,178 @@ static inline int32_t bunchfront(int32_t b1, int32_t b2)
 }
 
 
+#ifdef CLASSIC_STRIP_RENDERING
+//
+// Strip rendering (internal)
+//
+// With r_classicthreads > 1, the drawrooms pass records wall columns and flat ceiling/floor spans
+// instead of drawing them in place. Every primitive is filed under the vertical screen strip it
+// lies in (spans are cut at strip boundaries) and classicStripsFlush() rasterizes the strips on the
+// thread pool. Since drawrooms writes each pixel at most once, the result does not depend on the
+// order in which strips are drawn. Sloped and masked ceilings/floors are still drawn in place.
+//
+#define MAXCLASSICSTRIPS 64
+
+typedef struct
+{
+    intptr_t buf, pal;
+    uint32_t vplc;
+    int32_t vinc, logy, tilesizy;
+    int32_t x, y1, y2;
+} stripvline_t;
+
+typedef struct
+{
+    intptr_t buf, pal;
+    uint32_t bx, by;
+    int32_t xinc, yinc, logx, logy;
+    int32_t xl, xr, y;
+} striphline_t;
+
+typedef struct
+{
+    stripvline_t *vline;
+    striphline_t *hline;
+    int32_t numvlines, maxvlines;
+    int32_t numhlines, maxhlines;
+    int32_t x1;  // leftmost column
+} classicstrip_t;
+
+static classicstrip_t classicstrip[MAXCLASSICSTRIPS];
+static int32_t classicnumstrips;  // 0: draw in place
+
+static FORCE_INLINE int32_t classicStripOfColumn(int32_t x)
+{
+    return min(x*classicnumstrips/xdimen, classicnumstrips-1);
+}
+
+static void classicStripsBegin(void)
+{
+    classicnumstrips = min(min(r_classicthreads, MAXCLASSICSTRIPS), xdimen);
+
+    if (classicnumstrips <= 1)
+    {
+        classicnumstrips = 0;
+        return;
+    }
+
+    // ceil(i*xdimen/classicnumstrips), the first column for which classicStripOfColumn() returns i
+    for (bssize_t i=0; i<classicnumstrips; i++)
+        classicstrip[i].x1 = (i*xdimen + classicnumstrips-1)/classicnumstrips;
+}
+
+static void classicStripAddVline(int32_t x, int32_t y1, int32_t y2, intptr_t pal, intptr_t buf, uint32_t vplc, int32_t vinc)
+{
+    auto &strip = classicstrip[classicStripOfColumn(x)];
+
+    if (strip.numvlines == strip.maxvlines)
+    {
+        strip.maxvlines = max(strip.maxvlines<<1, 1024);
+        strip.vline = (stripvline_t *)Xrealloc(strip.vline, strip.maxvlines*sizeof(stripvline_t));
+    }
+
+    strip.vline[strip.numvlines++] = { buf, pal, vplc, vinc, globalshiftval, globaltilesizy, x, y1, y2 };
+}
+
+// Same arguments as hlineasm4(): the span is drawn from xr leftwards, stepping bx and by back by
+// xinc and yinc per pixel.
+static void classicStripAddHline(int32_t xl, int32_t xr, int32_t y, intptr_t pal, uint32_t bx, uint32_t by, int32_t xinc, int32_t yinc)
+{
+    int32_t const logx = picsiz[globalpicnum]&15, logy = picsiz[globalpicnum]>>4;
+
+    for (bssize_t s=classicStripOfColumn(xr); ; s--)
+    {
+        auto &strip = classicstrip[s];
+        int32_t const sxl = max(xl, strip.x1);
+
+        if (strip.numhlines == strip.maxhlines)
+        {
+            strip.maxhlines = max(strip.maxhlines<<1, 1024);
+            strip.hline = (striphline_t *)Xrealloc(strip.hline, strip.maxhlines*sizeof(striphline_t));
+        }
+
+        strip.hline[strip.numhlines++] = { globalbufplc, pal, bx, by, xinc, yinc, logx, logy, sxl, xr, y };
+
+        if (sxl == xl)
+            break;
+
+        uint32_t const cnt = xr-sxl+1;
+        bx -= cnt*(uint32_t)xinc;
+        by -= cnt*(uint32_t)yinc;
+        xr = sxl-1;
+    }
+}
+
+static inline uint32_t stripmulscale32(uint32_t a, uint32_t b)
+{
+    return ((uint64_t)a*b)>>32;
+}
+
+// Mirrors vlineasm1()/vlineasm4() and hlineasm4() from a-c.cpp.
+static void classicDrawStrip(int32_t const stripnum, void *)
+{
+    auto const &strip = classicstrip[stripnum];
+    int32_t const bpl = ylookup[1];
+
+    for (bssize_t i=0; i<strip.numvlines; i++)
+    {
+        auto const &v = strip.vline[i];
+        const char *const A_C_RESTRICT buf = (const char *)v.buf;
+        const char *const A_C_RESTRICT pal = (const char *)v.pal;
+        char *p = (char *)(ylookup[v.y1]+v.x+frameoffset);
+        uint32_t vplc = v.vplc;
+        int32_t cnt = v.y2-v.y1+1;
+
+        if (v.logy)
+        {
+            for (; cnt>0; cnt--, p+=bpl, vplc+=v.vinc)
+                *p = pal[buf[vplc>>v.logy]];
+        }
+        else
+        {
+            for (; cnt>0; cnt--, p+=bpl, vplc+=v.vinc)
+                *p = pal[buf[stripmulscale32(vplc, v.tilesizy)]];
+        }
+    }
+
+    for (bssize_t i=0; i<strip.numhlines; i++)
+    {
+        auto const &h = strip.hline[i];
+        hlinespan((char *)(ylookup[h.y]+h.xr+frameoffset), h.xr-h.xl, (const char *)h.pal, (const char *)h.buf,
+                  h.bx, h.by, h.xinc, h.yinc, h.logx, h.logy);
+    }
+}
+
+static void classicStripsFlush(void)
+{
+    if (!classicnumstrips)
+        return;
+
+    threadpoolParallelFor(classicnumstrips, classicDrawStrip, nullptr);
+
+    for (bssize_t i=0; i<classicnumstrips; i++)
+        classicstrip[i].numvlines = classicstrip[i].numhlines = 0;
+}
+
+static void classicStripsEnd(void)
+{
+    classicStripsFlush();
+    classicnumstrips = 0;
+}
+#else
+# define classicStripsBegin()
+# define classicStripsFlush()
+# define classicStripsEnd()
+#endif
+
+// Loading a tile can evict others from the cache, including ones referenced by recorded but not
+// yet drawn strip primitives.
+static inline void classicTileLoad(int16_t tilenume)
+{
+    classicStripsFlush();
+    tileLoadAsync(tilenume);
+}
+
 //
 // hline (internal)
 //
@@ -2213,6 +2394,15 @@ static inline void hline(int32_t xr, int32_t yp)
     asm2 = (inthi_t)mulscale6(globaly2, r);
     int32_t const s = getpalookupsh(mulscale22(r,globvis));
 
+#ifdef CLASSIC_STRIP_RENDERING
+    if (classicnumstrips)
+    {
+        classicStripAddHline(xl, xr, yp, (intptr_t)globalpalwritten+s,
+                             (uint32_t)mulscale6(globaly1,r)+globalxpanning, (uint32_t)mulscale6(globalx2,r)+globalypanning, asm1, asm2);
+        return;
+    }
+#endif
+
     hlineasm4(xr-xl,0,s,(uint32_t)mulscale6(globalx2,r)+globalypanning,(uint32_t)mulscale6(globaly1,r)+globalxpanning,
               ylookup[yp]+xr+frameoffset);
 }
@@ -2670,7 +2860,7 @@ static int32_t setup_globals_cf1(usectorptr_t sec, int32_t pal, int32_t zd,
     tileUpdatePicnum(&globalpicnum, 0);
     setgotpic(globalpicnum);
     if ((tilesiz[globalpicnum].x <= 0) || (tilesiz[globalpicnum].y <= 0)) return 1;
-    if (waloff[globalpicnum] == 0) tileLoad(globalpicnum);
+    if (waloff[globalpicnum] == 0) classicTileLoad(globalpicnum);
 
     globalbufplc = waloff[globalpicnum];
 
@@ -2944,6 +3134,87 @@ static void florscan(int32_t x1, int32_t x2, int32_t sectnum)
 }
 
 
+#ifdef CLASSIC_STRIP_RENDERING
+//
+// wallscan_strips (internal)
+//
+// Records the columns wallscan() would draw. Within a group of four columns, vlineasm4() is given
+// the outer columns' palookup for the inner two when the outer ones match, so the grouping has to
+// be reproduced here for the output to be identical.
+static void wallscan_strips(int32_t x, int32_t x2,
+                            const int16_t *uwal, const int16_t *dwal,
+                            const int32_t *swal, const int32_t *lwal,
+                            vec2_16_t tsiz, intptr_t fpalookup)
+{
+    int32_t y1ve[4], y2ve[4];
+    intptr_t pal[4], buf;
+    uint32_t vplc;
+    int32_t vinc;
+
+#ifdef MULTI_COLUMN_VLINE
+    for (; (x<=x2)&&((x+frameoffset)&3); x++)
+    {
+        y1ve[0] = max(uwal[x],umost[x]);
+        y2ve[0] = min(dwal[x],dmost[x]);
+        if (y2ve[0] <= y1ve[0]) continue;
+
+        calc_bufplc(&buf, lwal[x], tsiz);
+        calc_vplcinc(&vplc, &vinc, swal, x, y1ve[0]);
+
+        classicStripAddVline(x, y1ve[0], y2ve[0]-1, fpalookup + getpalookupsh(mulscale16(swal[x],globvis)), buf, vplc, vinc);
+    }
+    for (; x<=x2-3; x+=4)
+    {
+        char bad = 0;
+
+        for (bssize_t z=3; z>=0; z--)
+        {
+            y1ve[z] = max(uwal[x+z],umost[x+z]);
+            y2ve[z] = min(dwal[x+z],dmost[x+z])-1;
+            if (y2ve[z] < y1ve[z]) bad += pow2char[z];
+        }
+        if (bad == 15) continue;
+
+        pal[0] = fpalookup + getpalookupsh(mulscale16(swal[x],globvis));
+        pal[3] = fpalookup + getpalookupsh(mulscale16(swal[x+3],globvis));
+
+        if ((pal[0] == pal[3]) && ((bad&0x9) == 0))
+        {
+            pal[1] = pal[0];
+            pal[2] = pal[0];
+        }
+        else
+        {
+            pal[1] = fpalookup + getpalookupsh(mulscale16(swal[x+1],globvis));
+            pal[2] = fpalookup + getpalookupsh(mulscale16(swal[x+2],globvis));
+        }
+
+        for (bssize_t z=0; z<4; z++)
+        {
+            if (bad & pow2char[z]) continue;
+
+            calc_bufplc(&buf, lwal[x+z], tsiz);
+            calc_vplcinc(&vplc, &vinc, swal, x+z, y1ve[z]);
+
+            classicStripAddVline(x+z, y1ve[z], y2ve[z], pal[z], buf, vplc, vinc);
+        }
+    }
+#endif
+
+    for (; x<=x2; x++)
+    {
+        y1ve[0] = max(uwal[x],umost[x]);
+        y2ve[0] = min(dwal[x],dmost[x]);
+        if (y2ve[0] <= y1ve[0]) continue;
+
+        calc_bufplc(&buf, lwal[x], tsiz);
+        calc_vplcinc(&vplc, &vinc, swal, x, y1ve[0]);
+
+        classicStripAddVline(x, y1ve[0], y2ve[0]-1, fpalookup + getpalookupsh(mulscale16(swal[x],globvis)), buf, vplc, vinc);
+    }
+}
+#endif
+
 //
 // wallscan (internal)
 //
@@ -2979,7 +3250,7 @@ static void wallscan(int32_t x1, int32_t x2,
     if ((uwal[x1] > ydimen) && (uwal[x2] > ydimen)) return;
     if ((dwal[x1] < 0) && (dwal[x2] < 0)) return;
 
-    if (waloff[globalpicnum] == 0) tileLoad(globalpicnum);
+    if (waloff[globalpicnum] == 0) classicTileLoad(globalpicnum);
 
     tweak_tsizes(&tsiz);
 
@@ -2992,6 +3263,15 @@ static void wallscan(int32_t x1, int32_t x2,
     while ((x <= x2) && (umost[x] > dmost[x]))
         x++;
 
+#ifdef CLASSIC_STRIP_RENDERING
+    if (classicnumstrips)
+    {
+        wallscan_strips(x, x2, uwal, dwal, swal, lwal, tsiz, fpalookup);
+        faketimerhandler();
+        return;
+    }
+#endif
+
 #ifdef NONPOW2_YSIZE_ASM
     if (globalshiftval==0)
         goto do_vlineasm1;
@@ -3200,7 +3480,7 @@ static void transmaskwallscan(int32_t x1, int32_t x2, int32_t saturatevplc)
     if ((tilesiz[globalpicnum].x <= 0) || (tilesiz[globalpicnum].y <= 0))
         return;
 
-    if (waloff[globalpicnum] == 0) tileLoad(globalpicnum);
+    if (waloff[globalpicnum] == 0) tileLoadAsync(globalpicnum, true);
 
     setuptvlineasm(globalshiftval, saturatevplc);
 
@@ -3505,7 +3785,7 @@ static void fgrouscan(int32_t dax1, int32_t dax2, int32_t sectnum, char dastat)
     tileUpdatePicnum(&globalpicnum, sectnum);
     setgotpic(globalpicnum);
     if ((tilesiz[globalpicnum].x <= 0) || (tilesiz[globalpicnum].y <= 0)) return;
-    if (waloff[globalpicnum] == 0) tileLoad(globalpicnum);
+    if (waloff[globalpicnum] == 0) classicTileLoad(globalpicnum);
 
     wal = (uwalltype *)&wall[sec->wallptr];
     wxi = wall[wal->point2].x - wal->x;
@@ -3829,7 +4109,7 @@ static void grouscan(int32_t dax1, int32_t dax2, int32_t sectnum, char dastat)
     tileUpdatePicnum(&globalpicnum, sectnum);
     setgotpic(globalpicnum);
     if ((tilesiz[globalpicnum].x <= 0) || (tilesiz[globalpicnum].y <= 0)) return;
-    if (waloff[globalpicnum] == 0) tileLoad(globalpicnum);
+    if (waloff[globalpicnum] == 0) classicTileLoad(globalpicnum);
 
     wal = (uwallptr_t)&wall[sec->wallptr];
     wx = wall[wal->point2].x - wal->x;
@@ -6202,7 +6482,7 @@ draw_as_face_sprite:
         globalpicnum = tilenum;
         if ((unsigned)globalpicnum >= (unsigned)MAXTILES) globalpicnum = 0;
 
-        if (waloff[globalpicnum] == 0) tileLoad(globalpicnum);
+        if (waloff[globalpicnum] == 0) tileLoadAsync(globalpicnum, true);
         setgotpic(globalpicnum);
         globalbufplc = waloff[globalpicnum];
 
@@ -8268,6 +8548,8 @@ LISTFN_STATIC void do_insertsprite_at_headofsect(int16_t spritenum, int16_t sect
     headspritesect[sectnum] = spritenum;
 
     sprite[spritenum].sectnum = sectnum;
+
+    spritegridLink(spritenum, sectnum);
 }
 
 // remove sprite 'deleteme' from its sector list
@@ -8277,6 +8559,8 @@ LISTFN_STATIC void do_deletespritesect(int16_t deleteme)
     int32_t const prev = prevspritesect[deleteme];
     int32_t const next = nextspritesect[deleteme];
 
+    spritegridUnlink(deleteme);
+
     if (headspritesect[sectnum] == deleteme)
         headspritesect[sectnum] = next;
     if (prev >= 0)
@@ -8733,9 +9017,7 @@ int32_t enginePreInit(void)
     spritesmooth = spritesmooth_s;
 #endif
 
-#if !defined ENGINE_USING_A_C
     mmxoverlay();
-#endif
 
     upscalefactor = 1;
     validmodecnt = 0;
@@ -8863,6 +9145,15 @@ void engineUnInit(void)
         ALIGNED_FREE_AND_NULL(distrecipcache[i].distrecip);
     Bmemset(distrecipcache, 0, sizeof(distrecipcache));
 
+#ifdef CLASSIC_STRIP_RENDERING
+    for (auto &strip : classicstrip)
+    {
+        DO_FREE_AND_NULL(strip.vline);
+        DO_FREE_AND_NULL(strip.hline);
+        strip.maxvlines = strip.maxhlines = 0;
+    }
+#endif
+
     paletteloaded = 0;
 
     for (bssize_t i=0; i<MAXPALOOKUPS; i++)
@@ -8899,6 +9190,10 @@ void engineUnInit(void)
 
     DO_FREE_AND_NULL(g_defNamePtr);
 
+    sectorindexFree();
+    pvsFree();
+    threadpoolUninit();
+
     uninitsystem();
 }
 
@@ -8909,6 +9204,8 @@ void engineUnInit(void)
 void (*initspritelists_replace)(void) = NULL;
 void initspritelists(void)
 {
+    spritegridFree();
+
     if (initspritelists_replace)
     {
         initspritelists_replace();
@@ -9140,6 +9437,8 @@ int32_t renderDrawRoomsQ16(int32_t daposx, int32_t daposy, int32_t daposz,
             return 0;
     }
 
+    pvsSetView(globalposx, globalposy, globalcursectnum);
+
 #ifdef USE_OPENGL
     //============================================================================= //POLYMOST BEGINS
     polymost_drawrooms();
@@ -9161,6 +9460,8 @@ int32_t renderDrawRoomsQ16(int32_t daposx, int32_t daposy, int32_t daposz,
 
     frameoffset = frameplace + windowxy1.y*bytesperline + windowxy1.x;
 
+    classicStripsBegin();
+
     numhits = xdimen; numscans = 0; numbunches = 0;
     maskwallcnt = 0; smostwallcnt = 0; smostcnt = 0; spritesortcnt = 0;
 
@@ -9220,6 +9521,7 @@ int32_t renderDrawRoomsQ16(int32_t daposx, int32_t daposy, int32_t daposz,
         if (numbunches==0)
         {
             inpreparemirror = 0;
+            classicStripsEnd();
             videoEndDrawing();  //!!!
             return 0;
         }
@@ -9308,6 +9610,7 @@ int32_t renderDrawRoomsQ16(int32_t daposx, int32_t daposy, int32_t daposz,
         bunchlast[closest] = bunchlast[numbunches];
     }
 
+    classicStripsEnd();
     videoEndDrawing();   //}}}
 
     return inpreparemirror;
@@ -10318,7 +10621,11 @@ void calc_sector_reachability(void)
     Bmemset(wallsect, -1, sizeof(wallsect));
 
     if (!numsectors)
+    {
+        sectorindexFree();
+        pvsFree();
         return;
+    }
 
     DO_FREE_AND_NULL(reachablesectors);
     reachablesectors = (uint8_t*)Xcalloc(1, getreachabilitybitmapsize());
@@ -10374,6 +10681,9 @@ void calc_sector_reachability(void)
             }
         }
     }
+
+    sectorindexBuild();
+    pvsBuild();
 }
 
 static int32_t engineFinishLoadBoard(const vec3_t* dapos, int16_t* dacursectnum, int16_t numsprites, char myflags)
@@ -11567,6 +11877,9 @@ void videoNextPage(void)
     faketimerhandler();
     g_cache.ageBlocks();
 
+    // between frames, so no tile changes under the renderer halfway through one
+    tileFinishLoads();
+
 #ifdef USE_OPENGL
     omdtims = mdtims;
     mdtims = timerGetTicks();
@@ -11602,7 +11915,7 @@ int32_t qloadkvx(int32_t voxindex, const char *filename)
 
         //Must store filenames to use cacheing system :(
         voxlock[voxindex][i] = CACHE1D_PERMANENT;
-        g_cache.allocateBlock(&voxoff[voxindex][i], dasiz, &voxlock[voxindex][i]);
+        g_cache.allocateBlock(&voxoff[voxindex][i], dasiz, &voxlock[voxindex][i], CACHE1D_CAT_VOXEL);
 
         char *ptr = (char *) voxoff[voxindex][i];
         kread(fil, ptr, dasiz);
@@ -11886,6 +12199,8 @@ int32_t setsprite(int16_t spritenum, const vec3_t *newpos)
     if ((void const *) newpos != (void *) &sprite[spritenum])
         sprite[spritenum].xyz = *newpos;
 
+    spritegridTouch(spritenum);
+
     updatesector(newpos->x,newpos->y,&tempsectnum);
 
     if (tempsectnum < 0)
@@ -11903,6 +12218,8 @@ int32_t setspritez(int16_t spritenum, const vec3_t *newpos)
     if ((void const *)newpos != (void *)&sprite[spritenum])
         sprite[spritenum].xyz = *newpos;
 
+    spritegridTouch(spritenum);
+
     updatesectorz(newpos->x,newpos->y,newpos->z,&tempsectnum);
 
     if (tempsectnum < 0)
@@ -11997,16 +12314,13 @@ int32_t cansee_19950829(int32_t xs, int32_t ys, int32_t zs, int16_t sectnums, in
     return 0;
 }
 
-int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+// sectbitmap holds (MAXSECTORS+7)>>3 bytes, sectlist is the list of sectors to visit
+static int32_t cansee_internal(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2,
+                               uint8_t *const sectbitmap, int16_t *const sectlist)
 {
-    MICROPROFILE_SCOPEI("Engine", EDUKE32_FUNCTION, MP_AUTO);
-
-    if (enginecompatibilitymode == ENGINE_19950829)
-        return cansee_19950829(x1, y1, z1, sect1, x2, y2, z2, sect2);
     int32_t dacnt, danum;
     const int32_t x21 = x2-x1, y21 = y2-y1, z21 = z2-z1;
 
-    static uint8_t sectbitmap[(MAXSECTORS+7)>>3];
 #ifdef YAX_ENABLE
     int16_t pendingsectnum;
     vec3_t pendingvec;
@@ -12027,7 +12341,7 @@ int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, in
 
     Bmemset(&pendingvec, 0, sizeof(vec3_t));  // compiler-happy
 #endif
-    Bmemset(sectbitmap, 0, sizeof(sectbitmap));
+    Bmemset(sectbitmap, 0, (MAXSECTORS+7)>>3);
 #ifdef YAX_ENABLE
 restart_grand:
 #endif
@@ -12038,11 +12352,11 @@ restart_grand:
     pendingsectnum = -1;
 #endif
     bitmap_set(sectbitmap, sect1);
-    clipsectorlist[0] = sect1; danum = 1;
+    sectlist[0] = sect1; danum = 1;
 
     for (dacnt=0; dacnt<danum; dacnt++)
     {
-        const int32_t dasectnum = clipsectorlist[dacnt];
+        const int32_t dasectnum = sectlist[dacnt];
         auto const sec = (usectorptr_t)&sector[dasectnum];
         uwallptr_t wal;
         bssize_t cnt;
@@ -12165,7 +12479,7 @@ add_nextsector:
             if (!bitmap_test(sectbitmap, nexts))
             {
                 bitmap_set(sectbitmap, nexts);
-                clipsectorlist[danum++] = nexts;
+                sectlist[danum++] = nexts;
             }
         }
 
@@ -12187,6 +12501,233 @@ add_nextsector:
     return 0;
 }
 
+int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+{
+    MICROPROFILE_SCOPEI("Engine", EDUKE32_FUNCTION, MP_AUTO);
+
+    if (enginecompatibilitymode == ENGINE_19950829)
+        return cansee_19950829(x1, y1, z1, sect1, x2, y2, z2, sect2);
+
+    static uint8_t sectbitmap[(MAXSECTORS+7)>>3];
+
+    return cansee_internal(x1, y1, z1, sect1, x2, y2, z2, sect2, sectbitmap, clipsectorlist);
+}
+
+//
+// canseeBatch
+//
+#define CANSEE_JOBSIZE 16  // queries per thread pool job
+
+static int32_t *cansee_order;  // query indices sorted by source sector
+static uint8_t *cansee_seen;
+static int32_t  cansee_allocsize;
+static canseequery_t const *cansee_sortqueries;
+
+static int cansee_cmpsource(const void *a, const void *b)
+{
+    int32_t const ia = *(int32_t const *)a, ib = *(int32_t const *)b;
+    int32_t const sa = cansee_sortqueries[ia].sect1, sb = cansee_sortqueries[ib].sect1;
+
+    return (sa != sb) ? sa - sb : ia - ib;
+}
+
+static FORCE_INLINE int cansee_samequery(canseequery_t const &a, canseequery_t const &b)
+{
+    return a.sect1 == b.sect1 && a.sect2 == b.sect2 && a.pos1.x == b.pos1.x && a.pos1.y == b.pos1.y && a.pos1.z == b.pos1.z
+           && a.pos2.x == b.pos2.x && a.pos2.y == b.pos2.y && a.pos2.z == b.pos2.z;
+}
+
+typedef struct
+{
+    canseequery_t const *queries;
+    int32_t numqueries;
+} canseebatch_t;
+
+// Queries from one source sector end up next to each other in the same job, so they walk the
+// same walls while those are still cached, and a repeated query is only traced once.
+static void cansee_batchjob(int32_t const index, void *userdata)
+{
+    auto const batch = (canseebatch_t const *)userdata;
+    int32_t const end = min(index*CANSEE_JOBSIZE + CANSEE_JOBSIZE, batch->numqueries);
+
+    uint8_t sectbitmap[(MAXSECTORS+7)>>3];
+    int16_t sectlist[MAXSECTORS];
+
+    for (bssize_t i=index*CANSEE_JOBSIZE; i<end; i++)
+    {
+        int32_t const qnum = cansee_order[i];
+        auto const &q = batch->queries[qnum];
+
+        if (i > index*CANSEE_JOBSIZE && cansee_samequery(q, batch->queries[cansee_order[i-1]]))
+        {
+            cansee_seen[qnum] = cansee_seen[cansee_order[i-1]];
+            continue;
+        }
+
+        cansee_seen[qnum] = !!cansee_internal(q.pos1.x, q.pos1.y, q.pos1.z, q.sect1, q.pos2.x, q.pos2.y, q.pos2.z, q.sect2,
+                                              sectbitmap, sectlist);
+    }
+}
+
+void canseeBatch(canseequery_t const *queries, int32_t numqueries, uint8_t *results)
+{
+    MICROPROFILE_SCOPEI("Engine", EDUKE32_FUNCTION, MP_AUTO);
+
+    Bmemset(results, 0, (numqueries+7)>>3);
+
+    if (numqueries <= 0)
+        return;
+
+    if (enginecompatibilitymode == ENGINE_19950829)
+    {
+        for (bssize_t i=0; i<numqueries; i++)
+        {
+            auto const &q = queries[i];
+
+            if (cansee_19950829(q.pos1.x, q.pos1.y, q.pos1.z, q.sect1, q.pos2.x, q.pos2.y, q.pos2.z, q.sect2))
+                bitmap_set(results, i);
+        }
+
+        return;
+    }
+
+    if (cansee_allocsize < numqueries)
+    {
+        cansee_allocsize = numqueries;
+        cansee_order = (int32_t *)Xrealloc(cansee_order, cansee_allocsize*sizeof(int32_t));
+        cansee_seen  = (uint8_t *)Xrealloc(cansee_seen, cansee_allocsize*sizeof(uint8_t));
+    }
+
+    for (bssize_t i=0; i<numqueries; i++)
+        cansee_order[i] = i;
+
+    cansee_sortqueries = queries;
+    qsort(cansee_order, numqueries, sizeof(int32_t), &cansee_cmpsource);
+
+    canseebatch_t batch = { queries, numqueries };
+    int32_t const numjobs = (numqueries + CANSEE_JOBSIZE - 1) / CANSEE_JOBSIZE;
+
+    // yax_getneighborsect() caches what it finds in yax_updown[], so TROR maps stay on this thread
+#ifdef YAX_ENABLE
+    if (numyaxbunches > 0 || numjobs < 2)
+#else
+    if (numjobs < 2)
+#endif
+    {
+        for (bssize_t i=0; i<numjobs; i++)
+            cansee_batchjob(i, &batch);
+    }
+    else
+        threadpoolParallelFor(numjobs, cansee_batchjob, &batch);
+
+    for (bssize_t i=0; i<numqueries; i++)
+        if (cansee_seen[i])
+            bitmap_set(results, i);
+}
+
+//
+// canseeCached
+//
+static canseequery_t *canseecache_queries;
+static uint8_t *canseecache_results;
+static int32_t *canseecache_hash;  // indices into canseecache_queries, -1 if empty
+static int32_t  canseecache_num, canseecache_hashsize, canseecache_allocsize;
+#ifdef USE_STRUCT_TRACKERS
+static uint32_t canseecache_geometry;
+#endif
+
+static FORCE_INLINE uint32_t canseecache_hashquery(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2,
+                                                   int32_t z2, int16_t sect2)
+{
+    uint32_t h = (uint16_t)sect1 | ((uint32_t)(uint16_t)sect2 << 16);
+
+    h = (h ^ (uint32_t)x1) * 0x9E3779B1u;
+    h = (h ^ (uint32_t)y1) * 0x9E3779B1u;
+    h = (h ^ (uint32_t)z1) * 0x9E3779B1u;
+    h = (h ^ (uint32_t)x2) * 0x9E3779B1u;
+    h = (h ^ (uint32_t)y2) * 0x9E3779B1u;
+    h = (h ^ (uint32_t)z2) * 0x9E3779B1u;
+
+    return h ^ (h >> 15);
+}
+
+void canseeClearCache(void)
+{
+    canseecache_num = 0;
+}
+
+void canseePrepareCache(canseequery_t const *queries, int32_t numqueries)
+{
+    canseeClearCache();
+
+#ifdef USE_STRUCT_TRACKERS
+    if (numqueries <= 0)
+        return;
+
+    if (canseecache_allocsize < numqueries)
+    {
+        canseecache_allocsize = numqueries;
+        canseecache_queries = (canseequery_t *)Xrealloc(canseecache_queries, canseecache_allocsize*sizeof(canseequery_t));
+        canseecache_results = (uint8_t *)Xrealloc(canseecache_results, (canseecache_allocsize+7)>>3);
+    }
+
+    if (canseecache_hashsize < numqueries*2)
+    {
+        int32_t hashsize = 64;
+
+        while (hashsize < numqueries*2)
+            hashsize <<= 1;
+
+        canseecache_hashsize = hashsize;
+        canseecache_hash = (int32_t *)Xrealloc(canseecache_hash, canseecache_hashsize*sizeof(int32_t));
+    }
+
+    Bmemcpy(canseecache_queries, queries, numqueries*sizeof(canseequery_t));
+    canseeBatch(canseecache_queries, numqueries, canseecache_results);
+
+    Bmemset(canseecache_hash, -1, canseecache_hashsize*sizeof(int32_t));
+
+    for (bssize_t i=0; i<numqueries; i++)
+    {
+        auto const &q = queries[i];
+        uint32_t h = canseecache_hashquery(q.pos1.x, q.pos1.y, q.pos1.z, q.sect1, q.pos2.x, q.pos2.y, q.pos2.z, q.sect2);
+
+        while (canseecache_hash[h & (canseecache_hashsize-1)] >= 0)
+            h++;
+
+        canseecache_hash[h & (canseecache_hashsize-1)] = i;
+    }
+
+    canseecache_num = numqueries;
+    canseecache_geometry = geometrychanged;
+#else
+    UNREFERENCED_PARAMETER(queries);
+    UNREFERENCED_PARAMETER(numqueries);
+#endif
+}
+
+int32_t canseeCached(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+{
+#ifdef USE_STRUCT_TRACKERS
+    if (canseecache_num > 0 && canseecache_geometry == geometrychanged)
+    {
+        canseequery_t const q = { { x1, y1, z1 }, { x2, y2, z2 }, sect1, sect2 };
+        uint32_t h = canseecache_hashquery(x1, y1, z1, sect1, x2, y2, z2, sect2);
+        int32_t i;
+
+        while ((i = canseecache_hash[h & (canseecache_hashsize-1)]) >= 0)
+        {
+            if (cansee_samequery(canseecache_queries[i], q))
+                return bitmap_test(canseecache_results, i) != 0;
+
+            h++;
+        }
+    }
+#endif
+
+    return cansee(x1, y1, z1, sect1, x2, y2, z2, sect2);
+}
+
 //
 // neartag
 //
@@ -12320,6 +12861,7 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
             wall[w].x = dax;
             wall[w].y = day;
             walbitmap[w>>3] |= pow2char[w&7];
+            sectorindexUpdateWall(w);
 
             for (YAX_ITER_WALLS(w, j, tmpcf))
             {
@@ -12396,6 +12938,7 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
 
     wall[tempshort].x = dax;
     wall[tempshort].y = day;
+    sectorindexUpdateWall(tempshort);
 
     if (editstatus)
     {
@@ -12415,6 +12958,7 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
             wall[tempshort].x = dax;
             wall[tempshort].y = day;
             editwall[tempshort>>3] |= 1<<(tempshort&7);
+            sectorindexUpdateWall(tempshort);
         }
         else
         {
@@ -12428,6 +12972,7 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
                     wall[tempshort].x = dax;
                     wall[tempshort].y = day;
                     editwall[tempshort>>3] |= 1<<(tempshort&7);
+                    sectorindexUpdateWall(tempshort);
                 }
                 else
                 {
@@ -12545,6 +13090,33 @@ int findwallbetweensectors(int sect1, int sect2)
 int16_t updatesectorneighborlist[MAXSECTORS];
 uint8_t updatesectorneighbormap[(MAXSECTORS+7)>>3];
 
+// Returns the sector containing (x, y) according to test() that the linear scan it replaces would
+// have found first (better(a, b): a is tried before b), or -1. Only the sectors the sector index
+// lists for (x, y) are tested; callers do the linear scan themselves when this comes up empty.
+template <typename Test, typename Better>
+static int updatesector_indexed(int32_t const x, int32_t const y, Test test, Better better)
+{
+    int16_t const *cell, *extra;
+    int numcell, numextra;
+
+    if (!sectorindexQuery(x, y, &cell, &numcell, &extra, &numextra))
+        return -1;
+
+    int found = -1;
+
+    for (int i=0; i<numcell; i++)
+        if ((found < 0 || better(cell[i], found)) && test(cell[i]))
+            found = cell[i];
+
+    for (int i=0; i<numextra; i++)
+        if ((found < 0 || better(extra[i], found)) && test(extra[i]))
+            found = extra[i];
+
+    return found;
+}
+
+static FORCE_INLINE bool updatesector_highestfirst(int const a, int const b) { return a > b; }
+
 void updatesector_compat(int32_t const x, int32_t const y, int16_t* const sectnum)
 {
     if (inside_p(x, y, *sectnum))
@@ -12567,6 +13139,10 @@ void updatesector_compat(int32_t const x, int32_t const y, int16_t* const sectnu
 
     // we need to support passing in a sectnum of -1, unfortunately
 
+    int const found = updatesector_indexed(x, y, [&](int s) { return inside_p(x, y, s); }, updatesector_highestfirst);
+    if (found >= 0)
+        SET_AND_RETURN(*sectnum, found);
+
     for (int i = numsectors - 1; i >= 0; --i)
         if (inside_p(x, y, i))
             SET_AND_RETURN(*sectnum, i);
@@ -12586,6 +13162,12 @@ void updatesector_tryremaining(int32_t const x, int32_t const y, int16_t *const
     if (inside_exclude_p(x, y, sect, updatesectorneighbormap))
         SET_AND_RETURN(*sectnum, sect);
 
+    // the search below tries sect+1, sect-1, sect+2, sect-2...
+    int const found = updatesector_indexed(x, y, [&](int s) { return inside_exclude_p(x, y, s, updatesectorneighbormap); },
+                                           [sect](int a, int b) { int const da = klabs(a-sect), db = klabs(b-sect); return da < db || (da == db && a > b); });
+    if (found >= 0)
+        SET_AND_RETURN(*sectnum, found);
+
     int16_t highsect = sect, lowsect = sect;
 
     do
@@ -12637,6 +13219,10 @@ void updatesectorexclude(int32_t const x, int32_t const y, int16_t * const sectn
         while (--wallsleft);
     }
 
+    int const found = updatesector_indexed(x, y, [&](int s) { return inside_exclude_p(x, y, s, excludesectbitmap); }, updatesector_highestfirst);
+    if (found >= 0)
+        SET_AND_RETURN(*sectnum, found);
+
     for (bssize_t i=numsectors-1; i>=0; --i)
         if (inside_exclude_p(x, y, i, excludesectbitmap))
             SET_AND_RETURN(*sectnum, i);
@@ -12712,6 +13298,10 @@ void updatesectorz_compat(int32_t const x, int32_t const y, int32_t const z, int
     }
 
     // we need to support passing in a sectnum of -1, unfortunately
+    int const found = updatesector_indexed(x, y, [&](int s) { return inside_z_p(x, y, z, s); }, updatesector_highestfirst);
+    if (found >= 0)
+        SET_AND_RETURN(*sectnum, found);
+
     for (int i = numsectors - 1; i >= 0; --i)
         if (inside_z_p(x, y, z, i))
             SET_AND_RETURN(*sectnum, i);
@@ -292,12 +292,15 @@ skipit:
         mov byte ptr gotpic[eax], dl
         pop ebx
     }
+
+    if (waloff[a]) g_cache.countDraw(CACHE1D_CAT_TILE);
 }
 
 #elif defined(__GNUC__) && defined(__i386__) && !defined(NOASM)	// _MSC_VER
 
 #define setgotpic(a) \
 ({ int32_t __a=(a); \
+    if (waloff[__a]) g_cache.countDraw(CACHE1D_CAT_TILE); \
     __asm__ __volatile__ ( \
                    "movl %%eax, %%ebx\n\t" \
                    "cmpb $200, " ASMSYM("walock") "(%%eax)\n\t" \
@@ -320,6 +323,7 @@ static FORCE_INLINE void setgotpic(int32_t tilenume)
 {
     if (walock[tilenume] < CACHE1D_LOCKED) walock[tilenume] = CACHE1D_UNLOCKED;
     gotpic[tilenume>>3] |= pow2char[tilenume&7];
+    if (waloff[tilenume]) g_cache.countDraw(CACHE1D_CAT_TILE);
 }
 
 #endif
@@ -2650,6 +2650,27 @@ intptr_t kzopen(const char *filnam)
     return 0;
 }
 
+//For files kept uncompressed inside a mounted ZIP/GRP file, gets the archive's name and where in it
+//the file's data lies, so that it can be read without going through kzread
+int32_t kzfindstored(const char *filnam, char **zipnam, int32_t *fileoffs, int32_t *fileleng)
+{
+    char tempbuf[30], iscomp;
+
+    if (!kzcheckhash(filnam,zipnam,fileoffs,fileleng,&iscomp)) return 0;
+    if (!iscomp) return 1; //Must be from GRP file
+
+    buildvfs_FILE fil = buildvfs_fopen_read(*zipnam); if (!fil) return 0;
+    buildvfs_fseek_abs(fil,*fileoffs);
+    int32_t const ok = buildvfs_fread(tempbuf,30,1,fil) == 1 && B_UNBUF32(&tempbuf[0]) == B_LITTLE32(0x04034b50u)
+                       && B_LITTLE16(B_UNBUF16(&tempbuf[8])) == 0;
+    buildvfs_fclose(fil);
+    if (!ok) return 0;
+
+    (*fileoffs) += 30+B_LITTLE16(B_UNBUF16(&tempbuf[26]))+B_LITTLE16(B_UNBUF16(&tempbuf[28]));
+    (*fileleng) = B_LITTLE32(B_UNBUF32(&tempbuf[22]));
+    return 1;
+}
+
 #ifndef USE_PHYSFS
 // --------------------------------------------------------------------------
 
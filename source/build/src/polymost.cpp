@@ -3211,7 +3211,7 @@ static void polymost_drawpoly(vec2f_t const * const dpxy, int32_t const n, int32
 
     if (!waloff[globalpicnum])
     {
-        tileLoad(globalpicnum);
+        tileLoadAsync(globalpicnum, (method & DAMETH_MASKPROPS) != 0);
     }
 
     Bassert(n <= MAX_DRAWPOLY_VERTS);
@@ -6591,7 +6591,7 @@ static int32_t polymost_bunchfront(const int32_t b1, const int32_t b2)
 
 void polymost_scansector(int32_t sectnum)
 {
-    if (sectnum < 0) return;
+    if (sectnum < 0 || !pvsViewCanSee(sectnum)) return;
 
     if (automapping)
         show2dsector[sectnum>>3] |= pow2char[sectnum&7];
@@ -6649,7 +6649,7 @@ void polymost_scansector(int32_t sectnum)
 
             int const nextsectnum = wal->nextsector; //Scan close sectors
 
-            if (nextsectnum >= 0 && !(wal->cstat&32) && sectorbordercnt < ARRAY_SSIZE(sectorborder))
+            if (nextsectnum >= 0 && !(wal->cstat&32) && sectorbordercnt < ARRAY_SSIZE(sectorborder) && pvsViewCanSee(nextsectnum))
 #ifdef YAX_ENABLE
             if (yax_nomaskpass==0 || !yax_isislandwall(z, !yax_globalcf) || (yax_nomaskdidit=1, 0))
 #endif
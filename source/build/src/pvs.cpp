@@ -0,0 +1,576 @@
+// Sector potentially visible sets
+
+#include "pvs.h"
+
+#include "baselayer.h"
+#include "build.h"
+#include "compat.h"
+#include "crc32.h"
+#include "editor.h"
+#include "threadpool.h"
+#include "timer.h"
+#include "vfs.h"
+
+#define PVS_CACHEDIR  "pvscache"
+#define PVS_MAGIC     "BPVS"
+#define PVS_VERSION   1
+#define PVS_MAXSTEPS  (1<<18)     // portals a source sector may flow through before it falls back to reachability
+#define PVS_EPSILON   (1.0/16.0)  // in map units, in favor of keeping a window
+#define PVS_JOBSIZE   16          // source sectors per thread pool job
+#define PVS_MAXREFLOW 256         // stale rows flowed again per pvsUpdate()
+
+int32_t pvsactive;
+
+static uint8_t *pvs_bitmaps;  // pvs_numsectors rows of pvs_rowbytes
+static int32_t  pvs_numsectors, pvs_numwalls, pvs_rowbytes;
+static int32_t  pvs_viewsect = -1;
+
+// walls written through the trackers since the last pvsUpdate()
+static int32_t pvs_touched[MAXWALLS];
+static int32_t pvs_numtouched;
+static uint8_t pvs_touchedmap[(MAXWALLS+7)>>3];
+
+// rows that may no longer hold every sector their source can see
+static uint8_t pvs_stalemap[(MAXSECTORS+7)>>3];
+static int32_t pvs_numstale;
+
+typedef struct
+{
+    double x, y;
+} pvsvec_t;
+
+// A window on a red wall, oriented so that the sector it leads into lies to its left.
+typedef struct
+{
+    pvsvec_t p0, p1;
+} pvsportal_t;
+
+typedef struct
+{
+    pvsportal_t pass;
+    int32_t     sectnum, wallnum;  // sector entered through wall wallnum
+} pvsstep_t;
+
+typedef struct
+{
+    double *   lo, *hi;  // explored part of each wall, valid for the source portal in stamp
+    int32_t *  stamp;
+    pvsstep_t *stack;
+    int32_t    stacksize;
+} pvsscratch_t;
+
+static FORCE_INLINE double pvsCross(pvsvec_t const &o, pvsvec_t const &a, pvsvec_t const &b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+static FORCE_INLINE pvsvec_t pvsLerp(pvsvec_t const &a, pvsvec_t const &b, double const t)
+{
+    return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+// Sectors have their inside to the left of each wall in map coordinates, so a line of sight leaves
+// through the wall going from point2 back to the wall's own point.
+static FORCE_INLINE pvsportal_t pvsWallPortal(int const wallnum)
+{
+    auto const wal  = (uwallptr_t)&wall[wallnum];
+    auto const wal2 = (uwallptr_t)&wall[wal->point2];
+
+    return { { (double)wal2->x, (double)wal2->y }, { (double)wal->x, (double)wal->y } };
+}
+
+// Keeps the part of [*u0, *u1] along t where the cross product against the line o->d is at least
+// sign*0 (within PVS_EPSILON). Returns 0 if nothing is left.
+static int pvsClipWindow(pvsportal_t const &t, double *const u0, double *const u1, pvsvec_t const &o, pvsvec_t const &d, double const sign)
+{
+    double const len = Bsqrt((d.x - o.x) * (d.x - o.x) + (d.y - o.y) * (d.y - o.y));
+
+    // degenerate lines, like two portals sharing an end point, don't restrict anything
+    if (len < PVS_EPSILON)
+        return 1;
+
+    double const tol = -PVS_EPSILON * len;
+    double const f0  = sign * pvsCross(o, d, pvsLerp(t.p0, t.p1, *u0));
+    double const f1  = sign * pvsCross(o, d, pvsLerp(t.p0, t.p1, *u1));
+
+    if (f0 < tol && f1 < tol)
+        return 0;
+
+    if (f0 < tol)
+        *u0 += (*u1 - *u0) * ((f0 - tol) / (f0 - f1));
+    else if (f1 < tol)
+        *u1 -= (*u1 - *u0) * ((f1 - tol) / (f1 - f0));
+
+    return 1;
+}
+
+static FORCE_INLINE int pvsStackPush(pvsscratch_t *const scratch, int32_t *const num)
+{
+    if (*num >= scratch->stacksize)
+    {
+        scratch->stacksize = scratch->stacksize ? scratch->stacksize*2 : 256;
+        scratch->stack = (pvsstep_t *)Xrealloc(scratch->stack, scratch->stacksize * sizeof(pvsstep_t));
+    }
+
+    return (*num)++;
+}
+
+// Marks every sector a line of sight starting in sectnum can reach. For each red wall of the source
+// sector, windows on the walls further out are clipped to the lines passing through both that wall
+// and the window they were seen through (the 2D anti-penumbra).
+static void pvsFlowSector(int32_t const sectnum, pvsscratch_t *const scratch)
+{
+    uint8_t *const row = &pvs_bitmaps[sectnum * pvs_rowbytes];
+    int32_t steps = 0, numsteps = 0;
+
+    bitmap_set(row, sectnum);
+
+    auto const sec = (usectorptr_t)&sector[sectnum];
+
+    for (bssize_t w=sec->wallptr; w<sec->wallptr+sec->wallnum; w++)
+    {
+        auto const wal = (uwallptr_t)&wall[w];
+
+        if (wal->nextsector < 0)
+            continue;
+
+        pvsportal_t const source = pvsWallPortal(w);
+        int32_t const stamp = w + 1;
+
+        bitmap_set(row, wal->nextsector);
+
+        int32_t const i = pvsStackPush(scratch, &numsteps);
+        scratch->stack[i] = { source, wal->nextsector, (int32_t)w };
+
+        while (numsteps > 0)
+        {
+            pvsstep_t const step = scratch->stack[--numsteps];
+            auto const &pass = step.pass;
+            int const skipwall = wall[step.wallnum].nextwall;
+            auto const nsec = (usectorptr_t)&sector[step.sectnum];
+
+            for (bssize_t nw=nsec->wallptr; nw<nsec->wallptr+nsec->wallnum; nw++)
+            {
+                auto const nwal = (uwallptr_t)&wall[nw];
+
+                if (nwal->nextsector < 0 || nw == skipwall)
+                    continue;
+
+                pvsportal_t const target = pvsWallPortal(nw);
+                double u0 = 0.0, u1 = 1.0;
+
+                if (!pvsClipWindow(target, &u0, &u1, pass.p0, pass.p1, 1.0))
+                    continue;
+
+                if (step.wallnum != w && (!pvsClipWindow(target, &u0, &u1, source.p0, pass.p1, 1.0)
+                                          || !pvsClipWindow(target, &u0, &u1, source.p1, pass.p0, -1.0)))
+                    continue;
+
+                if (scratch->stamp[nw] == stamp)
+                {
+                    if (u0 >= scratch->lo[nw] && u1 <= scratch->hi[nw])
+                        continue;
+
+                    u0 = min(u0, scratch->lo[nw]);
+                    u1 = max(u1, scratch->hi[nw]);
+                }
+
+                scratch->stamp[nw] = stamp;
+                scratch->lo[nw] = u0;
+                scratch->hi[nw] = u1;
+
+                bitmap_set(row, nwal->nextsector);
+
+                if (++steps > PVS_MAXSTEPS)
+                {
+                    for (bssize_t j=0; j<numsectors; j++)
+                        if (sectorsareconnected(sectnum, j))
+                            bitmap_set(row, j);
+                    return;
+                }
+
+                int32_t const j = pvsStackPush(scratch, &numsteps);
+                scratch->stack[j] = { { pvsLerp(target.p0, target.p1, u0), pvsLerp(target.p0, target.p1, u1) },
+                                      nwal->nextsector, (int32_t)nw };
+            }
+        }
+    }
+}
+
+// userdata is null to flow all sectors, or a list of sector numbers ending in -1
+static void pvsFlowJob(int32_t const index, void *userdata)
+{
+    auto const list = (int32_t const *)userdata;
+    int32_t const end = min(index*PVS_JOBSIZE + PVS_JOBSIZE, (int32_t)numsectors);
+    pvsscratch_t scratch = {};
+
+    // stamps are wall numbers of source portals, so a job's sectors never see each other's
+    scratch.lo    = (double *)Xmalloc(numwalls * sizeof(double));
+    scratch.hi    = (double *)Xmalloc(numwalls * sizeof(double));
+    scratch.stamp = (int32_t *)Xcalloc(numwalls, sizeof(int32_t));
+
+    for (bssize_t i=index*PVS_JOBSIZE; i<end; i++)
+    {
+        if (!list)
+            pvsFlowSector(i, &scratch);
+        else if (list[i] < 0)
+            break;
+        else
+            pvsFlowSector(list[i], &scratch);
+    }
+
+    Xfree(scratch.lo);
+    Xfree(scratch.hi);
+    Xfree(scratch.stamp);
+    Xfree(scratch.stack);
+}
+
+// The flow needs every wall to have its sector on the same side; an editor normally makes sure.
+static int pvsCheckWallOrientation(void)
+{
+    for (bssize_t i=0; i<numsectors; i++)
+    {
+        auto const sec = (usectorptr_t)&sector[i];
+
+        for (bssize_t w=sec->wallptr; w<sec->wallptr+sec->wallnum; w++)
+        {
+            auto const wal  = (uwallptr_t)&wall[w];
+            auto const wal2 = (uwallptr_t)&wall[wal->point2];
+            vec2_t const d = { wal2->x - wal->x, wal2->y - wal->y };
+            double const len = Bsqrt((double)d.x * d.x + (double)d.y * d.y);
+
+            if (len < 16.0)
+                continue;
+
+            vec2_t const mid = { wal->x + d.x/2, wal->y + d.y/2 };
+            vec2_t const ofs = { Blrintf(-d.y * 4.0 / len), Blrintf(d.x * 4.0 / len) };
+
+            if (inside(mid.x + ofs.x, mid.y + ofs.y, i) != 1 && inside(mid.x - ofs.x, mid.y - ofs.y, i) == 1)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+static uint32_t pvsWallChecksum(void)
+{
+    uint32_t crc = 0;
+
+    for (bssize_t i=0; i<numwalls; i++)
+    {
+        auto const wal = (uwallptr_t)&wall[i];
+        int32_t const buf[4] = { B_LITTLE32(wal->x), B_LITTLE32(wal->y), B_LITTLE32(wal->point2), B_LITTLE32(wal->nextsector) };
+
+        crc = Bcrc32(buf, sizeof(buf), crc);
+    }
+
+    return crc;
+}
+
+// next to the texture cache: in the mod's directory if one is set, else the user's settings directory.
+// Returns 0 if the path doesn't fit, in which case there is no cache.
+static int pvsGetCacheDir(char *const dir)
+{
+    if (g_modDir[0] != '/' || g_modDir[1] != 0)
+        return Bsnprintf(dir, BMAX_PATH, "%s/" PVS_CACHEDIR, g_modDir) < BMAX_PATH;
+
+    Bstrcpy(dir, PVS_CACHEDIR);
+    return 1;
+}
+
+static int pvsGetCacheName(char *const fn, uint32_t const crc)
+{
+    uint8_t const *const md4 = g_loadedMapHack.md4;
+    char dir[BMAX_PATH];
+
+    if (!pvsGetCacheDir(dir))
+        return 0;
+
+    return Bsnprintf(fn, BMAX_PATH, "%s/%08x%08x%08x%08x-%08x.pvs", dir, B_BIG32(B_UNBUF32(&md4[0])), B_BIG32(B_UNBUF32(&md4[4])),
+                     B_BIG32(B_UNBUF32(&md4[8])), B_BIG32(B_UNBUF32(&md4[12])), crc) < BMAX_PATH;
+}
+
+typedef struct
+{
+    char     magic[4];
+    int32_t  version;
+    uint8_t  md4[16];
+    int32_t  numsectors, numwalls;
+    uint32_t crc;
+} pvsheader_t;
+
+static FORCE_INLINE pvsheader_t pvsMakeHeader(uint32_t const crc)
+{
+    pvsheader_t header;
+
+    Bmemcpy(header.magic, PVS_MAGIC, sizeof(header.magic));
+    Bmemcpy(header.md4, g_loadedMapHack.md4, sizeof(header.md4));
+    header.version    = B_LITTLE32(PVS_VERSION);
+    header.numsectors = B_LITTLE32(numsectors);
+    header.numwalls   = B_LITTLE32(numwalls);
+    header.crc        = B_LITTLE32(crc);
+
+    return header;
+}
+
+// Rows are stored with runs of zero bytes collapsed into a zero and a count.
+static int pvsReadCache(char const *const fn, uint32_t const crc)
+{
+    buildvfs_FILE fp = buildvfs_fopen_read(fn);
+
+    if (!fp)
+        return 0;
+
+    pvsheader_t const expected = pvsMakeHeader(crc);
+    pvsheader_t header;
+    int ok = buildvfs_fread(&header, sizeof(header), 1, fp) == 1 && !Bmemcmp(&header, &expected, sizeof(header));
+
+    for (bssize_t i=0; ok && i<numsectors; i++)
+    {
+        uint8_t *const row = &pvs_bitmaps[i * pvs_rowbytes];
+
+        for (bssize_t j=0; ok && j<pvs_rowbytes;)
+        {
+            int const c = buildvfs_fgetc(fp);
+
+            if (c == buildvfs_EOF)
+                ok = 0;
+            else if (c != 0)
+                row[j++] = c;
+            else
+            {
+                int const run = buildvfs_fgetc(fp);
+
+                if (run == buildvfs_EOF || run == 0 || j + run > pvs_rowbytes)
+                    ok = 0;
+                else
+                {
+                    Bmemset(&row[j], 0, run);
+                    j += run;
+                }
+            }
+        }
+    }
+
+    buildvfs_fclose(fp);
+
+    return ok;
+}
+
+static void pvsWriteCache(char const *const fn, uint32_t const crc)
+{
+    char dir[BMAX_PATH];
+
+    if (!pvsGetCacheDir(dir))
+        return;
+
+    buildvfs_mkdir(dir, S_IRWXU);
+
+    buildvfs_FILE fp = buildvfs_fopen_write(fn);
+
+    if (!fp)
+        return;
+
+    pvsheader_t const header = pvsMakeHeader(crc);
+    buildvfs_fwrite(&header, sizeof(header), 1, fp);
+
+    for (bssize_t i=0; i<numsectors; i++)
+    {
+        uint8_t const *const row = &pvs_bitmaps[i * pvs_rowbytes];
+
+        for (bssize_t j=0; j<pvs_rowbytes;)
+        {
+            if (row[j] != 0)
+            {
+                buildvfs_fputc(row[j++], fp);
+                continue;
+            }
+
+            int run = 0;
+
+            while (j < pvs_rowbytes && row[j] == 0 && run < 255)
+                j++, run++;
+
+            buildvfs_fputc(0, fp);
+            buildvfs_fputc(run, fp);
+        }
+    }
+
+    buildvfs_fclose(fp);
+}
+
+void pvsFree(void)
+{
+    DO_FREE_AND_NULL(pvs_bitmaps);
+
+    pvsactive      = 0;
+    pvs_numsectors = 0;
+    pvs_numwalls   = 0;
+    pvs_viewsect   = -1;
+
+    Bmemset(pvs_touchedmap, 0, sizeof(pvs_touchedmap));
+    Bmemset(pvs_stalemap, 0, sizeof(pvs_stalemap));
+    pvs_numtouched = 0;
+    pvs_numstale   = 0;
+}
+
+void pvsBuild(void)
+{
+    pvsFree();
+
+#ifdef USE_STRUCT_TRACKERS
+    if (editstatus || numsectors <= 0)
+        return;
+
+# ifdef YAX_ENABLE
+    if (numyaxbunches > 0)
+        return;
+# endif
+
+    if (!pvsCheckWallOrientation())
+    {
+        initprintf("PVS: map has walls facing the wrong way, not building visibility\n");
+        return;
+    }
+
+    pvs_rowbytes = (numsectors+7)>>3;
+    pvs_bitmaps  = (uint8_t *)Xcalloc(numsectors, pvs_rowbytes);
+
+    uint32_t const crc = pvsWallChecksum();
+    char fn[BMAX_PATH];
+    int const havemd4 = Bmemcmp(g_loadedMapHack.md4, "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", sizeof(g_loadedMapHack.md4)) != 0;
+    int const usecache = havemd4 && pvsGetCacheName(fn, crc);
+
+    if (!usecache || !pvsReadCache(fn, crc))
+    {
+        uint32_t const starttime = timerGetTicks();
+
+        Bmemset(pvs_bitmaps, 0, numsectors * pvs_rowbytes);
+        threadpoolParallelFor((numsectors + PVS_JOBSIZE - 1) / PVS_JOBSIZE, pvsFlowJob, nullptr);
+
+        initprintf("PVS: built visibility for %d sectors in %u ms\n", numsectors, timerGetTicks() - starttime);
+
+        if (usecache)
+            pvsWriteCache(fn, crc);
+    }
+
+    pvs_numsectors = numsectors;
+    pvs_numwalls   = numwalls;
+    pvsactive      = 1;
+#endif
+}
+
+void pvsTouchWall(int const wallnum)
+{
+    if ((unsigned)wallnum >= MAXWALLS || bitmap_test(pvs_touchedmap, wallnum))
+        return;
+
+    bitmap_set(pvs_touchedmap, wallnum);
+    pvs_touched[pvs_numtouched++] = wallnum;
+}
+
+// A source sector's flow only ever looks at the walls of sectors in its row, so a wall moving or
+// being relinked can only change the rows holding the wall's sector.
+static void pvsMarkStale(void)
+{
+    static int16_t dirty[MAXSECTORS];
+    static uint8_t dirtymap[(MAXSECTORS+7)>>3];
+    int32_t numdirty = 0;
+
+    for (bssize_t i=0; i<pvs_numtouched; i++)
+    {
+        int const wallnum = pvs_touched[i];
+        int const sectnum = (wallnum < numwalls) ? sectorofwall(wallnum) : -1;
+
+        bitmap_clear(pvs_touchedmap, wallnum);
+
+        if ((unsigned)sectnum < (unsigned)numsectors && !bitmap_test(dirtymap, sectnum))
+        {
+            bitmap_set(dirtymap, sectnum);
+            dirty[numdirty++] = sectnum;
+        }
+    }
+
+    pvs_numtouched = 0;
+
+    for (bssize_t i=0; i<numsectors; i++)
+    {
+        if (bitmap_test(pvs_stalemap, i))
+            continue;
+
+        uint8_t const *const row = &pvs_bitmaps[i * pvs_rowbytes];
+
+        for (bssize_t j=0; j<numdirty; j++)
+        {
+            if (bitmap_test(row, dirty[j]))
+            {
+                bitmap_set(pvs_stalemap, i);
+                pvs_numstale++;
+                break;
+            }
+        }
+    }
+
+    for (bssize_t j=0; j<numdirty; j++)
+        bitmap_clear(dirtymap, dirty[j]);
+}
+
+// Stale rows are flowed again once no walls have moved since the last call, so a sliding door
+// costs one flow of the rows that can see it after it stops instead of one every tic.
+static void pvsReflowStale(void)
+{
+    static int32_t list[PVS_MAXREFLOW+1];
+    int32_t num = 0;
+
+    for (bssize_t i=0; i<numsectors && num<PVS_MAXREFLOW; i++)
+    {
+        if (!bitmap_test(pvs_stalemap, i))
+            continue;
+
+        list[num++] = i;
+        Bmemset(&pvs_bitmaps[i * pvs_rowbytes], 0, pvs_rowbytes);
+    }
+
+    list[num] = -1;
+
+    threadpoolParallelFor((num + PVS_JOBSIZE - 1) / PVS_JOBSIZE, pvsFlowJob, list);
+
+    for (bssize_t i=0; i<num; i++)
+        bitmap_clear(pvs_stalemap, list[i]);
+
+    pvs_numstale -= num;
+}
+
+void pvsUpdate(void)
+{
+    if (!pvsactive || pvs_numsectors != numsectors || pvs_numwalls != numwalls)
+        return;
+
+    if (pvs_numtouched)
+        pvsMarkStale();
+    else if (pvs_numstale)
+        pvsReflowStale();
+}
+
+int pvsCanSee(int const fromsect, int const tosect)
+{
+    if (!pvsactive || pvs_numsectors != numsectors || pvs_numwalls != numwalls || pvs_numtouched
+        || (unsigned)fromsect >= (unsigned)numsectors || (unsigned)tosect >= (unsigned)numsectors
+        || bitmap_test(pvs_stalemap, fromsect))
+        return 1;
+
+    return bitmap_test(&pvs_bitmaps[fromsect * pvs_rowbytes], tosect) != 0;
+}
+
+void pvsSetView(int32_t const x, int32_t const y, int const sectnum)
+{
+    pvsUpdate();
+
+    pvs_viewsect = (pvsactive && (unsigned)sectnum < (unsigned)numsectors && inside(x, y, sectnum) == 1) ? sectnum : -1;
+}
+
+int pvsViewCanSee(int const sectnum)
+{
+    return pvs_viewsect < 0 || pvsCanSee(pvs_viewsect, sectnum);
+}
@@ -0,0 +1,281 @@
+// Sector lookup grid for updatesector() and friends
+
+#include "sectorindex.h"
+
+#include "build.h"
+#include "compat.h"
+#include "editor.h"
+
+#define SECTORINDEX_MINSECTORS 64    // a linear search is about as fast below this
+#define SECTORINDEX_MAXDIM     256
+#define SECTORINDEX_LARGECELLS 1024  // sectors covering more cells than this are always checked
+#define SECTORINDEX_MAXMOVED   64    // rebuild once this many sectors have left their cells
+
+typedef struct
+{
+    int16_t x1, y1, x2, y2;  // inclusive cell range the sector was filed under
+} sectcells_t;
+
+static int32_t si_numsectors = -1;  // -1: no index
+static int32_t si_numwalls;
+static vec2_t  si_origin;
+static int32_t si_shift, si_xdim, si_ydim;
+
+static int32_t *    si_cellstart;  // si_xdim*si_ydim+1 offsets into si_cellsect
+static int16_t *    si_cellsect;
+static sectcells_t *si_sectcells;
+
+static int16_t si_extra[MAXSECTORS];  // sectors too large for the grid, then ones that have moved
+static int32_t si_numextra, si_numlarge;
+static uint8_t si_extramap[(MAXSECTORS+7)>>3];
+static int32_t si_rebuild;
+
+static int32_t si_touched[MAXWALLS];  // walls written through the trackers since the last lookup
+static int32_t si_numtouched;
+static uint8_t si_touchedmap[(MAXWALLS+7)>>3];
+
+int32_t sectorindexactive;
+
+static FORCE_INLINE int32_t sectorindexCellX(int32_t const x) { return (int32_t)(((int64_t)x - si_origin.x) >> si_shift); }
+static FORCE_INLINE int32_t sectorindexCellY(int32_t const y) { return (int32_t)(((int64_t)y - si_origin.y) >> si_shift); }
+
+static void sectorindexAddExtra(int const sectnum)
+{
+    if (bitmap_test(si_extramap, sectnum))
+        return;
+
+    bitmap_set(si_extramap, sectnum);
+    si_extra[si_numextra++] = sectnum;
+
+    if (si_numextra - si_numlarge > SECTORINDEX_MAXMOVED)
+        si_rebuild = 1;
+}
+
+void sectorindexFree(void)
+{
+    DO_FREE_AND_NULL(si_cellstart);
+    DO_FREE_AND_NULL(si_cellsect);
+    DO_FREE_AND_NULL(si_sectcells);
+
+    si_numsectors = -1;
+    sectorindexactive = 0;
+}
+
+void sectorindexBuild(void)
+{
+    si_rebuild = 0;
+
+    Bmemset(si_touchedmap, 0, sizeof(si_touchedmap));
+    si_numtouched = 0;
+
+#ifndef USE_STRUCT_TRACKERS
+    sectorindexFree();
+    return;
+#endif
+
+    if (numsectors < SECTORINDEX_MINSECTORS)
+    {
+        sectorindexFree();
+        return;
+    }
+
+    vec2_t mins = { INT32_MAX, INT32_MAX }, maxs = { INT32_MIN, INT32_MIN };
+
+    auto uwal = (uwallptr_t)wall;
+
+    for (bssize_t i=numwalls; i>0; i--, uwal++)
+    {
+        mins.x = min(mins.x, uwal->x);
+        mins.y = min(mins.y, uwal->y);
+        maxs.x = max(maxs.x, uwal->x);
+        maxs.y = max(maxs.y, uwal->y);
+    }
+
+    if (mins.x > maxs.x)
+    {
+        sectorindexFree();
+        return;
+    }
+
+    // smallest power of two cell size giving no more than two cells per sector
+    int64_t const width = (int64_t)maxs.x - mins.x, height = (int64_t)maxs.y - mins.y;
+    int32_t const maxcells = numsectors*2;
+
+    si_origin = mins;
+    si_shift = 4;
+
+    while ((width>>si_shift) >= SECTORINDEX_MAXDIM || (height>>si_shift) >= SECTORINDEX_MAXDIM ||
+           ((width>>si_shift)+1)*((height>>si_shift)+1) > maxcells)
+        si_shift++;
+
+    si_xdim = (int32_t)(width>>si_shift)+1;
+    si_ydim = (int32_t)(height>>si_shift)+1;
+
+    int32_t const numcells = si_xdim*si_ydim;
+
+    si_numsectors = numsectors;
+    si_numwalls   = numwalls;
+    si_cellstart  = (int32_t *)Xrealloc(si_cellstart, (numcells+1)*sizeof(int32_t));
+    si_sectcells  = (sectcells_t *)Xrealloc(si_sectcells, numsectors*sizeof(sectcells_t));
+
+    Bmemset(si_cellstart, 0, (numcells+1)*sizeof(int32_t));
+    Bmemset(si_extramap, 0, sizeof(si_extramap));
+    si_numextra = 0;
+
+    for (bssize_t i=0; i<numsectors; i++)
+    {
+        auto const sec = (usectorptr_t)&sector[i];
+        auto &cells = si_sectcells[i];
+
+        if (sec->wallnum <= 0)
+        {
+            cells = { 0, 0, -1, -1 };
+            continue;
+        }
+
+        vec2_t smins = { INT32_MAX, INT32_MAX }, smaxs = { INT32_MIN, INT32_MIN };
+        auto uwal = (uwallptr_t)&wall[sec->wallptr];
+
+        for (bssize_t j=sec->wallnum; j>0; j--, uwal++)
+        {
+            smins.x = min(smins.x, uwal->x);
+            smins.y = min(smins.y, uwal->y);
+            smaxs.x = max(smaxs.x, uwal->x);
+            smaxs.y = max(smaxs.y, uwal->y);
+        }
+
+        cells = { (int16_t)sectorindexCellX(smins.x), (int16_t)sectorindexCellY(smins.y),
+                  (int16_t)sectorindexCellX(smaxs.x), (int16_t)sectorindexCellY(smaxs.y) };
+
+        if ((cells.x2-cells.x1+1)*(cells.y2-cells.y1+1) > SECTORINDEX_LARGECELLS)
+        {
+            sectorindexAddExtra(i);
+            continue;
+        }
+
+        for (bssize_t y=cells.y1; y<=cells.y2; y++)
+            for (bssize_t x=cells.x1; x<=cells.x2; x++)
+                si_cellstart[y*si_xdim+x+1]++;
+    }
+
+    si_numlarge = si_numextra;
+
+    for (bssize_t i=0; i<numcells; i++)
+        si_cellstart[i+1] += si_cellstart[i];
+
+    si_cellsect = (int16_t *)Xrealloc(si_cellsect, max(si_cellstart[numcells], 1)*sizeof(int16_t));
+
+    auto fill = (int32_t *)Xmalloc(numcells*sizeof(int32_t));
+    Bmemcpy(fill, si_cellstart, numcells*sizeof(int32_t));
+
+    for (bssize_t i=0; i<numsectors; i++)
+    {
+        if (bitmap_test(si_extramap, i))
+            continue;
+
+        auto const &cells = si_sectcells[i];
+
+        for (bssize_t y=cells.y1; y<=cells.y2; y++)
+            for (bssize_t x=cells.x1; x<=cells.x2; x++)
+                si_cellsect[fill[y*si_xdim+x]++] = i;
+    }
+
+    Xfree(fill);
+
+    sectorindexactive = 1;
+}
+
+static FORCE_INLINE int sectorindexValid(void)
+{
+    return si_numsectors == numsectors && si_numwalls == numwalls && !editstatus;
+}
+
+void sectorindexUpdateSector(int const sectnum)
+{
+    if (!sectorindexValid() || (unsigned)sectnum >= (unsigned)numsectors || bitmap_test(si_extramap, sectnum))
+        return;
+
+    auto const sec   = (usectorptr_t)&sector[sectnum];
+    auto const cells = si_sectcells[sectnum];
+    auto       uwal  = (uwallptr_t)&wall[sec->wallptr];
+
+    for (bssize_t j=sec->wallnum; j>0; j--, uwal++)
+    {
+        int32_t const x = sectorindexCellX(uwal->x), y = sectorindexCellY(uwal->y);
+
+        if (x < cells.x1 || x > cells.x2 || y < cells.y1 || y > cells.y2)
+        {
+            sectorindexAddExtra(sectnum);
+            return;
+        }
+    }
+}
+
+void sectorindexUpdateWall(int const wallnum)
+{
+    if (!sectorindexValid() || (unsigned)wallnum >= (unsigned)numwalls)
+        return;
+
+    int const sectnum = sectorofwall(wallnum);
+
+    if ((unsigned)sectnum >= (unsigned)numsectors || bitmap_test(si_extramap, sectnum))
+        return;
+
+    auto const &cells = si_sectcells[sectnum];
+    auto const  uwal  = (uwallptr_t)&wall[wallnum];
+    int32_t const x = sectorindexCellX(uwal->x), y = sectorindexCellY(uwal->y);
+
+    if (x < cells.x1 || x > cells.x2 || y < cells.y1 || y > cells.y2)
+        sectorindexAddExtra(sectnum);
+}
+
+void sectorindexTouchWall(int const wallnum)
+{
+    if ((unsigned)wallnum >= MAXWALLS || bitmap_test(si_touchedmap, wallnum))
+        return;
+
+    bitmap_set(si_touchedmap, wallnum);
+    si_touched[si_numtouched++] = wallnum;
+}
+
+int sectorindexQuery(int32_t const x, int32_t const y, int16_t const **cell, int *numcell, int16_t const **extra, int *numextra)
+{
+    if (!sectorindexValid())
+        return 0;
+
+    for (bssize_t i=0; i<si_numtouched; i++)
+    {
+        bitmap_clear(si_touchedmap, si_touched[i]);
+        sectorindexUpdateWall(si_touched[i]);
+    }
+
+    si_numtouched = 0;
+
+    if (si_rebuild)
+    {
+        sectorindexBuild();
+
+        if (!sectorindexValid())
+            return 0;
+    }
+
+    uint32_t const cx = sectorindexCellX(x), cy = sectorindexCellY(y);
+
+    if (cx < (unsigned)si_xdim && cy < (unsigned)si_ydim)
+    {
+        int32_t const c = cy*si_xdim+cx;
+
+        *cell    = &si_cellsect[si_cellstart[c]];
+        *numcell = si_cellstart[c+1]-si_cellstart[c];
+    }
+    else
+    {
+        *cell    = nullptr;
+        *numcell = 0;
+    }
+
+    *extra    = si_extra;
+    *numextra = si_numextra;
+
+    return 1;
+}
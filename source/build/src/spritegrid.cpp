@@ -0,0 +1,255 @@
+// Cell hash of facing sprites for clipmove() and getzrange()
+
+#include "spritegrid.h"
+
+#include "build.h"
+#include "compat.h"
+
+#define SPRITEGRID_SHIFT      10
+#define SPRITEGRID_NUMBUCKETS 4096  // must be a power of two
+#define SPRITEGRID_MINSPRITES 32    // walking a sector list is about as fast below this
+#define SPRITEGRID_MAXCELLS   64    // queries covering more cells than this walk the sector list
+
+int32_t spritegridactive;
+
+static int32_t sg_numsectors;
+static int32_t sg_rebuild;  // a sprite was linked into the middle of a sector list
+
+static int16_t sg_sect[MAXSPRITES];    // sector the sprite is linked into, -1 if none
+static int32_t sg_stamp[MAXSPRITES];   // ascending in sector list order
+static int32_t sg_bucket[MAXSPRITES];  // bucket the sprite is filed under, -1 if loose
+static vec2_t  sg_cell[MAXSPRITES];
+static int16_t sg_next[MAXSPRITES], sg_prev[MAXSPRITES];
+
+static int16_t sg_head[SPRITEGRID_NUMBUCKETS];
+static int16_t sg_loose[MAXSECTORS];
+static int16_t sg_count[MAXSECTORS];
+
+static int16_t sg_touched[MAXSPRITES];
+static int32_t sg_numtouched;
+static uint8_t sg_touchedmap[(MAXSPRITES+7)>>3];
+
+static int16_t sg_result[MAXSPRITES];
+
+static FORCE_INLINE int32_t spritegridBucket(int32_t const cx, int32_t const cy)
+{
+    return (int32_t)(((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u)) & (SPRITEGRID_NUMBUCKETS-1);
+}
+
+static FORCE_INLINE int16_t &spritegridListHead(int const spritenum)
+{
+    return sg_bucket[spritenum] >= 0 ? sg_head[sg_bucket[spritenum]] : sg_loose[sg_sect[spritenum]];
+}
+
+static void spritegridListInsert(int16_t &head, int const spritenum)
+{
+    sg_prev[spritenum] = -1;
+    sg_next[spritenum] = head;
+    if (head >= 0)
+        sg_prev[head] = spritenum;
+    head = spritenum;
+}
+
+static void spritegridListRemove(int16_t &head, int const spritenum)
+{
+    int const prev = sg_prev[spritenum];
+    int const next = sg_next[spritenum];
+
+    if (head == spritenum)
+        head = next;
+    if (prev >= 0)
+        sg_next[prev] = next;
+    if (next >= 0)
+        sg_prev[next] = prev;
+}
+
+// sprites that clipsprite_try() or a wall or floor alignment may put far from their position stay loose
+static FORCE_INLINE int spritegridCanFile(int const spritenum)
+{
+    auto const spr = (uspriteptr_t)&sprite[spritenum];
+    return (spr->cstat & CSTAT_SPRITE_ALIGNMENT_MASK) == CSTAT_SPRITE_ALIGNMENT_FACING && !clipshape_haspicnum(spr->picnum);
+}
+
+static void spritegridFile(int const spritenum)
+{
+    auto const spr = (uspriteptr_t)&sprite[spritenum];
+    vec2_t const cell = { spr->x >> SPRITEGRID_SHIFT, spr->y >> SPRITEGRID_SHIFT };
+
+    sg_cell[spritenum]   = cell;
+    sg_bucket[spritenum] = spritegridBucket(cell.x, cell.y);
+    spritegridListInsert(sg_head[sg_bucket[spritenum]], spritenum);
+}
+
+static void spritegridAddTouched(int const spritenum)
+{
+    if (bitmap_test(sg_touchedmap, spritenum))
+        return;
+
+    bitmap_set(sg_touchedmap, spritenum);
+    sg_touched[sg_numtouched++] = spritenum;
+}
+
+void spritegridFree(void)
+{
+    spritegridactive = 0;
+}
+
+void spritegridBuild(void)
+{
+#ifdef USE_STRUCT_TRACKERS
+    Bmemset(sg_sect, -1, sizeof(sg_sect));
+    Bmemset(sg_head, -1, sizeof(sg_head));
+    Bmemset(sg_loose, -1, sizeof(sg_loose));
+    Bmemset(sg_count, 0, sizeof(sg_count));
+    Bmemset(sg_touchedmap, 0, sizeof(sg_touchedmap));
+
+    sg_numtouched = 0;
+    sg_numsectors = numsectors;
+    sg_rebuild    = 0;
+
+    for (bssize_t i=0; i<numsectors; i++)
+    {
+        int32_t stamp = 0;
+
+        for (bssize_t j=headspritesect[i]; j>=0; j=nextspritesect[j])
+        {
+            sg_sect[j]  = i;
+            sg_stamp[j] = stamp++;
+            sg_count[i]++;
+
+            if (spritegridCanFile(j))
+                spritegridFile(j);
+            else
+            {
+                sg_bucket[j] = -1;
+                spritegridListInsert(sg_loose[i], j);
+            }
+        }
+    }
+
+    spritegridactive = 1;
+#endif
+}
+
+void spritegridRefile(void)
+{
+    if (!spritegridactive)
+        return;
+
+    if (sg_rebuild || sg_numsectors != numsectors)
+    {
+        spritegridBuild();
+        return;
+    }
+
+    for (bssize_t i=0; i<sg_numtouched; i++)
+    {
+        int const spritenum = sg_touched[i];
+
+        bitmap_clear(sg_touchedmap, spritenum);
+
+        if (sg_sect[spritenum] < 0 || sg_bucket[spritenum] >= 0 || !spritegridCanFile(spritenum))
+            continue;
+
+        spritegridListRemove(sg_loose[sg_sect[spritenum]], spritenum);
+        spritegridFile(spritenum);
+    }
+
+    sg_numtouched = 0;
+}
+
+void spritegridLink(int const spritenum, int const sectnum)
+{
+    if (!spritegridactive || (unsigned)sectnum >= (unsigned)sg_numsectors)
+        return;
+
+    if (sg_sect[spritenum] >= 0)
+        spritegridUnlink(spritenum);
+
+    // Sprites are linked at the head (the engine) or the tail (Blood) of their new sector's list.
+    int const next = nextspritesect[spritenum];
+    int const prev = prevspritesect[spritenum];
+
+    if (headspritesect[sectnum] == spritenum && (next < 0 || sg_sect[next] == sectnum))
+        sg_stamp[spritenum] = (next >= 0) ? sg_stamp[next]-1 : 0;
+    else if (next < 0 && prev >= 0 && sg_sect[prev] == sectnum)
+        sg_stamp[spritenum] = sg_stamp[prev]+1;
+    else
+        sg_rebuild = 1;
+
+    sg_sect[spritenum]   = sectnum;
+    sg_bucket[spritenum] = -1;
+    sg_count[sectnum]++;
+
+    spritegridListInsert(sg_loose[sectnum], spritenum);
+    spritegridAddTouched(spritenum);
+}
+
+void spritegridUnlink(int const spritenum)
+{
+    if (!spritegridactive || sg_sect[spritenum] < 0)
+        return;
+
+    spritegridListRemove(spritegridListHead(spritenum), spritenum);
+
+    sg_count[sg_sect[spritenum]]--;
+    sg_sect[spritenum] = -1;
+}
+
+void spritegridTouch(int const spritenum)
+{
+    if (!spritegridactive || sg_sect[spritenum] < 0)
+        return;
+
+    if (sg_bucket[spritenum] >= 0)
+    {
+        spritegridListRemove(sg_head[sg_bucket[spritenum]], spritenum);
+        sg_bucket[spritenum] = -1;
+        spritegridListInsert(sg_loose[sg_sect[spritenum]], spritenum);
+    }
+
+    spritegridAddTouched(spritenum);
+}
+
+static int spritegridCompareStamps(const void *a, const void *b)
+{
+    int32_t const sa = sg_stamp[*(int16_t const *)a];
+    int32_t const sb = sg_stamp[*(int16_t const *)b];
+
+    return (sa > sb) - (sa < sb);
+}
+
+int spritegridQuery(int const sectnum, int32_t const x, int32_t const y, int32_t const radius, int16_t const **list)
+{
+    if (!spritegridactive || sg_rebuild || sg_numsectors != numsectors || (unsigned)sectnum >= (unsigned)numsectors
+        || sg_count[sectnum] < SPRITEGRID_MINSPRITES)
+        return -1;
+
+    int32_t const cx1 = (int32_t)(((int64_t)x - radius) >> SPRITEGRID_SHIFT);
+    int32_t const cy1 = (int32_t)(((int64_t)y - radius) >> SPRITEGRID_SHIFT);
+    int32_t const cx2 = (int32_t)(((int64_t)x + radius) >> SPRITEGRID_SHIFT);
+    int32_t const cy2 = (int32_t)(((int64_t)y + radius) >> SPRITEGRID_SHIFT);
+
+    if (cx2 < cx1 || cy2 < cy1 || (int64_t)(cx2-cx1+1)*(cy2-cy1+1) > SPRITEGRID_MAXCELLS)
+        return -1;
+
+    int num = 0;
+
+    for (bssize_t cy=cy1; cy<=cy2; cy++)
+        for (bssize_t cx=cx1; cx<=cx2; cx++)
+        {
+            // a bucket is shared by all sectors and by any cells hashing to it
+            for (bssize_t j=sg_head[spritegridBucket(cx, cy)]; j>=0; j=sg_next[j])
+                if (sg_sect[j] == sectnum && sg_cell[j].x == cx && sg_cell[j].y == cy)
+                    sg_result[num++] = j;
+        }
+
+    for (bssize_t j=sg_loose[sectnum]; j>=0; j=sg_next[j])
+        sg_result[num++] = j;
+
+    if (num > 1)
+        qsort(sg_result, num, sizeof(int16_t), &spritegridCompareStamps);
+
+    *list = sg_result;
+    return num;
+}
@@ -0,0 +1,200 @@
+// Engine worker thread pool
+
+#include "threadpool.h"
+
+#include "baselayer.h"
+#include "compat.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define MAXPOOLTHREADS 63
+
+struct tpbatch_t
+{
+    threadpoolfunc_t func;
+    void *userdata;
+    int32_t count;
+    std::atomic<int32_t> next;
+    std::atomic<int32_t> done;
+};
+
+static std::thread *tp_threads;
+static int32_t      tp_numthreads = -1;
+
+static std::mutex              tp_mutex;      // protects everything below
+static std::condition_variable tp_wake;       // workers wait for a new batch or shutdown
+static std::condition_variable tp_idle;       // the caller waits for workers to leave a batch
+static tpbatch_t *             tp_batch;
+static uint32_t                tp_generation;
+static int32_t                 tp_active;     // workers currently holding tp_batch
+static bool                    tp_quit;
+
+static std::mutex tp_callmutex;  // serializes threadpoolParallelFor() callers
+static std::mutex tp_initmutex;  // serializes starting and stopping the pool
+
+static thread_local bool tp_injob;  // set while this thread runs jobs of a batch
+
+static void threadpoolRunBatch(tpbatch_t *batch)
+{
+    int32_t index;
+
+    tp_injob = true;
+
+    while ((index = batch->next.fetch_add(1, std::memory_order_relaxed)) < batch->count)
+    {
+        batch->func(index, batch->userdata);
+        batch->done.fetch_add(1, std::memory_order_release);
+    }
+
+    tp_injob = false;
+}
+
+static void threadpoolWorker(void)
+{
+    uint32_t generation = 0;
+
+    std::unique_lock<std::mutex> lock(tp_mutex);
+
+    for (;;)
+    {
+        tp_wake.wait(lock, [&]{ return tp_quit || generation != tp_generation; });
+
+        if (tp_quit)
+            return;
+
+        generation = tp_generation;
+
+        tpbatch_t *const batch = tp_batch;
+
+        if (batch == nullptr)
+            continue;
+
+        tp_active++;
+        lock.unlock();
+
+        threadpoolRunBatch(batch);
+
+        lock.lock();
+        if (--tp_active == 0)
+            tp_idle.notify_one();
+    }
+}
+
+static void threadpoolStop(void)
+{
+    if (tp_numthreads < 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(tp_mutex);
+        tp_quit = true;
+    }
+    tp_wake.notify_all();
+
+    for (native_t i = 0; i < tp_numthreads; i++)
+        tp_threads[i].join();
+
+    delete[] tp_threads;
+    tp_threads = nullptr;
+    tp_numthreads = -1;
+}
+
+static int32_t threadpoolStart(int32_t numthreads)
+{
+    threadpoolStop();
+
+    if (numthreads <= 0)
+        numthreads = (int32_t)std::thread::hardware_concurrency() - 1;
+
+    tp_numthreads = clamp(numthreads, 0, MAXPOOLTHREADS);
+    tp_quit = false;
+
+    if (tp_numthreads > 0)
+    {
+        tp_threads = new std::thread[tp_numthreads];
+
+        for (native_t i = 0; i < tp_numthreads; i++)
+            tp_threads[i] = std::thread(threadpoolWorker);
+    }
+
+    initprintf("Thread pool: %d worker thread%s\n", tp_numthreads, tp_numthreads == 1 ? "" : "s");
+
+    return tp_numthreads;
+}
+
+// Starts the pool with the default number of workers if nobody has started it yet and returns the
+// number of workers.
+static int32_t threadpoolCheckInit(void)
+{
+    std::lock_guard<std::mutex> lock(tp_initmutex);
+
+    if (tp_numthreads < 0)
+        threadpoolStart(0);
+
+    return tp_numthreads;
+}
+
+int32_t threadpoolInit(int32_t numthreads)
+{
+    Bassert(!tp_injob);
+
+    std::lock_guard<std::mutex> lock(tp_initmutex);
+    return threadpoolStart(numthreads);
+}
+
+void threadpoolUninit(void)
+{
+    Bassert(!tp_injob);
+
+    std::lock_guard<std::mutex> lock(tp_initmutex);
+    threadpoolStop();
+}
+
+int32_t threadpoolGetNumThreads(void)
+{
+    return threadpoolCheckInit() + 1;
+}
+
+void threadpoolParallelFor(int32_t count, threadpoolfunc_t func, void *userdata)
+{
+    if (count <= 0)
+        return;
+
+    // A job asking for another batch would wait for workers that may include its own thread, so
+    // nested calls run serially on the calling worker.
+    if (count == 1 || tp_injob || threadpoolCheckInit() == 0)
+    {
+        for (native_t i = 0; i < count; i++)
+            func(i, userdata);
+        return;
+    }
+
+    std::lock_guard<std::mutex> calllock(tp_callmutex);
+
+    tpbatch_t batch;
+
+    batch.func     = func;
+    batch.userdata = userdata;
+    batch.count    = count;
+    batch.next.store(0, std::memory_order_relaxed);
+    batch.done.store(0, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(tp_mutex);
+        tp_batch = &batch;
+        tp_generation++;
+    }
+    tp_wake.notify_all();
+
+    threadpoolRunBatch(&batch);
+
+    // Workers that never picked up the batch must not see it once we return.
+    std::unique_lock<std::mutex> lock(tp_mutex);
+    tp_batch = nullptr;
+    tp_idle.wait(lock, []{ return tp_active == 0; });
+
+    Bassert(batch.done.load(std::memory_order_acquire) == count);
+}
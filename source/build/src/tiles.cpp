@@ -9,13 +9,19 @@
 #include "baselayer.h"
 #include "build.h"
 #include "cache1d.h"
+#include "colmatch.h"
 #include "compat.h"
 #include "crc32.h"
 #include "engine_priv.h"
 #include "lz4.h"
+#include "mpmcqueue.h"
 #include "texcache.h"
 #include "vfs.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 static void *g_vm_data;
 
 // The tile file number (tilesXXX <- this) of each tile:
@@ -46,12 +52,15 @@ static char mapartfilename[BMAX_PATH];  // map-specific ART file name
 static int32_t mapartfnXXofs;  // byte offset to 'XX' (the number part) in the above
 static int32_t artfilnum, artfilplc;
 static buildvfs_kfd artfil;
+static char const *artfilmap;  // artfil's contents when they can be mapped, see kmapview()
+static int32_t artfilmapleng;
 
 ////////// Per-map ART file loading //////////
 
 // Some forward declarations.
 static const char *artGetIndexedFileName(int32_t tilefilei);
 static int32_t artReadIndexedFile(int32_t tilefilei);
+static void tileloadReset(void);
 
 static inline void artClearMapArtFilename(void)
 {
@@ -87,6 +96,7 @@ void artClearMapArt(void)
     if (g_bakTileFileNum == NULL)
         return;  // per-map ART N/A
 
+    tileloadReset();
     artClearMapArtFilename();
 
     if (artfilnum >= MAXARTFILES_BASE)
@@ -94,6 +104,7 @@ void artClearMapArt(void)
         kclose(artfil);
 
         artfil = buildvfs_kfd_invalid;
+        artfilmap = NULL;
         artfilnum = -1;
         artfilplc = 0L;
     }
@@ -583,6 +594,7 @@ static int32_t artReadIndexedFile(int32_t tilefilei)
 //
 int32_t artLoadFiles(const char *filename, int32_t askedsize)
 {
+    tileloadReset();
     Bstrncpyz(artfilenameformat, filename, sizeof(artfilenameformat));
 
     Bmemset(&tilesiz[0], 0, sizeof(vec2_16_t) * MAXTILES);
@@ -605,6 +617,7 @@ int32_t artLoadFiles(const char *filename, int32_t askedsize)
     artUpdateManifest();
 
     artfil = buildvfs_kfd_invalid;
+    artfilmap = NULL;
     artfilnum = -1;
     artfilplc = 0L;
 
@@ -615,7 +628,10 @@ int32_t artLoadFiles(const char *filename, int32_t askedsize)
 //
 // loadtile
 //
+static void tileInvalidateTextures(int16_t tilenume);
 static void tilePostLoad(int16_t tilenume);
+static void tileWaitLoad(int16_t tilenume);
+static uint8_t tileloadpending[(MAXTILES+7)>>3];
 
 bool (*rt_tileload_callback)(int16_t tileNum) = nullptr;
 
@@ -625,16 +641,32 @@ bool tileLoad(int16_t tileNum)
     int const dasiz = tilesiz[tileNum].x*tilesiz[tileNum].y;
     if (dasiz <= 0) return 0;
 
+    if (bitmap_test(tileloadpending, tileNum))
+    {
+        tileWaitLoad(tileNum);
+
+        if (waloff[tileNum] != 0)
+            return true;
+    }
+
     // Allocate storage if necessary.
     if (waloff[tileNum] == 0)
     {
         walock[tileNum] = CACHE1D_UNLOCKED;
-        g_cache.allocateBlock(&waloff[tileNum], dasiz, &walock[tileNum]);
+        g_cache.allocateBlock(&waloff[tileNum], dasiz, &walock[tileNum], CACHE1D_CAT_TILE);
     }
 
     if (!duke64 || !rt_tileload_callback || !rt_tileload_callback(tileNum))
         tileLoadData(tileNum, dasiz, (char *) waloff[tileNum]);
 
+    tileInvalidateTextures(tileNum);
+    tilePostLoad(tileNum);
+
+    return (waloff[tileNum] != 0 && tilesiz[tileNum].x > 0 && tilesiz[tileNum].y > 0);
+}
+
+static void tileInvalidateTextures(int16_t tilenume)
+{
 #ifdef USE_OPENGL
     if (videoGetRenderMode() >= REND_POLYMOST &&
         in3dmode())
@@ -643,15 +675,279 @@ bool tileLoad(int16_t tileNum)
         int type;
         for (type = 0; type <= 1; ++type)
         {
-            gltexinvalidate(tileNum, 0, (type ? DAMETH_CLAMPED : DAMETH_MASK) | DAMETH_INDEXED);
-            texcache_fetch(tileNum, 0, 0, (type ? DAMETH_CLAMPED : DAMETH_MASK) | DAMETH_INDEXED);
+            gltexinvalidate(tilenume, 0, (type ? DAMETH_CLAMPED : DAMETH_MASK) | DAMETH_INDEXED);
+            texcache_fetch(tilenume, 0, 0, (type ? DAMETH_CLAMPED : DAMETH_MASK) | DAMETH_INDEXED);
         }
     }
+#else
+    UNREFERENCED_PARAMETER(tilenume);
 #endif
+}
 
-    tilePostLoad(tileNum);
+//
+// Background tile loading
+//
+// Loader threads read tiles from their ART file into private buffers through handles of their own
+// (kpopen), so neither the VFS nor the tile cache is touched off the main thread; tileFinishLoads()
+// moves the finished buffers into the cache between frames. Until then, tiles queued by
+// tileLoadAsync() point at a shared placeholder. Tiles first wanted for a masked draw get one
+// filled with the transparent index 255, so nothing shows where they go. The others get one filled
+// with the color closest to black, which shade, fog and translucency tables may still tint.
+//
 
-    return (waloff[tileNum] != 0 && tilesiz[tileNum].x > 0 && tilesiz[tileNum].y > 0);
+#define TILELOAD_MAXTHREADS      8
+#define TILELOAD_QUEUESIZE       4096
+#define TILELOAD_PLACEHOLDERSIZE (512*512)
+
+int32_t r_tileloadthreads;
+
+typedef struct
+{
+    char *  buffer;  // NULL if the read failed
+    int32_t offset, size;
+    int16_t tile;
+    uint8_t artfile;
+} tileloadreq_t;
+
+static mpmcqueue<tileloadreq_t, TILELOAD_QUEUESIZE> tileloadrequests, tileloadfinished;
+
+static std::thread *            tileloadthreads;
+static int32_t                  tileloadnumthreads;
+static std::mutex               tileloadmutex;
+static std::condition_variable  tileloadwake;
+static bool                     tileloadquit;
+
+// main thread only
+static int32_t      tileloadnumpending;  // queued and not yet collected by tileFinishLoads()
+static buildvfs_pfd tileloadartpfd[MAXARTFILES_TOTAL];
+static int8_t       tileloadartstate[MAXARTFILES_TOTAL];  // 0: not opened yet, 1: open, -1: unusable
+static char         tileloadplaceholder[TILELOAD_PLACEHOLDERSIZE];
+static char         tileloadmaskedplaceholder[TILELOAD_PLACEHOLDERSIZE];
+
+static void tileloadWorker(void)
+{
+    tileloadreq_t req;
+
+    for (;;)
+    {
+        if (!tileloadrequests.pop(&req))
+        {
+            std::unique_lock<std::mutex> lock(tileloadmutex);
+            tileloadwake.wait(lock, []{ return tileloadquit || !tileloadrequests.empty(); });
+
+            if (tileloadquit)
+                return;
+
+            continue;
+        }
+
+        if (kpread(&tileloadartpfd[req.artfile], req.buffer, req.size, req.offset) != req.size)
+            DO_FREE_AND_NULL(req.buffer);
+
+        while (!tileloadfinished.push(req))
+            std::this_thread::yield();
+    }
+}
+
+static void tileloadStop(void)
+{
+    if (tileloadnumthreads == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(tileloadmutex);
+        tileloadquit = true;
+    }
+    tileloadwake.notify_all();
+
+    for (native_t i = 0; i < tileloadnumthreads; i++)
+        tileloadthreads[i].join();
+
+    delete[] tileloadthreads;
+    tileloadthreads = nullptr;
+    tileloadnumthreads = 0;
+}
+
+static void tileloadStart(void)
+{
+    // the number of threads can only change while nothing is queued
+    if (tileloadnumthreads == r_tileloadthreads || tileloadnumpending != 0)
+        return;
+
+    tileloadStop();
+
+    tileloadquit = false;
+    tileloadnumthreads = clamp(r_tileloadthreads, 0, TILELOAD_MAXTHREADS);
+
+    if (tileloadnumthreads == 0)
+        return;
+
+    Bmemset(tileloadplaceholder, paletteGetClosestColorUpToIndex(0, 0, 0, 254), sizeof(tileloadplaceholder));
+    Bmemset(tileloadmaskedplaceholder, 255, sizeof(tileloadmaskedplaceholder));
+
+    tileloadthreads = new std::thread[tileloadnumthreads];
+
+    for (native_t i = 0; i < tileloadnumthreads; i++)
+        tileloadthreads[i] = std::thread(tileloadWorker);
+}
+
+static int tileloadOpenArtFile(int const tfn)
+{
+    if (tileloadartstate[tfn] == 0)
+    {
+        buildvfs_kfd const fil = kopen4loadfrommod(artGetIndexedFileName(tfn), 0);
+
+        tileloadartstate[tfn] = -1;
+
+        if (fil != buildvfs_kfd_invalid)
+        {
+            if (kpopen(fil, &tileloadartpfd[tfn]) == 0)
+                tileloadartstate[tfn] = 1;
+
+            kclose(fil);
+        }
+    }
+
+    return tileloadartstate[tfn] == 1;
+}
+
+static bool tileloadQueue(int16_t const tilenume, int32_t const dasiz)
+{
+    if (r_tileloadthreads <= 0 || tileloadnumpending >= TILELOAD_QUEUESIZE)
+        return false;
+
+    // rotated, generated and console-specific tiles are loaded the usual way
+    if (rottile[tilenume].owner != -1 || (faketile[tilenume>>3] & pow2char[tilenume&7]) || (duke64 && rt_tileload_callback))
+        return false;
+
+    int const tfn = tilefilenum[tilenume];
+
+    if (tfn >= MAXARTFILES_TOTAL || !tileloadOpenArtFile(tfn))
+        return false;
+
+    tileloadStart();
+
+    if (tileloadnumthreads == 0)
+        return false;
+
+    tileloadreq_t const req = { (char *)Xmalloc(dasiz), tilefileoffs[tilenume], dasiz, tilenume, (uint8_t)tfn };
+
+    tileloadrequests.push(req);
+    {
+        std::lock_guard<std::mutex> lock(tileloadmutex);
+    }
+    tileloadwake.notify_one();
+
+    bitmap_set(tileloadpending, tilenume);
+    tileloadnumpending++;
+
+    return true;
+}
+
+static void tileloadCollect(tileloadreq_t const &req)
+{
+    int16_t const tilenume = req.tile;
+    bool const placeholder = waloff[tilenume] == (intptr_t)tileloadplaceholder || waloff[tilenume] == (intptr_t)tileloadmaskedplaceholder;
+
+    bitmap_clear(tileloadpending, tilenume);
+    tileloadnumpending--;
+
+    // the tile may have been deleted, replaced or created in the meantime
+    if (req.buffer != NULL && (placeholder || waloff[tilenume] == 0) && tilesiz[tilenume].x*tilesiz[tilenume].y == req.size
+        && tilefilenum[tilenume] == req.artfile && tilefileoffs[tilenume] == req.offset && !(faketile[tilenume>>3] & pow2char[tilenume&7]))
+    {
+        waloff[tilenume] = 0;
+        walock[tilenume] = CACHE1D_UNLOCKED;
+        g_cache.allocateBlock(&waloff[tilenume], req.size, &walock[tilenume], CACHE1D_CAT_TILE);
+        Bmemcpy((char *)waloff[tilenume], req.buffer, req.size);
+
+        tileInvalidateTextures(tilenume);
+        tilePostLoad(tilenume);
+    }
+    else if (placeholder)
+        waloff[tilenume] = 0;
+
+    Xfree(req.buffer);
+}
+
+void tileFinishLoads(void)
+{
+    tileloadreq_t req;
+
+    while (tileloadnumpending != 0 && tileloadfinished.pop(&req))
+        tileloadCollect(req);
+}
+
+static void tileWaitLoad(int16_t tilenume)
+{
+    while (bitmap_test(tileloadpending, tilenume))
+    {
+        tileloadreq_t req;
+
+        if (tileloadfinished.pop(&req))
+            tileloadCollect(req);
+        else
+            std::this_thread::yield();
+    }
+}
+
+// Waits for everything queued and forgets the open ART files; called whenever they change.
+static void tileloadReset(void)
+{
+    while (tileloadnumpending != 0)
+    {
+        tileloadreq_t req;
+
+        if (tileloadfinished.pop(&req))
+        {
+            DO_FREE_AND_NULL(req.buffer);
+            tileloadCollect(req);
+        }
+        else
+            std::this_thread::yield();
+    }
+
+    for (native_t i = 0; i < MAXARTFILES_TOTAL; i++)
+    {
+        if (tileloadartstate[i] == 1)
+            kpclose(&tileloadartpfd[i]);
+
+        tileloadartstate[i] = 0;
+    }
+}
+
+bool tileLoadAsync(int16_t tileNum, bool masked /*= false*/)
+{
+    if ((unsigned) tileNum >= (unsigned) MAXTILES) return 0;
+    int const dasiz = tilesiz[tileNum].x*tilesiz[tileNum].y;
+    if (dasiz <= 0) return 0;
+
+    if (waloff[tileNum] != 0)
+        return true;
+
+    if (dasiz <= TILELOAD_PLACEHOLDERSIZE && (bitmap_test(tileloadpending, tileNum) || tileloadQueue(tileNum, dasiz)))
+    {
+        waloff[tileNum] = (intptr_t)(masked ? tileloadmaskedplaceholder : tileloadplaceholder);
+        return true;
+    }
+
+    return tileLoad(tileNum);
+}
+
+bool tileIsLoading(int16_t tileNum)
+{
+    return (unsigned) tileNum < (unsigned) MAXTILES && bitmap_test(tileloadpending, tileNum);
+}
+
+void tilePrefetch(int16_t tileNum)
+{
+    if ((unsigned) tileNum >= (unsigned) MAXTILES || waloff[tileNum] != 0 || bitmap_test(tileloadpending, tileNum))
+        return;
+
+    int const dasiz = tilesiz[tileNum].x*tilesiz[tileNum].y;
+
+    if (dasiz > 0)
+        tileloadQueue(tileNum, dasiz);
 }
 
 void tileMaybeRotate(int16_t tilenume)
@@ -681,7 +977,8 @@ void tileLoadData(int16_t tilenume, int32_t dasiz, char *buffer)
 
     if (owner != -1)
     {
-        if (!waloff[owner])
+        // never rotate the placeholder's pixels
+        if (!waloff[owner] || bitmap_test(tileloadpending, owner))
             tileLoad(owner);
 
         if (waloff[tilenume])
@@ -714,16 +1011,24 @@ void tileLoadData(int16_t tilenume, int32_t dasiz, char *buffer)
 
         if (artfil == buildvfs_kfd_invalid)
         {
+            artfilmap = NULL;
             initprintf("Failed opening ART file \"%s\"!\n", fn);
             return;
         }
 
+        artfilmap = (char const *)kmapview(artfil, &artfilmapleng);
         artfilnum = tfn;
         artfilplc = 0L;
 
         faketimerhandler();
     }
 
+    if (artfilmap && tilefileoffs[tilenume] + dasiz <= artfilmapleng)
+    {
+        Bmemcpy(buffer, artfilmap + tilefileoffs[tilenume], dasiz);
+        return;
+    }
+
     // Seek to the right position.
     if (artfilplc != tilefileoffs[tilenume])
     {
@@ -832,7 +1137,7 @@ intptr_t tileCreate(int16_t tilenume, int32_t xsiz, int32_t ysiz)
     int const dasiz = xsiz*ysiz;
 
     walock[tilenume] = CACHE1D_PERMANENT;
-    g_cache.allocateBlock(&waloff[tilenume], dasiz, &walock[tilenume]);
+    g_cache.allocateBlock(&waloff[tilenume], dasiz, &walock[tilenume], CACHE1D_CAT_TILE);
 
     tileSetSize(tilenume, xsiz, ysiz);
     Bmemset(&picanm[tilenume], 0, sizeof(picanm_t));
@@ -853,8 +1158,8 @@ void tileCopySection(int32_t tilenume1, int32_t sx1, int32_t sy1, int32_t xsiz,
     xsiz2 = tilesiz[tilenume2].x; ysiz2 = tilesiz[tilenume2].y;
     if ((xsiz1 > 0) && (ysiz1 > 0) && (xsiz2 > 0) && (ysiz2 > 0))
     {
-        if (waloff[tilenume1] == 0) tileLoad(tilenume1);
-        if (waloff[tilenume2] == 0) tileLoad(tilenume2);
+        if (waloff[tilenume1] == 0 || bitmap_test(tileloadpending, tilenume1)) tileLoad(tilenume1);
+        if (waloff[tilenume2] == 0 || bitmap_test(tileloadpending, tilenume2)) tileLoad(tilenume2);
 
         x1 = sx1;
         for (i=0; i<xsiz; i++)
@@ -882,8 +1187,13 @@ void tileCopySection(int32_t tilenume1, int32_t sx1, int32_t sy1, int32_t xsiz,
 
 void Buninitart(void)
 {
+    tileloadReset();
+    tileloadStop();
+
     if (artfil != buildvfs_kfd_invalid)
         kclose(artfil);
 
+    artfilmap = NULL;
+
     DO_FREE_AND_NULL(g_vm_data);
 }
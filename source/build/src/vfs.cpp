@@ -15,6 +15,17 @@
 #include "vfs.h"
 #include "cache1d.h"
 
+#ifndef USE_PHYSFS
+#include "mio.hpp"
+
+// mio uses OS file handles on Windows and regular int file descriptors elsewhere
+#ifdef _WIN32
+# define MIO_HANDLE_FROM_FD(fd) (mio::file_handle_type)(_get_osfhandle(fd))
+#else
+# define MIO_HANDLE_FROM_FD(fd) (mio::file_handle_type)(fd)
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -456,6 +467,10 @@ static char *gfilelist[MAXGROUPFILES];
 static char *groupname[MAXGROUPFILES];
 static int32_t *gfileoffs[MAXGROUPFILES];
 
+// Group files read from the disk directly are mapped into memory as a whole; kread() copies out of
+// the mapping and kmapview() hands out pointers into it.
+static mio::mmap_source groupmap[MAXGROUPFILES];
+
 static uint8_t filegrp[MAXOPENFILES];
 static int32_t filepos[MAXOPENFILES];
 static intptr_t filehan[MAXOPENFILES] =
@@ -466,10 +481,20 @@ static intptr_t filehan[MAXOPENFILES] =
     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
 };
 
+// mappings kmapview() made of files opened from the disk, released by kclose()
+static mio::mmap_source filemap[MAXOPENFILES];
+
 #ifdef WITHKPLIB
 static char filenamsav[MAXOPENFILES][260];
 static int32_t kzcurhand = -1;
 
+// ZIP archives kmapview() has mapped for entries stored in them uncompressed
+static struct
+{
+    char *name;
+    mio::mmap_source map;
+} zipmap[MAXGROUPFILES];
+
 int32_t cache1d_file_fromzip(buildvfs_kfd fil)
 {
     return (filegrp[fil] == GRP_ZIP);
@@ -481,6 +506,16 @@ static int32_t kread_grp(int32_t handle, void *buffer, int32_t leng);
 static int32_t klseek_grp(int32_t handle, int32_t offset, int32_t whence);
 static void kclose_grp(int32_t handle);
 
+static void kmapgroup(int32_t const groupnum)
+{
+    if (groupfilgrp[groupnum] != GRP_FILESYSTEM)
+        return;
+
+    // no mapping just means the group is read with seeks and reads instead
+    std::error_code error;
+    groupmap[groupnum].map(MIO_HANDLE_FROM_FD(groupfil[groupnum]), 0, mio::map_entire_file, error);
+}
+
 int initgroupfile(const char *filename)
 {
     char buf[70];
@@ -543,6 +578,7 @@ int initgroupfile(const char *filename)
         }
         gfileoffs[numgroupfiles][gnumfiles[numgroupfiles]] = j;
         groupname[numgroupfiles] = Xstrdup(filename);
+        kmapgroup(numgroupfiles);
         return numgroupfiles++;
     }
     klseek_grp(numgroupfiles, 0, BSEEK_SET);
@@ -646,6 +682,7 @@ int initgroupfile(const char *filename)
         }
         gfileoffs[numgroupfiles][gnumfiles[numgroupfiles]] = j;
         groupname[numgroupfiles] = Xstrdup(filename);
+        kmapgroup(numgroupfiles);
         return numgroupfiles++;
     }
 
@@ -664,6 +701,7 @@ void uninitgroupfile(void)
             DO_FREE_AND_NULL(gfileoffs[i]);
             DO_FREE_AND_NULL(groupname[i]);
 
+            groupmap[i].unmap();
             Bclose(groupfil[i]);
             groupfil[i] = -1;
         }
@@ -675,6 +713,14 @@ void uninitgroupfile(void)
         if (filegrp[i] < GRP_RESERVED_ID_START)   // JBF 20040130: not external or ZIPped
             filehan[i] = -1;
     }
+
+#ifdef WITHKPLIB
+    for (auto &zip : zipmap)
+    {
+        DO_FREE_AND_NULL(zip.name);
+        zip.map.unmap();
+    }
+#endif
 }
 
 #ifdef FILENAME_CASE_CHECK
@@ -915,6 +961,22 @@ int32_t kread_internal(int32_t handle, void *buffer, int32_t leng, const uint8_t
     if (EDUKE32_PREDICT_TRUE(groupfil[rootgroupnum] != -1))
     {
         i += gfileoffs[groupnum][filenum]+arraypos[handle];
+
+        auto const &map = groupmap[rootgroupnum];
+
+        if (map.is_mapped())
+        {
+            leng = min(leng,(gfileoffs[groupnum][filenum+1]-gfileoffs[groupnum][filenum])-arraypos[handle]);
+            leng = min(leng,(int32_t)map.size()-i);
+
+            if (leng <= 0)
+                return 0;
+
+            Bmemcpy(buffer, map.data()+i, leng);
+            arraypos[handle] += leng;
+            return leng;
+        }
+
         if (i != groupfilpos[rootgroupnum])
         {
             Blseek(groupfil[rootgroupnum],i,BSEEK_SET);
@@ -1048,6 +1110,9 @@ int32_t ktell(int32_t handle)
 }
 void kclose(int32_t handle)
 {
+    if (handle >= 0)
+        filemap[handle].unmap();
+
     return kclose_internal(handle, filegrp, filehan);
 }
 
@@ -1063,6 +1128,190 @@ static void kclose_grp(int32_t handle)
 {
     return kclose_internal(handle, groupfilgrp, groupfil);
 }
+
+#ifdef WITHKPLIB
+static void const *kmapzip(const char *filename, int32_t *length)
+{
+    char *zipnam;
+    int32_t offs, leng;
+
+    if (!kzfindstored(filename, &zipnam, &offs, &leng))
+        return NULL;
+
+    for (auto &zip : zipmap)
+    {
+        if (zip.name && Bstrcmp(zip.name, zipnam))
+            continue;
+
+        if (!zip.name)
+        {
+            std::error_code error;
+            zip.map.map(zipnam, 0, mio::map_entire_file, error);
+
+            if (error)
+                return NULL;
+
+            zip.name = Xstrdup(zipnam);
+        }
+
+        if (offs + leng > (int32_t)zip.map.size())
+            return NULL;
+
+        *length = leng;
+        return zip.map.data() + offs;
+    }
+
+    return NULL;
+}
+#endif
+
+void const *kmapview(int32_t handle, int32_t *length)
+{
+    int32_t groupnum = filegrp[handle];
+
+    if (groupnum == GRP_FILESYSTEM)
+    {
+        auto &map = filemap[handle];
+
+        if (!map.is_mapped())
+        {
+            std::error_code error;
+            map.map(MIO_HANDLE_FROM_FD(filehan[handle]), 0, mio::map_entire_file, error);
+
+            if (error)
+                return NULL;
+        }
+
+        *length = map.size();
+        return map.data();
+    }
+#ifdef WITHKPLIB
+    else if (groupnum == GRP_ZIP)
+        return kmapzip(filenamsav[handle], length);
+#endif
+
+    if (groupnum >= MAXGROUPFILES || groupfil[groupnum] == -1)
+        return NULL;
+
+    int32_t const filenum = filehan[handle];
+    int32_t base = gfileoffs[groupnum][filenum];
+    int32_t const leng = gfileoffs[groupnum][filenum+1] - base;
+
+    // groups nested in other groups, see kread_internal()
+    while (groupfilgrp[groupnum] != GRP_FILESYSTEM)
+    {
+        int32_t const parent = groupfilgrp[groupnum];
+
+        if (parent >= MAXGROUPFILES)
+            return NULL;
+
+        base += gfileoffs[parent][groupfil[groupnum]];
+        groupnum = parent;
+    }
+
+    auto const &map = groupmap[groupnum];
+
+    if (!map.is_mapped() || base + leng > (int32_t)map.size())
+        return NULL;
+
+    *length = leng;
+    return map.data() + base;
+}
+
+int32_t kpopen(int32_t handle, buildvfs_pfd *pfd)
+{
+    int32_t groupnum = filegrp[handle];
+    intptr_t fd;
+
+    pfd->fd = -1;
+
+    if (groupnum == GRP_FILESYSTEM)
+    {
+        fd = filehan[handle];
+        pfd->base = 0;
+        pfd->length = buildvfs_length(fd);
+    }
+    else
+    {
+        if (groupnum >= MAXGROUPFILES || groupfil[groupnum] == -1)
+            return -1;
+
+        int32_t const filenum = filehan[handle];
+
+        pfd->base = gfileoffs[groupnum][filenum];
+        pfd->length = gfileoffs[groupnum][filenum+1] - pfd->base;
+
+        // groups nested in other groups, see kread_internal()
+        while (groupfilgrp[groupnum] != GRP_FILESYSTEM)
+        {
+            int32_t const parent = groupfilgrp[groupnum];
+
+            if (parent >= MAXGROUPFILES)
+                return -1;
+
+            pfd->base += gfileoffs[parent][groupfil[groupnum]];
+            groupnum = parent;
+        }
+
+        if (groupfil[groupnum] == -1)
+            return -1;
+
+        fd = groupfil[groupnum];
+    }
+
+#ifdef _WIN32
+    // A duplicated handle would share its file pointer with the original, which positional reads on
+    // synchronous handles move. ReOpenFile() is not available before Vista.
+    typedef HANDLE (WINAPI *reopenfile_t)(HANDLE, DWORD, DWORD, DWORD);
+    static reopenfile_t const reopenfile = (reopenfile_t)(intptr_t)GetProcAddress(GetModuleHandle("kernel32.dll"), "ReOpenFile");
+
+    if (reopenfile == NULL)
+        return -1;
+
+    HANDLE const h = reopenfile((HANDLE)_get_osfhandle(fd), GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE, 0);
+
+    if (h == INVALID_HANDLE_VALUE)
+        return -1;
+
+    pfd->fd = (intptr_t)h;
+#else
+    if ((pfd->fd = dup(fd)) < 0)
+        return -1;
+#endif
+
+    return 0;
+}
+
+int32_t kpread(buildvfs_pfd const *pfd, void *buffer, int32_t leng, int32_t offset)
+{
+    leng = min(leng, pfd->length - offset);
+
+    if (leng <= 0)
+        return 0;
+
+#ifdef _WIN32
+    OVERLAPPED ov = {};
+    ov.Offset = pfd->base + offset;
+
+    DWORD numread;
+    return ReadFile((HANDLE)pfd->fd, buffer, leng, &numread, &ov) ? (int32_t)numread : -1;
+#else
+    return pread(pfd->fd, buffer, leng, pfd->base + offset);
+#endif
+}
+
+void kpclose(buildvfs_pfd *pfd)
+{
+    if (pfd->fd == -1)
+        return;
+
+#ifdef _WIN32
+    CloseHandle((HANDLE)pfd->fd);
+#else
+    close(pfd->fd);
+#endif
+    pfd->fd = -1;
+}
 #endif
 
 int32_t klistaddentry(BUILDVFS_FIND_REC **rec, const char *name, int32_t type, int32_t source)
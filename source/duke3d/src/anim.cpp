@@ -434,7 +434,7 @@ int32_t Anim_Play(const char *fn)
     anim->animlock = CACHE1D_PERMANENT;
 
     if (!anim->animbuf)
-        g_cache.allocateBlock((intptr_t *)&anim->animbuf, length + 1, &anim->animlock);
+        g_cache.allocateBlock((intptr_t *)&anim->animbuf, length + 1, &anim->animlock, CACHE1D_CAT_ANIM);
 
     kread(handle, anim->animbuf, length);
     kclose(handle);
@@ -112,6 +112,8 @@ void G_ShowDebugHelp(void)
         "-nm\t\tDisable music\n"
         "-q#\t\tFake multiplayer with # players\n"
         "-z#/-condebug\tEnable line-by-line CON compile debugging at level #\n"
+        "-noconopt\tCompile CON scripts without the bytecode optimizations\n"
+        "-conprofile [file]\tWrite where CON code spends its time as flame graph stacks on exit (default conprofile.txt)\n"
         "-conversion YYYYMMDD\tSelects CON script version for compatibility with older mods\n"
         "-rotatesprite-no-widescreen\tStretch screen drawing from scripts to fullscreen\n"
         ;
@@ -504,6 +506,25 @@ void G_CheckCommandLine(int32_t argc, char const * const * argv)
                     i++;
                     continue;
                 }
+                if (!Bstrcasecmp(c+1, "noconopt"))
+                {
+                    g_scriptOptimize = 0;
+                    i++;
+                    continue;
+                }
+                if (!Bstrcasecmp(c+1, "conprofile"))
+                {
+                    // the file name is optional, so the next switch is not one
+                    if (argc > i+1 && argv[i+1][0] != '-')
+                    {
+                        VM_ProfileStart(argv[i+1]);
+                        i++;
+                    }
+                    else
+                        VM_ProfileStart("conprofile.txt");
+                    i++;
+                    continue;
+                }
                 if (!Bstrcasecmp(c+1, "nologo") || !Bstrcasecmp(c+1, "quick"))
                 {
                     g_noLogo = 1;
@@ -285,6 +285,7 @@ void CONFIG_SetDefaults(void)
     ud.crosshair              = 1;
     ud.crosshairscale         = 50;
     ud.default_skill          = 1;
+    ud.deltasaves             = 0;
     ud.democams               = 1;
     ud.detail                 = 0;
     ud.display_bonus_screen   = 1;
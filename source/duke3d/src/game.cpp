@@ -325,6 +325,9 @@ void G_GameExit(const char *msg)
 
     if (*msg != 0) initprintf("%s\n",msg);
 
+    VM_ProfileStop();
+    sv_stopsavethread();
+
     if (in3dmode())
         G_Shutdown();
 
@@ -869,7 +872,7 @@ void G_DrawRooms(int32_t playerNum, int32_t smoothRatio)
             walock[TILE_SAVESHOT] = CACHE1D_PERMANENT;
 
             if (waloff[TILE_SAVESHOT] == 0)
-                g_cache.allocateBlock(&waloff[TILE_SAVESHOT],200*320,&walock[TILE_SAVESHOT]);
+                g_cache.allocateBlock(&waloff[TILE_SAVESHOT],200*320,&walock[TILE_SAVESHOT],CACHE1D_CAT_TILE);
 
             if (videoGetRenderMode() == REND_CLASSIC)
                 renderSetTarget(TILE_SAVESHOT, 200, 320);
@@ -929,7 +932,7 @@ void G_DrawRooms(int32_t playerNum, int32_t smoothRatio)
 
                 walock[TILE_TILT] = CACHE1D_PERMANENT;
                 if (waloff[TILE_TILT] == 0)
-                    g_cache.allocateBlock(&waloff[TILE_TILT], maxTiltSize, &walock[TILE_TILT]);
+                    g_cache.allocateBlock(&waloff[TILE_TILT], maxTiltSize, &walock[TILE_TILT], CACHE1D_CAT_TILE);
 
                 renderSetTarget(TILE_TILT, viewtilexsiz, viewtileysiz);
 
@@ -6052,6 +6055,7 @@ static void G_Startup(void)
     initcrc32table();
 
     G_CompileScripts();
+    G_StartupPhase("CON");
 
     if (engineInit())
         G_FatalEngineInitError();
@@ -6134,6 +6138,8 @@ static void G_Startup(void)
     if (artLoadFiles("tiles%03i.art",MAXCACHE1DSIZE) < 0)
         G_GameExit("Failed loading art.");
 
+    G_StartupPhase("art");
+
     // Make the fullscreen nuke logo background non-fullbright.  Has to be
     // after dynamic tile remapping (from C_Compile) and loading tiles.
     picanm[LOADSCREEN].sf |= PICANM_NOFULLBRIGHT_BIT;
@@ -6494,7 +6500,9 @@ int app_main(int argc, char const* const* argv)
     if (Bstrcmp(g_setupFileName, SETUPFILENAME))
         initprintf("Using config file \"%s\".\n",g_setupFileName);
 
+    G_StartupPhase(NULL);
     G_ScanGroups();
+    G_StartupPhase("group scan");
 
 #ifdef STARTUP_SETUP_WINDOW
     if (!Bgetenv("SteamTenfoot") && (readSetup < 0 || (!g_noSetup && (ud.configversion != BYTEVERSION_EDUKE32 || ud.setup.forcesetup)) || g_commandSetup))
@@ -6507,6 +6515,8 @@ int app_main(int argc, char const* const* argv)
     }
 #endif
 
+    G_StartupPhase(NULL);  // don't count time spent in the setup window
+
     g_logFlushWindow = 0;
     G_LoadGroups(!g_noAutoLoad && !ud.setup.noautoload);
 //    flushlogwindow = 1;
@@ -6573,6 +6583,7 @@ int app_main(int argc, char const* const* argv)
     for (int i=0; i<MAXPLAYERS; i++)
         G_MaybeAllocPlayer(i);
 
+    G_StartupPhase("groups");
     G_Startup(); // a bunch of stuff including compiling cons
 
     g_player[0].playerquitflag = 1;
@@ -6605,6 +6616,8 @@ int app_main(int argc, char const* const* argv)
         Xfree(m);
     g_defModules.clear();
 
+    G_StartupPhase("defs");
+
     cacheAllSounds();
 
     if (enginePostInit())
@@ -6734,6 +6747,8 @@ int app_main(int argc, char const* const* argv)
         S_MusicStartup();
     }
 
+    G_StartupPhase("video/sound");
+
     G_InitText();
 
     if (g_networkMode != NET_DEDICATED_SERVER)
@@ -6768,6 +6783,9 @@ int app_main(int argc, char const* const* argv)
 
     VM_OnEvent(EVENT_INITCOMPLETE);
 
+    G_StartupPhase("menus");
+    G_PrintStartupTimes();
+
 MAIN_LOOP_RESTART:
     totalclock = 0;
     ototalclock = 0;
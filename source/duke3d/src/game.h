@@ -191,7 +191,7 @@ typedef struct {
     int32_t default_volume, default_skill;
 
     int32_t autosave;
-    int32_t autosavedeletion, maxautosaves;
+    int32_t autosavedeletion, maxautosaves, deltasaves;
 
     int32_t returnvar[MAX_RETURN_VALUES-1];
 
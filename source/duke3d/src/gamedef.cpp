@@ -50,6 +50,7 @@ MicroProfileToken g_instTokens[CON_END];
 #define LINE_NUMBER (g_lineNumber << 12)
 
 int32_t g_scriptVersion = 13; // 13 = 1.3D-style CON files, 14 = 1.4/1.5 style CON files
+int32_t g_scriptOptimize = 1; // 0 compiles the bytecode exactly as written, for debugging the VM
 
 char g_scriptFileName[BMAX_PATH] = "(none)";  // file we're currently compiling
 
@@ -71,6 +72,7 @@ static bool g_skipBranch;
 static bool g_switchCountPhase = false;
 
 static int g_checkingIfElse;
+static int g_elseChainCnt;
 static int g_checkingSwitch;
 static int g_lastKeyword = -1;
 static int g_numBraces;
@@ -82,6 +84,9 @@ static intptr_t g_scriptEventBreakOffset;
 static intptr_t g_scriptEventChainOffset;
 static intptr_t g_scriptEventOffset;
 
+// offsets of `else' jumps that land on the `else' currently being compiled
+static intptr_t g_elseChain[8];
+
 // The pointer to the start of the case table in a switch statement.
 // First entry is 'default' code.
 static intptr_t *g_caseTablePtr;
@@ -799,16 +804,30 @@ static const vec2_t actorvartable[] =
 #endif
 };
 
+// branches whose body is a single assignment from a constant run it without entering the VM again
+static const vec2_t ifsetvartable[] =
+{
+    { CON_IFVARAND,       CON_IFVARAND_SETVAR },
+    { CON_IFVARE,         CON_IFVARE_SETVAR },
+    { CON_IFVARG,         CON_IFVARG_SETVAR },
+    { CON_IFVARGE,        CON_IFVARGE_SETVAR },
+    { CON_IFVARL,         CON_IFVARL_SETVAR },
+    { CON_IFVARLE,        CON_IFVARLE_SETVAR },
+    { CON_IFVARN,         CON_IFVARN_SETVAR },
+};
+
 static inthashtable_t h_varvar = { NULL, INTHASH_SIZE(ARRAY_SIZE(varvartable)) };
 static inthashtable_t h_globalvar = { NULL, INTHASH_SIZE(ARRAY_SIZE(globalvartable)) };
 static inthashtable_t h_playervar = { NULL, INTHASH_SIZE(ARRAY_SIZE(playervartable)) };
 static inthashtable_t h_actorvar = { NULL, INTHASH_SIZE(ARRAY_SIZE(actorvartable)) };
+static inthashtable_t h_ifsetvar = { NULL, INTHASH_SIZE(ARRAY_SIZE(ifsetvartable)) };
 
 static inthashtable_t *const inttables[] = {
     &h_varvar,
     &h_globalvar,
     &h_playervar,
     &h_actorvar,
+    &h_ifsetvar,
 };
 
 
@@ -853,6 +872,14 @@ static const tokenmap_t keywords_for_private_opcodes[] =
 
     { "getplayer", CON_GETPLAYERSTRUCT },
     { "setplayer", CON_SETPLAYERSTRUCT },
+
+    { "ifvarand",  CON_IFVARAND_SETVAR },
+    { "ifvare",    CON_IFVARE_SETVAR },
+    { "ifvarg",    CON_IFVARG_SETVAR },
+    { "ifvarge",   CON_IFVARGE_SETVAR },
+    { "ifvarl",    CON_IFVARL_SETVAR },
+    { "ifvarle",   CON_IFVARLE_SETVAR },
+    { "ifvarn",    CON_IFVARN_SETVAR },
 };
 
 char const *VM_GetKeywordForID(int32_t id)
@@ -2481,6 +2508,195 @@ static void scriptUpdateOpcodeForVariableType(intptr_t *ins)
     }
 }
 
+// The optimizations below only rewrite code emitted by the statement being compiled, in place or
+// before anything else can point into it. Savegames refer to labels, not script offsets, so the
+// layout is free to differ between optimized and unoptimized compiles.
+
+#define MAXINLINESTATEINSTS 4
+
+// length of the instruction at ins if all it does is change a gamevar by a constant, 0 otherwise
+static int C_GetVarOpLength(intptr_t const *ins)
+{
+    switch (VM_DECODE_INST(*ins))
+    {
+        case CON_NULLOP:
+            return 1;
+        case CON_SETVAR_GLOBAL:
+        case CON_SETVAR_PLAYER:
+        case CON_SETVAR_ACTOR:
+        case CON_SETVAR:
+        case CON_ADDVAR:
+        case CON_SUBVAR:
+        case CON_MULVAR:
+        case CON_ANDVAR:
+        case CON_ORVAR:
+        case CON_XORVAR:
+        case CON_SHIFTVARL:
+        case CON_SHIFTVARR:
+            return 3;
+    }
+
+    return 0;
+}
+
+// true if the branch body between body and end is one setvar, addvar or subvar, braced or not
+static bool C_IsSingleSetVar(intptr_t const *body, intptr_t const *end)
+{
+    if (end - body < 3)
+        return false;
+
+    bool const braces = VM_DECODE_INST(*body) == CON_LEFTBRACE;
+    body += braces;
+
+    switch (VM_DECODE_INST(*body))
+    {
+        case CON_SETVAR_GLOBAL:
+        case CON_SETVAR_PLAYER:
+        case CON_SETVAR_ACTOR:
+        case CON_SETVAR:
+        case CON_ADDVAR:
+        case CON_SUBVAR:
+            body += 3;
+            break;
+        default:
+            return false;
+    }
+
+    if (braces && (body >= end || VM_DECODE_INST(*body++) != CON_RIGHTBRACE))
+        return false;
+
+    return body == end;
+}
+
+// result of an ifvar* comparing two constants, -1 for the loops and anything not handled
+static int C_EvaluateIfVar(int const opcode, int32_t const lValue, int32_t const rValue)
+{
+    switch (opcode)
+    {
+        case CON_IFVARA:      return (uint32_t)lValue > (uint32_t)rValue;
+        case CON_IFVARAE:     return (uint32_t)lValue >= (uint32_t)rValue;
+        case CON_IFVARAND:    return (lValue & rValue) != 0;
+        case CON_IFVARB:      return (uint32_t)lValue < (uint32_t)rValue;
+        case CON_IFVARBE:     return (uint32_t)lValue <= (uint32_t)rValue;
+        case CON_IFVARBOTH:   return lValue && rValue;
+        case CON_IFVARE:      return lValue == rValue;
+        case CON_IFVAREITHER: return lValue || rValue;
+        case CON_IFVARG:      return lValue > rValue;
+        case CON_IFVARGE:     return lValue >= rValue;
+        case CON_IFVARL:      return lValue < rValue;
+        case CON_IFVARLE:     return lValue <= rValue;
+        case CON_IFVARN:      return lValue != rValue;
+        case CON_IFVAROR:     return (lValue | rValue) != 0;
+        case CON_IFVARXOR:    return (lValue ^ rValue) != 0;
+    }
+
+    return -1;
+}
+
+// called once an ifvar* has its fail location; g_scriptPtr is the end of its branch
+static void C_OptimizeIfVar(intptr_t * const ins, intptr_t * const failPtr, bool const hasElse)
+{
+    int const opcode = VM_DECODE_INST(*ins);
+
+    if (failPtr == &ins[3])
+    {
+        // plain gamevar operand: fuse a single assignment in the branch into the condition
+        int const fused = inthash_find(&h_ifsetvar, opcode);
+
+        if (fused == -1 || !C_IsSingleSetVar(&failPtr[1], g_scriptPtr))
+            return;
+
+        if (g_scriptDebug > 1 && !g_errorCnt && !g_warningCnt)
+            initprintf("%s:%d: fusing %s with the assignment in its branch\n", g_scriptFileName, g_lineNumber,
+                       VM_GetKeywordForID(opcode));
+
+        scriptWriteAtOffset(fused | (*ins & ~VM_INSTMASK), ins);
+    }
+    else if (failPtr == &ins[4] && ins[1] == GV_FLAG_CONSTANT && !hasElse && C_EvaluateIfVar(opcode, ins[2], ins[3]) == 0)
+    {
+        // usually a define switching a feature off: jump over the branch without testing anything.
+        // This has to be a jump and not an else, since the first word of the statement may be the
+        // fail location of an if before it, and branch() would take an else there for that if's own.
+        if (g_scriptDebug > 1 && !g_errorCnt && !g_warningCnt)
+            initprintf("%s:%d: %s is never true, skipping its branch\n", g_scriptFileName, g_lineNumber,
+                       VM_GetKeywordForID(opcode));
+
+        scriptWriteAtOffset(CON_JUMP | (*ins & ~VM_INSTMASK), ins);
+        scriptWriteAtOffset(g_scriptPtr - apScript, &ins[2]);
+    }
+}
+
+// An `else' whose branch ends right where another `else' starts, as in "ifa ifb x else y else z",
+// only jumps there to be sent on to the end of that one's branch. Send it to the end directly.
+static void C_ThreadElseJumps(intptr_t const elseOffset)
+{
+    intptr_t const target = apScript[elseOffset + 1];
+    int chainCnt = 0;
+
+    for (native_t i = 0; i < g_elseChainCnt; i++)
+    {
+        intptr_t const offset = g_elseChain[i];
+
+        // the code may have been thrown away and written over since the offset was recorded
+        if (offset >= elseOffset || VM_DECODE_INST(apScript[offset]) != CON_ELSE || !BITPTR_IS_POINTER(offset + 1)
+            || apScript[offset + 1] != (intptr_t)&apScript[elseOffset])
+            continue;
+
+        scriptWritePointer(target, &apScript[offset + 1]);
+        g_elseChain[chainCnt++] = offset;
+    }
+
+    if (chainCnt < ARRAY_SSIZE(g_elseChain))
+        g_elseChain[chainCnt++] = elseOffset;
+
+    g_elseChainCnt = chainCnt;
+}
+
+// Copies a state that only changes gamevars by constants into the caller in place of the `state'
+// opcode just written. It is wrapped in braces so that it still counts as one statement after an if.
+static bool C_InlineState(intptr_t const stateOffset)
+{
+    intptr_t const callOffset = &g_scriptPtr[-1] - apScript;
+    int length = 0;
+    int numInsts = 0;
+
+    for (; stateOffset + length < callOffset && VM_DECODE_INST(apScript[stateOffset + length]) != CON_ENDS; numInsts++)
+    {
+        int const instLength = C_GetVarOpLength(&apScript[stateOffset + length]);
+
+        if (!instLength || numInsts == MAXINLINESTATEINSTS)
+            return false;
+
+        length += instLength;
+    }
+
+    // still being defined, so this is a recursive call
+    if (stateOffset + length >= callOffset)
+        return false;
+
+    if (g_scriptDebug > 1 && !g_errorCnt && !g_warningCnt)
+        initprintf("%s:%d: debug: inlining state `%s'.\n", g_scriptFileName, g_lineNumber, LAST_LABEL);
+
+    g_scriptPtr--;
+
+    if (numInsts == 0)
+    {
+        scriptWriteValue(CON_NULLOP | LINE_NUMBER);
+        return true;
+    }
+
+    if (numInsts > 1)
+        scriptWriteValue(CON_LEFTBRACE | (VM_IFELSE_MAGIC << 12));
+
+    for (native_t i = 0; i < length; i++)
+        scriptWriteValue(apScript[stateOffset + i]);
+
+    if (numInsts > 1)
+        scriptWriteValue(CON_RIGHTBRACE | (VM_IFELSE_MAGIC << 12));
+
+    return true;
+}
+
 static bool C_ParseCommand(bool loop /*= false*/)
 {
     int32_t i, j=0, k=0, tw;
@@ -2569,6 +2785,9 @@ DO_DEFSTATE:
             if (g_scriptDebug > 1 && !g_errorCnt && !g_warningCnt)
                 initprintf("%s:%d: debug: state label `%s'.\n", g_scriptFileName, g_lineNumber, label+(j<<6));
 
+            if (g_scriptOptimize && C_InlineState(labelcode[j]))
+                continue;
+
             // 'state' type labels are always script addresses, as far as I can see
             scriptWritePointer((intptr_t)(apScript+labelcode[j]), g_scriptPtr++);
             continue;
@@ -3358,6 +3577,9 @@ DO_DEFSTATE:
                 auto const tempscrptr = (intptr_t *) apScript+offset;
                 scriptWritePointer((intptr_t)g_scriptPtr, tempscrptr);
 
+                if (g_scriptOptimize)
+                    C_ThreadElseJumps(lastScriptPtr);
+
                 continue;
             }
 
@@ -3890,6 +4112,25 @@ setvar:
                     g_scriptPtr--;
                 }
             }
+            // replace operations leaving a plain global var as it was with nullop
+            else if (g_scriptOptimize && (unsigned)ins[1] < MAXGAMEVARS
+                     && (aGameVars[ins[1]].flags & (GAMEVAR_USER_MASK | GAMEVAR_PTR_MASK)) == 0
+                     && ((ins[2] == 0 && (tw == CON_ADDVAR || tw == CON_SUBVAR || tw == CON_ORVAR || tw == CON_XORVAR
+                                          || tw == CON_SHIFTVARL || tw == CON_SHIFTVARR))
+                         || (ins[2] == -1 && tw == CON_ANDVAR)))
+            {
+                int constexpr const opcode = CON_NULLOP;
+
+                if (g_scriptDebug > 1 && !g_errorCnt && !g_warningCnt)
+                {
+                    initprintf("%s:%d: %s -> %s\n", g_scriptFileName, g_lineNumber,
+                               VM_GetKeywordForID(tw), VM_GetKeywordForID(opcode));
+                }
+
+                scriptWriteAtOffset(opcode | LINE_NUMBER, ins);
+                g_scriptPtr = &ins[1];
+                continue;
+            }
             // replace instructions with special versions for specific var types
             scriptUpdateOpcodeForVariableType(ins);
             continue;
@@ -4569,6 +4810,9 @@ ifvar:
 
                     if (j == CON_ELSE)
                         g_checkingIfElse++;
+
+                    if (g_scriptOptimize)
+                        C_OptimizeIfVar(apScript + lastScriptPtr, tempscrptr, j == CON_ELSE);
                 }
 
                 continue;
@@ -6387,10 +6631,12 @@ void scriptInitTables()
 
     for (auto &actorvar : actorvartable)
         inthash_add(&h_actorvar, actorvar.x, actorvar.y, 0);
+
+    for (auto &ifsetvar : ifsetvartable)
+        inthash_add(&h_ifsetvar, ifsetvar.x, ifsetvar.y, 0);
 }
 
-#if MICROPROFILE_ENABLED != 0
-static int C_GetLabelIndex(int32_t val, int type)
+int C_GetLabelIndex(int32_t val, int type)
 {
     for (int i=0;i<g_labelCnt;i++)
         if (labelcode[i] == val && (labeltype[i] & type) != 0)
@@ -6402,7 +6648,6 @@ static int C_GetLabelIndex(int32_t val, int type)
 
     return -1;
 }
-#endif
 
 void C_Compile(const char *fileName)
 {
@@ -6470,6 +6715,8 @@ void C_Compile(const char *fileName)
     g_totalLines = 0;
     g_warningCnt = 0;
 
+    g_elseChainCnt = 0;
+
     Bstrcpy(g_scriptFileName, fileName);
 
     C_AddDefaultDefinitions();
@@ -138,6 +138,7 @@ extern const uint8_t  CheatFunctionIDs[];
 extern int32_t g_errorCnt;
 extern int32_t g_lineNumber;
 extern int32_t g_numXStrings;
+extern int32_t g_scriptOptimize;
 extern int32_t g_scriptVersion;
 extern int32_t g_totalLines;
 extern int32_t g_warningCnt;
@@ -157,6 +158,7 @@ void C_AllocProjectile(int32_t j);
 void C_FreeProjectile(int32_t j);
 void C_InitQuotes(void);
 void C_InitProjectiles(void);
+int C_GetLabelIndex(int32_t val, int type);
 
 typedef struct {
     int spriteNum;
@@ -830,6 +832,14 @@ enum IterationTypes_t
     TRANSFORM(CON_SETVAR_GLOBAL) DELIMITER \
     TRANSFORM(CON_SETVAR_PLAYER) DELIMITER \
     TRANSFORM(CON_SETVAR_ACTOR) DELIMITER \
+    \
+    TRANSFORM(CON_IFVARAND_SETVAR) DELIMITER \
+    TRANSFORM(CON_IFVARE_SETVAR) DELIMITER \
+    TRANSFORM(CON_IFVARG_SETVAR) DELIMITER \
+    TRANSFORM(CON_IFVARGE_SETVAR) DELIMITER \
+    TRANSFORM(CON_IFVARL_SETVAR) DELIMITER \
+    TRANSFORM(CON_IFVARLE_SETVAR) DELIMITER \
+    TRANSFORM(CON_IFVARN_SETVAR) DELIMITER \
 /*  CON_DISCRETE_VAR_ACCESS \
 
     TRANSFORM(CON_IFVARA_GLOBAL) DELIMITER \
@@ -31,6 +31,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menus.h"
 #include "microprofile.h"
 #include "osdcmds.h"
+#include "premap.h"
 #include "savegame.h"
 #include "scriplib.h"
 #include "vfs.h"
@@ -133,6 +134,249 @@ static inline void VM_DummySprite(void)
     vm.pData    = &dummy_actor.t_data[0];
 }
 
+// CON profiler: an instrumented call tree of events, actors and states, written out as collapsed
+// stacks for flame graph tools. States the compiler inlined don't appear in it; compile with
+// -noconopt to see all of them.
+
+#define VM_PROFILE_MAXDEPTH 64
+
+enum vmprofkind_t
+{
+    VM_PROFILE_EVENT,
+    VM_PROFILE_ACTOR,
+    VM_PROFILE_STATE,
+};
+
+typedef struct
+{
+    uint64_t ticks;   // including the nodes below it
+    uint32_t calls;
+    int32_t  parent;
+    int32_t  id;      // event number, actor tile or script offset of the state
+    int32_t  kind;
+} vmprofnode_t;
+
+int32_t g_vmProfiling;
+
+static char          vmProfileFileName[BMAX_PATH];
+static vmprofnode_t *vmProfileNodes;
+static int32_t      *vmProfileHash;  // indices into vmProfileNodes, -1 if unused
+static int           vmProfileNodeCnt;
+static int           vmProfileHashSize;
+
+static struct
+{
+    int32_t  node;
+    uint64_t start;
+} vmProfileStack[VM_PROFILE_MAXDEPTH];
+
+// frames past VM_PROFILE_MAXDEPTH are counted but charged to the deepest one kept
+static int vmProfileDepth;
+
+static inline uint32_t VM_ProfileHashKey(int const parent, int const kind, int const id)
+{
+    return ((uint32_t)parent * 0x9E3779B1u) ^ ((uint32_t)id * 0x85EBCA6Bu) ^ kind;
+}
+
+static void VM_ProfileGrow(void)
+{
+    int const newSize = vmProfileHashSize ? vmProfileHashSize << 1 : 1024;
+
+    vmProfileNodes = (vmprofnode_t *)Xrealloc(vmProfileNodes, (newSize >> 1) * sizeof(vmprofnode_t));
+    vmProfileHash  = (int32_t *)Xrealloc(vmProfileHash, newSize * sizeof(int32_t));
+    vmProfileHashSize = newSize;
+
+    Bmemset(vmProfileHash, -1, newSize * sizeof(int32_t));
+
+    for (native_t i = 0; i < vmProfileNodeCnt; i++)
+    {
+        auto const &node = vmProfileNodes[i];
+        uint32_t slot = VM_ProfileHashKey(node.parent, node.kind, node.id);
+
+        while (vmProfileHash[slot & (newSize - 1)] != -1)
+            slot++;
+
+        vmProfileHash[slot & (newSize - 1)] = i;
+    }
+}
+
+static int VM_ProfileGetNode(int const parent, int const kind, int const id)
+{
+    uint32_t slot = VM_ProfileHashKey(parent, kind, id);
+
+    for (;; slot++)
+    {
+        int const nodeNum = vmProfileHash[slot & (vmProfileHashSize - 1)];
+
+        if (nodeNum == -1)
+            break;
+
+        auto const &node = vmProfileNodes[nodeNum];
+
+        if (node.parent == parent && node.kind == kind && node.id == id)
+            return nodeNum;
+    }
+
+    // the hash is kept at most half full, which also bounds the node array
+    if (vmProfileNodeCnt >= (vmProfileHashSize >> 1) - 1)
+    {
+        VM_ProfileGrow();
+        return VM_ProfileGetNode(parent, kind, id);
+    }
+
+    vmProfileNodes[vmProfileNodeCnt] = { 0, 0, parent, id, kind };
+    vmProfileHash[slot & (vmProfileHashSize - 1)] = vmProfileNodeCnt;
+
+    return vmProfileNodeCnt++;
+}
+
+static void VM_ProfileEnter(int const kind, int const id)
+{
+    if (vmProfileDepth < VM_PROFILE_MAXDEPTH)
+    {
+        int const parent = vmProfileDepth ? vmProfileStack[vmProfileDepth - 1].node : -1;
+
+        vmProfileStack[vmProfileDepth].node  = VM_ProfileGetNode(parent, kind, id);
+        vmProfileStack[vmProfileDepth].start = timerGetPerformanceCounter();
+    }
+
+    vmProfileDepth++;
+}
+
+static void VM_ProfileLeave(void)
+{
+    // profiling was started while this frame was already running
+    if (vmProfileDepth == 0)
+        return;
+
+    if (--vmProfileDepth < VM_PROFILE_MAXDEPTH)
+    {
+        auto &node = vmProfileNodes[vmProfileStack[vmProfileDepth].node];
+
+        node.ticks += timerGetPerformanceCounter() - vmProfileStack[vmProfileDepth].start;
+        node.calls++;
+    }
+}
+
+#define VM_PROFILE_ENTER(kind, id)                   \
+    do                                               \
+    {                                                \
+        if (EDUKE32_PREDICT_FALSE(g_vmProfiling))    \
+            VM_ProfileEnter(kind, id);               \
+    } while (0)
+
+#define VM_PROFILE_LEAVE()                           \
+    do                                               \
+    {                                                \
+        if (EDUKE32_PREDICT_FALSE(g_vmProfiling))    \
+            VM_ProfileLeave();                       \
+    } while (0)
+
+void VM_ProfileStart(const char *fileName)
+{
+    Bstrncpyz(vmProfileFileName, fileName, sizeof(vmProfileFileName));
+
+    vmProfileNodeCnt = 0;
+    vmProfileDepth   = 0;
+
+    if (vmProfileHashSize)
+        Bmemset(vmProfileHash, -1, vmProfileHashSize * sizeof(int32_t));
+    else
+        VM_ProfileGrow();
+
+    g_vmProfiling = 1;
+    OSD_Printf("Profiling CON code into \"%s\".\n", vmProfileFileName);
+}
+
+static char const *VM_ProfileNodeName(vmprofnode_t const &node, char *buf)
+{
+    int labelNum;
+
+    switch (node.kind)
+    {
+        case VM_PROFILE_EVENT:
+            return EventNames[node.id];
+        case VM_PROFILE_ACTOR:
+            if ((labelNum = C_GetLabelIndex(node.id, LABEL_ACTOR)) != -1)
+                Bsprintf(buf, "actor %s (%d)", label + (labelNum << 6), node.id);
+            else
+                Bsprintf(buf, "actor unnamed (%d)", node.id);
+            return buf;
+        default:
+            if ((labelNum = C_GetLabelIndex(node.id, LABEL_STATE)) != -1 && (labeltype[labelNum] & LABEL_STATE))
+                Bsprintf(buf, "state %s", label + (labelNum << 6));
+            else
+                Bsprintf(buf, "state %d", node.id);
+            return buf;
+    }
+}
+
+// Writes one "frame;frame;frame microseconds" line per call path, counting only the time spent in
+// the last frame itself, which is the collapsed format flamegraph.pl and speedscope read.
+void VM_ProfileStop(void)
+{
+    if (!g_vmProfiling)
+        return;
+
+    g_vmProfiling = 0;
+
+    buildvfs_FILE fp = buildvfs_fopen_write(vmProfileFileName);
+
+    if (fp == nullptr)
+    {
+        OSD_Printf("Unable to write CON profile \"%s\".\n", vmProfileFileName);
+        return;
+    }
+
+    auto selfTicks = (uint64_t *)Xmalloc(vmProfileNodeCnt * sizeof(uint64_t));
+
+    for (native_t i = 0; i < vmProfileNodeCnt; i++)
+        selfTicks[i] = vmProfileNodes[i].ticks;
+
+    for (native_t i = 0; i < vmProfileNodeCnt; i++)
+    {
+        int const parent = vmProfileNodes[i].parent;
+
+        if (parent != -1)
+            selfTicks[parent] -= min(selfTicks[parent], vmProfileNodes[i].ticks);
+    }
+
+    double const ticksPerMicrosecond = (double)timerGetPerformanceFrequency() / 1000000.0;
+    uint64_t totalTicks = 0;
+
+    for (native_t i = 0; i < vmProfileNodeCnt; i++)
+    {
+        auto const microseconds = (uint64_t)(selfTicks[i] / ticksPerMicrosecond);
+
+        totalTicks += selfTicks[i];
+
+        if (microseconds == 0)
+            continue;
+
+        int path[VM_PROFILE_MAXDEPTH];
+        int pathLength = 0;
+
+        for (int nodeNum = i; nodeNum != -1; nodeNum = vmProfileNodes[nodeNum].parent)
+            path[pathLength++] = nodeNum;
+
+        while (pathLength--)
+        {
+            char nameBuf[80];
+            buildvfs_fputstrptr(fp, VM_ProfileNodeName(vmProfileNodes[path[pathLength]], nameBuf));
+            buildvfs_fputstr(fp, pathLength ? ";" : " ");
+        }
+
+        Bsprintf(tempbuf, "%llu\n", (unsigned long long)microseconds);
+        buildvfs_fputstrptr(fp, tempbuf);
+    }
+
+    buildvfs_fclose(fp);
+    Xfree(selfTicks);
+
+    OSD_Printf("Wrote CON profile \"%s\": %d call paths, %.1f ms.\n", vmProfileFileName, vmProfileNodeCnt,
+               (double)totalTicks / (ticksPerMicrosecond * 1000.0));
+}
+
 // verification that the event actually exists happens elsewhere
 static FORCE_INLINE int32_t VM_EventInlineInternal__(int const eventNum, int const spriteNum, int const playerNum,
                                                        int const playerDist = -1, int32_t returnValue = 0)
@@ -167,7 +411,9 @@ static FORCE_INLINE int32_t VM_EventInlineInternal__(int const eventNum, int con
     if ((unsigned)playerNum >= (unsigned)g_mostConcurrentPlayers)
         vm.pPlayer = g_player[0].ps;
 
+    VM_PROFILE_ENTER(VM_PROFILE_EVENT, eventNum);
     VM_Execute(true);
+    VM_PROFILE_LEAVE();
 
     if (vm.flags & VM_KILL)
         VM_DeleteSprite(vm.spriteNum, vm.playerNum);
@@ -1412,6 +1658,31 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
         }
     };
 
+    // the compiler only emits the ifvar*_setvar opcodes when the branch is one assignment from a
+    // constant, optionally braced, so it is carried out here instead of in a nested VM_Execute()
+    auto branchSetVar = [&](int const x) {
+        if (!x)
+        {
+            branch(0);
+            return;
+        }
+
+        auto body = &insptr[2];
+        body += (VM_DECODE_INST(*body) == CON_LEFTBRACE);
+
+        switch (VM_DECODE_INST(*body))
+        {
+            case CON_SETVAR_GLOBAL: aGameVars[body[1]].global = body[2]; break;
+            case CON_SETVAR_ACTOR:  aGameVars[body[1]].pValues[vm.spriteNum & (MAXSPRITES-1)] = body[2]; break;
+            case CON_SETVAR_PLAYER: aGameVars[body[1]].pValues[vm.playerNum & (MAXPLAYERS-1)] = body[2]; break;
+            case CON_SETVAR:        Gv_SetVar(body[1], body[2]); break;
+            case CON_ADDVAR:        Gv_AddVar(body[1], body[2]); break;
+            case CON_SUBVAR:        Gv_SubVar(body[1], body[2]); break;
+        }
+
+        insptr = (intptr_t *)insptr[1];
+    };
+
     int vm_execution_depth = loop;
 #ifdef CON_USE_COMPUTED_GOTO
     static void *const jumpTable[] = JUMP_TABLE_ARRAY_LITERAL;
@@ -1451,7 +1722,9 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
             {
                 auto tempscrptr = &insptr[2];
                 insptr = (intptr_t *)insptr[1];
+                VM_PROFILE_ENTER(VM_PROFILE_STATE, insptr - apScript);
                 VM_Execute(true);
+                VM_PROFILE_LEAVE();
                 insptr = tempscrptr;
             }
             dispatch();
@@ -1472,6 +1745,48 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
                 insptr += 2;
                 dispatch();
 
+            vInstruction(CON_IFVARAND_SETVAR):
+                insptr++;
+                tw = Gv_GetVar(*insptr++);
+                branchSetVar(tw & *insptr);
+                dispatch();
+
+            vInstruction(CON_IFVARE_SETVAR):
+                insptr++;
+                tw = Gv_GetVar(*insptr++);
+                branchSetVar(tw == *insptr);
+                dispatch();
+
+            vInstruction(CON_IFVARG_SETVAR):
+                insptr++;
+                tw = Gv_GetVar(*insptr++);
+                branchSetVar(tw > *insptr);
+                dispatch();
+
+            vInstruction(CON_IFVARGE_SETVAR):
+                insptr++;
+                tw = Gv_GetVar(*insptr++);
+                branchSetVar(tw >= *insptr);
+                dispatch();
+
+            vInstruction(CON_IFVARL_SETVAR):
+                insptr++;
+                tw = Gv_GetVar(*insptr++);
+                branchSetVar(tw < *insptr);
+                dispatch();
+
+            vInstruction(CON_IFVARLE_SETVAR):
+                insptr++;
+                tw = Gv_GetVar(*insptr++);
+                branchSetVar(tw <= *insptr);
+                dispatch();
+
+            vInstruction(CON_IFVARN_SETVAR):
+                insptr++;
+                tw = Gv_GetVar(*insptr++);
+                branchSetVar(tw != *insptr);
+                dispatch();
+
 #ifdef CON_DISCRETE_VAR_ACCESS
             vInstruction(CON_IFVARE_GLOBAL):
                 insptr++;
@@ -6562,7 +6877,9 @@ void A_LoadActor(int const spriteNum)
     }
 
     insptr = g_tile[vm.pSprite->picnum].loadPtr;
+    VM_PROFILE_ENTER(VM_PROFILE_ACTOR, vm.pSprite->picnum);
     VM_Execute(true);
+    VM_PROFILE_LEAVE();
     insptr = NULL;
 
     if (vm.flags & VM_KILL)
@@ -6631,7 +6948,9 @@ void A_Execute(int const spriteNum, int const playerNum, int const playerDist)
     VM_UpdateAnim(vm.spriteNum, vm.pData);
 
     insptr = 4 + (g_tile[vm.pSprite->picnum].execPtr);
+    VM_PROFILE_ENTER(VM_PROFILE_ACTOR, vm.pSprite->picnum);
     VM_Execute(true);
+    VM_PROFILE_LEAVE();
     insptr = NULL;
 
     if ((vm.flags & VM_KILL) == 0)
@@ -6704,6 +7023,8 @@ void G_SaveMapState(void)
 
     mapstate_t *save = pMapInfo->savedstate;
 
+    g_mapStateSerial++;
+
     if (save == NULL)
         return;
 
@@ -36,6 +36,11 @@ typedef struct
 
 extern zhit_t zhit[MAXSPRITES];
 
+extern int32_t g_vmProfiling;
+
+void VM_ProfileStart(const char *fileName);
+void VM_ProfileStop(void);
+
 int32_t VM_ExecuteEvent(int const nEventID, int const spriteNum, int const playerNum, int const nDist, int32_t const nReturn);
 int32_t VM_ExecuteEvent(int const nEventID, int const spriteNum, int const playerNum, int const nDist);
 int32_t VM_ExecuteEvent(int const nEventID, int const spriteNum, int const playerNum);
@@ -364,10 +364,10 @@ int Gv_ReadSave(buildvfs_kfd kFile)
 }
 #undef A_
 
-void Gv_WriteSave(buildvfs_FILE fil)
+void Gv_WriteSave(savewriter_t &sw)
 {
 #ifndef NDEBUG
-    int const startofs = buildvfs_ftell(fil);
+    int const startofs = sw.tell();
 #endif
     int32_t savedVarCount = 0;
     for (native_t i = 0; i < g_gameVarCount; i++)
@@ -377,16 +377,16 @@ void Gv_WriteSave(buildvfs_FILE fil)
 
         savedVarCount++;
     }
-    buildvfs_fwrite(&savedVarCount, sizeof(savedVarCount), 1, fil);
+    sw.write(&savedVarCount, sizeof(savedVarCount), 1);
 
     char *varlabels = nullptr;
 
     if (savedVarCount)
     {
-        buildvfs_fwrite(s_gamevars, Bstrlen(s_gamevars), 1, fil);
+        sw.write(s_gamevars, Bstrlen(s_gamevars), 1);
 
         // this is the size of the label table, not the number of actual saved vars
-        buildvfs_fwrite(&g_gameVarCount, sizeof(g_gameVarCount), 1, fil);
+        sw.write(&g_gameVarCount, sizeof(g_gameVarCount), 1);
 
         varlabels = (char *)Xcalloc(g_gameVarCount, MAXVARLABEL);
 
@@ -397,7 +397,7 @@ void Gv_WriteSave(buildvfs_FILE fil)
             Bmemcpy(&varlabels[i * MAXVARLABEL], aGameVars[i].szLabel, MAXVARLABEL);
         }
 
-        dfwrite_LZ4(varlabels, g_gameVarCount * MAXVARLABEL, 1, fil);
+        sw.writeLZ4(varlabels, g_gameVarCount * MAXVARLABEL, 1);
         int writeCnt = 0;
         for (int32_t idx = 0; idx < g_gameVarCount; idx++)
         {
@@ -408,13 +408,13 @@ void Gv_WriteSave(buildvfs_FILE fil)
             if (var.flags & SAVEGAMEVARSKIPMASK)
                 continue;
             writeCnt++;
-            buildvfs_fwrite(&idx, sizeof(idx), 1, fil);
-            buildvfs_fwrite(&var, sizeof(gamevar_t), 1, fil);
+            sw.write(&idx, sizeof(idx), 1);
+            sw.write(&var, sizeof(gamevar_t), 1);
 
             if (var.flags & GAMEVAR_PERPLAYER)
-                dfwrite_LZ4(var.pValues, sizeof(var.pValues[0]) * MAXPLAYERS, 1, fil);
+                sw.writeLZ4(var.pValues, sizeof(var.pValues[0]) * MAXPLAYERS, 1);
             else if (var.flags & GAMEVAR_PERACTOR)
-                dfwrite_LZ4(var.pValues, sizeof(var.pValues[0]) * MAXSPRITES, 1, fil);
+                sw.writeLZ4(var.pValues, sizeof(var.pValues[0]) * MAXSPRITES, 1);
         }
         Bassert(savedVarCount == writeCnt);
     }
@@ -427,16 +427,16 @@ void Gv_WriteSave(buildvfs_FILE fil)
 
         savedArrayCount++;
     }
-    buildvfs_fwrite(&savedArrayCount, sizeof(savedArrayCount), 1, fil);
+    sw.write(&savedArrayCount, sizeof(savedArrayCount), 1);
 
     char *arrlabels = nullptr;
 
     if (savedArrayCount)
     {
-        buildvfs_fwrite(s_arrays, Bstrlen(s_arrays), 1, fil);
+        sw.write(s_arrays, Bstrlen(s_arrays), 1);
 
         // this is the size of the label table, not the number of actual saved arrays
-        buildvfs_fwrite(&g_gameArrayCount, sizeof(g_gameArrayCount), 1, fil);
+        sw.write(&g_gameArrayCount, sizeof(g_gameArrayCount), 1);
 
         arrlabels = (char *)Xcalloc(g_gameArrayCount, MAXARRAYLABEL);
 
@@ -447,7 +447,7 @@ void Gv_WriteSave(buildvfs_FILE fil)
             Bmemcpy(&arrlabels[i * MAXARRAYLABEL], aGameArrays[i].szLabel, MAXARRAYLABEL);
         }
 
-        dfwrite_LZ4(arrlabels, g_gameArrayCount * MAXARRAYLABEL, 1, fil);
+        sw.writeLZ4(arrlabels, g_gameArrayCount * MAXARRAYLABEL, 1);
 
         for (int32_t idx = 0; idx < g_gameArrayCount; idx++)
         {
@@ -459,14 +459,14 @@ void Gv_WriteSave(buildvfs_FILE fil)
                 continue;
 
             // write for .size and .dwFlags (the rest are pointers):
-            buildvfs_fwrite(&idx, sizeof(idx), 1, fil);
-            buildvfs_fwrite(&array, sizeof(gamearray_t), 1, fil);
+            sw.write(&idx, sizeof(idx), 1);
+            sw.write(&array, sizeof(gamearray_t), 1);
 
             int32_t arrayAllocSize = Gv_GetArrayAllocSize(idx);
-            buildvfs_fwrite(&arrayAllocSize, sizeof(arrayAllocSize), 1, fil);
+            sw.write(&arrayAllocSize, sizeof(arrayAllocSize), 1);
 
             if (arrayAllocSize > 0)
-                dfwrite_LZ4(array.pValues, arrayAllocSize, 1, fil);
+                sw.writeLZ4(array.pValues, arrayAllocSize, 1);
         }
     }
 
@@ -478,12 +478,12 @@ void Gv_WriteSave(buildvfs_FILE fil)
         if (g_mapInfo[i].savedstate != nullptr)
             bitmap_set(savedStateMap, i), ++worldStateCount;
 
-    buildvfs_fwrite(&worldStateCount, sizeof(worldStateCount), 1, fil);
+    sw.write(&worldStateCount, sizeof(worldStateCount), 1);
 
     if (worldStateCount)
     {
-        buildvfs_fwrite(s_mapstate, Bstrlen(s_mapstate), 1, fil);
-        dfwrite_LZ4(savedStateMap, sizeof(savedStateMap), 1, fil);
+        sw.write(s_mapstate, Bstrlen(s_mapstate), 1);
+        sw.writeLZ4(savedStateMap, sizeof(savedStateMap), 1);
 
         // these are separate counts from the ones above because mapstate_t uses a more restrictive mask than the general savegame format
         savedVarCount = 0;
@@ -494,7 +494,7 @@ void Gv_WriteSave(buildvfs_FILE fil)
 
             savedVarCount++;
         }
-        buildvfs_fwrite(&savedVarCount, sizeof(savedVarCount), 1, fil);
+        sw.write(&savedVarCount, sizeof(savedVarCount), 1);
 
         savedArrayCount = 0;
         for (native_t i = 0; i < g_gameArrayCount; i++)
@@ -504,7 +504,7 @@ void Gv_WriteSave(buildvfs_FILE fil)
 
             savedArrayCount++;
         }
-        buildvfs_fwrite(&savedArrayCount, sizeof(savedArrayCount), 1, fil);
+        sw.write(&savedArrayCount, sizeof(savedArrayCount), 1);
 
         for (native_t i = 0; i < (MAXVOLUMES * MAXLEVELS); i++)
         {
@@ -514,12 +514,12 @@ void Gv_WriteSave(buildvfs_FILE fil)
             mapstate_t &sv = *g_mapInfo[i].savedstate;
 
             sv_prepareactors(sv.actor);
-            dfwrite_LZ4(g_mapInfo[i].savedstate, sizeof(mapstate_t), 1, fil);
+            sw.writeLZ4(g_mapInfo[i].savedstate, sizeof(mapstate_t), 1);
             sv_restoreactors(sv.actor);
 
             if (savedVarCount)
             {
-                buildvfs_fwrite(s_gamevars, Bstrlen(s_gamevars), 1, fil);
+                sw.write(s_gamevars, Bstrlen(s_gamevars), 1);
 
                 int writeCnt = 0;
                 for (int32_t idx = 0; idx < g_gameVarCount; idx++)
@@ -531,32 +531,32 @@ void Gv_WriteSave(buildvfs_FILE fil)
                     if (var.flags & SAVEGAMEMAPSTATEVARSKIPMASK)
                         continue;
 
-                    buildvfs_fwrite(&idx, sizeof(idx), 1, fil);
+                    sw.write(&idx, sizeof(idx), 1);
                     writeCnt++;
                     // these will be null if the mapstate comes from an old savegame with gamevars that were skipped during load
                     if ((var.flags& GAMEVAR_USER_MASK) && sv.vars[idx] == nullptr)
                     {
                         gamevar_t dummy = {};
                         dummy.flags = INT_MAX;
-                        buildvfs_fwrite(&dummy, sizeof(dummy), 1, fil);
+                        sw.write(&dummy, sizeof(dummy), 1);
                         continue;
                     }
 
-                    buildvfs_fwrite(&var, sizeof(var), 1, fil);
+                    sw.write(&var, sizeof(var), 1);
 
                     if (var.flags & GAMEVAR_PERPLAYER)
-                        dfwrite_LZ4(sv.vars[idx], sizeof(sv.vars[0][0]) * MAXPLAYERS, 1, fil);
+                        sw.writeLZ4(sv.vars[idx], sizeof(sv.vars[0][0]) * MAXPLAYERS, 1);
                     else if (var.flags & GAMEVAR_PERACTOR)
-                        dfwrite_LZ4(sv.vars[idx], sizeof(sv.vars[0][0]) * MAXSPRITES, 1, fil);
+                        sw.writeLZ4(sv.vars[idx], sizeof(sv.vars[0][0]) * MAXSPRITES, 1);
                     else
-                        buildvfs_fwrite(&sv.vars[idx], sizeof(sv.vars[0][0]), 1, fil);
+                        sw.write(&sv.vars[idx], sizeof(sv.vars[0][0]), 1);
                 }
                 Bassert(savedVarCount == writeCnt);
             }
 
             if (savedArrayCount)
             {
-                buildvfs_fwrite(s_arrays, Bstrlen(s_arrays), 1, fil);
+                sw.write(s_arrays, Bstrlen(s_arrays), 1);
 
                 for (int32_t idx = 0; idx < g_gameArrayCount; idx++)
                 {
@@ -567,20 +567,20 @@ void Gv_WriteSave(buildvfs_FILE fil)
                     if ((array.flags & (GAMEARRAY_RESTORE|SAVEGAMEARRAYSKIPMASK)) != GAMEARRAY_RESTORE)
                         continue;
 
-                    buildvfs_fwrite(&idx, sizeof(idx), 1, fil);
-                    buildvfs_fwrite(&sv.arraysiz[idx], sizeof(sv.arraysiz[0]), 1, fil);
+                    sw.write(&idx, sizeof(idx), 1);
+                    sw.write(&sv.arraysiz[idx], sizeof(sv.arraysiz[0]), 1);
                     int32_t arrayAllocSize = Gv_GetArrayAllocSizeForCount(idx, sv.arraysiz[idx]);
-                    buildvfs_fwrite(&arrayAllocSize, sizeof(arrayAllocSize), 1, fil);
+                    sw.write(&arrayAllocSize, sizeof(arrayAllocSize), 1);
                     if (arrayAllocSize > 0)
-                        dfwrite_LZ4(sv.arrays[idx], arrayAllocSize, 1, fil);
+                        sw.writeLZ4(sv.arrays[idx], arrayAllocSize, 1);
                 }
             }
         }
     }
 
-    buildvfs_fwrite(s_EOF, Bstrlen(s_EOF), 1, fil);
+    sw.write(s_EOF, Bstrlen(s_EOF), 1);
 #ifndef NDEBUG
-    OSD_Printf("Gv_WriteSave(): wrote %d bytes extended data at offset 0x%08x\n", (int)buildvfs_ftell(fil) - startofs, startofs);
+    OSD_Printf("Gv_WriteSave(): wrote %d bytes extended data at offset 0x%08x\n", (int)sw.tell() - startofs, startofs);
 #endif
     Xfree(varlabels);
     Xfree(arrlabels);
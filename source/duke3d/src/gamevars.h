@@ -27,6 +27,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "vfs.h"
 
+struct savewriter_t;
+
 #define MAXGAMEVARS 2048 // must be a power of two
 #define MAXVARLABEL 26
 
@@ -173,7 +175,7 @@ void Gv_InitWeaponPointers(void);
 void Gv_RefreshPointers(void);
 void Gv_ResetVars(void);
 int Gv_ReadSave(buildvfs_kfd kFile);
-void Gv_WriteSave(buildvfs_FILE fil);
+void Gv_WriteSave(savewriter_t &sw);
 void Gv_Clear(void);
 
 void Gv_ResetSystemDefaults(void);
@@ -213,9 +213,9 @@ static int32_t g_chatPlayer = -1;
 #define NETINDEX_BITS (16 + 1)
 
 
-// worst case: 2 bits per field per stuct if every field in every struct is changed
+// worst case: 3 bits per field per stuct if every field in every struct is changed
 #define WORLD_CHANGEBITSSIZE                                                                                                               \
-    (MAXWALLS * ARRAY_SIZE(WallFields) * 2) + (MAXSECTORS * ARRAY_SIZE(SectorFields) * 2) + (MAXSPRITES * ARRAY_SIZE(ActorFields) * 2)
+    (MAXWALLS * ARRAY_SIZE(WallFields) * 3) + (MAXSECTORS * ARRAY_SIZE(SectorFields) * 3) + (MAXSPRITES * ARRAY_SIZE(ActorFields) * 3)
 
 //                              each changed entry has a netindex + stop codes                  bits to indicate whether a field
 //                              changed/zeroed                 convert to bytes....
@@ -227,42 +227,46 @@ typedef struct netField_s
     const char  *name;      // field name
     int32_t     offset;     // offset from the start of the entity struct
     int32_t     bits;       // field size
+    int32_t     deltaBits;  // if nonzero, changes small enough to fit this many bits are sent instead of the new value
+    int32_t     isAngle;    // build angle, changes are taken modulo 2048
 
 } netField_t;
 
+#define NETF_ANGLE 1
+
 #define	SECTF(x) #x,(int32_t)(size_t)&((netSector_t*)0)->x
 
 static netField_t SectorFields[] =
 {
-    { SECTF(wallptr),                16 },
-    { SECTF(wallnum),                16 },
+    { SECTF(wallptr),                16, 0, 0 },
+    { SECTF(wallnum),                16, 0, 0 },
 
-    { SECTF(ceilingz),                   32 },
-    { SECTF(floorz),                     32 },
+    { SECTF(ceilingz),                   32, 16, 0 },
+    { SECTF(floorz),                     32, 16, 0 },
 
-    { SECTF(ceilingstat),           16 },
-    { SECTF(floorstat),             16 },
-    { SECTF(ceilingpicnum),         16 },
-    { SECTF(ceilingheinum),         16 },
+    { SECTF(ceilingstat),           16, 0, 0 },
+    { SECTF(floorstat),             16, 0, 0 },
+    { SECTF(ceilingpicnum),         16, 0, 0 },
+    { SECTF(ceilingheinum),         16, 0, 0 },
 
-    { SECTF(ceilingshade),       8 },
-    { SECTF(ceilingpal),         8 },
-    { SECTF(ceilingxpanning),    8 },
-    { SECTF(ceilingypanning),    8 },
+    { SECTF(ceilingshade),       8, 0, 0 },
+    { SECTF(ceilingpal),         8, 0, 0 },
+    { SECTF(ceilingxpanning),    8, 0, 0 },
+    { SECTF(ceilingypanning),    8, 0, 0 },
 
-    { SECTF(floorpicnum),           16 },
-    { SECTF(floorheinum),           16 },
+    { SECTF(floorpicnum),           16, 0, 0 },
+    { SECTF(floorheinum),           16, 0, 0 },
 
-    { SECTF(floorshade),         8 },
-    { SECTF(floorpal),           8 },
-    { SECTF(floorxpanning),      8 },
-    { SECTF(floorypanning),      8 },
-    { SECTF(visibility),         8 },
-    { SECTF(fogpal),             8 },
+    { SECTF(floorshade),         8, 0, 0 },
+    { SECTF(floorpal),           8, 0, 0 },
+    { SECTF(floorxpanning),      8, 0, 0 },
+    { SECTF(floorypanning),      8, 0, 0 },
+    { SECTF(visibility),         8, 0, 0 },
+    { SECTF(fogpal),             8, 0, 0 },
 
-    { SECTF(lotag),                  16 },
-    { SECTF(hitag),                  16 },
-    { SECTF(extra),                  16 },
+    { SECTF(lotag),                  16, 0, 0 },
+    { SECTF(hitag),                  16, 0, 0 },
+    { SECTF(extra),                  16, 0, 0 },
 
 };
 
@@ -273,27 +277,27 @@ static netField_t SectorFields[] =
 
 static netField_t WallFields[] =
 {
-    { WALLF(x),                          32 },
-    { WALLF(y),                          32 },
+    { WALLF(x),                          32, 12, 0 },
+    { WALLF(y),                          32, 12, 0 },
 
-    { WALLF(point2),                 16 },
-    { WALLF(nextwall),               16 },
-    { WALLF(nextsector),             16 },
+    { WALLF(point2),                 16, 0, 0 },
+    { WALLF(nextwall),               16, 0, 0 },
+    { WALLF(nextsector),             16, 0, 0 },
 
-    { WALLF(cstat),                  16 },
-    { WALLF(picnum),                 16 },
-    { WALLF(overpicnum),             16 },
+    { WALLF(cstat),                  16, 0, 0 },
+    { WALLF(picnum),                 16, 0, 0 },
+    { WALLF(overpicnum),             16, 0, 0 },
 
-    { WALLF(shade),              8 },
-    { WALLF(pal),                8 },
-    { WALLF(xrepeat),            8 },
-    { WALLF(yrepeat),            8 },
-    { WALLF(xpanning),           8 },
-    { WALLF(ypanning),           8 },
+    { WALLF(shade),              8, 0, 0 },
+    { WALLF(pal),                8, 0, 0 },
+    { WALLF(xrepeat),            8, 0, 0 },
+    { WALLF(yrepeat),            8, 0, 0 },
+    { WALLF(xpanning),           8, 0, 0 },
+    { WALLF(ypanning),           8, 0, 0 },
 
-    { WALLF(lotag),                  16 },
-    { WALLF(hitag),                  16 },
-    { WALLF(extra),                  16 },
+    { WALLF(lotag),                  16, 0, 0 },
+    { WALLF(hitag),                  16, 0, 0 },
+    { WALLF(extra),                  16, 0, 0 },
 
 };
 
@@ -304,106 +308,106 @@ static netField_t WallFields[] =
 
 static netField_t ActorFields[] =
 {
-    { ACTF(t_data_0),                   32 },
-    { ACTF(t_data_1),                   32 },
-    { ACTF(t_data_2),                   32 },
-    { ACTF(t_data_3),                   32 },
-    { ACTF(t_data_4),                   32 },
-    { ACTF(t_data_5),                   32 },
-    { ACTF(t_data_6),                   32 },
-    { ACTF(t_data_7),                   32 },
-    { ACTF(t_data_8),                   32 },
-    { ACTF(t_data_9),                   32 },
+    { ACTF(t_data_0),                   32, 0, 0 },
+    { ACTF(t_data_1),                   32, 0, 0 },
+    { ACTF(t_data_2),                   32, 0, 0 },
+    { ACTF(t_data_3),                   32, 0, 0 },
+    { ACTF(t_data_4),                   32, 0, 0 },
+    { ACTF(t_data_5),                   32, 0, 0 },
+    { ACTF(t_data_6),                   32, 0, 0 },
+    { ACTF(t_data_7),                   32, 0, 0 },
+    { ACTF(t_data_8),                   32, 0, 0 },
+    { ACTF(t_data_9),                   32, 0, 0 },
 
-    { ACTF(flags),                      32 },
+    { ACTF(flags),                      32, 0, 0 },
 
-    { ACTF(bpos_x),                     32 },
-    { ACTF(bpos_y),                     32 },
-    { ACTF(bpos_z),                     32 },
+    { ACTF(bpos_x),                     32, 12, 0 },
+    { ACTF(bpos_y),                     32, 12, 0 },
+    { ACTF(bpos_z),                     32, 16, 0 },
 
-    { ACTF(floorz),                     32 },
-    { ACTF(ceilingz),                   32 },
-    { ACTF(lastvx),                     32 },
-    { ACTF(lastvy),                     32 },
+    { ACTF(floorz),                     32, 16, 0 },
+    { ACTF(ceilingz),                   32, 16, 0 },
+    { ACTF(lastvx),                     32, 0, 0 },
+    { ACTF(lastvy),                     32, 0, 0 },
 
-    { ACTF(lasttransport),  8},
+    { ACTF(lasttransport),  8, 0, 0},
 
-    { ACTF(htpicnum),             16 },
-    { ACTF(htang),                16 },
-    { ACTF(htextra),              16 },
-    { ACTF(htowner),              16 },
+    { ACTF(htpicnum),             16, 0, 0 },
+    { ACTF(htang),                16, 7, NETF_ANGLE },
+    { ACTF(htextra),              16, 0, 0 },
+    { ACTF(htowner),              16, 0, 0 },
 
-    { ACTF(movflag),            16 },
-    { ACTF(tempang),            16 },
-    { ACTF(timetosleep),        16 },
+    { ACTF(movflag),            16, 0, 0 },
+    { ACTF(tempang),            16, 7, NETF_ANGLE },
+    { ACTF(timetosleep),        16, 0, 0 },
 
-    { ACTF(stayput),            16 },
-    { ACTF(dispicnum),          16 },
+    { ACTF(stayput),            16, 0, 0 },
+    { ACTF(dispicnum),          16, 0, 0 },
 
-    { ACTF(cgg),            8},
+    { ACTF(cgg),            8, 0, 0},
 
     //------------------------------------------------------
     // sprite fields
 
-    { ACTF(spr_x),                          32 },
-    { ACTF(spr_y),                          32 },
-    { ACTF(spr_z),                          32 },
+    { ACTF(spr_x),                          32, 12, 0 },
+    { ACTF(spr_y),                          32, 12, 0 },
+    { ACTF(spr_z),                          32, 16, 0 },
 
-    { ACTF(spr_cstat),          16 },
+    { ACTF(spr_cstat),          16, 0, 0 },
 
-    { ACTF(spr_picnum),         16 },
-    { ACTF(spr_shade),      8 },
-    { ACTF(spr_pal),        8 },
-    { ACTF(spr_clipdist),   8 },
-    { ACTF(spr_blend),      8 },
-    { ACTF(spr_xrepeat),    8 },
-    { ACTF(spr_yrepeat),    8 },
-    { ACTF(spr_xoffset),    8 },
-    { ACTF(spr_yoffset),    8 },
+    { ACTF(spr_picnum),         16, 0, 0 },
+    { ACTF(spr_shade),      8, 0, 0 },
+    { ACTF(spr_pal),        8, 0, 0 },
+    { ACTF(spr_clipdist),   8, 0, 0 },
+    { ACTF(spr_blend),      8, 0, 0 },
+    { ACTF(spr_xrepeat),    8, 0, 0 },
+    { ACTF(spr_yrepeat),    8, 0, 0 },
+    { ACTF(spr_xoffset),    8, 0, 0 },
+    { ACTF(spr_yoffset),    8, 0, 0 },
 
-    { ACTF(spr_sectnum),        16 },
-    { ACTF(spr_statnum),        16 },
+    { ACTF(spr_sectnum),        16, 0, 0 },
+    { ACTF(spr_statnum),        16, 0, 0 },
 
-    { ACTF(spr_ang),            16 },
-    { ACTF(spr_owner),          16 },
-    { ACTF(spr_xvel),           16 },
-    { ACTF(spr_yvel),           16 },
-    { ACTF(spr_zvel),           16 },
+    { ACTF(spr_ang),            16, 7, NETF_ANGLE },
+    { ACTF(spr_owner),          16, 0, 0 },
+    { ACTF(spr_xvel),           16, 0, 0 },
+    { ACTF(spr_yvel),           16, 0, 0 },
+    { ACTF(spr_zvel),           16, 0, 0 },
 
-    { ACTF(spr_lotag),          16 },
-    { ACTF(spr_hitag),          16 },
+    { ACTF(spr_lotag),          16, 0, 0 },
+    { ACTF(spr_hitag),          16, 0, 0 },
 
-    { ACTF(spr_extra),          16 },
+    { ACTF(spr_extra),          16, 0, 0 },
 
     //--------------------------------------------------------------
     //spriteext fields
 
-    { ACTF(ext_mdanimtims),                 32 },
-    { ACTF(ext_mdanimcur),      16 },
-    { ACTF(ext_angoff),         16 },
-    { ACTF(ext_pitch),          16 },
-    { ACTF(ext_roll),           16 },
+    { ACTF(ext_mdanimtims),                 32, 0, 0 },
+    { ACTF(ext_mdanimcur),      16, 0, 0 },
+    { ACTF(ext_angoff),         16, 0, 0 },
+    { ACTF(ext_pitch),          16, 0, 0 },
+    { ACTF(ext_roll),           16, 0, 0 },
 
-    { ACTF(ext_pivot_offset_x),                   32 },
-    { ACTF(ext_pivot_offset_y),                   32 },
-    { ACTF(ext_pivot_offset_z),                   32 },
+    { ACTF(ext_pivot_offset_x),                   32, 0, 0 },
+    { ACTF(ext_pivot_offset_y),                   32, 0, 0 },
+    { ACTF(ext_pivot_offset_z),                   32, 0, 0 },
 
-    { ACTF(ext_position_offset_x),                   32 },
-    { ACTF(ext_position_offset_y),                   32 },
-    { ACTF(ext_position_offset_z),                   32 },
+    { ACTF(ext_position_offset_x),                   32, 0, 0 },
+    { ACTF(ext_position_offset_y),                   32, 0, 0 },
+    { ACTF(ext_position_offset_z),                   32, 0, 0 },
 
-    { ACTF(ext_flags),      8 },
-    { ACTF(ext_xpanning),   8 },
-    { ACTF(ext_ypanning),   8 },
-    { ACTF(ext_alpha),                                  0 }, // float
+    { ACTF(ext_flags),      8, 0, 0 },
+    { ACTF(ext_xpanning),   8, 0, 0 },
+    { ACTF(ext_ypanning),   8, 0, 0 },
+    { ACTF(ext_alpha),                                  0, 0, 0 }, // float
 
     //--------------------------------------------------------------
     //spritesmooth fields
 
-    { ACTF(sm_smoothduration),                          0 }, // float
-    { ACTF(sm_mdcurframe),      16 },
-    { ACTF(sm_mdoldframe),      16 },
-    { ACTF(sm_mdsmooth),        16 },
+    { ACTF(sm_smoothduration),                          0, 0, 0 }, // float
+    { ACTF(sm_mdcurframe),      16, 0, 0 },
+    { ACTF(sm_mdoldframe),      16, 0, 0 },
+    { ACTF(sm_mdsmooth),        16, 0, 0 },
 
 
 
@@ -451,6 +455,126 @@ static const int32_t cSTOP_PARSING_CODE = ((1 << NETINDEX_BITS) - 1);
 
 static uint32_t NET_75_CHECK;
 
+//------------------------------------------------------------------------------
+// Map state pages (see netpage_t)
+//------------------------------------------------------------------------------
+
+// every entry of a freshly initialized map state points into these, they are never freed
+static netpage_t<netactor_t>  *g_nullActorPage;
+static netpage_t<netWall_t>   *g_nullWallPage;
+static netpage_t<netSector_t> *g_nullSectorPage;
+
+// number of pages allocated apart from the null pages, for DumpMapStateHistory()
+static int32_t g_netPageCount;
+
+template <typename T>
+static netpage_t<T> *Net_NewNullPage(const T &nullEntry)
+{
+    netpage_t<T> *page = (netpage_t<T> *)Xmalloc(sizeof(netpage_t<T>));
+
+    // the reference held by the g_null*Page pointer
+    page->refCount = 1;
+
+    for (T &entry : page->entry)
+        entry = nullEntry;
+
+    return page;
+}
+
+static void Net_InitNullPages(void)
+{
+    if (g_nullActorPage)
+    {
+        return;
+    }
+
+    netactor_t nullActor = cNullNetActor;
+    nullActor.netIndex = cSTOP_PARSING_CODE;
+
+    g_nullActorPage  = Net_NewNullPage(nullActor);
+    g_nullWallPage   = Net_NewNullPage(cNullNetWall);
+    g_nullSectorPage = Net_NewNullPage(cNullNetSector);
+}
+
+// point pageSlot at page, dropping the page it pointed at before
+template <typename T>
+static void Net_SetPage(netpage_t<T> **pageSlot, netpage_t<T> *page)
+{
+    netpage_t<T> *oldPage = *pageSlot;
+
+    page->refCount++;
+    *pageSlot = page;
+
+    if (oldPage && --oldPage->refCount == 0)
+    {
+        Xfree(oldPage);
+        g_netPageCount--;
+    }
+}
+
+template <typename T>
+static const T *Net_GetEntry(netpage_t<T> *const *pages, int32_t index)
+{
+    return &pages[index >> NETPAGE_SHIFT]->entry[index & (NETPAGE_ENTRIES - 1)];
+}
+
+// returns the entry for writing, copying its page first if any other map state still uses it
+template <typename T>
+static T *Net_GetWritableEntry(netpage_t<T> **pages, int32_t index)
+{
+    netpage_t<T> *&page = pages[index >> NETPAGE_SHIFT];
+
+    if (page->refCount > 1)
+    {
+        netpage_t<T> *newPage = (netpage_t<T> *)Xmalloc(sizeof(netpage_t<T>));
+
+        Bmemcpy(newPage->entry, page->entry, sizeof(newPage->entry));
+        newPage->refCount = 1;
+        g_netPageCount++;
+
+        page->refCount--;
+        page = newPage;
+    }
+
+    return &page->entry[index & (NETPAGE_ENTRIES - 1)];
+}
+
+// only writes entries that actually differ, so that pages nothing changed in stay shared
+template <typename T>
+static void Net_StoreEntry(netpage_t<T> **pages, int32_t index, const T &value)
+{
+    if (memcmp(Net_GetEntry(pages, index), &value, sizeof(T)) != 0)
+    {
+        *Net_GetWritableEntry(pages, index) = value;
+    }
+}
+
+// make dest share all of source's pages
+static void Net_ShareMapState(netmapstate_t *dest, const netmapstate_t *source)
+{
+    if (dest == source)
+    {
+        return;
+    }
+
+    for (int32_t pageIndex = 0; pageIndex < ARRAY_SSIZE(dest->actor); pageIndex++)
+    {
+        Net_SetPage(&dest->actor[pageIndex], source->actor[pageIndex]);
+    }
+
+    for (int32_t pageIndex = 0; pageIndex < ARRAY_SSIZE(dest->wall); pageIndex++)
+    {
+        Net_SetPage(&dest->wall[pageIndex], source->wall[pageIndex]);
+    }
+
+    for (int32_t pageIndex = 0; pageIndex < ARRAY_SSIZE(dest->sector); pageIndex++)
+    {
+        Net_SetPage(&dest->sector[pageIndex], source->sector[pageIndex]);
+    }
+
+    dest->maxActorIndex = source->maxActorIndex;
+}
+
 // Externally available data / functions
 int32_t     g_netPlayersWaiting = 0;
 int32_t     g_netIndex          = 2;
@@ -597,7 +721,7 @@ static void Net_InitNetActor(netactor_t *netActor)
 // Net -> Game Arrays
 //------------------------------------------------------------------------------
 
-static void Net_CopyWallFromNet(netWall_t* netWall, walltype* gameWall)
+static void Net_CopyWallFromNet(const netWall_t* netWall, walltype* gameWall)
 {
     // (convert data from 32 bit integers)
 
@@ -640,7 +764,7 @@ static void Net_CopyWallFromNet(netWall_t* netWall, walltype* gameWall)
 
 }
 
-static void Net_CopySectorFromNet(netSector_t* netSector, sectortype* gameSector)
+static void Net_CopySectorFromNet(const netSector_t* netSector, sectortype* gameSector)
 {
     Bassert(gameSector);
     Bassert(netSector);
@@ -1092,8 +1216,16 @@ static void Net_CopyActorsToGameArrays(const netmapstate_t* srv_snapshot, const
 
     for (actorIndex = 0; actorIndex < MAXSPRITES; actorIndex++)
     {
-        const netactor_t*       srvActor = &(srv_snapshot->actor[actorIndex]);
-        const netactor_t*       clActor  = &(cl_snapshot->actor[actorIndex]);
+        // a page both snapshots share holds no incorrect guesses
+        if (g_enableClientInterpolationCheck && (actorIndex & (NETPAGE_ENTRIES - 1)) == 0
+            && srv_snapshot->actor[actorIndex >> NETPAGE_SHIFT] == cl_snapshot->actor[actorIndex >> NETPAGE_SHIFT])
+        {
+            actorIndex += NETPAGE_ENTRIES - 1;
+            continue;
+        }
+
+        const netactor_t*       srvActor = Net_GetEntry(srv_snapshot->actor, actorIndex);
+        const netactor_t*       clActor  = Net_GetEntry(cl_snapshot->actor, actorIndex);
 
         int status = memcmp(srvActor, clActor, sizeof(netactor_t));
 
@@ -1393,10 +1525,12 @@ static void Net_AddActorsToSnapshot(netmapstate_t* snapshot)
         const spriteext_t*      gameExt = &spriteext[gameIndex];
         const spritesmooth_t*   gameSmooth = &spritesmooth[gameIndex];
 
-        netactor_t*       netSprite = &snapshot->actor[gameIndex];
+        netactor_t        netSprite = cNullNetActor;
 
 
-        Net_CopyAllActorDataToNet(gameIndex, gameSpr, gameAct, gameExt, gameSmooth, netSprite);
+        Net_CopyAllActorDataToNet(gameIndex, gameSpr, gameAct, gameExt, gameSmooth, &netSprite);
+
+        Net_StoreEntry(snapshot->actor, gameIndex, netSprite);
 
     }
 
@@ -1414,9 +1548,10 @@ static void Net_AddWorldToSnapshot(netmapstate_t* snapshot)
         // on the off chance that numwalls somehow gets set to higher than MAXWALLS... somehow...
         Bassert(index < MAXWALLS);
         const	walltype*   gameWall = &wall[index];
-        netWall_t*  snapshotWall = &snapshot->wall[index];
+        netWall_t   snapshotWall = cNullNetWall;
 
-        Net_CopyWallToNet(gameWall, snapshotWall, index);
+        Net_CopyWallToNet(gameWall, &snapshotWall, index);
+        Net_StoreEntry(snapshot->wall, index, snapshotWall);
 
 
     }
@@ -1425,9 +1560,10 @@ static void Net_AddWorldToSnapshot(netmapstate_t* snapshot)
     {
         Bassert(index < MAXSECTORS);
         const	sectortype*  gameSector = &sector[index];
-        netSector_t* snapshotSector = &snapshot->sector[index];
+        netSector_t  snapshotSector = cNullNetSector;
 
-        Net_CopySectorToNet(gameSector, snapshotSector, index);
+        Net_CopySectorToNet(gameSector, &snapshotSector, index);
+        Net_StoreEntry(snapshot->sector, index, snapshotSector);
 
     }
 
@@ -2542,31 +2678,26 @@ static void Net_InitMapState(netmapstate_t* mapState)
 {
     Bassert(mapState != nullptr);
 
-    netactor_t  sprDefault = cNullNetActor;
-
-    int32_t     index = 0;
-
-    sprDefault.netIndex = cSTOP_PARSING_CODE;
+    Net_InitNullPages();
 
     mapState->maxActorIndex = 0;
 
-    // this code is just a (slow) memset as it is now,
     // it may be a good idea to use "baselines", which can reduce the amount
     // of delta encoding when a sprite is first added. This
     // could be a good optimization to consider later.
-    for (index = 0; index < MAXSPRITES; index++)
+    for (auto &page : mapState->actor)
     {
-        mapState->actor[index] = sprDefault;
+        Net_SetPage(&page, g_nullActorPage);
     }
 
-    for (index = 0; index < MAXWALLS; index++)
+    for (auto &page : mapState->wall)
     {
-        mapState->wall[index] = cNullNetWall;
+        Net_SetPage(&page, g_nullWallPage);
     }
 
-    for (index = 0; index < MAXSECTORS; index++)
+    for (auto &page : mapState->sector)
     {
-        mapState->sector[index] = cNullNetSector;
+        Net_SetPage(&page, g_nullSectorPage);
     }
 
     // set the revision number to a valid but easy to identify number,
@@ -2671,88 +2802,68 @@ static void SafeStrncpyz(char *dest, const char *src, int destsize)
     dest[destsize - 1] = 0;
 }
 
-// Write a bit (bitValue) to a byte array (dataBuffer) at bit offset bitOffset,
-// this function increments bitOffset for you.
-static void PutBit(int32_t bitValue, uint8_t *dataBuffer, int32_t *bitOffset)
-{
-    int32_t bitOffsetValue = *bitOffset;
-
-    const int32_t byteIndex = bitOffsetValue >> 3;
-    const int32_t bitIndex = bitOffsetValue & 7;
-
-    // reset this byte to 0 on the first bit
-    if ((bitIndex) == 0)
-    {
-        dataBuffer[byteIndex] = 0;
-    }
-
-    dataBuffer[byteIndex] |= (bitValue << (bitIndex));
-
-
-    bitOffsetValue++;
-    *bitOffset = bitOffsetValue;
-}
-
-// Get a single bit (return value) from a byte array (dataBuffer) at bit offset bitOffset
-// this function increments bitOffset for you.
-static int32_t GetBit(uint8_t *dataBuffer, int32_t *bitOffset)
-{
-    int32_t bitValue = -1;
-
-    int32_t bitOffsetValue = *bitOffset;
-
-    const int32_t byteIndex = bitOffsetValue >> 3;
-    const int32_t bitIndex = bitOffsetValue & 7;
-
-    bitValue = (dataBuffer[byteIndex] >> bitIndex) & 0x1;
-
-    bitOffsetValue++;
-    *bitOffset = bitOffsetValue;
-
-    return bitValue;
-}
-
 //Note: This function increments bitOffset for you
 static void PutBits(int32_t value, uint8_t *dataBuffer, int32_t *bitOffset, int16_t numberOfBits)
 {
-    int16_t bitIndex;
-
     if (numberOfBits > 32)
     {
         Net_Error_Disconnect("PutBits: Attempted to write more than 32 bits to the buffer.");
         numberOfBits = 32;
     }
 
-    for (bitIndex = 0; bitIndex < numberOfBits; bitIndex++)
+    uint32_t bitsLeft = value;
+    int32_t  bitOffsetValue = *bitOffset;
+
+    // least significant bits first, filling up to a byte per step
+    while (numberOfBits > 0)
     {
-        int32_t bitValue = value & (1 << bitIndex);
+        const int32_t byteIndex = bitOffsetValue >> 3;
+        const int32_t bitIndex = bitOffsetValue & 7;
+        const int32_t chunkBits = min<int32_t>(8 - bitIndex, numberOfBits);
 
-        PutBit((bitValue != 0), dataBuffer, bitOffset);
+        if (bitIndex == 0)
+        {
+            dataBuffer[byteIndex] = 0;
+        }
 
+        dataBuffer[byteIndex] |= (uint8_t)((bitsLeft & ((1u << chunkBits) - 1)) << bitIndex);
+
+        bitsLeft >>= chunkBits;
+        bitOffsetValue += chunkBits;
+        numberOfBits -= chunkBits;
     }
 
+    *bitOffset = bitOffsetValue;
 }
 
 //Note: this function increments bitOffset for you
 static int32_t GetBits(uint8_t *dataBuffer, int32_t *bitOffset, int16_t numberOfBits)
 {
-    int32_t value = 0;
-    int16_t bitIndex;
-
     if (numberOfBits > 32)
     {
         Net_Error_Disconnect("GetBits: Attempted to read more than 32 bits from the buffer.");
         numberOfBits = 32;
     }
 
-    for (bitIndex = 0; bitIndex < numberOfBits; bitIndex++)
+    uint32_t value = 0;
+    int32_t  valueBits = 0;
+    int32_t  bitOffsetValue = *bitOffset;
+
+    while (numberOfBits > 0)
     {
-        int32_t tBitValue = GetBit(dataBuffer, bitOffset);
+        const int32_t byteIndex = bitOffsetValue >> 3;
+        const int32_t bitIndex = bitOffsetValue & 7;
+        const int32_t chunkBits = min<int32_t>(8 - bitIndex, numberOfBits);
 
-        value |= (tBitValue << bitIndex);
+        value |= (uint32_t)((dataBuffer[byteIndex] >> bitIndex) & ((1u << chunkBits) - 1)) << valueBits;
 
+        valueBits += chunkBits;
+        bitOffsetValue += chunkBits;
+        numberOfBits -= chunkBits;
     }
 
+    *bitOffset = bitOffsetValue;
+
     return value;
 }
 
@@ -3031,6 +3142,51 @@ EDUKE32_UNUSED static void NetBuffer_ReadData(NetBuffer_t *netBuffer, void *data
     }
 }
 
+// value of a changed, non-zero field
+//
+// positions and angles mostly move by small amounts between revisions, so fields with deltaBits
+// are written as {0, <change from the "from" value>} when the change fits, and as {1, <value>} otherwise.
+// Angles only take the short form if they are within 0-2047, where the change modulo 2048 is exact.
+static void NetBuffer_WriteFieldValue(NetBuffer_t *netBuffer, const netField_t *field, int32_t fromValue, int32_t toValue)
+{
+    if (field->deltaBits)
+    {
+        const uint32_t cValueMask = field->isAngle ? 2047 : (0xffffffff >> (32 - field->bits));
+        const int32_t  cValueShift = 32 - (field->isAngle ? 11 : field->bits);
+        const int32_t  cDeltaLimit = 1 << (field->deltaBits - 1);
+
+        // sign-extended change, wrapped the same way the field will be when it is read
+        const int32_t  change = (int32_t)((((uint32_t)toValue - (uint32_t)fromValue) & cValueMask) << cValueShift) >> cValueShift;
+
+        if ((!field->isAngle || (uint32_t)toValue <= cValueMask) && change >= -cDeltaLimit && change < cDeltaLimit)
+        {
+            NetBuffer_WriteBits(netBuffer, 0, 1);                                       // {0}          small change
+            NetBuffer_WriteBits(netBuffer, change, field->deltaBits);                   // {0, <change>}
+            return;
+        }
+
+        NetBuffer_WriteBits(netBuffer, 1, 1);                                           // {1}          whole value
+    }
+
+    NetBuffer_WriteBits(netBuffer, toValue, field->bits);
+}
+
+static int32_t NetBuffer_ReadFieldValue(NetBuffer_t *netBuffer, const netField_t *field, int32_t fromValue)
+{
+    if (field->deltaBits && NetBuffer_ReadBits(netBuffer, 1) == 0)
+    {
+        const uint32_t cValueMask = field->isAngle ? 2047 : (0xffffffff >> (32 - field->bits));
+        const int32_t  cDeltaShift = 32 - field->deltaBits;
+
+        const int32_t  change = (int32_t)((uint32_t)NetBuffer_ReadBits(netBuffer, field->deltaBits) << cDeltaShift) >> cDeltaShift;
+
+        // the same as reading the whole value, which only keeps the low field->bits bits
+        return (int32_t)(((uint32_t)fromValue + (uint32_t)change) & cValueMask);
+    }
+
+    return NetBuffer_ReadBits(netBuffer, field->bits);
+}
+
 // net struct -> Buffer functions
 //----------------------------------------------------------------------------------------------------------
 
@@ -3105,7 +3261,7 @@ static void NetBuffer_WriteDeltaNetWall(NetBuffer_t *netBuffer, const netWall_t
         else
         {
             NetBuffer_WriteBits(netBuffer, 1, 1);                       // don't zero this field
-            NetBuffer_WriteBits(netBuffer, *toField, fieldPtr->bits);   // new field value
+            NetBuffer_WriteFieldValue(netBuffer, fieldPtr, *fromField, *toField);   // new field value
         }
 
     }
@@ -3182,7 +3338,7 @@ static void NetBuffer_WriteDeltaNetSector(NetBuffer_t *netBuffer, const netSecto
         else
         {
             NetBuffer_WriteBits(netBuffer, 1, 1);                       // don't zero this field
-            NetBuffer_WriteBits(netBuffer, *toField, fieldPtr->bits);      // new field value
+            NetBuffer_WriteFieldValue(netBuffer, fieldPtr, *fromField, *toField);  // new field value
         }
 
     }
@@ -3311,7 +3467,7 @@ static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_
             else
             {
                 NetBuffer_WriteBits(netBuffer, 1, 1);                                    // {1, 1}           don't zero this int field
-                NetBuffer_WriteBits(netBuffer, *toField, fieldPtr->bits);                    // {1, 1, <value>}  new field value
+                NetBuffer_WriteFieldValue(netBuffer, fieldPtr, *fromField, *toField);       // {1, 1, <value>}  new field value
 
             }
 
@@ -3350,6 +3506,14 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
         actorIndex < fromMaxIndex
         )
     {
+        // nothing changed in a page both snapshots share
+        if ((actorIndex & (NETPAGE_ENTRIES - 1)) == 0
+            && actorIndex + NETPAGE_ENTRIES <= min(to->maxActorIndex, (int32_t)fromMaxIndex)
+            && from->actor[actorIndex >> NETPAGE_SHIFT] == to->actor[actorIndex >> NETPAGE_SHIFT])
+        {
+            actorIndex += NETPAGE_ENTRIES;
+            continue;
+        }
 
         // load actor pointers using actor indexes
         if (actorIndex >= to->maxActorIndex)
@@ -3358,7 +3522,7 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
         }
         else
         {
-            toActor = &to->actor[actorIndex];
+            toActor = Net_GetEntry(to->actor, actorIndex);
 
             if (toActor->netIndex == cSTOP_PARSING_CODE)
             {
@@ -3373,7 +3537,7 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
         }
         else
         {
-            fromActor = &from->actor[actorIndex];
+            fromActor = Net_GetEntry(from->actor, actorIndex);
 
             if (fromActor->netIndex == cSTOP_PARSING_CODE)
             {
@@ -3400,8 +3564,15 @@ static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t*
     {
         Bassert(index < MAXWALLS);
 
-        const netWall_t* fromWall = &fromSnapshot->wall[index];
-        const netWall_t* toWall = &toSnapshot->wall[index];
+        // nothing changed in a page both snapshots share
+        if ((index & (NETPAGE_ENTRIES - 1)) == 0 && fromSnapshot->wall[index >> NETPAGE_SHIFT] == toSnapshot->wall[index >> NETPAGE_SHIFT])
+        {
+            index += NETPAGE_ENTRIES - 1;
+            continue;
+        }
+
+        const netWall_t* fromWall = Net_GetEntry(fromSnapshot->wall, index);
+        const netWall_t* toWall = Net_GetEntry(toSnapshot->wall, index);
 
         NetBuffer_WriteDeltaNetWall(netBuffer, fromWall, toWall);
 
@@ -3415,8 +3586,14 @@ static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t*
     {
         Bassert(index < MAXSECTORS);
 
-        const netSector_t* fromSector = &fromSnapshot->sector[index];
-        const netSector_t* toSector = &toSnapshot->sector[index];
+        if ((index & (NETPAGE_ENTRIES - 1)) == 0 && fromSnapshot->sector[index >> NETPAGE_SHIFT] == toSnapshot->sector[index >> NETPAGE_SHIFT])
+        {
+            index += NETPAGE_ENTRIES - 1;
+            continue;
+        }
+
+        const netSector_t* fromSector = Net_GetEntry(fromSnapshot->sector, index);
+        const netSector_t* toSector = Net_GetEntry(toSnapshot->sector, index);
 
         NetBuffer_WriteDeltaNetSector(netBuffer, fromSector, toSector);
     }
@@ -3500,7 +3677,7 @@ static void NetBuffer_ReadDeltaWall(NetBuffer_t *netBuffer, const netWall_t *fro
             // read the whole field
             else
             {
-                *toField = NetBuffer_ReadBits(netBuffer, field->bits);
+                *toField = NetBuffer_ReadFieldValue(netBuffer, field, *fromField);
 
             }
 
@@ -3585,7 +3762,7 @@ static void NetBuffer_ReadDeltaSector(NetBuffer_t *netBuffer, const netSector_t
             // read the whole field
             else
             {
-                *toField = NetBuffer_ReadBits(netBuffer, field->bits);
+                *toField = NetBuffer_ReadFieldValue(netBuffer, field, *fromField);
 
             }
 
@@ -3742,7 +3919,7 @@ static void NetBuffer_ReadDeltaActor(NetBuffer_t* netBuffer, const netactor_t *f
                 // read the whole field
                 else
                 {
-                    *toField = NetBuffer_ReadBits(netBuffer, field->bits);
+                    *toField = NetBuffer_ReadFieldValue(netBuffer, field, *fromField);
 
                 }
             }
@@ -3781,7 +3958,7 @@ static void Net_ParseWalls(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot, n
 
 
 
-    netWall_t       *oldSnapshotStruct = NULL;
+    const netWall_t *oldSnapshotStruct = NULL;
     netWall_t       *newSnapshotStruct = NULL;
 
     const   int32_t         cMaxStructIndex = numwalls - 1;
@@ -3840,9 +4017,6 @@ static void Net_ParseWalls(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot, n
             break;
         }
 
-        newSnapshotStruct = &(newSnapshot->wall[newSnapshotNetIndex]);
-        oldSnapshotStruct = &(oldSnapshot->wall[oldSnapshotNetIndex]);
-
         if (netBuffer->ReadCurByte > netBuffer->CurSize)
         {
             Net_Error_Disconnect("Net_ParseWalls: Reached end of buffer without finding a stop code.");
@@ -3850,19 +4024,19 @@ static void Net_ParseWalls(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot, n
         }
 
         // index up to the point where the changed structs start
-        while (oldSnapshotNetIndex < newSnapshotNetIndex)
+        // (walls that are not in the delta entity set already share the previous snapshot's page)
+        if (oldSnapshotNetIndex < newSnapshotNetIndex)
         {
-            // if it's not in the delta entity set, just use the previous snapshot's value
-            newSnapshot->wall[oldSnapshotNetIndex] = oldSnapshot->wall[oldSnapshotNetIndex];
-            oldSnapshotNetIndex++;
-            oldSnapshotStruct = &(oldSnapshot->wall[oldSnapshotNetIndex]);
-
+            oldSnapshotNetIndex = newSnapshotNetIndex;
         }
 
         // the struct referred to by oldindex is the same struct as the one referred to by newindex,
         // compare the two structs
         if (oldSnapshotNetIndex == newSnapshotNetIndex)
         {
+            oldSnapshotStruct = Net_GetEntry(oldSnapshot->wall, oldSnapshotNetIndex);
+            newSnapshotStruct = Net_GetWritableEntry(newSnapshot->wall, newSnapshotNetIndex);
+
             NetBuffer_ReadDeltaWall(netBuffer, oldSnapshotStruct, newSnapshotStruct, newSnapshotNetIndex);
 
             oldSnapshotNetIndex++;
@@ -3877,16 +4051,8 @@ static void Net_ParseWalls(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot, n
 
     }
 
-    // No more walls changed for the new snapshot, but there's still walls in the old snapshot.
-    //
-    // all of those old walls are unchanged. Copy all of these into the new snapshot.
-    while (oldSnapshotNetIndex < numwalls)
-    {
-        newSnapshot->wall[oldSnapshotNetIndex] = oldSnapshot->wall[oldSnapshotNetIndex];
-
-        oldSnapshotNetIndex++;
-    }
-
+    // No more walls changed for the new snapshot, any walls left in the old snapshot are unchanged
+    // and already shared with the new one.
 }
 
 static void Net_ParseSectors(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot, netmapstate_t *newSnapshot)
@@ -3899,7 +4065,7 @@ static void Net_ParseSectors(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot,
 
 
 
-    netSector_t     *oldSnapshotStruct = NULL;
+    const netSector_t *oldSnapshotStruct = NULL;
     netSector_t     *newSnapshotStruct = NULL;
 
     const   int32_t         cMaxStructIndex = numsectors - 1;
@@ -3968,9 +4134,6 @@ static void Net_ParseSectors(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot,
             break;
         }
 
-        newSnapshotStruct = &(newSnapshot->sector[newSnapshotNetIndex]);
-        oldSnapshotStruct = &(oldSnapshot->sector[oldSnapshotNetIndex]);
-
         if (netBuffer->ReadCurByte > netBuffer->CurSize)
         {
             Net_Error_Disconnect("Net_ParseSectors: Reached end of buffer without finding a stop code.");
@@ -3978,18 +4141,19 @@ static void Net_ParseSectors(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot,
         }
 
         // index up to the point where the changed structs start
-        while (oldSnapshotNetIndex < newSnapshotNetIndex)
+        // (sectors that are not in the delta entity set already share the previous snapshot's page)
+        if (oldSnapshotNetIndex < newSnapshotNetIndex)
         {
-            // if it's not in the delta entity set, just use the previous snapshot's value
-            newSnapshot->sector[oldSnapshotNetIndex] = oldSnapshot->sector[oldSnapshotNetIndex];
-            oldSnapshotNetIndex++;
-            oldSnapshotStruct = &(oldSnapshot->sector[oldSnapshotNetIndex]);
+            oldSnapshotNetIndex = newSnapshotNetIndex;
         }
 
         // the struct referred to by oldindex is the same struct as the one referred to by newindex,
         // compare the two structs
         if (oldSnapshotNetIndex == newSnapshotNetIndex)
         {
+            oldSnapshotStruct = Net_GetEntry(oldSnapshot->sector, oldSnapshotNetIndex);
+            newSnapshotStruct = Net_GetWritableEntry(newSnapshot->sector, newSnapshotNetIndex);
+
             NetBuffer_ReadDeltaSector(netBuffer, oldSnapshotStruct, newSnapshotStruct, newSnapshotNetIndex);
 
             oldSnapshotNetIndex++;
@@ -4002,16 +4166,8 @@ static void Net_ParseSectors(NetBuffer_t *netBuffer, netmapstate_t *oldSnapshot,
 
     }
 
-    // No more sectors changed for the new snapshot, but there's still sectors in the old snapshot.
-    //
-    // all of those old sectors are unchanged. Copy all of these into the new snapshot.
-    while (oldSnapshotNetIndex < numsectors)
-    {
-        newSnapshot->sector[oldSnapshotNetIndex] = oldSnapshot->sector[oldSnapshotNetIndex];
-
-        oldSnapshotNetIndex++;
-    }
-
+    // No more sectors changed for the new snapshot, any sectors left in the old snapshot are unchanged
+    // and already shared with the new one.
 }
 
 static void Net_ParseActors(NetBuffer_t *netBuffer, const netmapstate_t* oldSnapshot, netmapstate_t* newSnapshot)
@@ -4050,7 +4206,7 @@ static void Net_ParseActors(NetBuffer_t *netBuffer, const netmapstate_t* oldSnap
     }
     else
     {
-        oldSnapshotStruct = &oldSnapshot->actor[oldActorIndex];
+        oldSnapshotStruct = Net_GetEntry(oldSnapshot->actor, oldActorIndex);
     }
 
     //read each struct from the delta packet, until the NetIndex == the stop number
@@ -4076,9 +4232,8 @@ static void Net_ParseActors(NetBuffer_t *netBuffer, const netmapstate_t* oldSnap
 
         if (newActorIndex == cSTOP_PARSING_CODE)
         {
-            //NOTE: This is okay, there is a while loop below to handle cases
-            //      where there are unchanged actors after the last changed actor in the
-            //      netbuffer.
+            //NOTE: This is okay, unchanged actors after the last changed actor in the
+            //      netbuffer were already shared from the old snapshot.
             break;
         }
 
@@ -4092,22 +4247,19 @@ static void Net_ParseActors(NetBuffer_t *netBuffer, const netmapstate_t* oldSnap
             Net_Error_Disconnect("Net_ParseActors: Invalid netIndex from client.");
         }
 
-        // loop up to the point where the structs changed between the old frame and the new frame start
-        while (oldActorIndex < newActorIndex)
+        // skip up to the point where the structs changed between the old frame and the new frame start,
+        // actors unchanged in the new snapshot already share the previous snapshot's page
+        if (oldActorIndex < newActorIndex)
         {
-            //actor is unchanged in the new snapshot, just *copy* the previous snapshot's value
-            newSnapshot->actor[oldActorIndex] = oldSnapshot->actor[oldActorIndex];
-
-            oldActorIndex++;
-
+            oldActorIndex = newActorIndex;
         }
 
         // NOTE that actors deleted for the new snapshot will be processed *here*. New actors that "fill in gaps"
         // (rather than being added to the end) in the actor list will be processed here too.
         if (oldActorIndex == newActorIndex)
         {
-            oldSnapshotStruct = &(oldSnapshot->actor[oldActorIndex]);
-            newSnapshotStruct = &(newSnapshot->actor[newActorIndex]);
+            oldSnapshotStruct = Net_GetEntry(oldSnapshot->actor, oldActorIndex);
+            newSnapshotStruct = Net_GetWritableEntry(newSnapshot->actor, newActorIndex);
 
             NetBuffer_ReadDeltaActor(netBuffer, oldSnapshotStruct, newSnapshotStruct, newActorIndex);
 
@@ -4126,24 +4278,15 @@ static void Net_ParseActors(NetBuffer_t *netBuffer, const netmapstate_t* oldSnap
         // Note that the "no more oldframe entities" index constant runs this
         if (oldActorIndex > newActorIndex)
         {
-            newSnapshotStruct = &(newSnapshot->actor[newActorIndex]);
+            newSnapshotStruct = Net_GetWritableEntry(newSnapshot->actor, newActorIndex);
 
             NetBuffer_ReadDeltaActor(netBuffer, &cNullNetActor, newSnapshotStruct, newActorIndex);
 
         }
     }
 
-    // No more actors changed for the new snapshot, but there's still actors in the old snapshot.
-    //
-    // All of those old actors are unchanged. Copy all of these into the new snapshot.
-    // Remember that deleting an actor counts as a "change".
-    while (oldActorIndex < MAXSPRITES)
-    {
-        newSnapshot->actor[oldActorIndex] = oldSnapshot->actor[oldActorIndex];
-
-        oldActorIndex++;
-
-    }
+    // No more actors changed for the new snapshot, any actors left in the old snapshot are unchanged
+    // and already shared with the new one. Remember that deleting an actor counts as a "change".
 
     NET_75_CHECK++; // For now every snapshot will have MAXSPRITES entries
     newSnapshot->maxActorIndex = MAXSPRITES;
@@ -4156,6 +4299,9 @@ static void NetBuffer_ReadWorldSnapshotFromBuffer(NetBuffer_t* netBuffer, netmap
     Bassert(oldSnapshot != nullptr);
     Bassert(newSnapshot != nullptr);
 
+    // start out with everything unchanged, parsing only replaces what the delta touches
+    Net_ShareMapState(newSnapshot, oldSnapshot);
+
     // note that the order these functions are called should match the order that these structs are written to
     // by the server
     Net_ParseWalls(netBuffer, oldSnapshot, newSnapshot);
@@ -4256,8 +4402,16 @@ static void Net_CopySnapshotToGameArrays(netmapstate_t* srv_snapshot, netmapstat
 
     for (index = 0; index < numwalls; index++)
     {
-        netWall_t*  srvWall = &(srv_snapshot->wall[index]);
-        netWall_t*  clWall  = &(cl_snapshot->wall[index]);
+        if (g_enableClientInterpolationCheck && (index & (NETPAGE_ENTRIES - 1)) == 0
+            && srv_snapshot->wall[index >> NETPAGE_SHIFT] == cl_snapshot->wall[index >> NETPAGE_SHIFT])
+        {
+            // same page in both snapshots, the client interpolated all of these walls correctly
+            index += NETPAGE_ENTRIES - 1;
+            continue;
+        }
+
+        const netWall_t*  srvWall = Net_GetEntry(srv_snapshot->wall, index);
+        const netWall_t*  clWall  = Net_GetEntry(cl_snapshot->wall, index);
 
         int status = memcmp(srvWall, clWall, sizeof(netWall_t));
 
@@ -4278,8 +4432,15 @@ static void Net_CopySnapshotToGameArrays(netmapstate_t* srv_snapshot, netmapstat
 
     for (index = 0; index < numsectors; index++)
     {
-        netSector_t*  srvSector = &(srv_snapshot->sector[index]);
-        netSector_t*  clSector  = &(cl_snapshot->sector[index]);
+        if (g_enableClientInterpolationCheck && (index & (NETPAGE_ENTRIES - 1)) == 0
+            && srv_snapshot->sector[index >> NETPAGE_SHIFT] == cl_snapshot->sector[index >> NETPAGE_SHIFT])
+        {
+            index += NETPAGE_ENTRIES - 1;
+            continue;
+        }
+
+        const netSector_t*  srvSector = Net_GetEntry(srv_snapshot->sector, index);
+        const netSector_t*  clSector  = Net_GetEntry(cl_snapshot->sector, index);
 
         int status = memcmp(srvSector, clSector, sizeof(netSector_t));
 
@@ -4312,7 +4473,7 @@ static void Net_ReadWorldUpdate(uint8_t* packetData, int32_t packetSize)
     uint8_t*        dataStartAddr = packetData + 1;
 
     NET_DEBUG_VAR int16_t   DEBUG_NoMapLoaded               = ((numwalls < 1) || (numsectors < 1));
-    NET_DEBUG_VAR int32_t   DEBUG_InitialSnapshotNotSet     = (g_mapStartState->sector[0].wallnum <= 0);
+    NET_DEBUG_VAR int32_t   DEBUG_InitialSnapshotNotSet     = (Net_GetEntry(g_mapStartState->sector, 0)->wallnum <= 0);
 
     if (!ClientPlayerReady)
     {
@@ -4563,13 +4724,18 @@ void Net_StoreClientState(void)
         return;
     }
 
+    uint32_t const prevRevision = g_cl_InterpolatedRevision;
+
     g_cl_InterpolatedRevision = Net_GetNextRevisionNumber(g_cl_InterpolatedRevision);
 
     netmapstate_t* currentMapState = g_cl_InterpolatedMapStateHistory[g_cl_InterpolatedRevision % NET_REVISIONS];
 
     Bassert(currentMapState != nullptr);
 
-    Net_InitMapState(currentMapState);
+    // start from the previous state so that only the pages that changed since then get copied
+    Net_ShareMapState(currentMapState, (prevRevision == cInitialMapStateRevisionNumber)
+                                       ? g_mapStartState
+                                       : g_cl_InterpolatedMapStateHistory[prevRevision % NET_REVISIONS]);
     Net_AddWorldToSnapshot(currentMapState);
 
     currentMapState->revisionNumber = g_cl_InterpolatedRevision;
@@ -4583,13 +4749,18 @@ void Net_SendMapUpdate(void)
         return;
     }
 
+    uint32_t const prevRevision = g_netMapRevisionNumber;
+
     g_netMapRevisionNumber = Net_GetNextRevisionNumber(g_netMapRevisionNumber);
 
     netmapstate_t* toMapState = g_mapStateHistory[g_netMapRevisionNumber % NET_REVISIONS];
 
     Bassert(toMapState != nullptr);
 
-    Net_InitMapState(toMapState);
+    // share the previous revision's pages, the world only touches a few of them per tic
+    Net_ShareMapState(toMapState, (prevRevision == cInitialMapStateRevisionNumber)
+                                  ? g_mapStartState
+                                  : g_mapStateHistory[prevRevision % NET_REVISIONS]);
     Net_AddWorldToSnapshot(toMapState);
 
     toMapState->revisionNumber = g_netMapRevisionNumber;
@@ -4630,12 +4801,28 @@ void DumpMapStateHistory()
     // write the null map state (it should never, ever be changed, but just for completeness sake
     // fwrite(&NullMapState, sizeof(NullMapState), 1, mapStatesFile);
 
-    fwrite(g_mapStartState, sizeof(g_mapStartState), 1, mapStatesFile);
+    // map states only hold pointers to their (possibly shared) pages, so write out the entries themselves
+    auto const writeMapState = [mapStatesFile](const netmapstate_t *mapState)
+    {
+        fwrite(&mapState->revisionNumber, sizeof(mapState->revisionNumber), 1, mapStatesFile);
+        fwrite(&mapState->maxActorIndex, sizeof(mapState->maxActorIndex), 1, mapStatesFile);
+
+        for (auto page : mapState->actor)
+            fwrite(page->entry, sizeof(page->entry), 1, mapStatesFile);
+
+        for (auto page : mapState->wall)
+            fwrite(page->entry, sizeof(page->entry), 1, mapStatesFile);
+
+        for (auto page : mapState->sector)
+            fwrite(page->entry, sizeof(page->entry), 1, mapStatesFile);
+    };
+
+    writeMapState(g_mapStartState);
 
     for (int mapStateIndex = 0; mapStateIndex < NET_REVISIONS; mapStateIndex++)
-        fwrite(g_mapStateHistory[mapStateIndex], sizeof(netmapstate_t), 1, mapStatesFile);
+        writeMapState(g_mapStateHistory[mapStateIndex]);
 
-    OSD_Printf("Dumped map states to %s.\n", fileName);
+    OSD_Printf("Dumped map states to %s (%d pages allocated).\n", fileName, g_netPageCount);
 
     fclose(mapStatesFile);
     mapStatesFile = NULL;
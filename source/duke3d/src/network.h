@@ -34,7 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "enet.h"
 
 // net packet specification/compatibility version
-#define NETVERSION    1
+#define NETVERSION    2
 
 extern ENetHost       *g_netClient;
 extern ENetHost       *g_netServer;
@@ -177,6 +177,21 @@ typedef struct netSector_s
         extra;
 } netSector_t;
 
+// Map states are split into pages of NETPAGE_ENTRIES walls, sectors or actors. A page is shared by
+// every map state it is identical in and only copied once one of them changes it, so the revision
+// history only costs what actually changed between revisions instead of a full copy of the world each.
+#define NETPAGE_SHIFT 5
+#define NETPAGE_ENTRIES (1 << NETPAGE_SHIFT)
+#define NETPAGE_COUNT(x) (((x) + NETPAGE_ENTRIES - 1) >> NETPAGE_SHIFT)
+
+template <typename T>
+struct netpage_t
+{
+    int32_t refCount;
+    T       entry[NETPAGE_ENTRIES];
+};
+
+// the most a full revision history could take if no page were ever shared
 const uint64_t cSnapshotMemUsage = NET_REVISIONS *	(
                                                             (sizeof(netWall_t) * MAXWALLS)
                                                         +   (sizeof(netSector_t)  * MAXSECTORS)
@@ -184,19 +199,16 @@ const uint64_t cSnapshotMemUsage = NET_REVISIONS *	(
                                                     );
 
 
-#pragma pack(push,1)
 typedef struct netmapstate_s
 {
     uint32_t revisionNumber;
     int32_t maxActorIndex;
-    netactor_t actor[MAXSPRITES];
-    netWall_t wall[MAXWALLS];
-    netSector_t sector[MAXSECTORS];
+    netpage_t<netactor_t>  *actor[NETPAGE_COUNT(MAXSPRITES)];
+    netpage_t<netWall_t>   *wall[NETPAGE_COUNT(MAXWALLS)];
+    netpage_t<netSector_t> *sector[NETPAGE_COUNT(MAXSECTORS)];
 
 } netmapstate_t;
 
-#pragma pack(pop)
-
 #pragma pack(push,1)
 typedef struct playerupdate_s
 {
@@ -1100,6 +1100,19 @@ static int osdcmd_screenshot(osdcmdptr_t parm)
     return OSDCMD_OK;
 }
 
+static int osdcmd_conprofile(osdcmdptr_t parm)
+{
+    if (g_vmProfiling)
+    {
+        VM_ProfileStop();
+        return OSDCMD_OK;
+    }
+
+    VM_ProfileStart(parm->numparms == 1 ? parm->parms[0] : "conprofile.txt");
+
+    return OSDCMD_OK;
+}
+
 #if 0
 static int osdcmd_savestate(osdcmdptr_t UNUSED(parm))
 {
@@ -1335,6 +1348,17 @@ static int osdcmd_purgesaves(osdcmdptr_t UNUSED(parm))
     return OSDCMD_OK;
 }
 
+static int osdcmd_savetimes(osdcmdptr_t UNUSED(parm))
+{
+    UNREFERENCED_CONST_PARAMETER(parm);
+
+    // picks up the write time of a save still in flight
+    sv_flushsaves();
+
+    OSD_Printf("Last save: %.3f ms on the game thread, %.3f ms writing on the save thread\n", g_saveSnapshotTime, g_saveWriteTime);
+    return OSDCMD_OK;
+}
+
 static int osdcmd_cvar_set_game(osdcmdptr_t parm)
 {
     static char const prefix_snd[] = "snd_";
@@ -1574,6 +1598,7 @@ int32_t registerosdcommands(void)
         { "cl_autosave", "save game at checkpoints" CVAR_BOOL_OPTSTR, (void *) &ud.autosave, CVAR_BOOL, 0, 1 },
         { "cl_autosavedeletion", "automatically delete old checkpoint saves" CVAR_BOOL_OPTSTR, (void *) &ud.autosavedeletion, CVAR_BOOL, 0, 1 },
         { "cl_maxautosaves", "number of autosaves kept before deleting the oldest", (void *) &ud.maxautosaves, CVAR_INT, 1, 100 },
+        { "cl_deltasaves", "write saves as the difference to a base snapshot kept next to each slot" CVAR_BOOL_OPTSTR, (void *) &ud.deltasaves, CVAR_BOOL, 0, 1 },
 
 #if !defined NETCODE_DISABLE
         { "cl_automsg", "automatically send messages to all players" CVAR_BOOL_OPTSTR, (void *)&ud.automsg, CVAR_BOOL, 0, 1 },
@@ -1759,6 +1784,7 @@ int32_t registerosdcommands(void)
     OSD_RegisterFunction("addpath","addpath <path>: adds path to game filesystem", osdcmd_addpath);
     OSD_RegisterFunction("bind",R"(bind <key> <string>: associates a keypress with a string of console input. Type "bind showkeys" for a list of keys and "listsymbols" for a list of valid console commands.)", osdcmd_bind);
     OSD_RegisterFunction("cmenu","cmenu <#>: jumps to menu", osdcmd_cmenu);
+    OSD_RegisterFunction("conprofile","conprofile [file]: starts timing CON events, actors and states; run again to stop and write the flame graph stacks (conprofile.txt by default)", osdcmd_conprofile);
     OSD_RegisterFunction("crosshaircolor","crosshaircolor: changes the crosshair color", osdcmd_crosshaircolor);
 
     for (auto & func : gamefunctions)
@@ -1805,6 +1831,7 @@ int32_t registerosdcommands(void)
     OSD_RegisterFunction("setvar","setvar <gamevar> <value>: sets the value of a gamevar", osdcmd_setvar);
     OSD_RegisterFunction("setvarvar","setvarvar <gamevar1> <gamevar2>: sets the value of <gamevar1> to <gamevar2>", osdcmd_setvar);
     OSD_RegisterFunction("setactorvar","setactorvar <actor#> <gamevar> <value>: sets the value of <actor#>'s <gamevar> to <value>", osdcmd_setactorvar);
+    OSD_RegisterFunction("savetimes","savetimes: shows how long the last save took to snapshot and to write out", osdcmd_savetimes);
     OSD_RegisterFunction("screenshot","screenshot [format]: takes a screenshot.", osdcmd_screenshot);
 
     OSD_RegisterFunction("spawn","spawn <picnum> [palnum] [cstat] [ang] [x y z]: spawns a sprite with the given properties",osdcmd_spawn);
@@ -2097,6 +2097,8 @@ int G_EnterLevel(int gameMode)
     return 0;
 }
 
+uint32_t g_mapStateSerial;
+
 void G_FreeMapState(int levelNum)
 {
     auto &board = g_mapInfo[levelNum];
@@ -2104,6 +2106,8 @@ void G_FreeMapState(int levelNum)
     if (board.savedstate == NULL)
         return;
 
+    g_mapStateSerial++;
+
     for (int j=0; j<g_gameVarCount; j++)
     {
         if (aGameVars[j].flags & SAVEGAMEMAPSTATEVARSKIPMASK)
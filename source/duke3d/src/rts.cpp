@@ -157,7 +157,7 @@ void *RTS_GetSound(int32_t lump)
     if (rts_lumpcache[lump] == NULL)
     {
         rts_lumplockbyte[lump] = CACHE1D_LOCKED;
-        g_cache.allocateBlock((intptr_t *)&rts_lumpcache[lump], RTS_SoundLength(lump-1), &rts_lumplockbyte[lump]);  // JBF 20030910: char * => int32_t *
+        g_cache.allocateBlock((intptr_t *)&rts_lumpcache[lump], RTS_SoundLength(lump-1), &rts_lumplockbyte[lump], CACHE1D_CAT_SOUND);  // JBF 20030910: char * => int32_t *
         RTS_ReadLump(lump, rts_lumpcache[lump]);
     }
     else
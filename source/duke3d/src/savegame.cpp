@@ -26,8 +26,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "md4.h"
 #include "savegame.h"
 
+#include "crc32.h"
+#include "lz4.h"
 #include "vfs.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 static OutputFileCounter savecounter;
 
 // For storing pointers in files.
@@ -135,6 +141,7 @@ void G_ResetInterpolations(void)
 savebrief_t g_lastautosave, g_lastusersave, g_freshload;
 int32_t g_lastAutoSaveArbitraryID = -1;
 bool g_saveRequested;
+double g_saveSnapshotTime, g_saveWriteTime;
 savebrief_t * g_quickload;
 
 menusave_t * g_menusaves;
@@ -271,6 +278,7 @@ static void ReadSaveGameHeaders_Internal(void)
 
 void ReadSaveGameHeaders(void)
 {
+    sv_flushsaves();
     ReadSaveGameHeaders_Internal();
 
     if (!ud.autosavedeletion)
@@ -311,7 +319,7 @@ int32_t G_LoadSaveHeaderNew(char const *fn, savehead_t *saveh)
 
     walock[TILE_LOADSHOT] = CACHE1D_PERMANENT;
     if (waloff[TILE_LOADSHOT] == 0)
-        g_cache.allocateBlock(&waloff[TILE_LOADSHOT], 320*200, &walock[TILE_LOADSHOT]);
+        g_cache.allocateBlock(&waloff[TILE_LOADSHOT], 320*200, &walock[TILE_LOADSHOT], CACHE1D_CAT_TILE);
     tilesiz[TILE_LOADSHOT].x = 200;
     tilesiz[TILE_LOADSHOT].y = 320;
     if (screenshotofs)
@@ -397,6 +405,11 @@ static void sv_loadMapart(usermaphack_t* const mhkInfo, char* const currentboard
 }
 
 static void sv_postudload();
+static int32_t sv_checkdelta(buildvfs_kfd fil, savehead_t const *h);
+static void sv_savedelta(savebrief_t const &sv, char const *fn, bool isAutoSave);
+static void sv_dropdeltabase(char const *path);
+static void sv_saveinbackground(savebrief_t const &sv, char const *fn, bool isAutoSave);
+static double sv_msecsince(uint64_t t);
 
 // hack
 static int different_user_map;
@@ -656,6 +669,8 @@ int32_t G_LoadPlayer(savebrief_t & sv)
         return 0;
     }
 
+    sv_flushsaves();
+
     buildvfs_kfd const fil = kopen4loadfrommod(sv.path, 0);
 
     if (fil == buildvfs_kfd_invalid)
@@ -666,9 +681,12 @@ int32_t G_LoadPlayer(savebrief_t & sv)
     savehead_t h;
     int status = sv_loadheader(fil, 0, &h);
 
+    if (status == 0 && h.isDelta() && sv_checkdelta(fil, &h))
+        status = -5;
+
     if (status < 0 || h.numplayers != ud.multimode)
     {
-        if (status == -4 || status == -3 || status == 1)
+        if (status == -5 || status == -4 || status == -3 || status == 1)
             P_DoQuote(QUOTE_SAVE_BAD_VERSION, g_player[myconnectindex].ps);
         else if (h.numplayers != ud.multimode)
             P_DoQuote(QUOTE_SAVE_BAD_PLAYERS, g_player[myconnectindex].ps);
@@ -791,9 +809,18 @@ void G_DeleteSave(savebrief_t const & sv)
         return;
     }
 
+    sv_flushsaves();
+    sv_dropdeltabase(sv.path);
+
+    int const len = Bstrlen(temp);
+
     buildvfs_unlink(temp);
     Bstrcat(temp, ".ext");
     buildvfs_unlink(temp);
+    Bstrcpy(temp + len, ".base");
+    buildvfs_unlink(temp);
+    Bstrcpy(temp + len, ".base.tmp");
+    buildvfs_unlink(temp);
 }
 
 void G_DeleteOldSaves(void)
@@ -839,14 +866,18 @@ int32_t G_SavePlayer(savebrief_t & sv, bool isAutoSave)
     errno = 0;
     buildvfs_FILE fil;
 
-    if (sv.isValid())
+    // delta saves and autosaves are written by the save thread
+    bool const threaded = ud.deltasaves || isAutoSave;
+    bool const newslot  = !sv.isValid();
+
+    if (!newslot)
     {
         if (G_ModDirSnprintf(fn, sizeof(fn), "%s", sv.path))
         {
             OSD_Printf("G_SavePlayer: file name \"%s\" too long\n", sv.path);
             goto saveproblem;
         }
-        fil = buildvfs_fopen_write(fn);
+        fil = threaded ? nullptr : buildvfs_fopen_write(fn);
     }
     else
     {
@@ -864,7 +895,7 @@ int32_t G_SavePlayer(savebrief_t & sv, bool isAutoSave)
         Bstrcpy(sv.path, fn + (len-(ARRAY_SIZE(SaveName)-1)));
     }
 
-    if (!fil)
+    if (!fil && (!threaded || newslot))
     {
         OSD_Printf("G_SavePlayer: failed opening \"%s\" for writing: %s\n",
                    fn, strerror(errno));
@@ -886,9 +917,29 @@ int32_t G_SavePlayer(savebrief_t & sv, bool isAutoSave)
     portableBackupSave(sv.path, sv.name, ud.last_stateless_volume, ud.last_stateless_level);
 
     // SAVE!
-    sv_saveandmakesnapshot(fil, sv.name, 0, 0, 0, 0, isAutoSave);
+    {
+        uint64_t const t = timerGetNanoTicks();
 
-    buildvfs_fclose(fil);
+        if (threaded)
+        {
+            // a new slot is only opened to claim its name
+            if (fil)
+                buildvfs_fclose(fil);
+
+            if (ud.deltasaves)
+                sv_savedelta(sv, fn, isAutoSave);
+            else
+                sv_saveinbackground(sv, fn, isAutoSave);
+        }
+        else
+        {
+            sv_saveandmakesnapshot(fil, sv.name, 0, 0, 0, 0, isAutoSave);
+            buildvfs_fclose(fil);
+            g_saveWriteTime = 0;
+        }
+
+        g_saveSnapshotTime = sv_msecsince(t);
+    }
 
     if (!g_netServer && ud.multimode < 2)
     {
@@ -1007,8 +1058,67 @@ static inline void ds_get(const dataspec_t *spec, void **ptr, int32_t *cnt)
     *ptr = (spec->flags & DS_DYNAMIC) ? *((void **)spec->ptr) : spec->ptr;
 }
 
+static uint8_t *sv_arenareserve(savewriter_t *sw, uint32_t len)
+{
+    if (sw->arenapos + len > sw->arenasiz)
+    {
+        sw->arenasiz = max(sw->arenasiz << 1, sw->arenapos + len);
+        sw->arena    = (uint8_t *)Xrealloc(sw->arena, sw->arenasiz);
+    }
+
+    uint8_t *const p = sw->arena + sw->arenapos;
+    sw->arenapos += len;
+    return p;
+}
+
+void savewriter_t::write(void const *buf, int32_t size, int32_t count)
+{
+    if (fil)
+    {
+        buildvfs_fwrite(buf, size, count, fil);
+        return;
+    }
+
+    uint32_t const len = size * count;
+
+    // runs of uncompressed writes share a record
+    if (!rawpos)
+    {
+        rawpos = arenapos + 1;
+        Bmemset(sv_arenareserve(this, sizeof(uint32_t)), 0, sizeof(uint32_t));
+    }
+
+    Bmemcpy(sv_arenareserve(this, len), buf, len);
+
+    uint32_t rec;
+    Bmemcpy(&rec, arena + rawpos - 1, sizeof(rec));
+    rec += len;
+    Bmemcpy(arena + rawpos - 1, &rec, sizeof(rec));
+}
+
+void savewriter_t::writeLZ4(void const *buf, int32_t size, int32_t count)
+{
+    if (fil)
+    {
+        dfwrite_LZ4(buf, size, count, fil);
+        return;
+    }
+
+    uint32_t const len = size * count;
+    uint32_t const rec = len | SV_ARENALZ4;
+
+    Bmemcpy(sv_arenareserve(this, sizeof(rec)), &rec, sizeof(rec));
+    Bmemcpy(sv_arenareserve(this, len), buf, len);
+    rawpos = 0;
+}
+
+int32_t savewriter_t::tell(void) const
+{
+    return fil ? buildvfs_ftell(fil) : arenapos;
+}
+
 // write state to file and/or to dump
-static uint8_t *writespecdata(const dataspec_t *spec, buildvfs_FILE fil, uint8_t *dump)
+static uint8_t *writespecdata(const dataspec_t *spec, savewriter_t *sw, uint8_t *dump)
 {
     for (; spec->flags != DS_END; spec++)
     {
@@ -1019,11 +1129,11 @@ static uint8_t *writespecdata(const dataspec_t *spec, buildvfs_FILE fil, uint8_t
             continue;
         }
 
-        if (!fil && (spec->flags & (DS_NOCHK|DS_CMP|DS_STRING)))
+        if (!sw && (spec->flags & (DS_NOCHK|DS_CMP|DS_STRING)))
             continue;
         else if (spec->flags & DS_STRING)
         {
-            buildvfs_fwrite(spec->ptr, Bstrlen((const char *)spec->ptr), 1, fil);  // not null-terminated!
+            sw->write(spec->ptr, Bstrlen((const char *)spec->ptr), 1);  // not null-terminated!
             continue;
         }
 
@@ -1041,12 +1151,12 @@ static uint8_t *writespecdata(const dataspec_t *spec, buildvfs_FILE fil, uint8_t
         if (!ptr || !cnt)
             continue;
 
-        if (fil)
+        if (sw)
         {
             if ((spec->flags & DS_CMP) || ((spec->flags & DS_CNTMASK) == 0 && spec->size * cnt <= savegame_comprthres))
-                buildvfs_fwrite(ptr, spec->size, cnt, fil);
+                sw->write(ptr, spec->size, cnt);
             else
-                dfwrite_LZ4((void *)ptr, spec->size, cnt, fil);
+                sw->writeLZ4(ptr, spec->size, cnt);
         }
 
         if (dump && (spec->flags & (DS_NOCHK|DS_CMP)) == 0)
@@ -1255,7 +1365,8 @@ static void cmpspecdata(const dataspec_t *spec, uint8_t **dumpvar, uint8_t **dif
 
         if (spec->flags&(DS_LOADFN|DS_SAVEFN))
         {
-            if ((spec->flags&(DS_PROTECTFN))==0)
+            // the load functions would restore the state from data the save functions have already released
+            if ((spec->flags&(DS_SAVEFN|DS_PROTECTFN))==DS_SAVEFN)
                 (*(void (*)())spec->ptr)();
             continue;
         }
@@ -1587,9 +1698,10 @@ static const dataspec_t svgm_anmisc[] =
 };
 
 static dataspec_gv_t *svgm_vars=NULL;
-static uint8_t *dosaveplayer2(buildvfs_FILE fil, uint8_t *mem);
+static uint8_t *dosaveplayer2(savewriter_t *sw, uint8_t *mem);
 static int32_t doloadplayer2(buildvfs_kfd fil, uint8_t **memptr);
 static void postloadplayer(int32_t savegamep);
+static int32_t sv_loaddelta(buildvfs_kfd fil, savehead_t const *h);
 
 // SVGM snapshot system
 static uint32_t svsnapsiz;
@@ -1688,11 +1800,8 @@ static void SV_AllocSnap(int32_t allocinit)
     svdiff = (uint8_t *)Xmalloc(svdiffsiz);
 }
 
-// make snapshot only if spot < 0 (demo)
-int32_t sv_saveandmakesnapshot(buildvfs_FILE fil, char const *name, int8_t spot, int8_t recdiffsp, int8_t diffcompress, int8_t synccompress, bool isAutoSave)
+static void sv_makeheader(savehead_t *h, char const *name, int8_t spot, int8_t recdiffsp, int8_t diffcompress, int8_t synccompress, bool isAutoSave)
 {
-    savehead_t h;
-
     // set a few savegame system globals
     savegame_comprthres = SV_DEFAULTCOMPRTHRES;
     savegame_diffcompress = diffcompress;
@@ -1704,43 +1813,43 @@ int32_t sv_saveandmakesnapshot(buildvfs_FILE fil, char const *name, int8_t spot,
 
 
     // create header
-    Bmemcpy(h.headerstr, "E32SAVEGAME", 11);
-    h.majorver = SV_MAJOR_VER;
-    h.minorver = SV_MINOR_VER;
-    h.ptrsize  = sizeof(intptr_t);
+    Bmemcpy(h->headerstr, "E32SAVEGAME", 11);
+    h->majorver = SV_MAJOR_VER;
+    h->minorver = SV_MINOR_VER;
+    h->ptrsize  = sizeof(intptr_t);
 
     if (isAutoSave)
-        h.ptrsize |= 1u << 7u;
+        h->ptrsize |= 1u << 7u;
 
-    h.bytever      = BYTEVERSION;
-    h.userbytever  = ud.userbytever;
+    h->bytever      = BYTEVERSION;
+    h->userbytever  = ud.userbytever;
 
-    Bstrncpyz(h.scriptname, g_scriptFileName, sizeof(h.scriptname));
-    h.comprthres   = savegame_comprthres;
-    h.recdiffsp    = recdiffsp;
-    h.diffcompress = savegame_diffcompress;
-    h.synccompress = synccompress;
+    Bstrncpyz(h->scriptname, g_scriptFileName, sizeof(h->scriptname));
+    h->comprthres   = savegame_comprthres;
+    h->recdiffsp    = recdiffsp;
+    h->diffcompress = savegame_diffcompress;
+    h->synccompress = synccompress;
 
-    h.reccnt  = 0;
-    h.snapsiz = svsnapsiz;
+    h->reccnt  = 0;
+    h->snapsiz = svsnapsiz;
 
     // the following is kinda redundant, but we save it here to be able to quickly fetch
     // it in a savegame header read
 
-    h.numplayers = ud.multimode;
-    h.volnum     = ud.volume_number;
-    h.levnum     = ud.level_number;
-    h.skill      = ud.player_skill;
+    h->numplayers = ud.multimode;
+    h->volnum     = ud.volume_number;
+    h->levnum     = ud.level_number;
+    h->skill      = ud.player_skill;
 
-    Bstrncpyz(h.boardfn, currentboardfilename, sizeof(h.boardfn));
+    Bstrncpyz(h->boardfn, currentboardfilename, sizeof(h->boardfn));
 
     if (spot >= 0)
     {
         // savegame
-        Bstrncpyz(h.savename, name, sizeof(h.savename));
+        Bstrncpyz(h->savename, name, sizeof(h->savename));
 #ifdef __ANDROID__
-        Bstrncpyz(h.volname, g_volumeNames[ud.volume_number], sizeof(h.volname));
-        Bstrncpyz(h.skillname, g_skillNames[ud.player_skill], sizeof(h.skillname));
+        Bstrncpyz(h->volname, g_volumeNames[ud.volume_number], sizeof(h->volname));
+        Bstrncpyz(h->skillname, g_skillNames[ud.player_skill], sizeof(h->skillname));
 #endif
     }
     else
@@ -1750,12 +1859,19 @@ int32_t sv_saveandmakesnapshot(buildvfs_FILE fil, char const *name, int8_t spot,
         const time_t t = time(NULL);
         struct tm *  st;
 
-        Bstrncpyz(h.savename, "EDuke32 demo", sizeof(h.savename));
+        Bstrncpyz(h->savename, "EDuke32 demo", sizeof(h->savename));
         if (t>=0 && (st = localtime(&t)))
-            Bsnprintf(h.savename, sizeof(h.savename), "Demo %04d%02d%02d %s",
+            Bsnprintf(h->savename, sizeof(h->savename), "Demo %04d%02d%02d %s",
                       st->tm_year+1900, st->tm_mon+1, st->tm_mday, s_buildRev);
     }
+}
 
+// make snapshot only if spot < 0 (demo)
+int32_t sv_saveandmakesnapshot(buildvfs_FILE fil, char const *name, int8_t spot, int8_t recdiffsp, int8_t diffcompress, int8_t synccompress, bool isAutoSave)
+{
+    savehead_t h;
+
+    sv_makeheader(&h, name, spot, recdiffsp, diffcompress, synccompress, isAutoSave);
 
     // write header
     buildvfs_fwrite(&h, sizeof(savehead_t), 1, fil);
@@ -1781,17 +1897,19 @@ int32_t sv_saveandmakesnapshot(buildvfs_FILE fil, char const *name, int8_t spot,
     OSD_Printf("sv_saveandmakesnapshot: snapshot size: %d bytes.\n", svsnapsiz);
 #endif
 
+    savewriter_t sw = { fil, nullptr, 0, 0, 0 };
+
     if (spot >= 0)
     {
         // savegame
-        dosaveplayer2(fil, NULL);
+        dosaveplayer2(&sw, NULL);
     }
     else
     {
         // demo
         SV_AllocSnap(0);
 
-        uint8_t * const p = dosaveplayer2(fil, svsnapshot);
+        uint8_t * const p = dosaveplayer2(&sw, svsnapshot);
 
         if (p != svsnapshot+svsnapsiz)
         {
@@ -1898,7 +2016,16 @@ int32_t sv_loadsnapshot(buildvfs_kfd fil, int32_t spot, savehead_t *h)
 
     savegame_comprthres = h->comprthres;
 
-    if (spot >= 0)
+    if (spot >= 0 && h->isDelta())
+    {
+        i = sv_loaddelta(fil, h);
+        if (i)
+        {
+            OSD_Printf("sv_loadsnapshot: sv_loaddelta() returned %d.\n", i);
+            return 5;
+        }
+    }
+    else if (spot >= 0)
     {
         // savegame
         i = doloadplayer2(fil, NULL);
@@ -2009,6 +2136,726 @@ int32_t sv_readdiff(buildvfs_kfd fil)
     return i;
 }
 
+////////// BACKGROUND SAVES //////////
+
+// With cl_deltasaves, a slot only holds the header, the screenshot and a diff against the full
+// snapshot in <slot>.base. Autosaves and the player's own saves each keep their last base in memory,
+// so saving to one does not throw away the base of the other. A base is rewritten when the save goes
+// to another slot of its kind, when anything a diff does not carry has changed (see sv_deltakey())
+// or once the diff grows past 1/SV_DELTAREBASE of the snapshot. Any other save costs the game thread
+// one compare against the base and a copy of the result; compressing and writing the file is left
+// to the save thread.
+//
+// A new base is recorded into the arena of the job that saves the slot, like a full background save.
+// The save thread writes it to <slot>.base.tmp and only moves it over <slot>.base once the delta
+// taken against it has replaced the slot, so the slot on disk always has its base. Should the game
+// stop between the two renames, loading falls back to the .tmp file. If the base cannot be written,
+// the job saves the slot in full from the same arena instead.
+//
+// Without it, autosaves still leave the writing to the save thread: dosaveplayer2() records the
+// state into the arena of a job instead of a file, see sv_saveinbackground().
+
+#define SV_DELTAREBASE 4
+
+typedef struct
+{
+    char    magic[4];  // "dElT"
+    int32_t stamp;     // matches reccnt in the header of the base
+    char    basefn[BMAX_PATH];
+    int32_t labelcnt;  // followed by the labels actor script offsets were translated with, then the diff
+} savedelta_t;
+
+typedef struct
+{
+    uint8_t *base;     // dump of the state written to basefn
+    uint32_t snapsiz;  // 0 if there is no usable base
+    uint32_t diffsiz, key;
+    int32_t  stamp;
+    char     basefn[BMAX_PATH];
+    char     basepath[BMAX_PATH];  // where the base goes, while it is still in basepath.tmp
+} svdeltabase_t;
+
+static struct
+{
+    svdeltabase_t bases[2];  // for the player's saves and for autosaves
+    uint8_t *     scratch;   // copy of a base the current state is compared against
+    uint8_t *     diff;
+    uint32_t      scratchsiz, diffsiz;
+    int32_t       stamp;     // last stamp handed to a base
+} svdelta;
+
+typedef struct
+{
+    char        fn[BMAX_PATH];
+    char        basepath[BMAX_PATH];  // base to move into place after fn, see svdeltabase_t::basepath
+    savehead_t  h;
+    savehead_t  bh;      // header of the base, if the job writes one
+    savedelta_t d;
+    char const *labels;  // the label table never changes once the scripts are compiled
+    uint8_t *   shot;    // copy of TILE_SAVESHOT, if there was one
+    uint8_t *   diff;
+    uint32_t    diffsiz, diffalloc;
+    savewriter_t sw;     // what dosaveplayer2() wrote, for full saves and new bases
+    double      writetime;
+    int8_t      busy, failed, written, rebase;
+} svsavejob_t;
+
+#define SV_JOBFAILED     1
+#define SV_JOBBASEFAILED 2
+
+// two jobs, so that one can be filled while the save thread writes the other
+static svsavejob_t             svsavejobs[2];
+static int32_t                 svsavejobnext;
+static std::thread *           svsavethread;
+static std::mutex              svsavemutex;
+static std::condition_variable svsavewake, svsavedone;
+static bool                    svsavequit;
+
+// dfwrite_LZ4() compresses into a static buffer that only the game thread may use
+static void sv_writelz4(void const *buf, int32_t len, buildvfs_FILE fil, char **cbuf, int32_t *cbufsiz)
+{
+    int32_t const bound = LZ4_compressBound(len);
+
+    if (bound > *cbufsiz)
+    {
+        *cbuf    = (char *)Xrealloc(*cbuf, bound);
+        *cbufsiz = bound;
+    }
+
+    int32_t const leng   = LZ4_compress_fast((char const *)buf, *cbuf, len, bound, lz4CompressionLevel);
+    int32_t const swleng = B_LITTLE32(leng);
+
+    buildvfs_fwrite(&swleng, sizeof(swleng), 1, fil);
+    buildvfs_fwrite(*cbuf, leng, 1, fil);
+}
+
+static void sv_writearena(savewriter_t const &sw, buildvfs_FILE fil, char **cbuf, int32_t *cbufsiz)
+{
+    for (uint32_t pos = 0; pos < sw.arenapos;)
+    {
+        uint32_t rec;
+        Bmemcpy(&rec, sw.arena + pos, sizeof(rec));
+        pos += sizeof(rec);
+
+        uint32_t const len = rec & ~SV_ARENALZ4;
+
+        if (rec & SV_ARENALZ4)
+            sv_writelz4(sw.arena + pos, len, fil, cbuf, cbufsiz);
+        else
+            buildvfs_fwrite(sw.arena + pos, len, 1, fil);
+
+        pos += len;
+    }
+}
+
+// same layout as sv_saveandmakesnapshot(), except that a delta save follows the screenshot with the
+// savedelta_t and what sv_writediff() writes. Without delta, the data is whatever is in the arena.
+static int8_t sv_writesavefile(char const *fn, savehead_t const &h, svsavejob_t const &job, bool withshot,
+                               char **cbuf, int32_t *cbufsiz)
+{
+    buildvfs_FILE const fil = buildvfs_fopen_write(fn);
+
+    if (!fil)
+        return 1;
+
+    buildvfs_fwrite(&h, sizeof(savehead_t), 1, fil);
+    buildvfs_fwrite("\0\0\0\0", 4, 1, fil);
+
+    if (withshot && job.shot)
+    {
+        sv_writelz4(job.shot, 320*200, fil, cbuf, cbufsiz);
+
+        int32_t const ofs = buildvfs_ftell(fil);
+        buildvfs_fseek_abs(fil, sizeof(savehead_t));
+        buildvfs_fwrite(&ofs, 4, 1, fil);
+        buildvfs_fseek_abs(fil, ofs);
+    }
+
+    if (h.isDelta())
+    {
+        buildvfs_fwrite(&job.d, sizeof(savedelta_t), 1, fil);
+
+        if (job.d.labelcnt > 0)
+            sv_writelz4(job.labels, job.d.labelcnt << 6, fil, cbuf, cbufsiz);
+
+        buildvfs_fwrite("dIfF", 4, 1, fil);
+        buildvfs_fwrite(&job.diffsiz, sizeof(job.diffsiz), 1, fil);
+        sv_writelz4(job.diff, job.diffsiz, fil, cbuf, cbufsiz);
+    }
+    else
+        sv_writearena(job.sw, fil, cbuf, cbufsiz);
+
+    buildvfs_fclose(fil);
+
+    return 0;
+}
+
+// A job with a new base writes it first. The old files are only replaced once the new ones are
+// complete. failedstamp is the stamp of the last base that could not be written: a delta against it
+// has nothing to refer to and is dropped, leaving the slot as it was.
+static int8_t sv_writesavejob(svsavejob_t const &job, int32_t *failedstamp, char **cbuf, int32_t *cbufsiz)
+{
+    char tmpfn[BMAX_PATH];
+    int8_t failed = 0;
+    savehead_t const *h = &job.h;
+
+    if (job.rebase)
+    {
+        if (Bsnprintf(tmpfn, sizeof(tmpfn), "%s.tmp", job.basepath) >= (int)sizeof(tmpfn)
+            || sv_writesavefile(tmpfn, job.bh, job, false, cbuf, cbufsiz))
+        {
+            buildvfs_unlink(tmpfn);
+            *failedstamp = job.bh.reccnt;
+            failed |= SV_JOBBASEFAILED;
+
+            // the arena holds the whole state, so the slot can still be saved in full
+            h = &job.bh;
+        }
+    }
+    else if (h->isDelta() && job.d.stamp == *failedstamp)
+        return SV_JOBFAILED;
+
+    if (Bsnprintf(tmpfn, sizeof(tmpfn), "%s.tmp", job.fn) >= (int)sizeof(tmpfn))
+        return failed | SV_JOBFAILED;
+
+    if (sv_writesavefile(tmpfn, *h, job, true, cbuf, cbufsiz) || buildvfs_rename(tmpfn, job.fn))
+    {
+        buildvfs_unlink(tmpfn);
+        return failed | SV_JOBFAILED;
+    }
+
+    if (job.basepath[0] && !(failed & SV_JOBBASEFAILED))
+    {
+        // an earlier job against the same base may have moved it already
+        if (Bsnprintf(tmpfn, sizeof(tmpfn), "%s.tmp", job.basepath) < (int)sizeof(tmpfn))
+            buildvfs_rename(tmpfn, job.basepath);
+    }
+
+    return failed;
+}
+
+static double sv_msecsince(uint64_t t)
+{
+    return (double)(timerGetNanoTicks() - t) * 1000.0 / timerGetNanoTickRate();
+}
+
+static void sv_saveworker(void)
+{
+    char *  cbuf    = nullptr;
+    int32_t cbufsiz = 0;
+    int32_t failedstamp = 0;
+
+    for (int next = 0;; next ^= 1)
+    {
+        svsavejob_t &job = svsavejobs[next];
+
+        {
+            std::unique_lock<std::mutex> lock(svsavemutex);
+            svsavewake.wait(lock, [&]{ return svsavequit || job.busy; });
+
+            if (!job.busy)
+                break;
+        }
+
+        uint64_t const t = timerGetNanoTicks();
+
+        job.failed    = sv_writesavejob(job, &failedstamp, &cbuf, &cbufsiz);
+        job.writetime = sv_msecsince(t);
+
+        {
+            std::lock_guard<std::mutex> lock(svsavemutex);
+            job.busy    = 0;
+            job.written = 1;
+        }
+        svsavedone.notify_all();
+    }
+
+    Xfree(cbuf);
+}
+
+static void sv_reportsavejob(svsavejob_t &job)
+{
+    if (job.written)
+    {
+        g_saveWriteTime = job.writetime;
+        job.written     = 0;
+    }
+
+    if (job.failed & SV_JOBBASEFAILED)
+    {
+        OSD_Printf("G_SavePlayer: failed writing \"%s\"\n", job.basepath);
+
+        // the next save of the slot has to write a base again
+        for (auto &b : svdelta.bases)
+        {
+            if (b.stamp == job.bh.reccnt && !Bstrcmp(b.basepath, job.basepath))
+            {
+                b.snapsiz     = 0;
+                b.basepath[0] = '\0';
+            }
+        }
+    }
+
+    if (job.failed & SV_JOBFAILED)
+        OSD_Printf("G_SavePlayer: failed writing \"%s\"\n", job.fn);
+    else if (job.basepath[0] && !(job.failed & SV_JOBBASEFAILED))
+    {
+        for (auto &b : svdelta.bases)
+        {
+            if (!Bstrcmp(job.basepath, b.basepath))
+                b.basepath[0] = '\0';
+        }
+    }
+
+    job.failed      = 0;
+    job.basepath[0] = '\0';
+}
+
+// waits until the save thread is done with the job filled next
+static svsavejob_t &sv_getsavejob(void)
+{
+    svsavejob_t &job = svsavejobs[svsavejobnext];
+
+    {
+        std::unique_lock<std::mutex> lock(svsavemutex);
+        svsavedone.wait(lock, [&]{ return !job.busy; });
+    }
+
+    sv_reportsavejob(job);
+
+    return job;
+}
+
+static void sv_queuesavejob(svsavejob_t &job)
+{
+    if (!svsavethread)
+    {
+        svsavequit   = false;
+        svsavethread = new std::thread(sv_saveworker);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(svsavemutex);
+        job.busy = 1;
+    }
+    svsavewake.notify_one();
+
+    svsavejobnext ^= 1;
+}
+
+void sv_flushsaves(void)
+{
+    if (!svsavethread)
+        return;
+
+    {
+        std::unique_lock<std::mutex> lock(svsavemutex);
+        svsavedone.wait(lock, []{ return !svsavejobs[0].busy && !svsavejobs[1].busy; });
+    }
+
+    // the job filled next is the one queued first
+    sv_reportsavejob(svsavejobs[svsavejobnext]);
+    sv_reportsavejob(svsavejobs[svsavejobnext ^ 1]);
+}
+
+void sv_stopsavethread(void)
+{
+    if (!svsavethread)
+        return;
+
+    sv_flushsaves();
+
+    {
+        std::lock_guard<std::mutex> lock(svsavemutex);
+        svsavequit = true;
+    }
+    svsavewake.notify_all();
+
+    svsavethread->join();
+    DO_DELETE_AND_NULL(svsavethread);
+
+    // the save thread starts over with the first job
+    svsavejobnext = 0;
+}
+
+// CRC of everything a diff does not carry: the DS_NOCHK data, the layout of the dump and the saved map states
+static uint32_t sv_deltakey(void)
+{
+    static const dataspec_t *const specs[] = { svgm_udnetw, svgm_secwsp, svgm_script, svgm_anmisc };
+
+    uint32_t crc = Bcrc32(&svsnapsiz, sizeof(svsnapsiz), 0);
+
+    for (auto spec : specs)
+    {
+        for (; spec->flags != DS_END; spec++)
+        {
+            if ((spec->flags & (DS_NOCHK|DS_DYNAMIC|DS_LOADFN|DS_SAVEFN)) != DS_NOCHK)
+                continue;
+
+            void *  ptr;
+            int32_t cnt;
+
+            ds_get(spec, &ptr, &cnt);
+            crc = Bcrc32(ptr, spec->size * cnt, crc);
+        }
+    }
+
+    for (auto spec = svgm_vars + 1; spec->flags != DS_END; spec++)
+    {
+        crc = Bcrc32(&spec->size, sizeof(spec->size), crc);
+        crc = Bcrc32(&spec->cnt, sizeof(spec->cnt), crc);
+    }
+
+    return Bcrc32(&g_mapStateSerial, sizeof(g_mapStateSerial), crc);
+}
+
+// the largest diff cmpspecdata() can write for spec, i.e. with every element changed
+static uint32_t sv_calcdiffsz(const dataspec_t *spec)
+{
+    uint32_t dasiz = Bstrlen((const char *)spec->ptr) + ((getnumvar(spec) + 7) >> 3);
+
+    for (spec++; spec->flags != DS_END; spec++)
+    {
+        if (spec->flags & (DS_NOCHK|DS_STRING|DS_CMP|DS_LOADFN|DS_SAVEFN))
+            continue;
+
+        int const cnt = ds_getcnt(spec);
+
+        if (cnt < 0)
+            continue;
+
+        uint32_t const size = spec->size;
+
+        if (cnt == 1 && (size == 1 || size == 2 || size == 4 || size == 8))
+        {
+            dasiz += size;
+            continue;
+        }
+
+        uint32_t const datbytes = (size == 8) ? 8 : (size & 3) == 0 ? 4 : (size & 1) == 0 ? 2 : 1;
+        uint32_t const nelts    = size * cnt / datbytes;
+        uint32_t const idxbytes = (nelts > 65536) ? 4 : (nelts > 256) ? 2 : 1;
+
+        dasiz += nelts * (idxbytes + datbytes) + idxbytes;
+    }
+
+    return dasiz;
+}
+
+// compare the current state against the base, leaving the diff in svdelta.diff
+static uint32_t sv_makedelta(svdeltabase_t const &b)
+{
+    uint8_t *p = svdelta.scratch;
+    uint8_t *d = svdelta.diff;
+
+    Bmemcpy(svdelta.scratch, b.base, b.snapsiz);
+
+    // the base holds the actor script offsets as label indices
+    sv_prelabelsave();
+    sv_preactorsave();
+
+    cmpspecdata(svgm_udnetw, &p, &d);
+    cmpspecdata(svgm_secwsp, &p, &d);
+    cmpspecdata(svgm_script, &p, &d);
+    cmpspecdata(svgm_anmisc, &p, &d);
+    cmpspecdata((const dataspec_t *)svgm_vars, &p, &d);
+
+    sv_postactordata();
+
+    Bassert(p == svdelta.scratch + b.snapsiz && d <= svdelta.diff + b.diffsiz);
+
+    return d - svdelta.diff;
+}
+
+// records the current state into the job's arena and into b, which the job then writes as the base
+static int32_t sv_recordbase(svdeltabase_t &b, svsavejob_t &job, savehead_t const *h)
+{
+    b.snapsiz     = 0;
+    b.basepath[0] = '\0';
+
+    svdelta.stamp = max<int32_t>(svdelta.stamp + 1, (int32_t)time(NULL));
+    b.stamp       = svdelta.stamp;
+
+    job.bh        = *h;
+    job.bh.reccnt = b.stamp;
+
+    b.diffsiz = sv_calcdiffsz(svgm_udnetw) + sv_calcdiffsz(svgm_secwsp) + sv_calcdiffsz(svgm_script)
+                + sv_calcdiffsz(svgm_anmisc) + sv_calcdiffsz((const dataspec_t *)svgm_vars);
+
+    b.base = (uint8_t *)Xrealloc(b.base, svsnapsiz);
+
+    if (svsnapsiz > svdelta.scratchsiz)
+    {
+        svdelta.scratch    = (uint8_t *)Xrealloc(svdelta.scratch, svsnapsiz);
+        svdelta.scratchsiz = svsnapsiz;
+    }
+
+    if (b.diffsiz > svdelta.diffsiz)
+    {
+        svdelta.diff    = (uint8_t *)Xrealloc(svdelta.diff, b.diffsiz);
+        svdelta.diffsiz = b.diffsiz;
+    }
+
+    job.sw.arenapos = 0;
+    job.sw.rawpos   = 0;
+
+    uint8_t *const p = dosaveplayer2(&job.sw, b.base);
+
+    if (p != b.base + svsnapsiz)
+    {
+        OSD_Printf("sv_recordbase: ptr-(snapshot end)=%d!\n", (int32_t)(p - (b.base + svsnapsiz)));
+        return -1;
+    }
+
+    b.snapsiz = svsnapsiz;
+
+    return 0;
+}
+
+static void sv_copysaveshot(svsavejob_t &job)
+{
+    if (waloff[TILE_SAVESHOT])
+    {
+        if (!job.shot)
+            job.shot = (uint8_t *)Xmalloc(320*200);
+
+        Bmemcpy(job.shot, (void *)waloff[TILE_SAVESHOT], 320*200);
+    }
+    else
+        DO_FREE_AND_NULL(job.shot);
+}
+
+static void sv_savedelta(savebrief_t const &sv, char const *fn, bool isAutoSave)
+{
+    svdeltabase_t &b = svdelta.bases[isAutoSave];
+    savehead_t h;
+    char basefn[BMAX_PATH], basepath[BMAX_PATH];
+
+    // a path too long for the base's name would pair the slot with the wrong file
+    if (Bsnprintf(basefn, sizeof(basefn), "%s.base", sv.path) >= (int)sizeof(basefn)
+        || Bsnprintf(basepath, sizeof(basepath), "%s.base", fn) >= (int)sizeof(basepath))
+    {
+        sv_saveinbackground(sv, fn, isAutoSave);
+        return;
+    }
+
+    sv_makeheader(&h, sv.name, 0, 0, 0, 0, isAutoSave);
+
+    uint32_t const key = sv_deltakey();
+    uint32_t diffsiz = 0;
+
+    bool rebase = b.snapsiz == 0 || b.key != key || Bstrcmp(b.basefn, basefn);
+
+    if (!rebase)
+    {
+        diffsiz = sv_makedelta(b);
+        rebase  = diffsiz > b.snapsiz / SV_DELTAREBASE;
+    }
+
+    svsavejob_t &job = sv_getsavejob();
+
+    Bstrncpyz(job.fn, fn, sizeof(job.fn));
+    job.h = h;
+    sv_copysaveshot(job);
+
+    if (rebase)
+    {
+        if (sv_recordbase(b, job, &h))
+        {
+            // no base, so the slot is saved the usual way from what was recorded
+            job.rebase = 0;
+            sv_queuesavejob(job);
+            return;
+        }
+
+        b.key = key;
+        Bstrncpyz(b.basefn, basefn, sizeof(b.basefn));
+        Bstrncpyz(b.basepath, basepath, sizeof(b.basepath));
+
+        diffsiz = sv_makedelta(b);
+    }
+
+    Bstrncpyz(job.basepath, b.basepath, sizeof(job.basepath));
+
+    job.rebase = rebase;
+    job.h.ptrsize |= 1u << 6u;
+    job.h.reccnt = b.stamp;
+
+    Bmemcpy(job.d.magic, "dElT", 4);
+    job.d.stamp    = b.stamp;
+    job.d.labelcnt = g_labelCnt;
+    Bstrncpyz(job.d.basefn, b.basefn, sizeof(job.d.basefn));
+    job.labels = label;
+
+    if (diffsiz > job.diffalloc)
+    {
+        job.diff      = (uint8_t *)Xrealloc(job.diff, diffsiz);
+        job.diffalloc = diffsiz;
+    }
+
+    Bmemcpy(job.diff, svdelta.diff, diffsiz);
+    job.diffsiz = diffsiz;
+
+    sv_queuesavejob(job);
+}
+
+// the arena is kept between saves, so once it has grown to fit the state this is only the copy
+static void sv_saveinbackground(savebrief_t const &sv, char const *fn, bool isAutoSave)
+{
+    svsavejob_t &job = sv_getsavejob();
+
+    Bstrncpyz(job.fn, fn, sizeof(job.fn));
+    sv_makeheader(&job.h, sv.name, 0, 0, 0, 0, isAutoSave);
+    sv_copysaveshot(job);
+
+    job.rebase = 0;
+
+    job.sw.arenapos = 0;
+    job.sw.rawpos   = 0;
+    dosaveplayer2(&job.sw, NULL);
+
+    sv_queuesavejob(job);
+}
+
+static void sv_dropdeltabase(char const *path)
+{
+    int const len = Bstrlen(path);
+
+    for (auto &b : svdelta.bases)
+    {
+        if (!Bstrncmp(b.basefn, path, len) && !Bstrcmp(b.basefn + len, ".base"))
+        {
+            b.snapsiz     = 0;
+            b.basepath[0] = '\0';
+        }
+    }
+}
+
+static buildvfs_kfd sv_openbasefile(char const *fn, savehead_t const *h, savedelta_t const *d)
+{
+    buildvfs_kfd const basefil = kopen4loadfrommod(fn, 0);
+
+    if (basefil == buildvfs_kfd_invalid)
+        return buildvfs_kfd_invalid;
+
+    savehead_t bh;
+
+    if (sv_loadheader(basefil, 0, &bh) || bh.isDelta() || bh.reccnt != d->stamp || bh.snapsiz != h->snapsiz)
+    {
+        kclose(basefil);
+        return buildvfs_kfd_invalid;
+    }
+
+    return basefil;
+}
+
+// the base a delta save was taken against, with fil positioned at its savedelta_t
+static buildvfs_kfd sv_opendeltabase(buildvfs_kfd fil, savehead_t const *h, savedelta_t *d)
+{
+    if (kread_and_test(fil, d, sizeof(savedelta_t)) || Bmemcmp(d->magic, "dElT", 4))
+    {
+        OSD_Printf("sv_opendeltabase: delta corrupt.\n");
+        return buildvfs_kfd_invalid;
+    }
+
+    d->basefn[sizeof(d->basefn)-1] = '\0';
+
+    buildvfs_kfd basefil = sv_openbasefile(d->basefn, h, d);
+
+    if (basefil == buildvfs_kfd_invalid)
+    {
+        // the game may have stopped before the new base was moved into place
+        char tmpfn[BMAX_PATH];
+
+        if (Bsnprintf(tmpfn, sizeof(tmpfn), "%s.tmp", d->basefn) < (int)sizeof(tmpfn))
+            basefil = sv_openbasefile(tmpfn, h, d);
+    }
+
+    if (basefil == buildvfs_kfd_invalid)
+        OSD_Printf("sv_opendeltabase: base \"%s\" not found or not the one the save was made against.\n", d->basefn);
+
+    return basefil;
+}
+
+static int32_t sv_skipscreenshot(buildvfs_kfd fil)
+{
+    int32_t ofs;
+    return kread_and_test(fil, &ofs, 4) || (ofs > 0 && klseek(fil, ofs, SEEK_SET) != ofs);
+}
+
+// lets G_LoadPlayer() reject a delta save before it gets to where a failed load cannot be recovered from
+static int32_t sv_checkdelta(buildvfs_kfd fil, savehead_t const *h)
+{
+    savedelta_t  d;
+    buildvfs_kfd basefil = buildvfs_kfd_invalid;
+
+    if (!sv_skipscreenshot(fil))
+        basefil = sv_opendeltabase(fil, h, &d);
+
+    klseek(fil, sizeof(savehead_t), SEEK_SET);
+
+    if (basefil == buildvfs_kfd_invalid)
+        return 1;
+
+    kclose(basefil);
+    return 0;
+}
+
+// restore the base into the snapshot, then apply the diff to it like demo playback does
+static int32_t sv_loaddelta(buildvfs_kfd fil, savehead_t const *h)
+{
+    savedelta_t        d;
+    buildvfs_kfd const basefil = sv_opendeltabase(fil, h, &d);
+
+    if (basefil == buildvfs_kfd_invalid)
+        return -1;
+
+    if (sv_skipscreenshot(basefil))
+    {
+        kclose(basefil);
+        return -2;
+    }
+
+    svsnapsiz = h->snapsiz;
+    SV_AllocSnap(0);
+
+    uint8_t *p = svsnapshot;
+    int32_t  i = doloadplayer2(basefil, &p);
+
+    kclose(basefil);
+
+    if (i || p != svsnapshot + svsnapsiz)
+    {
+        OSD_Printf("sv_loaddelta: doloadplayer2() returned %d.\n", i);
+        return -3;
+    }
+
+    char magic[4];
+
+    savegame_labelcnt = d.labelcnt;
+    sv_prelabelload();
+
+    if ((savegame_labelcnt > 0 && kdfread_LZ4(savegame_labels, 1<<6, savegame_labelcnt, fil) != savegame_labelcnt)
+        || kread_and_test(fil, magic, 4) || Bmemcmp(magic, "dIfF", 4))
+        i = -4;
+    else
+    {
+        savegame_diffcompress = 1;
+
+        if (sv_readdiff(fil))
+            i = -5;
+        else if (sv_updatestate(0))
+            i = -6;
+        else
+            sv_postactordata();
+    }
+
+    DO_FREE_AND_NULL(savegame_labels);
+    savegame_labelcnt = 0;
+
+    return i;
+}
+
 // SVGM data description
 static void sv_postudload()
 {
@@ -2298,22 +3145,22 @@ static void sv_restload()
 # define PRINTSIZE(name) do { } while (0)
 #endif
 
-static uint8_t *dosaveplayer2(buildvfs_FILE fil, uint8_t *mem)
+static uint8_t *dosaveplayer2(savewriter_t *sw, uint8_t *mem)
 {
 #ifdef DEBUGGINGAIDS
     uint8_t *tmem = mem;
     int32_t t=timerGetTicks();
 #endif
-    mem=writespecdata(svgm_udnetw, fil, mem);  // user settings, players & net
+    mem=writespecdata(svgm_udnetw, sw, mem);  // user settings, players & net
     PRINTSIZE("ud");
-    mem=writespecdata(svgm_secwsp, fil, mem);  // sector, wall, sprite
+    mem=writespecdata(svgm_secwsp, sw, mem);  // sector, wall, sprite
     PRINTSIZE("sws");
-    mem=writespecdata(svgm_script, fil, mem);  // script
+    mem=writespecdata(svgm_script, sw, mem);  // script
     PRINTSIZE("script");
-    mem=writespecdata(svgm_anmisc, fil, mem);  // animates, quotes & misc.
+    mem=writespecdata(svgm_anmisc, sw, mem);  // animates, quotes & misc.
     PRINTSIZE("animisc");
 
-    Gv_WriteSave(fil);  // gamevars
+    Gv_WriteSave(*sw);  // gamevars
     mem=writespecdata((const dataspec_t *)svgm_vars, 0, mem);
     PRINTSIZE("vars");
 
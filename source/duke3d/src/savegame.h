@@ -49,6 +49,7 @@ typedef struct _savehead
     uint8_t recdiffsp, diffcompress, synccompress;
     // 4 bytes
 
+    // savegames written with cl_deltasaves store the stamp pairing a delta with its base in reccnt
     int32_t reccnt, snapsiz;
     // 8 bytes
 
@@ -64,8 +65,10 @@ typedef struct _savehead
     char skillname[32], volname[32];
 #endif
 
-    uint8_t getPtrSize() const { return ptrsize & 0x7Fu; }
+    uint8_t getPtrSize() const { return ptrsize & 0x3Fu; }
     bool isAutoSave() const { return !!(ptrsize & (1u<<7u)); }
+    // the data is a diff against the snapshot in another file, see sv_savedelta()
+    bool isDelta() const { return !!(ptrsize & (1u<<6u)); }
 } savehead_t;
 #pragma pack(pop)
 
@@ -112,11 +115,31 @@ struct menusave_t
     }
 };
 
+// Everything dosaveplayer2() writes goes through here. With fil set, it goes straight to the file;
+// otherwise it is recorded into the arena, which the save thread writes out later. Each record is
+// a uint32_t length, with SV_ARENALZ4 set if the data is to be compressed, followed by the data.
+#define SV_ARENALZ4 0x80000000u
+
+struct savewriter_t
+{
+    buildvfs_FILE fil;
+    uint8_t *arena;
+    uint32_t arenasiz, arenapos;
+    uint32_t rawpos;  // 1 + offset of the record uncompressed writes are appended to, or 0
+
+    void    write(void const *buf, int32_t size, int32_t count);
+    void    writeLZ4(void const *buf, int32_t size, int32_t count);
+    int32_t tell(void) const;
+};
+
 extern savebrief_t g_lastautosave, g_lastusersave, g_freshload;
 extern int32_t g_lastAutoSaveArbitraryID;
 extern bool g_saveRequested;
 extern savebrief_t * g_quickload;
 
+// milliseconds the last save kept the game thread busy, and the save thread spent writing it out
+extern double g_saveSnapshotTime, g_saveWriteTime;
+
 extern menusave_t * g_menusaves;
 extern uint16_t g_nummenusaves;
 
@@ -127,6 +150,8 @@ int32_t sv_loadheader(buildvfs_kfd fil, int32_t spot, savehead_t *h);
 int32_t sv_loadsnapshot(buildvfs_kfd fil, int32_t spot, savehead_t *h);
 int32_t sv_saveandmakesnapshot(buildvfs_FILE fil, char const *name, int8_t spot, int8_t recdiffsp, int8_t diffcompress, int8_t synccompress, bool isAutoSave = false);
 void sv_freemem();
+void sv_flushsaves(void);
+void sv_stopsavethread(void);
 void sv_prepareactors(actor_t * const actor);
 void sv_restoreactors(actor_t * const actor);
 void G_DeleteSave(savebrief_t const & sv);
@@ -506,7 +506,7 @@ int LoadSound(const char *sound)
         int nSize = kfilelength(hVoc);
         SoundLock[i] = 255; // TODO: implement cache lock properly
         SoundLen[i] = nSize;
-        g_cache.allocateBlock((intptr_t*)&SoundBuf[i], nSize, &SoundLock[i]);
+        g_cache.allocateBlock((intptr_t*)&SoundBuf[i], nSize, &SoundLock[i], CACHE1D_CAT_SOUND);
 
         if (!SoundBuf[i])
             bail2dos("Error allocating buf '%s' to %lld  (size=%ld)!\n", buffer, (intptr_t)&SoundBuf[i], nSize);
@@ -3931,7 +3931,7 @@ void drawscreen(short snum, int dasmoothratio)
                 {
                     walock[TILE_TILT] = 255;
                     if (waloff[TILE_TILT] == 0)
-                        g_cache.allocateBlock(&waloff[TILE_TILT],320L*320L,&walock[TILE_TILT]);
+                        g_cache.allocateBlock(&waloff[TILE_TILT],320L*320L,&walock[TILE_TILT],CACHE1D_CAT_TILE);
                     if ((tiltlock&1023) == 0)
                         renderSetTarget(TILE_TILT,200L>>detailmode,320L>>detailmode);
                     else
@@ -1131,7 +1131,7 @@ void G_DrawRooms(int32_t playerNum, int32_t smoothRatio)
         {
             walock[TILE_SAVESHOT] = CACHE1D_PERMANENT;
             if (waloff[TILE_SAVESHOT] == 0)
-                g_cache.allocateBlock(&waloff[TILE_SAVESHOT],200*320,&walock[TILE_SAVESHOT]);
+                g_cache.allocateBlock(&waloff[TILE_SAVESHOT],200*320,&walock[TILE_SAVESHOT],CACHE1D_CAT_TILE);
 
             if (videoGetRenderMode() == REND_CLASSIC)
                 renderSetTarget(TILE_SAVESHOT, 200, 320);
@@ -1191,7 +1191,7 @@ void G_DrawRooms(int32_t playerNum, int32_t smoothRatio)
 
                 walock[TILE_TILT] = CACHE1D_PERMANENT;
                 if (waloff[TILE_TILT] == 0)
-                    g_cache.allocateBlock(&waloff[TILE_TILT], maxTiltSize, &walock[TILE_TILT]);
+                    g_cache.allocateBlock(&waloff[TILE_TILT], maxTiltSize, &walock[TILE_TILT], CACHE1D_CAT_TILE);
 
                 renderSetTarget(TILE_TILT, viewtilexsiz, viewtileysiz);
 
@@ -7827,6 +7827,7 @@ static void G_Startup(void)
 #endif
 
     G_CompileScripts();
+    G_StartupPhase("CON");
 
     enginecompatibilitymode = ENGINE_19961112;
 
@@ -7967,6 +7968,8 @@ static void G_Startup(void)
     if (REALITY)
         RT_LoadTiles();
 
+    G_StartupPhase("art");
+
     // Make the fullscreen nuke logo background non-fullbright.  Has to be
     // after dynamic tile remapping (from C_Compile) and loading tiles.
     picanm[LOADSCREEN].sf |= PICANM_NOFULLBRIGHT_BIT;
@@ -8287,7 +8290,9 @@ int app_main(int argc, char const * const * argv)
     if (Bstrcmp(g_setupFileName, SETUPFILENAME))
         initprintf("Using config file \"%s\".\n",g_setupFileName);
 
+    G_StartupPhase(NULL);
     G_ScanGroups();
+    G_StartupPhase("group scan");
 
 #ifdef STARTUP_SETUP_WINDOW
     if (readSetup < 0 || (!g_noSetup && (ud.configversion != BYTEVERSION_EDUKE32 || ud.setup.forcesetup)) || g_commandSetup)
@@ -8300,6 +8305,8 @@ int app_main(int argc, char const * const * argv)
     }
 #endif
 
+    G_StartupPhase(NULL);  // don't count time spent in the setup window
+
     g_logFlushWindow = 0;
     G_LoadGroups(!g_noAutoLoad && !ud.setup.noautoload);
 //    flushlogwindow = 1;
@@ -8371,6 +8378,7 @@ int app_main(int argc, char const * const * argv)
     for (bssize_t i=0; i<MAXPLAYERS; i++)
         G_MaybeAllocPlayer(i);
 
+    G_StartupPhase("groups");
     G_Startup(); // a bunch of stuff including compiling cons
 
     g_player[0].playerquitflag = 1;
@@ -8403,6 +8411,8 @@ int app_main(int argc, char const * const * argv)
         free(m);
     g_defModules.clear();
 
+    G_StartupPhase("defs");
+
     if (enginePostInit())
         G_FatalEngineError();
 
@@ -8561,6 +8571,8 @@ int app_main(int argc, char const * const * argv)
     for (bssize_t i = MINIFONT + ('a'-'!'); minitext_lowercase && i < MINIFONT + ('z'-'!') + 1; ++i)
         minitext_lowercase &= (int)tileLoad(i);
 
+    G_StartupPhase("video/sound");
+
     if (RRRA)
         playmve("REDINT.MVE");
 
@@ -8595,6 +8607,9 @@ int app_main(int argc, char const * const * argv)
     if (DEER)
         ghtrophy_loadbestscores();
 
+    G_StartupPhase(NULL);  // the intro movie doesn't count
+    G_PrintStartupTimes();
+
     //    getpackets();
 
 MAIN_LOOP_RESTART:
@@ -369,15 +369,46 @@ static grpinfo_t const * FindGrpInfo(int32_t crcval, int32_t size)
     return NULL;
 }
 
+static void AddFoundGroup(char const *name, int32_t size, int32_t mtime, int32_t crcval)
+{
+    grpinfo_t const * const grptype = FindGrpInfo(crcval, size);
+    if (grptype)
+    {
+        grpfile_t * const grp = (grpfile_t *)Xcalloc(1, sizeof(grpfile_t));
+        grp->filename = Xstrdup(name);
+        grp->type = grptype;
+        grp->next = foundgrps;
+        foundgrps = grp;
+    }
+
+    struct grpcache * const fgg = (struct grpcache *)Xcalloc(1, sizeof(struct grpcache));
+    Bstrncpyz(fgg->name, name, sizeof(fgg->name));
+    fgg->size = size;
+    fgg->mtime = mtime;
+    fgg->crcval = crcval;
+    fgg->next = usedgrpcache;
+    usedgrpcache = fgg;
+}
+
 static void ProcessGroups(BUILDVFS_FIND_REC *srch)
 {
     BUILDVFS_FIND_REC *sidx;
-    struct grpcache *fg, *fgg;
+    struct grpcache *fg;
     char *fn;
     struct Bstat st;
 
-#define BUFFER_SIZE (1024 * 1024 * 8)
-    uint8_t *buf = (uint8_t *)Xmalloc(BUFFER_SIZE);
+    // files missing from grpfiles.cache or changed since are collected first and then checksummed
+    // all at once on the thread pool; the results are added in directory order afterwards so the
+    // found list comes out exactly as it did when every file was hashed in turn
+    struct grpentry
+    {
+        BUILDVFS_FIND_REC *rec;
+        int32_t size, mtime, crcval;
+        int32_t job;
+    };
+
+    GrowArray<grpentry> entries;
+    GrowArray<char *> paths;
 
     for (sidx = srch; sidx; sidx = sidx->next)
     {
@@ -386,77 +417,56 @@ static void ProcessGroups(BUILDVFS_FIND_REC *srch)
             if (!Bstrcmp(fg->name, sidx->name)) break;
         }
 
-        if (fg)
+        if (findfrompath(sidx->name, &fn)) continue; // failed to resolve the filename
+        if (Bstat(fn, &st))
         {
-            if (findfrompath(sidx->name, &fn)) continue; // failed to resolve the filename
-            if (Bstat(fn, &st))
-            {
-                Xfree(fn);
-                continue;
-            } // failed to stat the file
             Xfree(fn);
-            if (fg->size == (int32_t)st.st_size && fg->mtime == (int32_t)st.st_mtime)
-            {
-                grpinfo_t const * const grptype = FindGrpInfo(fg->crcval, fg->size);
-                if (grptype)
-                {
-                    grpfile_t * const grp = (grpfile_t *)Xcalloc(1, sizeof(grpfile_t));
-                    grp->filename = Xstrdup(sidx->name);
-                    grp->type = grptype;
-                    grp->next = foundgrps;
-                    foundgrps = grp;
-                }
+            continue;
+        } // failed to stat the file
 
-                fgg = (struct grpcache *)Xcalloc(1, sizeof(struct grpcache));
-                strcpy(fgg->name, fg->name);
-                fgg->size = fg->size;
-                fgg->mtime = fg->mtime;
-                fgg->crcval = fg->crcval;
-                fgg->next = usedgrpcache;
-                usedgrpcache = fgg;
-                continue;
-            }
+        if (fg && fg->size == (int32_t)st.st_size && fg->mtime == (int32_t)st.st_mtime)
+        {
+            Xfree(fn);
+            entries.append({ sidx, fg->size, fg->mtime, fg->crcval, -1 });
+            continue;
         }
 
-        {
-            int32_t b, fh;
-            int32_t crcval = 0;
+        entries.append({ sidx, (int32_t)st.st_size, (int32_t)st.st_mtime, 0, (int32_t)paths.size() });
+        paths.append(fn);
+    }
 
-            fh = openfrompath(sidx->name, BO_RDONLY|BO_BINARY, BS_IREAD);
-            if (fh < 0) continue;
-            if (Bfstat(fh, &st)) continue;
+    auto failed = (uint8_t *)Xcalloc(paths.size() + 1, sizeof(uint8_t));
 
-            initprintf(" Checksumming %s...", sidx->name);
-            do
-            {
-                b = read(fh, buf, BUFFER_SIZE);
-                if (b > 0) crcval = Bcrc32((uint8_t *)buf, b, crcval);
-            }
-            while (b == BUFFER_SIZE);
-            close(fh);
-            initprintf(" Done\n");
+    if (paths.size())
+    {
+        auto crcs = (uint32_t *)Xmalloc(paths.size() * sizeof(uint32_t));
 
-            grpinfo_t const * const grptype = FindGrpInfo(crcval, st.st_size);
-            if (grptype)
-            {
-                grpfile_t * const grp = (grpfile_t *)Xcalloc(1, sizeof(grpfile_t));
-                grp->filename = Xstrdup(sidx->name);
-                grp->type = grptype;
-                grp->next = foundgrps;
-                foundgrps = grp;
-            }
+        initprintf(" Checksumming %d file%s...", (int32_t)paths.size(), paths.size() > 1 ? "s" : "");
+        G_CrcFiles(paths.size(), paths.begin(), crcs, failed);
+        initprintf(" Done\n");
 
-            fgg = (struct grpcache *)Xcalloc(1, sizeof(struct grpcache));
-            Bstrncpy(fgg->name, sidx->name, BMAX_PATH);
-            fgg->size = st.st_size;
-            fgg->mtime = st.st_mtime;
-            fgg->crcval = crcval;
-            fgg->next = usedgrpcache;
-            usedgrpcache = fgg;
+        for (grpentry &e : entries)
+        {
+            if (e.job >= 0)
+                e.crcval = (int32_t)crcs[e.job];
         }
+
+        Xfree(crcs);
     }
 
-    Xfree(buf);
+    for (grpentry const &e : entries)
+    {
+        if (e.job < 0 || !failed[e.job])
+            AddFoundGroup(e.rec->name, e.size, e.mtime, e.crcval);
+    }
+
+    for (char *path : paths)
+        Xfree(path);
+
+    Xfree(failed);
+
+    entries.clear();
+    paths.clear();
 }
 
 static void ProcessDN64Groups(void)
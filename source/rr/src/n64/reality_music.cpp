@@ -107,7 +107,7 @@ void RT_LoadRTSound(rt_sound_t *snd)
     RT_ROMSeek(snd->wave->base);
     int l = snd->wave->len;
     snd->lock = 200;
-    g_cache.allocateBlock((intptr_t *)&snd->ptr, l, &snd->lock);
+    g_cache.allocateBlock((intptr_t *)&snd->ptr, l, &snd->lock, CACHE1D_CAT_SOUND);
     RT_ROMRead(snd->ptr, l);
 }
 
@@ -405,7 +405,7 @@ bool RT_TileLoad(int16_t tilenum)
     if (rt_waloff[tileid] == 0)
     {
         rt_walock[tileid] = CACHE1D_UNLOCKED;
-        g_cache.allocateBlock(&rt_waloff[tileid], bufsize, &rt_walock[tileid]);
+        g_cache.allocateBlock(&rt_waloff[tileid], bufsize, &rt_walock[tileid], CACHE1D_CAT_TILE);
     }
     if (!rt_waloff[tileid])
         return false;
@@ -343,7 +343,7 @@ int RT_LoadSound(int num)
     int l = sound->wave->len;
     g_soundlocks[num] = 200;
     snd.siz = sound->wave->len;
-    g_cache.allocateBlock((intptr_t *)&snd.ptr, l, (char *)&g_soundlocks[num]);
+    g_cache.allocateBlock((intptr_t *)&snd.ptr, l, (char *)&g_soundlocks[num], CACHE1D_CAT_SOUND);
     l = RT_ROMRead(snd.ptr, l);
 
     return l;
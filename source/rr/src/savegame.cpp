@@ -294,7 +294,7 @@ int32_t G_LoadSaveHeaderNew(char const *fn, savehead_t *saveh)
 
     walock[TILE_LOADSHOT] = 255;
     if (waloff[TILE_LOADSHOT] == 0)
-        g_cache.allocateBlock(&waloff[TILE_LOADSHOT], 320*200, &walock[TILE_LOADSHOT]);
+        g_cache.allocateBlock(&waloff[TILE_LOADSHOT], 320*200, &walock[TILE_LOADSHOT], CACHE1D_CAT_TILE);
     tilesiz[TILE_LOADSHOT].x = 200;
     tilesiz[TILE_LOADSHOT].y = 320;
     if (screenshotofs)
@@ -2162,6 +2162,9 @@ static void postloadplayer(int32_t savegamep)
         actor[i].lightId = -1;
     }
 #endif
+
+    calc_sector_reachability();
+
     for (i=0; i<MAXPLAYERS; i++)
         g_player[i].ps->drug_timer = 0;
 
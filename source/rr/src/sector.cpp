@@ -390,6 +390,23 @@ int __fastcall A_FindPlayer(const spritetype *pSprite, int32_t *dist)
     return closestPlayer;
 }
 
+// Sliding doors animate wall coordinates through the pointers SetAnimation() was given, so the
+// struct trackers only see the first step; the sector index and PVS are told about each one.
+static void G_AnimatedWallMoved(int32_t const *animPtr)
+{
+    intptr_t const wallOfs = (intptr_t)animPtr - (intptr_t)&wall[0];
+
+    if (wallOfs < 0 || wallOfs >= (intptr_t)(numwalls * sizeof(walltype)))
+        return;
+
+    int const wallNum = wallOfs / sizeof(walltype);
+
+    if (pvsactive)
+        pvsTouchWall(wallNum);
+
+    sectorindexUpdateWall(wallNum);
+}
+
 void G_DoSectorAnimations(void)
 {
     for (bssize_t animNum=g_animateCnt-1; animNum>=0; animNum--)
@@ -454,6 +471,7 @@ void G_DoSectorAnimations(void)
         }
 
         *g_animatePtr[animNum] = animPos;
+        G_AnimatedWallMoved(g_animatePtr[animNum]);
     }
 }
 
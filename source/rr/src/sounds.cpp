@@ -510,7 +510,7 @@ int32_t S_LoadSound(int num)
     int32_t l = kfilelength(fp);
     g_soundlocks[num] = 200;
     snd.siz = l;
-    g_cache.allocateBlock((intptr_t *)&snd.ptr, l, (char *)&g_soundlocks[num]);
+    g_cache.allocateBlock((intptr_t *)&snd.ptr, l, (char *)&g_soundlocks[num], CACHE1D_CAT_SOUND);
     l = kread(fp, snd.ptr, l);
     kclose(fp);
 
@@ -301,12 +301,45 @@ CanSeePlayer(short SpriteNum)
     //if (FAF_Sector(sp->sectnum))
     //    return(TRUE);
 
+    // answered from the batch PrepareCanSeePlayer() ran when neither end is above or below water
+    if ((sp->sectnum < 0 || !FAF_Sector(sp->sectnum)) && (u->tgt_sp->sectnum < 0 || !FAF_Sector(u->tgt_sp->sectnum)))
+        return canseeCached(sp->x, sp->y, look_height, sp->sectnum, u->tgt_sp->x, u->tgt_sp->y, SPRITEp_UPPER(u->tgt_sp), u->tgt_sp->sectnum) ? TRUE : FALSE;
+
     if (FAFcansee(sp->x, sp->y, look_height, sp->sectnum, u->tgt_sp->x, u->tgt_sp->y, SPRITEp_UPPER(u->tgt_sp), u->tgt_sp->sectnum))
         return TRUE;
     else
         return FALSE;
 }
 
+static canseequery_t CanSeeQueries[MAXSPRITES];
+
+void
+PrepareCanSeePlayer(void)
+{
+    int i, nexti, num = 0;
+    USERp u;
+    SPRITEp sp;
+
+    TRAVERSE_SPRITE_STAT(headspritestat[STAT_ENEMY], i, nexti)
+    {
+        u = User[i];
+        if (!u || !u->tgt_sp)
+            continue;
+
+        sp = u->SpriteP;
+        if ((sp->sectnum >= 0 && FAF_Sector(sp->sectnum)) || (u->tgt_sp->sectnum >= 0 && FAF_Sector(u->tgt_sp->sectnum)))
+            continue;
+
+        canseequery_t &q = CanSeeQueries[num++];
+        q.pos1 = { sp->x, sp->y, SPRITEp_TOS(sp) };
+        q.sect1 = sp->sectnum;
+        q.pos2 = { u->tgt_sp->x, u->tgt_sp->y, SPRITEp_UPPER(u->tgt_sp) };
+        q.sect2 = u->tgt_sp->sectnum;
+    }
+
+    canseePrepareCache(CanSeeQueries, num);
+}
+
 int
 CanHitPlayer(short SpriteNum)
 {
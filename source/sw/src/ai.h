@@ -76,6 +76,7 @@ void DoActorSetSpeed(short SpriteNum,uint8_t speed);
 short ChooseActionNumber(short decision[]);
 int DoActorNoise(ANIMATORp Action,short SpriteNum);
 int CanSeePlayer(short SpriteNum);
+void PrepareCanSeePlayer(void);
 int CanHitPlayer(short SpriteNum);
 int DoActorPickClosePlayer(short SpriteNum);
 int CloseRangeDist(SPRITEp sp1,SPRITEp sp2);
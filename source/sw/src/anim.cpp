@@ -244,7 +244,7 @@ unsigned char *LoadAnm(short anim_num)
             return NULL;
         length = kfilelength(handle);
 
-        g_cache.allocateBlock((intptr_t *) &anm_ptr[anim_num], length + sizeof(anim_t), &walock[ANIM_TILE(ANIMnum)]);
+        g_cache.allocateBlock((intptr_t *) &anm_ptr[anim_num], length + sizeof(anim_t), &walock[ANIM_TILE(ANIMnum)], CACHE1D_CAT_ANIM);
         animbuf = (unsigned char *)((intptr_t)anm_ptr[anim_num] + sizeof(anim_t));
 
         kread(handle, animbuf, length);
@@ -2698,7 +2698,7 @@ ScreenLoadSaveSetup(void)
     ScreenTileLock();
 
     if (!waloff[SAVE_SCREEN_TILE])
-        g_cache.allocateBlock((intptr_t*)&waloff[SAVE_SCREEN_TILE], SAVE_SCREEN_XSIZE * SAVE_SCREEN_YSIZE, &walock[SAVE_SCREEN_TILE]);
+        g_cache.allocateBlock((intptr_t*)&waloff[SAVE_SCREEN_TILE], SAVE_SCREEN_XSIZE * SAVE_SCREEN_YSIZE, &walock[SAVE_SCREEN_TILE], CACHE1D_CAT_TILE);
 
     tilesiz[SAVE_SCREEN_TILE].x = SAVE_SCREEN_XSIZE;
     tilesiz[SAVE_SCREEN_TILE].x = SAVE_SCREEN_YSIZE;
@@ -925,6 +925,7 @@ InitGame(int32_t argc, char const * const * argv)
 
     memcpy(palette_data,palette,768);
     InitPalette();
+    G_StartupPhase("engine");
     // sets numplayers, connecthead, connectpoint2, myconnectindex
 
     if (!firstnet)
@@ -944,6 +945,7 @@ InitGame(int32_t argc, char const * const * argv)
         }
     }
     initsynccrc();
+    G_StartupPhase(NULL);  // waiting for other players doesn't count
 
     // code to duplicate packets
     if (numplayers > 4 && MovesPerPacket == 1)
@@ -996,6 +998,7 @@ InitGame(int32_t argc, char const * const * argv)
     //buildputs("Loading sound and graphics...\n");
     //AnimateCacheCursor();
     LoadImages("tiles%03i.art");
+    G_StartupPhase("art");
 
     // Now free it up for later use
     /*
@@ -1029,6 +1032,8 @@ InitGame(int32_t argc, char const * const * argv)
         Xfree(m);
     g_defModules.clear();
 
+    G_StartupPhase("defs");
+
     if (enginePostInit())
         SW_FatalEngineError();
 
@@ -1053,6 +1058,8 @@ InitGame(int32_t argc, char const * const * argv)
         DoTheCache();
     }
 
+    G_StartupPhase("precache");
+
     Set_GameMode();
     GraphicsMode = TRUE;
     SetupAspectRatio();
@@ -1063,6 +1070,9 @@ InitGame(int32_t argc, char const * const * argv)
     InitMusic();
 
     enginecompatibilitymode = ENGINE_19961112; // SW 1.0: 19970212, SW 1.1-1.2: 19970522
+
+    G_StartupPhase("video/sound");
+    G_PrintStartupTimes();
 }
 
 
@@ -3537,7 +3547,9 @@ int32_t app_main(int32_t argc, char const * const * argv)
         exit(1);
     }
 
+    G_StartupPhase(NULL);
     SW_ScanGroups();
+    G_StartupPhase("group scan");
 
 #ifdef STARTUP_SETUP_WINDOW
     if (i < 0 || CommandSetup || (ud_setup.ForceSetup && !g_noSetup))
@@ -3551,7 +3563,9 @@ int32_t app_main(int32_t argc, char const * const * argv)
     }
 #endif
 
+    G_StartupPhase(NULL);  // don't count time spent in the setup window
     SW_LoadGroups();
+    G_StartupPhase("groups");
 
     if (!g_useCwd)
         SW_CleanupSearchPaths();
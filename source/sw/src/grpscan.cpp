@@ -27,6 +27,7 @@
 #include "scriptfile.h"
 #include "cache1d.h"
 #include "crc32.h"
+#include "common.h"
 
 #include "grpscan.h"
 #include "common_game.h"
@@ -157,13 +158,47 @@ static struct internalgrpfile const * FindGrpInfo(uint32_t crcval, int32_t size)
     return NULL;
 }
 
+static void AddFoundGroup(char const *name, int size, int mtime, uint32_t crcval)
+{
+    struct internalgrpfile const * const grptype = FindGrpInfo(crcval, size);
+    if (grptype)
+    {
+        auto grp = (struct grpfile *)Xcalloc(1, sizeof(struct grpfile));
+        grp->filename = Xstrdup(name);
+        grp->type = grptype;
+        grp->next = foundgrps;
+        foundgrps = grp;
+    }
+
+    auto fgg = (struct grpcache *)Xcalloc(1, sizeof(struct grpcache));
+    Bstrncpyz(fgg->name, name, sizeof(fgg->name));
+    fgg->size = size;
+    fgg->mtime = mtime;
+    fgg->crcval = crcval;
+    fgg->next = usedgrpcache;
+    usedgrpcache = fgg;
+}
+
 static void ProcessGroups(BUILDVFS_FIND_REC *srch, native_t maxsize)
 {
     BUILDVFS_FIND_REC *sidx;
-    struct grpcache *fg, *fgg;
+    struct grpcache *fg;
     char *fn;
     struct Bstat st;
 
+    // uncached files are checksummed together on the thread pool once the directory has been
+    // walked, then everything is added in directory order as before
+    struct grpentry
+    {
+        BUILDVFS_FIND_REC *rec;
+        int size, mtime;
+        uint32_t crcval;
+        int job;
+    };
+
+    GrowArray<grpentry> entries;
+    GrowArray<char *> paths;
+
     for (sidx = srch; sidx; sidx = sidx->next)
     {
         for (fg = grpcache; fg; fg = fg->next)
@@ -171,73 +206,54 @@ static void ProcessGroups(BUILDVFS_FIND_REC *srch, native_t maxsize)
             if (!Bstrcmp(fg->name, sidx->name)) break;
         }
 
-        if (fg)
+        if (findfrompath(sidx->name, &fn)) continue;    // failed to resolve the filename
+        if (Bstat(fn, &st)) { Xfree(fn); continue; } // failed to stat the file
+
+        if (fg && fg->size == st.st_size && fg->mtime == st.st_mtime)
         {
-            if (findfrompath(sidx->name, &fn)) continue;    // failed to resolve the filename
-            if (Bstat(fn, &st)) { Xfree(fn); continue; } // failed to stat the file
             Xfree(fn);
-            if (fg->size == st.st_size && fg->mtime == st.st_mtime)
-            {
-                struct internalgrpfile const * const grptype = FindGrpInfo(fg->crcval, fg->size);
-                if (grptype)
-                {
-                    auto grp = (struct grpfile *)Xcalloc(1, sizeof(struct grpfile));
-                    grp->filename = Xstrdup(sidx->name);
-                    grp->type = grptype;
-                    grp->next = foundgrps;
-                    foundgrps = grp;
-                }
-
-                fgg = (struct grpcache *)Xcalloc(1, sizeof(struct grpcache));
-                strcpy(fgg->name, fg->name);
-                fgg->size = fg->size;
-                fgg->mtime = fg->mtime;
-                fgg->crcval = fg->crcval;
-                fgg->next = usedgrpcache;
-                usedgrpcache = fgg;
-                continue;
-            }
+            entries.append({ sidx, fg->size, fg->mtime, fg->crcval, -1 });
+            continue;
         }
 
-        {
-            int b, fh;
-            unsigned int crcval = 0;
-            unsigned char buf[16*512];
+        if (st.st_size > maxsize) { Xfree(fn); continue; }
 
-            fh = openfrompath(sidx->name, BO_RDONLY|BO_BINARY, BS_IREAD);
-            if (fh < 0) continue;
-            if (fstat(fh, &st)) continue;
-            if (st.st_size > maxsize) continue;
+        entries.append({ sidx, (int)st.st_size, (int)st.st_mtime, 0, (int)paths.size() });
+        paths.append(fn);
+    }
 
-            buildprintf(" Checksumming %s...", sidx->name);
-            do
-            {
-                b = read(fh, buf, sizeof(buf));
-                if (b > 0) crcval = Bcrc32(buf, b, crcval);
-            }
-            while (b == sizeof(buf));
-            close(fh);
-            buildputs(" Done\n");
+    auto failed = (uint8_t *)Xcalloc(paths.size() + 1, sizeof(uint8_t));
 
-            struct internalgrpfile const * const grptype = FindGrpInfo(crcval, st.st_size);
-            if (grptype)
-            {
-                auto grp = (struct grpfile *)Xcalloc(1, sizeof(struct grpfile));
-                grp->filename = Xstrdup(sidx->name);
-                grp->type = grptype;
-                grp->next = foundgrps;
-                foundgrps = grp;
-            }
+    if (paths.size())
+    {
+        auto crcs = (uint32_t *)Xmalloc(paths.size() * sizeof(uint32_t));
+
+        buildprintf(" Checksumming %d file%s...", (int)paths.size(), paths.size() > 1 ? "s" : "");
+        G_CrcFiles(paths.size(), paths.begin(), crcs, failed);
+        buildputs(" Done\n");
 
-            fgg = (struct grpcache *)Xcalloc(1, sizeof(struct grpcache));
-            strncpy(fgg->name, sidx->name, BMAX_PATH);
-            fgg->size = st.st_size;
-            fgg->mtime = st.st_mtime;
-            fgg->crcval = crcval;
-            fgg->next = usedgrpcache;
-            usedgrpcache = fgg;
+        for (grpentry &e : entries)
+        {
+            if (e.job >= 0)
+                e.crcval = crcs[e.job];
         }
+
+        Xfree(crcs);
+    }
+
+    for (grpentry const &e : entries)
+    {
+        if (e.job < 0 || !failed[e.job])
+            AddFoundGroup(e.rec->name, e.size, e.mtime, e.crcval);
     }
+
+    for (char *path : paths)
+        Xfree(path);
+
+    Xfree(failed);
+
+    entries.clear();
+    paths.clear();
 }
 
 int ScanGroups(void)
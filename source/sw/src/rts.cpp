@@ -295,7 +295,7 @@ void *RTS_GetSound(int32_t lump)
     if (lumpcache[lump] == (intptr_t)NULL)
     {
         lumplockbyte[lump] = CACHE_LOCK_START;
-        g_cache.allocateBlock(&lumpcache[lump],(int)RTS_SoundLength(lump-1),&lumplockbyte[lump]);
+        g_cache.allocateBlock(&lumpcache[lump],(int)RTS_SoundLength(lump-1),&lumplockbyte[lump],CACHE1D_CAT_SOUND);
         RTS_ReadLump(lump, lumpcache[lump]);
     }
     else
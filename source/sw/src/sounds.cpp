@@ -821,7 +821,7 @@ SWBOOL CacheSound(int num, int /*type*/)
             */
             vp->lock = CACHE_UNLOCK_MAX;
 
-            g_cache.allocateBlock((intptr_t*)&vp->data, length, &vp->lock);
+            g_cache.allocateBlock((intptr_t*)&vp->data, length, &vp->lock, CACHE1D_CAT_SOUND);
 
 #if 0
             // DEBUG
@@ -6803,6 +6803,8 @@ SpriteControl(void)
     if (MoveSkip2 == 0)                 // limit to 20 times a second
     {
         // move bad guys around
+        PrepareCanSeePlayer();
+
         TRAVERSE_SPRITE_STAT(headspritestat[STAT_ENEMY], i, nexti)
         {
             ASSERT(User[i]);
@@ -6852,6 +6854,8 @@ SpriteControl(void)
                 RESET(u->Flags, SPR_ATTACKED);
             }
         }
+
+        canseeClearCache();
     }
 
     // Skip4 things
@@ -24,6 +24,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 */
 //-------------------------------------------------------------------------
 #include "build.h"
+#include "sectorindex.h"
 
 #include "names2.h"
 #include "panel.h"
@@ -1759,6 +1760,8 @@ MovePoints(SECTOR_OBJECTp sop, short delta_ang, int nx, int ny)
             }
         }
 
+        sectorindexUpdateSector(*sectp - sector);
+
 PlayerPart:
 
         TRAVERSE_CONNECT(pnum)
@@ -2163,6 +2166,8 @@ CollapseSectorObject(SECTOR_OBJECTp sop, int nx, int ny)
                     wp->y = ny;
                 }
             }
+
+            sectorindexUpdateSector(*sectp - sector);
         }
     }
 }